@@ -0,0 +1,195 @@
+#pragma once
+
+#include "Engine/scene/node_handle.h"
+#include "Engine/thread_pool/thread_pool.h"
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+using std::vector;
+
+// --- CallbackRegistry ---
+// Stores per-node callbacks in packed arrays so executing them is a linear walk instead of
+// pointer chasing through hash buckets.  A sparse array indexed by the node handle's index points
+// at each callback's slot, removal swaps the last callback into the hole.  Handles whose generation
+// doesn't match the stored one are treated as absent, so a stale handle can't remove the callback
+// of the node that reused its slot.
+//
+// Callbacks are grouped into phases that run in ascending order.  Inside a phase the callbacks
+// run in parallel chunks on a `ThreadPool::Pool`, unless they were added as serial in which case
+// they run one at a time in the order they were added, after that phase's parallel callbacks.
+// ------------------------
+
+template<typename... Args>
+class CallbackRegistry {
+public:
+	using Callback = std::function<void(Args...)>;
+
+	static constexpr size_t DEFAULT_CHUNK_SIZE = 256;
+
+	void add(NodeHandle node, Callback callback, int phase = 0, bool serial = false) {
+		if (node.is_null()) {
+			throw std::invalid_argument("Callbacks can't be added for a null node.");
+		}
+
+		// Re-adding a node replaces its callback, possibly moving it to a different phase.
+		// This also drops a callback left behind by a destroyed node that had the same slot.
+		this->remove_slot(node.index);
+
+		uint32_t groupIndex = this->find_or_create_group(phase, serial);
+		Group& group = this->groups[groupIndex];
+
+		if (static_cast<size_t>(node.index) >= this->sparse.size()) {
+			this->sparse.resize(static_cast<size_t>(node.index) + 1, Slot{ INVALID_INDEX, INVALID_INDEX });
+		}
+
+		this->sparse[node.index] = Slot{ groupIndex, static_cast<uint32_t>(group.callbacks.size()) };
+		group.nodes.push_back(node);
+		group.callbacks.push_back(std::move(callback));
+		this->callback_count++;
+	}
+
+	void remove(NodeHandle node) {
+		if (this->contains(node)) {
+			this->remove_slot(node.index);
+		}
+	}
+
+	bool contains(NodeHandle node) const {
+		if (static_cast<size_t>(node.index) >= this->sparse.size() || this->sparse[node.index].group == INVALID_INDEX) {
+			return false;
+		}
+
+		Slot slot = this->sparse[node.index];
+		return this->groups[slot.group].nodes[slot.index] == node;
+	}
+
+	size_t size() const {
+		return this->callback_count;
+	}
+
+	void execute(ThreadPool::Pool* pool, Args... args) {
+		// Callbacks must not add or remove callbacks from this registry while it is executing.
+		for (size_t g = 0; g < this->groups.size(); g++) {
+			Group& group = this->groups[g];
+			size_t count = group.callbacks.size();
+
+			if (group.serial || pool == nullptr || count <= this->chunk_size) {
+				for (size_t i = 0; i < count; i++) {
+					group.callbacks[i](args...);
+				}
+			}
+			else {
+				pool->parallel_for(count, this->chunk_size, [&group, &args...](size_t begin, size_t end) {
+					for (size_t i = begin; i < end; i++) {
+						group.callbacks[i](args...);
+					}
+				});
+			}
+
+			bool isLastOfPhase = g + 1 == this->groups.size() || this->groups[g + 1].phase != group.phase;
+			if (isLastOfPhase && this->phase_end_callback) {
+				this->phase_end_callback();
+			}
+		}
+
+		// Work the hook hands over to the next phase still has to happen with no callbacks.
+		if (this->groups.empty() && this->phase_end_callback) {
+			this->phase_end_callback();
+		}
+	}
+
+	void set_phase_end_callback(std::function<void()> callback) {
+		this->phase_end_callback = std::move(callback);
+	}
+	/// Called once every phase's parallel and serial callbacks have all finished, before the next
+	// phase starts.
+
+	void set_chunk_size(size_t chunk_size) {
+		this->chunk_size = std::max<size_t>(chunk_size, 1);
+	}
+	/// The amount of callbacks each thread pool job executes.
+
+private:
+
+	static constexpr uint32_t INVALID_INDEX = std::numeric_limits<uint32_t>::max();
+
+	struct Group {
+		int phase;
+		bool serial;
+		vector<NodeHandle> nodes;
+		vector<Callback> callbacks;
+	};
+
+	struct Slot {
+		uint32_t group;
+		uint32_t index;
+	};
+
+	void remove_slot(uint32_t node_index) {
+		if (static_cast<size_t>(node_index) >= this->sparse.size() || this->sparse[node_index].group == INVALID_INDEX) {
+			return;
+		}
+
+		Slot slot = this->sparse[node_index];
+		Group& group = this->groups[slot.group];
+
+		if (group.serial) {
+			// Serial callbacks keep the order they were added in.
+			group.nodes.erase(group.nodes.begin() + slot.index);
+			group.callbacks.erase(group.callbacks.begin() + slot.index);
+			for (size_t i = slot.index; i < group.nodes.size(); i++) {
+				this->sparse[group.nodes[i].index].index = static_cast<uint32_t>(i);
+			}
+		}
+		else {
+			uint32_t last = static_cast<uint32_t>(group.callbacks.size() - 1);
+			if (slot.index != last) {
+				group.nodes[slot.index] = group.nodes[last];
+				group.callbacks[slot.index] = std::move(group.callbacks[last]);
+				this->sparse[group.nodes[slot.index].index].index = slot.index;
+			}
+			group.nodes.pop_back();
+			group.callbacks.pop_back();
+		}
+
+		this->sparse[node_index] = Slot{ INVALID_INDEX, INVALID_INDEX };
+		this->callback_count--;
+	}
+
+	uint32_t find_or_create_group(int phase, bool serial) {
+		// Groups are sorted by phase, a phase's parallel group comes before its serial group.
+		auto it = std::lower_bound(this->groups.begin(), this->groups.end(), std::make_pair(phase, serial),
+			[](const Group& group, const std::pair<int, bool>& key) {
+				return std::make_pair(group.phase, group.serial) < key;
+			}
+		);
+
+		uint32_t groupIndex = static_cast<uint32_t>(it - this->groups.begin());
+
+		if (it != this->groups.end() && it->phase == phase && it->serial == serial) {
+			return groupIndex;
+		}
+
+		this->groups.insert(it, Group{ phase, serial, {}, {} });
+
+		// Every group after the new one moved down by one.
+		for (size_t g = groupIndex + 1; g < this->groups.size(); g++) {
+			for (NodeHandle node : this->groups[g].nodes) {
+				this->sparse[node.index].group = static_cast<uint32_t>(g);
+			}
+		}
+
+		return groupIndex;
+	}
+
+	vector<Group> groups;
+	vector<Slot> sparse;
+	size_t callback_count = 0;
+	size_t chunk_size = DEFAULT_CHUNK_SIZE;
+
+	std::function<void()> phase_end_callback;
+};
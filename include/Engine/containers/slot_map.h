@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+using std::vector;
+
+// --- SlotMap ---
+// Maps generational handles to values without hashing.
+//
+// Values live in one contiguous array of slots indexed by `handle.index`.  Each slot stores the
+// generation of the handle that currently owns it, so validating a handle is one array access
+// and one compare.  Erased slots are chained into a free list and reused by later inserts, with
+// their generation bumped so every old handle to them stops validating.
+//
+// `Handle` is any struct with `uint32_t index` and `uint32_t generation` members, generation 0
+// is reserved for null handles.
+// ---------------
+
+template<typename T, typename Handle>
+class SlotMap {
+public:
+
+	Handle insert(T value) {
+		uint32_t index;
+
+		if (this->free_head != INVALID_INDEX) {
+			index = this->free_head;
+			this->free_head = this->slots[index].next_free;
+		}
+		else {
+			if (this->slots.size() >= INVALID_INDEX) {
+				throw std::length_error("SlotMap is full.");
+			}
+			index = static_cast<uint32_t>(this->slots.size());
+			this->slots.push_back(Slot{ T(), 1, INVALID_INDEX, false });
+		}
+
+		Slot& slot = this->slots[index];
+		slot.value = std::move(value);
+		slot.occupied = true;
+		this->count++;
+
+		return Handle{ index, slot.generation };
+	}
+
+	bool erase(Handle handle) {
+		if (!this->contains(handle)) {
+			return false;
+		}
+
+		Slot& slot = this->slots[handle.index];
+		slot.value = T();
+		slot.occupied = false;
+		this->count--;
+
+		// A slot whose generation would wrap around is retired instead of reused, otherwise
+		// a very old handle could validate again.
+		if (slot.generation == std::numeric_limits<uint32_t>::max()) {
+			return true;
+		}
+
+		slot.generation++;
+		slot.next_free = this->free_head;
+		this->free_head = handle.index;
+
+		return true;
+	}
+
+	bool contains(Handle handle) const {
+		return handle.index < this->slots.size()
+			&& this->slots[handle.index].occupied
+			&& this->slots[handle.index].generation == handle.generation;
+	}
+
+	T* get(Handle handle) {
+		return this->contains(handle) ? &this->slots[handle.index].value : nullptr;
+	}
+	const T* get(Handle handle) const {
+		return this->contains(handle) ? &this->slots[handle.index].value : nullptr;
+	}
+	/// Null if the handle is stale.
+
+	T& operator[](Handle handle) {
+		return this->slots[handle.index].value;
+	}
+	const T& operator[](Handle handle) const {
+		return this->slots[handle.index].value;
+	}
+	/// Unchecked, only use with handles that are known to be live.
+
+	size_t size() const {
+		return this->count;
+	}
+
+	size_t slot_count() const {
+		return this->slots.size();
+	}
+	/// The size of the slot array, one past the highest handle index ever handed out.
+
+	void clear() {
+		// Keep the generations so handles from before the clear stay stale.
+		for (uint32_t i = 0; i < this->slots.size(); i++) {
+			if (this->slots[i].occupied) {
+				this->erase(Handle{ i, this->slots[i].generation });
+			}
+		}
+	}
+
+	void reserve(size_t capacity) {
+		this->slots.reserve(capacity);
+	}
+
+private:
+
+	static constexpr uint32_t INVALID_INDEX = std::numeric_limits<uint32_t>::max();
+
+	struct Slot {
+		T value;
+		uint32_t generation;
+		uint32_t next_free;
+		bool occupied;
+	};
+
+	vector<Slot> slots;
+	uint32_t free_head = INVALID_INDEX;
+	size_t count = 0;
+};
@@ -0,0 +1,131 @@
+#pragma once
+
+#include "Engine/ecs/component.h"
+#include "Engine/scene/node_handle.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+using std::vector;
+
+// --- Chunk ---
+// A fixed 16 KB block holding up to `Archetype::chunk_capacity` nodes of one archetype.
+// Each component is its own column (structure of arrays) so a system that reads one component
+// streams through contiguous memory and never loads the others.
+//
+// Every column carries the `ComponentStore` change version of its last write, so incremental
+// systems can skip the chunks that didn't change since they last ran.
+// -------------
+
+struct Chunk {
+	static constexpr size_t SIZE = 16 * 1024;
+
+	alignas(64) std::byte data[SIZE];
+
+	uint32_t count = 0;
+
+	vector<uint64_t> column_versions;
+	/// One per archetype column, in column order.
+};
+
+// --- Archetype ---
+// Every node with exactly the same set of components lives in the same archetype, packed into
+// its chunks.  All chunks but the last are always full, removing a node moves the archetype's
+// last node into the hole.
+// -----------------
+
+class Archetype {
+public:
+
+	Archetype(const ComponentMask& mask);
+
+	~Archetype();
+
+	Archetype(const Archetype&) = delete;
+	Archetype& operator=(const Archetype&) = delete;
+
+	struct Row {
+		uint32_t chunk;
+		uint32_t row;
+	};
+
+	Row allocate_row(NodeHandle node);
+	/// Reserves a row at the end for `node`.  Its component columns are left uninitialized.
+
+	NodeHandle remove_row(Row row);
+	/// Destroys the row's components and fills the hole with the archetype's last row.
+	// Returns the node that moved into `row`, or a null handle when nothing had to move.
+
+	bool has_component(ComponentId id) const {
+		return this->column_indices[id] >= 0;
+	}
+
+	NodeHandle* get_nodes(Chunk& chunk) const {
+		return reinterpret_cast<NodeHandle*>(chunk.data);
+	}
+
+	void* get_component(Chunk& chunk, ComponentId id, uint32_t row) const {
+		const Column& column = this->columns[this->column_indices[id]];
+		return chunk.data + column.offset + static_cast<size_t>(row) * column.size;
+	}
+	/// The component must be in this archetype.
+
+	template<typename T>
+	T* get_column(Chunk& chunk) const {
+		return static_cast<T*>(this->get_component(chunk, Components::get_id<T>(), 0));
+	}
+
+	uint64_t get_version(const Chunk& chunk, ComponentId id) const {
+		// Loading through an atomic_ref doesn't write, it just can't be made of a const value.
+		uint64_t& version = const_cast<uint64_t&>(chunk.column_versions[this->column_indices[id]]);
+		return std::atomic_ref<uint64_t>(version).load(std::memory_order_relaxed);
+	}
+
+	void mark_changed(Chunk& chunk, ComponentId id, uint64_t version) const {
+		// Jobs writing components of one chunk stamp it at the same time.
+		std::atomic_ref<uint64_t>(chunk.column_versions[this->column_indices[id]]).store(version, std::memory_order_relaxed);
+	}
+
+	void mark_chunk_changed(Chunk& chunk, uint64_t version) const {
+		std::fill(chunk.column_versions.begin(), chunk.column_versions.end(), version);
+	}
+	/// Stamps every column, used when rows are added, removed or moved.
+
+	size_t size() const {
+		return this->node_count;
+	}
+
+//////////////////////
+///// ATTRIBUTES /////
+//////////////////////
+
+	struct Column {
+		ComponentId id;
+		uint32_t offset;
+		uint32_t size;
+	};
+
+	const ComponentMask mask;
+
+	vector<Column> columns;
+	/// Sorted by component id.
+
+	vector<int16_t> column_indices;
+	/// The column holding each component id, -1 when the archetype doesn't have it.
+
+	uint32_t chunk_capacity = 0;
+
+	vector<std::unique_ptr<Chunk>> chunks;
+
+	vector<Archetype*> add_edges;
+	vector<Archetype*> remove_edges;
+	/// The archetype a node moves to when a component id is added or removed, filled in lazily.
+
+private:
+
+	size_t node_count = 0;
+};
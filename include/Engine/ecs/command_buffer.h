@@ -0,0 +1,163 @@
+#pragma once
+
+#include "Engine/ecs/component_store.h"
+#include "Engine/scene/node_handle.h"
+#include "Engine/thread_pool/thread_pool.h"
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+using std::vector;
+
+class Scene;
+
+// --- CommandBuffer ---
+// Records structural changes (adding and removing components, destroying and re-parenting
+// nodes) so they can be made later at a sync point, when nothing is iterating the scene.
+//
+// Component values are moved into 16 KB payload blocks that are kept between frames, so in the
+// steady state recording doesn't allocate.
+// ---------------------
+
+class CommandBuffer {
+public:
+
+	CommandBuffer() = default;
+
+	~CommandBuffer();
+
+	CommandBuffer(const CommandBuffer&) = delete;
+	CommandBuffer& operator=(const CommandBuffer&) = delete;
+
+	// = Recording =
+
+	template<typename T>
+	void add_component(NodeHandle node, T value) {
+		static_assert(alignof(T) <= alignof(std::max_align_t), "Over aligned components can't be recorded.");
+
+		void* payload = this->allocate_payload(sizeof(T), alignof(T));
+		new (payload) T(std::move(value));
+
+		this->commands.push_back(Command{
+			[](Scene*, ComponentStore& components, const Command& command) {
+				T* value = static_cast<T*>(command.payload);
+				components.add_component<T>(command.node, std::move(*value));
+				value->~T();
+			},
+			[](void* payload) {
+				static_cast<T*>(payload)->~T();
+			},
+			node,
+			NodeHandle(),
+			payload
+		});
+	}
+
+	template<typename T>
+	void remove_component(NodeHandle node) {
+		this->commands.push_back(Command{
+			[](Scene*, ComponentStore& components, const Command& command) {
+				components.remove_component<T>(command.node);
+			},
+			nullptr,
+			node,
+			NodeHandle(),
+			nullptr
+		});
+	}
+
+	void destroy_node(NodeHandle node);
+
+	void set_parent(NodeHandle node, NodeHandle parent);
+
+	// = Playback =
+
+	void play_back(Scene& scene);
+	/// Applies every command in the order it was recorded, then empties the buffer.
+	// Commands for nodes that were destroyed in the meantime are skipped.  When a command throws
+	// it and every later command are dropped before the exception is passed on.
+
+	void clear();
+	/// Drops every command without applying it.
+
+	size_t size() const;
+
+private:
+
+	struct Command {
+		void (*apply)(Scene* scene, ComponentStore& components, const Command& command);
+		void (*discard)(void* payload);
+		NodeHandle node;
+		NodeHandle other;
+		void* payload;
+	};
+
+	void* allocate_payload(size_t size, size_t alignment);
+
+	static constexpr size_t BLOCK_SIZE = 16 * 1024;
+
+	vector<Command> commands;
+
+	vector<std::unique_ptr<std::byte[]>> blocks;
+	size_t block_index = 0;
+	size_t block_used = 0;
+	/// The block being filled and how much of it is used.
+
+	vector<std::unique_ptr<std::byte[]>> large_payloads;
+	/// Values bigger than a block get their own allocation.
+};
+
+// --- CommandBuffers ---
+// One `CommandBuffer` per thread pool worker so parallel jobs record without contending, plus a
+// locked one shared by every thread that isn't a worker (the game loop, the render thread).
+// Played back in worker order at the sync point.
+// ----------------------
+
+class CommandBuffers {
+public:
+
+	template<typename T>
+	void add_component(NodeHandle node, T value) {
+		this->record([&](CommandBuffer& buffer) { buffer.add_component<T>(node, std::move(value)); });
+	}
+
+	template<typename T>
+	void remove_component(NodeHandle node) {
+		this->record([&](CommandBuffer& buffer) { buffer.remove_component<T>(node); });
+	}
+
+	void destroy_node(NodeHandle node);
+
+	void set_parent(NodeHandle node, NodeHandle parent);
+
+	void play_back(Scene& scene, ThreadPool::Pool* pool);
+	/// Plays back every buffer, then sets up one buffer per worker of `pool` for the next frame.
+	// Must not run while anything is recording.
+
+private:
+
+	template<typename Function>
+	void record(Function&& function) {
+		size_t workerIndex = this->pool != nullptr ? this->pool->get_current_worker_index() : this->worker_buffers.size();
+
+		if (workerIndex < this->worker_buffers.size()) {
+			function(*this->worker_buffers[workerIndex]);
+			return;
+		}
+
+		std::lock_guard<std::mutex> lock(this->shared_buffer_mutex);
+		function(this->shared_buffer);
+	}
+
+	ThreadPool::Pool* pool = nullptr;
+
+	vector<std::unique_ptr<CommandBuffer>> worker_buffers;
+	/// Separate allocations so workers don't share cache lines.
+
+	CommandBuffer shared_buffer;
+	std::mutex shared_buffer_mutex;
+};
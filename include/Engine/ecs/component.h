@@ -0,0 +1,116 @@
+#pragma once
+
+#include <bitset>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <optional>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+// Component type registration for the `ComponentStore`.
+// Every component type gets a small integer id the first time it is used, archetypes are
+// described by the set of ids they hold and columns are moved around through `ComponentInfo`
+// without knowing the type.
+//
+// Component types declare a name that is unique and stays the same across compilers and builds,
+// scene files refer to their components by it:
+//
+//     struct Health {
+//         static constexpr const char* component_name = "Health";
+//         float value;
+//     };
+//
+// Ids are only handed out in the order types are first used, so they differ between runs.
+// `REGISTER_COMPONENT` registers a type before `main` runs, which lets it be found by name
+// before any code touched it.
+
+using ComponentId = uint16_t;
+
+static constexpr size_t MAX_COMPONENT_TYPES = 256;
+
+using ComponentMask = std::bitset<MAX_COMPONENT_TYPES>;
+
+struct ComponentInfo {
+	size_t size;
+	size_t alignment;
+
+	bool trivially_relocatable;
+	/// Trivially copyable components are moved between chunks with memcpy and never destroyed.
+
+	void (*move_construct)(void* destination, void* source);
+	void (*destroy)(void* value);
+
+	const char* name;
+};
+
+namespace Components {
+
+	ComponentId register_component(const ComponentInfo& info);
+	/// Thread safe.  Throws once `MAX_COMPONENT_TYPES` types have been registered or when another
+	// type already registered `info.name`.
+
+	const ComponentInfo& get_info(ComponentId id);
+
+	std::optional<ComponentId> find_id(std::string_view name);
+	/// The registered type whose `ComponentInfo::name` is `name`.  Types register the first time
+	// `get_id` is called for them or with `REGISTER_COMPONENT`, they can't be found by name before.
+
+	template<typename T>
+	ComponentId get_id() {
+		using Component = std::remove_cv_t<T>;
+		static_assert(
+			requires { { Component::component_name } -> std::convertible_to<const char*>; },
+			"Components need a `static constexpr const char* component_name`."
+		);
+
+		// One registration per type no matter how it is qualified.
+		if constexpr (!std::is_same_v<T, Component>) {
+			return get_id<Component>();
+		}
+		else {
+			static const ComponentId id = register_component(ComponentInfo{
+				sizeof(Component),
+				alignof(Component),
+				std::is_trivially_copyable_v<Component>,
+				[](void* destination, void* source) {
+					new (destination) Component(std::move(*static_cast<Component*>(source)));
+				},
+				[](void* value) {
+					static_cast<Component*>(value)->~Component();
+				},
+				Component::component_name
+			});
+
+			return id;
+		}
+	}
+	/// `const T` shares `T`'s id, queries use the const to mark read only access.
+
+	inline void move_construct(ComponentId id, void* destination, void* source) {
+		const ComponentInfo& info = get_info(id);
+		if (info.trivially_relocatable) {
+			std::memcpy(destination, source, info.size);
+		}
+		else {
+			info.move_construct(destination, source);
+		}
+	}
+
+	inline void destroy(ComponentId id, void* value) {
+		const ComponentInfo& info = get_info(id);
+		if (!info.trivially_relocatable) {
+			info.destroy(value);
+		}
+	}
+};
+
+#define COMPONENT_CONCATENATE_INNER(a, b) a##b
+#define COMPONENT_CONCATENATE(a, b) COMPONENT_CONCATENATE_INNER(a, b)
+
+#define REGISTER_COMPONENT(Type) \
+	static const ComponentId COMPONENT_CONCATENATE(registeredComponent, __LINE__) = Components::get_id<Type>()
+/// Registers `Type` during static initialization, at namespace scope in a source file.
@@ -0,0 +1,365 @@
+#pragma once
+
+#include "Engine/ecs/archetype.h"
+#include "Engine/ecs/component.h"
+#include "Engine/scene/node_handle.h"
+#include "Engine/thread_pool/thread_pool.h"
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+using std::vector;
+
+// --- ComponentStore ---
+// Stores the data attached to nodes (scripts, meshes, lights, rigid bodies...) as components
+// grouped by archetype.  Nodes are the entities, so components are added and looked up by
+// `NodeHandle` through a sparse array indexed by the handle's index, no hashing.
+//
+// Systems go through a `Query`, which walks every chunk of every archetype that has the queried
+// components.  The archetypes matching a query are cached and only new archetypes are checked
+// against it afterwards.
+//
+// Every write access (a non-const query component, a non-const `get_component`, a structural
+// change) stamps the chunk column it touches with a new change version.  Queries and writes to
+// existing components may run from parallel jobs, the versions and query caches are shared
+// safely between them.  A system that stores
+// `get_change_version()` after it runs can then use `Query::changed_since` to only visit the
+// chunks that changed in between.
+//
+// Adding or removing components moves the node between archetypes, so it must not happen while
+// a query is iterating.  Jobs running in parallel record those changes into a `CommandBuffers`
+// instead, which plays them back at the next sync point.
+// ----------------------
+
+class ComponentStore;
+
+// --- ChunkView ---
+// One chunk of a query's results.
+// -----------------
+
+class ChunkView {
+public:
+	ChunkView(Archetype* archetype, Chunk* chunk)
+		: archetype(archetype), chunk(chunk) {
+	}
+
+	size_t size() const {
+		return this->chunk->count;
+	}
+
+	std::span<const NodeHandle> get_nodes() const {
+		return std::span<const NodeHandle>(this->archetype->get_nodes(*this->chunk), this->chunk->count);
+	}
+
+	template<typename T>
+	std::span<T> get() const {
+		return std::span<T>(this->archetype->get_column<T>(*this->chunk), this->chunk->count);
+	}
+	/// The component must be one of the archetype's.
+
+	template<typename T>
+	bool has() const {
+		return this->archetype->has_component(Components::get_id<T>());
+	}
+
+	template<typename T>
+	bool changed_since(uint64_t version) const {
+		return this->archetype->get_version(*this->chunk, Components::get_id<T>()) > version;
+	}
+	/// True if this chunk's `T` column was written after `version`.
+
+	Archetype* archetype;
+	Chunk* chunk;
+};
+
+// --- Query ---
+// Iterates every node that has all of `Ts`.  Declare components that are only read as `const T`.
+// --------------
+
+struct QueryCache {
+	ComponentMask included;
+	ComponentMask excluded;
+
+	vector<Archetype*> archetypes;
+	size_t archetypes_checked = 0;
+	/// How many of the store's archetypes have already been matched against this query.
+};
+
+template<typename... Ts>
+class Query {
+public:
+	Query(ComponentStore* store, QueryCache* cache)
+		: store(store), cache(cache) {
+	}
+
+	template<typename T>
+	Query& changed_since(uint64_t version) {
+		this->changed_filter = Components::get_id<T>();
+		this->changed_filter_version = version;
+		return *this;
+	}
+	/// Only visit chunks whose `T` column was written after `version`.  `T` must be one of `Ts`.
+
+	template<typename Function>
+	void for_each_chunk(ThreadPool::Pool* pool, Function&& function);
+	/// Calls `function(ChunkView&)` once per chunk, chunks run in parallel on `pool` if it isn't null.
+	// The non-const components of every visited chunk are marked as changed.
+
+	template<typename Function>
+	void for_each(ThreadPool::Pool* pool, Function&& function);
+	/// Calls `function(NodeHandle, Ts&...)` for every node.
+
+	size_t size();
+
+private:
+	void gather_chunks();
+
+	ComponentStore* store;
+	QueryCache* cache;
+
+	vector<ChunkView> chunks;
+	/// The chunks of the current iteration, owned by the query since the same query can run
+	// from several jobs at once.
+
+	ComponentId changed_filter = static_cast<ComponentId>(MAX_COMPONENT_TYPES);
+	uint64_t changed_filter_version = 0;
+};
+
+class ComponentStore {
+public:
+
+/////////////////////
+///// FUNCTIONS /////
+/////////////////////
+
+	ComponentStore() = default;
+
+	ComponentStore(const ComponentStore&) = delete;
+	ComponentStore& operator=(const ComponentStore&) = delete;
+
+// ==== Component Functions ====
+// ---
+
+	template<typename T>
+	T& add_component(NodeHandle node, T value = T()) {
+		ComponentId id = Components::get_id<T>();
+		Location* location = this->find_location(node);
+
+		// Already has it, just overwrite.
+		if (location != nullptr && location->archetype->has_component(id)) {
+			Chunk& chunk = *location->archetype->chunks[location->row.chunk];
+			location->archetype->mark_changed(chunk, id, this->advance_change_version());
+
+			T* component = static_cast<T*>(location->archetype->get_component(chunk, id, location->row.row));
+			*component = std::move(value);
+			return *component;
+		}
+
+		Location& newLocation = this->move_node(node, location, this->get_add_target(location, id), id);
+		T* component = static_cast<T*>(newLocation.archetype->get_component(*newLocation.archetype->chunks[newLocation.row.chunk], id, newLocation.row.row));
+		new (component) T(std::move(value));
+		return *component;
+	}
+	/// Adds or replaces `node`'s `T` component.  The returned reference is invalidated by the
+	// next structural change.
+
+	template<typename T>
+	void remove_component(NodeHandle node) {
+		this->remove_component(node, Components::get_id<T>());
+	}
+
+	template<typename T>
+	T* get_component(NodeHandle node) {
+		ComponentId id = Components::get_id<T>();
+		Location* location = this->find_location(node);
+
+		if (location == nullptr || !location->archetype->has_component(id)) {
+			return nullptr;
+		}
+
+		Chunk& chunk = *location->archetype->chunks[location->row.chunk];
+		if constexpr (!std::is_const_v<T>) {
+			location->archetype->mark_changed(chunk, id, this->advance_change_version());
+		}
+
+		return static_cast<T*>(location->archetype->get_component(chunk, id, location->row.row));
+	}
+	/// Null if the node doesn't have a `T`.  Use `get_component<const T>` when only reading,
+	// otherwise the component's chunk is marked as changed.
+
+	template<typename T>
+	bool has_component(NodeHandle node) {
+		Location* location = this->find_location(node);
+		return location != nullptr && location->archetype->has_component(Components::get_id<T>());
+	}
+
+	void add_components(std::span<const NodeHandle> nodes, std::span<const ComponentId> ids, std::span<const std::byte* const> columns);
+	/// Gives every node in `nodes` the `ids` components in one go, for loading.  `columns[i]`
+	// holds one packed `ids[i]` value per node, copied a chunk at a time.  The nodes must not
+	// have components yet and the components must be trivially copyable, otherwise this throws.
+	// So does a destroyed node's handle once a newer node in its slot has components.
+
+	void remove_component(NodeHandle node, ComponentId id);
+
+	void remove_node(NodeHandle node);
+	/// Removes all of `node`'s components.
+
+	bool contains(NodeHandle node);
+	/// True if `node` has any components.
+
+// ==== Query Functions ====
+// ---
+
+	template<typename... Ts>
+	Query<Ts...> query(const ComponentMask& excluded = ComponentMask()) {
+		ComponentMask included;
+		(included.set(Components::get_id<Ts>()), ...);
+		return Query<Ts...>(this, this->get_query_cache(included, excluded));
+	}
+	/// Nodes with any of the `excluded` components are skipped.
+
+	void update_query_cache(QueryCache& cache);
+	/// Matches archetypes created since the cache was last updated.  Safe to call from parallel
+	// jobs, archetypes are only created by structural changes which don't run alongside them.
+
+	uint64_t get_change_version() const;
+	/// The version of the latest write.  Store this after a system runs to pass to `changed_since` next time.
+
+	uint64_t advance_change_version();
+	/// Returns a new version, newer than every write so far.
+
+	size_t get_archetype_count() const;
+
+	Archetype& get_archetype(size_t index);
+	/// Archetypes are never removed, indices stay valid.
+
+	size_t size() const;
+	/// The amount of nodes with at least one component.
+
+private:
+
+/////////////////////
+///// FUNCTIONS /////
+/////////////////////
+
+	struct Location {
+		Archetype* archetype;
+		Archetype::Row row;
+	};
+
+	Location* find_location(NodeHandle node);
+	/// Null if the node has no components or the handle is stale.
+
+	Location& move_node(NodeHandle node, Location* location, Archetype* target, ComponentId added_id);
+	/// Moves `node` to `target` carrying over every component they share, leaving `added_id`'s
+	// column uninitialized for the caller to construct.
+
+	Archetype* get_add_target(Location* location, ComponentId id);
+
+	Archetype* find_or_create_archetype(const ComponentMask& mask);
+
+	QueryCache* get_query_cache(const ComponentMask& included, const ComponentMask& excluded);
+
+	void remove_row(Location& location);
+
+//////////////////////
+///// ATTRIBUTES /////
+//////////////////////
+
+	vector<Location> locations;
+	/// Indexed by node handle index.  The handle stored in the chunk validates the generation.
+
+	vector<std::unique_ptr<Archetype>> archetypes;
+	std::unordered_map<ComponentMask, Archetype*> archetype_lookup;
+
+	vector<std::unique_ptr<QueryCache>> query_caches;
+	std::mutex query_cache_mutex;
+	/// Queries run from parallel jobs create and update the caches.
+
+	size_t node_count = 0;
+
+	std::atomic<uint64_t> change_version = 0;
+	/// Advanced by writes from parallel jobs too.
+};
+
+// === Query Implementation ===
+
+template<typename... Ts>
+void Query<Ts...>::gather_chunks() {
+	this->store->update_query_cache(*this->cache);
+
+	// Stamped up front, the writes all happen during this iteration.
+	const uint64_t version = this->store->advance_change_version();
+	const bool filtered = this->changed_filter < MAX_COMPONENT_TYPES;
+
+	this->chunks.clear();
+	for (Archetype* archetype : this->cache->archetypes) {
+		for (auto& chunk : archetype->chunks) {
+			if (filtered && archetype->get_version(*chunk, this->changed_filter) <= this->changed_filter_version) {
+				continue;
+			}
+
+			([&] {
+				if constexpr (!std::is_const_v<Ts>) {
+					archetype->mark_changed(*chunk, Components::get_id<Ts>(), version);
+				}
+			}(), ...);
+
+			this->chunks.emplace_back(archetype, chunk.get());
+		}
+	}
+}
+
+template<typename... Ts>
+template<typename Function>
+void Query<Ts...>::for_each_chunk(ThreadPool::Pool* pool, Function&& function) {
+	this->gather_chunks();
+
+	vector<ChunkView>& chunks = this->chunks;
+
+	if (pool == nullptr || chunks.size() <= 1) {
+		for (ChunkView& chunk : chunks) {
+			function(chunk);
+		}
+		return;
+	}
+
+	// A chunk is already a decent amount of work, one per job.
+	pool->parallel_for(chunks.size(), 1, [&chunks, &function](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			function(chunks[i]);
+		}
+	});
+}
+
+template<typename... Ts>
+template<typename Function>
+void Query<Ts...>::for_each(ThreadPool::Pool* pool, Function&& function) {
+	this->for_each_chunk(pool, [&function](ChunkView& chunk) {
+		const NodeHandle* nodes = chunk.archetype->get_nodes(*chunk.chunk);
+		std::tuple<Ts*...> columns(chunk.archetype->get_column<Ts>(*chunk.chunk)...);
+		const size_t count = chunk.size();
+
+		for (size_t i = 0; i < count; i++) {
+			function(nodes[i], std::get<Ts*>(columns)[i]...);
+		}
+	});
+}
+
+template<typename... Ts>
+size_t Query<Ts...>::size() {
+	this->store->update_query_cache(*this->cache);
+
+	size_t count = 0;
+	for (Archetype* archetype : this->cache->archetypes) {
+		count += archetype->size();
+	}
+	return count;
+}
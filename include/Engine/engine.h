@@ -12,6 +12,7 @@ namespace ThreadPool {
 
 class RenderBackend;
 class Logger;
+class VirtualFileSystem;
 
 namespace Tritium {
 
@@ -38,6 +39,9 @@ namespace Tritium {
 		RenderBackend* render_backend;
 		Logger* logger;
 		ThreadPool::Pool* thread_pool;
+		VirtualFileSystem* file_system = nullptr;
+		/// Where game files (shaders, assets) are read from, set by the application.  Null reads
+		// them as loose files.
 		string application_name;
 		string application_description;
 		vector<string> application_authors;
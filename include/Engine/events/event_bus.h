@@ -0,0 +1,96 @@
+#pragma once
+
+#include "Engine/events/events.h"
+#include "Engine/thread_pool/mpmc_queue.h"
+#include <SDL2/SDL.h>
+#include <functional>
+#include <span>
+#include <vector>
+
+using std::vector;
+
+namespace ThreadPool {
+	class Pool;
+};
+
+// --- EventBus ---
+// Collects a frame's events into typed per channel arrays (input, window, game) and hands each
+// subscriber the whole batch in one call, so there is no per event dispatch.
+//
+// Subscribers added as parallel run concurrently with the channel's other parallel subscribers
+// on the thread pool, the rest run one at a time in the order they subscribed.
+//
+// Game events can be posted from any thread through a lock-free queue.  Events posted before
+// `dispatch` are delivered in that same dispatch, so they reach subscribers within the frame.
+// ----------------
+
+class EventBus {
+public:
+	using InputSubscriber = std::function<void(std::span<const InputEvent>)>;
+	using WindowSubscriber = std::function<void(std::span<const WindowEvent>)>;
+	using GameSubscriber = std::function<void(std::span<const GameEvent>)>;
+
+	EventBus(size_t game_event_queue_capacity = 4096);
+
+	// = Subscribing =
+	// These return a subscription id for `unsubscribe`.
+
+	int subscribe_input(InputSubscriber subscriber, bool parallel = false);
+
+	int subscribe_window(WindowSubscriber subscriber, bool parallel = false);
+
+	int subscribe_game(GameSubscriber subscriber, bool parallel = false);
+
+	void unsubscribe(int subscription_id);
+
+	// = Producing =
+
+	void push_SDL_event(const SDL_Event& sdl_event);
+	/// Translates and batches an SDL event.  Call from the thread that polls SDL.
+
+	void push_input_event(const InputEvent& event);
+
+	void push_window_event(const WindowEvent& event);
+
+	bool post_game_event(const GameEvent& event);
+	/// Thread safe and lock-free.  Returns false if the queue is full and the event was dropped.
+
+	// = Dispatching =
+
+	void dispatch(ThreadPool::Pool* pool);
+	/// Delivers every batched event to the subscribers.
+
+	void clear();
+	/// Empties the batches, call at the start of each frame before pushing its events.
+
+	std::span<const InputEvent> get_input_events() const;
+	std::span<const WindowEvent> get_window_events() const;
+	std::span<const GameEvent> get_game_events() const;
+	/// The current frame's batches, for code that wants to poll instead of subscribe.
+
+private:
+
+	template<typename T>
+	struct Channel {
+		struct Subscriber {
+			int id;
+			std::function<void(std::span<const T>)> callback;
+		};
+
+		vector<T> batch;
+		vector<Subscriber> serial_subscribers;
+		vector<Subscriber> parallel_subscribers;
+
+		void dispatch(ThreadPool::Pool* pool);
+
+		bool unsubscribe(int subscription_id);
+	};
+
+	Channel<InputEvent> input_channel;
+	Channel<WindowEvent> window_channel;
+	Channel<GameEvent> game_channel;
+
+	ThreadPool::MPMCQueue<GameEvent> game_event_queue;
+
+	int next_subscription_id = 0;
+};
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "Engine/events/events.h"
+#include <cstdint>
+#include <fstream>
+#include <span>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+// --- Event Recording ---
+// Records the per frame input stream and fixed update tick schedule of a game loop to a compact
+// binary file and plays it back, so performance investigations can start from an identical workload.
+//
+// Only input and window events are recorded.  Game events are produced by game code, which
+// produces them again during a replay.
+//
+// File layout:
+//   EventRecordingHeader
+//   for every frame:
+//     RecordedFrameHeader
+//     InputEvent[input_event_count]
+//     WindowEvent[window_event_count]
+// -----------------------
+
+struct EventRecordingHeader {
+	static constexpr uint32_t MAGIC = 0x43455254; // "TREC"
+	static constexpr uint32_t VERSION = 1;
+
+	uint32_t magic = MAGIC;
+	uint32_t version = VERSION;
+	uint32_t input_event_size = sizeof(InputEvent);
+	uint32_t window_event_size = sizeof(WindowEvent);
+	/// Recordings can only be replayed by builds with the same event layout.
+
+	uint32_t fixed_update_ticks_per_second = 0;
+};
+
+struct RecordedFrameHeader {
+	float delta_time;
+	float fixed_update_interpolation_alpha;
+	uint32_t fixed_update_ticks;
+	/// The fixed update ticks that completed since the previous frame.
+
+	uint16_t input_event_count;
+	uint16_t window_event_count;
+};
+
+struct RecordedFrame {
+	RecordedFrameHeader header;
+	std::span<const InputEvent> input_events;
+	std::span<const WindowEvent> window_events;
+};
+
+class EventRecorder {
+public:
+	EventRecorder(const string& output_path, uint32_t fixed_update_ticks_per_second);
+	~EventRecorder();
+
+	void record_frame(
+		float delta_time,
+		float fixed_update_interpolation_alpha,
+		uint32_t fixed_update_ticks,
+		std::span<const InputEvent> input_events,
+		std::span<const WindowEvent> window_events
+	);
+
+	uint64_t get_frame_count() const;
+
+private:
+	std::ofstream file;
+	uint64_t frame_count = 0;
+};
+
+class EventReplayer {
+public:
+	EventReplayer(const string& input_path);
+	/// Reads the whole recording into memory so playback never waits on the disk.
+
+	bool next_frame(RecordedFrame& frame);
+	/// Returns false once every recorded frame has been played.
+
+	const EventRecordingHeader& get_header() const;
+
+	void rewind();
+
+private:
+	template<typename T>
+	std::span<const T> read_array(vector<T>& events, size_t count);
+
+	vector<char> data;
+	size_t read_offset = 0;
+	EventRecordingHeader header;
+
+	// Events are copied out of the byte buffer so they are correctly aligned.
+	vector<InputEvent> input_events;
+	vector<WindowEvent> window_events;
+};
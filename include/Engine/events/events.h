@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+
+// Plain event types the `EventBus` batches into per channel arrays.
+// These are kept small and trivially copyable so a frame's worth of events is one
+// contiguous array and game events can go through the lock-free queue.
+
+namespace Events {
+	enum InputType {
+		KEY_DOWN = 0,
+		KEY_UP = 1,
+		MOUSE_MOTION = 2,
+		MOUSE_BUTTON_DOWN = 3,
+		MOUSE_BUTTON_UP = 4,
+		MOUSE_WHEEL = 5,
+		CONTROLLER_BUTTON_DOWN = 6,
+		CONTROLLER_BUTTON_UP = 7,
+		CONTROLLER_AXIS_MOTION = 8
+	};
+
+	enum WindowType {
+		QUIT = 0,
+		SHOWN = 1,
+		HIDDEN = 2,
+		MOVED = 3,
+		RESIZED = 4,
+		MINIMIZED = 5,
+		MAXIMIZED = 6,
+		RESTORED = 7,
+		FOCUS_GAINED = 8,
+		FOCUS_LOST = 9,
+		CLOSE = 10
+	};
+}
+
+struct InputEvent {
+	Events::InputType type;
+	uint32_t timestamp;
+	/// SDL timestamp in milliseconds.
+
+	uint32_t device;
+	/// Mouse or controller id.
+
+	// keyboard
+	int32_t keycode;
+	int32_t scancode;
+	uint16_t modifiers;
+	bool repeat;
+
+	// mouse / controller buttons and axes
+	uint8_t button;
+	/// The mouse button, controller button or controller axis.
+
+	int32_t x;
+	int32_t y;
+	int32_t x_relative;
+	int32_t y_relative;
+	/// Mouse position and motion.
+
+	float value_x;
+	float value_y;
+	/// Mouse wheel scroll, or the controller axis value in [-1, 1] in `value_x`.
+};
+
+struct WindowEvent {
+	Events::WindowType type;
+	uint32_t timestamp;
+	int32_t data1;
+	int32_t data2;
+	/// Position for `MOVED`, size for `RESIZED`.
+};
+
+struct GameEvent {
+	uint32_t type;
+	/// User defined.
+
+	uint32_t timestamp;
+	/// Set when the event is dispatched if it was posted with 0.
+
+	uint64_t sender;
+	/// User defined, usually the `NodeHandle::to_uint64` of the node that posted the event.
+
+	uint64_t payload[2];
+};
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+using std::vector;
+
+namespace ThreadPool {
+	class Pool;
+};
+
+// --- AsyncFileIo ---
+// Reads files in the background without tying up thread pool workers on the disk.  Requests
+// wait in one queue per thread pool priority and at most `queue_depth` of them are issued at
+// once, highest priority first, so a level load keeps the drive's queues full while urgent
+// reads still overtake bulk ones.
+//
+// On Linux the reads go through io_uring: a dedicated thread fills the submission ring with
+// every read that fits and hands the whole batch to the kernel with one system call, then
+// sleeps until completions arrive.  Where io_uring isn't available (other platforms, old
+// kernels, sandboxes that block it) every read is a thread pool job doing a blocking positional
+// read instead, still limited to `queue_depth` at once.
+//
+// Either way the completion callback runs as a thread pool job at the request's priority, so it
+// can go straight on to decoding what was read.
+// -------------------
+
+class AsyncFileIo {
+public:
+
+	enum class Backend {
+		IO_URING,
+		THREAD_POOL
+	};
+
+	struct Result {
+		size_t bytes_read = 0;
+		/// Less than the destination's size only when the file ended first.
+		std::error_code error;
+		/// Set when the file couldn't be opened or read.
+		bool cancelled = false;
+	};
+
+	struct Request {
+		std::string path;
+		uint64_t offset = 0;
+		std::span<std::byte> destination;
+		/// Must stay valid until the completion callback ran.
+		size_t priority = 0;
+		/// A thread pool priority, 0 first.  Clamped to the pool's lowest.
+		std::function<void(const Result&)> on_complete;
+		/// Runs exactly once for every request, cancelled or not.  Exceptions it throws are
+		// dropped, like those of any thread pool job.
+	};
+
+	typedef uint64_t RequestId;
+
+/////////////////////
+///// FUNCTIONS /////
+/////////////////////
+
+	AsyncFileIo(ThreadPool::Pool* pool, uint32_t queue_depth = DEFAULT_QUEUE_DEPTH, bool allow_io_uring = true);
+	/// Falls back to the thread pool backend when io_uring can't be set up.
+
+	~AsyncFileIo();
+	/// Cancels the queued requests and waits for every callback.
+
+	AsyncFileIo(const AsyncFileIo&) = delete;
+	AsyncFileIo& operator=(const AsyncFileIo&) = delete;
+
+// ==== Requests ====
+// ---
+
+	RequestId submit(Request request);
+
+	vector<RequestId> submit(vector<Request> requests);
+	/// Queues every request under one lock and wakes the backend once.
+
+	bool cancel(RequestId id);
+	/// Drops a request that hasn't been issued yet, its callback then runs with `cancelled` set.
+	// Returns false when the read already started (or finished), it then completes normally.
+
+	void wait();
+	/// Until every request submitted so far completed and its callback returned.  Must not be
+	// called from a callback.
+
+// ==== Getters ====
+// ---
+
+	Backend get_backend() const;
+
+	size_t get_queued_count() const;
+	/// Requests waiting to be issued.
+
+	size_t get_in_flight_count() const;
+
+//////////////////////
+///// ATTRIBUTES /////
+//////////////////////
+
+	static constexpr uint32_t DEFAULT_QUEUE_DEPTH = 64;
+
+private:
+
+/////////////////////
+///// FUNCTIONS /////
+/////////////////////
+
+	struct Pending {
+		RequestId id = 0;
+		Request request;
+	};
+
+	struct Ring;
+	/// The io_uring state, only defined where io_uring is available.
+
+	bool try_pop(Pending& pending);
+	/// The oldest request of the highest priority, the lock must be held.
+
+	void deliver(Request& request, const Result& result);
+	/// Runs the callback as a thread pool job and counts the request as done once it returns.
+
+	void complete(Request& request, const Result& result);
+	/// Runs the callback right here, then counts the request as done.
+
+	void dispatch_to_pool();
+	/// Starts thread pool reads while there is room, for the thread pool backend.
+
+	void run_ring();
+	/// The io_uring thread.
+
+	static Result read_file(const Request& request);
+	/// A blocking read, for the thread pool backend.
+
+//////////////////////
+///// ATTRIBUTES /////
+//////////////////////
+
+	ThreadPool::Pool* pool;
+	uint32_t queue_depth;
+
+	Backend backend = Backend::THREAD_POOL;
+	std::unique_ptr<Ring> ring;
+	std::thread ring_thread;
+
+	vector<std::deque<Pending>> queues;
+	/// One per thread pool priority.
+	RequestId next_id = 1;
+
+	size_t queued_count = 0;
+	size_t in_flight_count = 0;
+	size_t unfinished_count = 0;
+	/// Submitted requests whose callback hasn't returned yet.
+	bool stopping = false;
+
+	mutable std::mutex mutex;
+	std::condition_variable finished_condition;
+};
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+
+// --- BlockCompression ---
+// LZ4 block format compression of independent blocks of up to 64 KB: a greedy single hash
+// compressor (offline tools) and a bounds checked decoder fast enough that reading a compressed
+// pack is limited by the disk, not the CPU.  Streams are plain LZ4 blocks, any LZ4 decoder reads
+// them.
+// ------------------------
+
+namespace BlockCompression {
+
+	static constexpr size_t MAX_BLOCK_SIZE = 64 * 1024;
+
+	constexpr size_t get_max_compressed_size(size_t size) {
+		return size + size / 255 + 16;
+	}
+
+	size_t compress(std::span<const std::byte> source, std::span<std::byte> destination);
+	/// Returns the compressed size.  `source` is at most `MAX_BLOCK_SIZE` bytes and `destination`
+	// at least `get_max_compressed_size` of it, throws otherwise.  Incompressible data comes out
+	// larger than it went in, callers store those blocks as they are.
+
+	void decompress(std::span<const std::byte> source, std::span<std::byte> destination);
+	/// `destination` is exactly the decompressed size.  Throws if the block is malformed or
+	// doesn't decompress to exactly that size, never reads or writes out of bounds.
+};
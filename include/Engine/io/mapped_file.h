@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <string>
+
+// --- MappedFile ---
+// A whole file mapped read only into memory.  Pages are only read from disk when they are first
+// touched and are shared with the OS file cache, so opening a large file costs next to nothing
+// and its contents can be used in place instead of being read into a buffer.
+// ------------------
+
+class MappedFile {
+public:
+
+	MappedFile() = default;
+
+	explicit MappedFile(const std::string& path);
+	/// Throws if the file can't be opened or mapped.
+
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	MappedFile(MappedFile&& other) noexcept;
+	MappedFile& operator=(MappedFile&& other) noexcept;
+
+	void close();
+
+	bool is_open() const;
+
+	std::span<const std::byte> get_data() const;
+	/// Page aligned, valid until the file is closed.
+
+	size_t size() const;
+
+private:
+
+	const std::byte* data = nullptr;
+	size_t data_size = 0;
+
+	bool empty_file = false;
+	/// Empty files can't be mapped but still count as open.
+
+#ifdef _WIN32
+	void* file_handle = nullptr;
+	void* mapping_handle = nullptr;
+#endif // _WIN32
+};
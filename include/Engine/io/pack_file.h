@@ -0,0 +1,142 @@
+#pragma once
+
+#include "Engine/io/mapped_file.h"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using std::vector;
+
+namespace ThreadPool {
+	class Pool;
+};
+
+// ==== Binary Layout ====
+// A header, the compressed blocks of every file, then the table of contents: the entries sorted
+// by path hash, the block table and the path names.  The table is used in place from the mapped
+// file, opening a pack reads nothing but the pages it touches.
+//
+// Files are split into blocks of `BLOCK_SIZE` bytes (the last one shorter), each compressed on
+// its own (`Engine/io/block_compression.h`) so they decompress in parallel.  Blocks that don't
+// compress are stored as they are, with a compressed size equal to their size.
+// ---
+
+struct PackFileEntry {
+	uint64_t path_hash = 0;
+	uint64_t size = 0;
+	/// Decompressed, in bytes.
+	uint64_t first_block = 0;
+	uint32_t block_count = 0;
+	uint32_t name_offset = 0;
+	/// Into the names, which aren't null terminated.
+	uint32_t name_size = 0;
+	uint32_t reserved = 0;
+};
+
+struct PackFileBlock {
+	uint64_t offset = 0;
+	uint32_t compressed_size = 0;
+	uint32_t size = 0;
+};
+
+struct PackFileHeader {
+	static constexpr uint32_t MAGIC = 0x4B415054;
+	/// "TPAK"
+	static constexpr uint32_t VERSION = 1;
+	static constexpr uint32_t BLOCK_SIZE = 64 * 1024;
+
+	uint32_t magic = MAGIC;
+	uint32_t version = VERSION;
+	uint64_t file_size = 0;
+
+	uint32_t block_size = BLOCK_SIZE;
+	uint32_t entry_count = 0;
+	uint64_t block_count = 0;
+
+	uint64_t entries_offset = 0;
+	uint64_t blocks_offset = 0;
+	uint64_t names_offset = 0;
+	uint64_t names_size = 0;
+};
+
+// --- PackFile ---
+// A pack archive built by the pack builder (`src/tools/pack_builder`).  Many small files in one
+// mapped file: one open instead of one per asset, lookups are a binary search of the mapped
+// table, and compressed blocks cut the bytes read from cold disks.
+// ----------------
+
+class PackFile {
+public:
+
+/////////////////////
+///// FUNCTIONS /////
+/////////////////////
+
+// ==== Class Functions ====
+// ---
+
+	explicit PackFile(const std::string& path);
+	/// Maps the file and checks its table of contents.  Throws if it can't be opened or isn't a
+	// valid pack.
+
+	PackFile(const PackFile&) = delete;
+	PackFile& operator=(const PackFile&) = delete;
+
+	PackFile(PackFile&&) = default;
+	PackFile& operator=(PackFile&&) = default;
+
+	static std::string normalize_path(std::string_view path);
+	/// Forward slashes, no leading "./" or repeated slashes.  Pack paths are stored normalized.
+
+	static uint64_t hash_path(std::string_view normalized_path);
+	/// 64 bit FNV-1a.
+
+// ==== Reading ====
+// ---
+
+	const PackFileEntry* find(std::string_view path) const;
+	/// Null if the pack doesn't hold `path`.
+
+	void read(const PackFileEntry& entry, std::span<std::byte> destination, ThreadPool::Pool* pool) const;
+	/// Decompresses the file into `destination`, exactly `entry.size` bytes, blocks in parallel
+	// when `pool` isn't null.  Throws if a block is corrupt.
+
+	vector<std::byte> read(const PackFileEntry& entry, ThreadPool::Pool* pool) const;
+
+// ==== Getters ====
+// ---
+
+	std::span<const PackFileEntry> get_entries() const;
+	/// Sorted by path hash.
+
+	std::string_view get_name(const PackFileEntry& entry) const;
+
+	size_t size() const;
+	/// In bytes, of the whole pack.
+
+private:
+
+/////////////////////
+///// FUNCTIONS /////
+/////////////////////
+
+	void fix_up();
+	/// Validates the table of contents.
+
+	void read_blocks(const PackFileEntry& entry, std::span<std::byte> destination, size_t begin, size_t end) const;
+
+//////////////////////
+///// ATTRIBUTES /////
+//////////////////////
+
+	MappedFile mapped_file;
+	std::span<const std::byte> data;
+
+	const PackFileHeader* header = nullptr;
+	std::span<const PackFileEntry> entries;
+	std::span<const PackFileBlock> blocks;
+	std::string_view names;
+};
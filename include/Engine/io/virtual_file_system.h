@@ -0,0 +1,83 @@
+#pragma once
+
+#include "Engine/io/pack_file.h"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+using std::vector;
+
+namespace ThreadPool {
+	class Pool;
+};
+
+// --- VirtualFileSystem ---
+// Reads game files by their path relative to the game's root, from the mounted packs or, when a
+// loose root is set, from loose files on disk.  Shipped builds mount one pack and never touch
+// the file system again; development builds fall back to loose files so edited assets are
+// picked up without rebuilding packs.
+//
+// Mounting isn't thread safe, reading is.
+// -------------------------
+
+class VirtualFileSystem {
+public:
+
+/////////////////////
+///// FUNCTIONS /////
+/////////////////////
+
+// ==== Mounting ====
+// ---
+
+	void mount(const std::string& pack_path);
+	/// Packs mounted later shadow files of the ones before.  Throws if it isn't a valid pack.
+
+	void set_loose_root(const std::string& directory);
+	/// Where files missing from every pack are looked for, an empty string turns loose files off.
+
+// ==== Reading ====
+// ---
+
+	bool exists(const std::string& path) const;
+
+	bool is_packed(const std::string& path) const;
+
+	uint64_t get_size(const std::string& path) const;
+	/// Throws if the file doesn't exist.
+
+	vector<std::byte> read(const std::string& path, ThreadPool::Pool* pool = nullptr) const;
+	/// Packed files decompress their blocks in parallel when `pool` isn't null.  Throws if the
+	// file doesn't exist or can't be read.
+
+	void read_into(const std::string& path, std::span<std::byte> destination, ThreadPool::Pool* pool = nullptr) const;
+	/// Reads straight into `destination`, exactly `get_size(path)` bytes, so callers can read
+	// into memory they already own.
+
+// ==== Getters ====
+// ---
+
+	size_t get_pack_count() const;
+
+private:
+
+/////////////////////
+///// FUNCTIONS /////
+/////////////////////
+
+	const PackFile* find(const std::string& path, const PackFileEntry*& entry) const;
+	/// The newest pack holding `path`, or null.
+
+	std::string get_loose_path(const std::string& path) const;
+
+//////////////////////
+///// ATTRIBUTES /////
+//////////////////////
+
+	vector<PackFile> packs;
+
+	std::string loose_root;
+	bool loose_files = false;
+};
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "Engine/mesh/mesh_file.h"
+#include "Engine/spatial/frustum.h"
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+using std::vector;
+
+namespace ThreadPool {
+	class Pool;
+};
+
+// --- MeshClusters ---
+// A mesh's meshlets (`MeshFile::get_meshlets`) laid out for culling, one array per field so
+// the kernel tests 8 clusters at once (`Float8`).  `cull` tests a submesh's clusters against
+// a view's frustum and their normal cones against its camera, and writes the triangles of the
+// visible ones as index ranges into the mesh's index buffer, neighbouring clusters merged into
+// one range, so large meshes only draw what can be seen.
+//
+// Culling happens in mesh space: the frustum and the camera are moved into it once per call
+// instead of moving every cluster into world space.  Only one `cull` may run at a time per
+// instance, its scratch buffers are kept between calls.
+// --------------------
+
+class MeshClusters {
+public:
+
+/////////////////////
+///// FUNCTIONS /////
+/////////////////////
+
+	struct IndexRange {
+		uint32_t first_index;
+		uint32_t index_count;
+	};
+
+// ==== Class Functions ====
+// ---
+
+	explicit MeshClusters(const MeshFile& mesh);
+	/// Copies the meshlets out, the file can be closed afterwards.
+
+// ==== Culling ====
+// ---
+
+	size_t cull(const glm::mat4& view_projection, const glm::mat4& world_matrix, uint32_t first_cluster, uint32_t cluster_count, vector<IndexRange>& visible, ThreadPool::Pool* pool, bool backface_culling = true);
+	/// Replaces `visible` with the index ranges of the clusters in [first_cluster, first_cluster +
+	// cluster_count) that aren't outside the view, usually a submesh's `first_meshlet` and
+	// `meshlet_count`.  Returns how many clusters were visible.  Normal cones are only tested
+	// with `backface_culling`, turn it off for double sided materials.  Large submeshes are split
+	// across `pool`, which may be null.
+
+// ==== Getters ====
+// ---
+
+	size_t get_cluster_count() const;
+
+private:
+
+/////////////////////
+///// FUNCTIONS /////
+/////////////////////
+
+	size_t cull_range(const Frustum& frustum, const glm::vec3& camera, bool cone_culling, size_t begin, size_t end, IndexRange* visible, size_t& visible_cluster_count) const;
+	/// Writes merged ranges to `visible` and returns how many.
+
+//////////////////////
+///// ATTRIBUTES /////
+//////////////////////
+
+	size_t cluster_count = 0;
+
+	vector<float> center_x;
+	vector<float> center_y;
+	vector<float> center_z;
+	vector<float> radius;
+	vector<float> cone_axis_x;
+	vector<float> cone_axis_y;
+	vector<float> cone_axis_z;
+	vector<float> cone_cutoff;
+	vector<uint32_t> first_index;
+	vector<uint32_t> index_count;
+	/// Padded with `FrustumCulling::LANE_PADDING` entries, so the last clusters load as a full `Float8`.
+
+	vector<IndexRange> chunk_ranges;
+	vector<size_t> chunk_range_counts;
+	vector<size_t> chunk_cluster_counts;
+};
@@ -0,0 +1,247 @@
+#pragma once
+
+#include "Engine/io/mapped_file.h"
+#include "Engine/spatial/aabb.h"
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using std::vector;
+
+// ==== Binary Layout ====
+// Like scene files, everything is addressed by its byte offset from the start of the file and
+// arrays are raw, little endian and 16 byte aligned, so a mapped file is used as is.  Vertex
+// streams and the index buffer are stored exactly as the GPU reads them, loading one is a copy
+// into a buffer.
+// ---
+
+struct MeshFileRange {
+	uint64_t offset = 0;
+	uint64_t count = 0;
+	/// In elements of the array's type, not bytes.
+};
+
+enum class VertexSemantic : uint32_t {
+	POSITION,
+	NORMAL,
+	TEXCOORD,
+	COLOR
+};
+
+enum class VertexFormat : uint32_t {
+	FLOAT2,
+	FLOAT3,
+	FLOAT4,
+	HALF2,
+	HALF4,
+	UNORM16x4,
+	SNORM16x2,
+	UNORM8x4
+};
+/// The quantized formats are read as floats by the vertex input, normalized ones in [0, 1] or
+// [-1, 1].  Positions stored as UNORM16x4 are relative to the header's position offset and
+// scale (`MeshFile::get_position_transform`), normals with two components are octahedral
+// encoded and must be decoded by the vertex shader.
+
+struct MeshFileVertexAttribute {
+	VertexSemantic semantic = VertexSemantic::POSITION;
+	VertexFormat format = VertexFormat::FLOAT3;
+	uint32_t stream = 0;
+	uint32_t offset = 0;
+	/// In bytes from the start of the vertex in its stream.
+};
+
+struct MeshFileVertexStream {
+	MeshFileRange data;
+	/// std::byte, `vertex_count * stride` long.
+	uint32_t stride = 0;
+	uint32_t reserved = 0;
+};
+
+struct MeshFileSubmesh {
+	uint32_t first_index = 0;
+	uint32_t index_count = 0;
+	uint32_t material = 0;
+	/// Index into the header's material names.
+	uint32_t reserved = 0;
+	Aabb bounds;
+	uint32_t first_meshlet = 0;
+	uint32_t meshlet_count = 0;
+	/// The submesh's run of meshlets, none when the cooker didn't build them.
+};
+
+struct MeshFileMeshlet {
+	glm::vec3 center = glm::vec3(0.0f);
+	float radius = 0.0f;
+	/// Bounding sphere, in mesh space.
+	glm::vec3 cone_axis = glm::vec3(0.0f);
+	float cone_cutoff = 1.0f;
+	/// Every triangle faces away from a camera at `camera` when
+	// `dot(center - camera, cone_axis) >= cone_cutoff * length(center - camera) + radius`.
+	// A cutoff of 1 never culls.
+	uint32_t first_index = 0;
+	uint32_t index_count = 0;
+	/// A run of triangles inside the submesh's.
+	uint32_t reserved[2] = {};
+};
+
+struct MeshFileLod {
+	uint32_t first_submesh = 0;
+	uint32_t submesh_count = 0;
+	float error = 0.0f;
+	/// The largest distance of the LOD's surface from LOD 0's, in mesh space.  Never decreases
+	// along the chain.
+	uint32_t reserved = 0;
+};
+
+struct MeshFileHeader {
+	static constexpr uint32_t MAGIC = 0x48534D54;
+	/// "TMSH"
+	static constexpr uint32_t VERSION = 4;
+
+	uint32_t magic = MAGIC;
+	uint32_t version = VERSION;
+	uint64_t file_size = 0;
+
+	uint32_t vertex_count = 0;
+	uint32_t index_count = 0;
+	uint32_t index_size = 0;
+	/// 2 or 4 bytes, 16 bit indices are used whenever every vertex fits.
+	uint32_t reserved = 0;
+
+	Aabb bounds;
+
+	glm::vec3 position_offset = glm::vec3(0.0f);
+	glm::vec3 position_scale = glm::vec3(1.0f);
+	/// Stored positions map to `offset + position * scale`, the identity unless they are quantized.
+
+	MeshFileRange attributes;
+	/// `MeshFileVertexAttribute`
+	MeshFileRange streams;
+	/// `MeshFileVertexStream`
+	MeshFileRange indices;
+	/// std::byte, `index_count * index_size` long.  Triangle lists, absolute vertex indices.
+	MeshFileRange submeshes;
+	/// `MeshFileSubmesh`
+	MeshFileRange material_names;
+	/// `MeshFileRange` of char per material.
+	MeshFileRange lods;
+	/// `MeshFileLod`, finest first, at least one.  Every LOD draws its own consecutive run of
+	// submeshes over the shared vertices.
+	MeshFileRange meshlets;
+	/// `MeshFileMeshlet`, consecutive runs per submesh.
+};
+
+// --- MeshFile ---
+// A mesh cooked offline by the asset cooker (`src/tools/asset_cooker`) into the layout the
+// renderer draws from: vertex streams, an index buffer, a submesh table and bounds.  The
+// runtime never imports source models, opening a mesh maps the file and checks its ranges and
+// indices, nothing is parsed or converted.
+// ----------------
+
+class MeshFile {
+public:
+
+/////////////////////
+///// FUNCTIONS /////
+/////////////////////
+
+	struct StreamView {
+		std::span<const std::byte> data;
+		uint32_t stride;
+	};
+
+// ==== Class Functions ====
+// ---
+
+	explicit MeshFile(const std::string& path);
+	/// Maps the file.  Throws if it can't be opened or isn't a valid mesh file.
+
+	explicit MeshFile(vector<std::byte> bytes);
+	/// Takes over an already loaded file, for meshes read from a pack.
+
+	MeshFile(const MeshFile&) = delete;
+	MeshFile& operator=(const MeshFile&) = delete;
+
+	MeshFile(MeshFile&&) = default;
+	MeshFile& operator=(MeshFile&&) = default;
+
+	static uint32_t get_format_size(VertexFormat format);
+	/// In bytes.  Throws for unknown formats.
+
+// ==== Getters ====
+// ---
+
+	uint32_t get_vertex_count() const;
+
+	uint32_t get_index_count() const;
+
+	uint32_t get_index_size() const;
+
+	std::span<const MeshFileVertexAttribute> get_attributes() const;
+
+	const MeshFileVertexAttribute* find_attribute(VertexSemantic semantic) const;
+	/// Null if the mesh doesn't have it.
+
+	std::span<const StreamView> get_streams() const;
+
+	std::span<const std::byte> get_index_data() const;
+
+	std::span<const MeshFileSubmesh> get_submeshes() const;
+	/// Of every LOD.
+
+	std::span<const MeshFileSubmesh> get_lod_submeshes(size_t lod) const;
+
+	std::span<const MeshFileLod> get_lods() const;
+
+	std::span<const MeshFileMeshlet> get_meshlets() const;
+	/// Of every submesh, empty if the mesh wasn't split into meshlets.
+
+	std::span<const std::string_view> get_material_names() const;
+
+	const Aabb& get_bounds() const;
+
+	glm::mat4 get_position_transform() const;
+	/// Maps the stored positions to mesh space.  Fold it into the model matrix and quantized
+	// positions draw with no decoding in the shader.
+
+	size_t size() const;
+	/// In bytes.
+
+private:
+
+/////////////////////
+///// FUNCTIONS /////
+/////////////////////
+
+	void fix_up();
+	/// Validates the file and points the spans into it.
+
+	template<typename T>
+	std::span<const T> get_range(const MeshFileRange& range) const;
+	/// Throws if the range doesn't lie inside the file or isn't aligned for `T`.
+
+//////////////////////
+///// ATTRIBUTES /////
+//////////////////////
+
+	MappedFile mapped_file;
+	vector<std::byte> bytes;
+	/// Only one of the two holds the file.
+
+	std::span<const std::byte> data;
+
+	const MeshFileHeader* header = nullptr;
+
+	std::span<const MeshFileVertexAttribute> attributes;
+	vector<StreamView> streams;
+	std::span<const std::byte> index_data;
+	std::span<const MeshFileSubmesh> submeshes;
+	std::span<const MeshFileLod> lods;
+	std::span<const MeshFileMeshlet> meshlets;
+	vector<std::string_view> material_names;
+};
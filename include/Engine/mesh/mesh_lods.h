@@ -0,0 +1,40 @@
+#pragma once
+
+#include "Engine/mesh/mesh_file.h"
+#include <algorithm>
+#include <cstdint>
+
+// --- MeshLods ---
+// Component holding the errors of a node's mesh LOD chain (`MeshFile::get_lods`), so the
+// render backend can pick a LOD per view without touching the mesh.  Errors are in the
+// mesh's space, the backend scales them by the node's world matrix and projects them to
+// pixels to choose the coarsest LOD that still looks like LOD 0.
+// ----------------
+
+struct MeshLods {
+	static constexpr const char* component_name = "MeshLods";
+	static constexpr uint32_t MAX_LODS = 8;
+
+	float errors[MAX_LODS] = {};
+	uint32_t lod_count = 1;
+
+	static MeshLods from_file(const MeshFile& mesh) {
+		MeshLods lods;
+		lods.lod_count = static_cast<uint32_t>(std::min<size_t>(mesh.get_lods().size(), MAX_LODS));
+		for (uint32_t i = 0; i < lods.lod_count; i++) {
+			lods.errors[i] = mesh.get_lods()[i].error;
+		}
+		return lods;
+	}
+
+	uint32_t select(float pixels_per_unit, float max_pixel_error) const {
+		for (uint32_t lod = this->lod_count; lod > 1; lod--) {
+			if (this->errors[lod - 1] * pixels_per_unit <= max_pixel_error) {
+				return lod - 1;
+			}
+		}
+		return 0;
+	}
+	/// The coarsest LOD whose error, `pixels_per_unit` pixels long per mesh space unit, stays
+	// within `max_pixel_error`.
+};
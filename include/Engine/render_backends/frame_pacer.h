@@ -0,0 +1,35 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+
+// --- FramePacer ---
+// Limits how often the game loop runs.  Frame deadlines are kept on the SDL performance counter
+// and waited for with a hybrid wait: the thread sleeps through most of the wait since sleeping is
+// cheap but imprecise, then spins through the last stretch so the frame starts on time.
+// ------------------
+
+class FramePacer {
+public:
+	FramePacer(double spin_threshold_seconds = 0.002);
+
+	void wait_for_next_frame(int frames_per_second);
+	/// Blocks until the next frame deadline for the given frame rate.
+	// A frame rate of 0 or less is uncapped and returns straight away.
+
+	void reset();
+	/// Forgets the previous deadline so the next frame isn't rushed to catch up.
+
+	void set_spin_threshold_seconds(double spin_threshold_seconds);
+	/// How long before the deadline the pacer stops sleeping and starts spinning.
+	// Raise this on platforms with coarse sleep granularity.
+
+	void wait_until(Uint64 target_counter);
+	/// Hybrid sleep-then-spin wait until `SDL_GetPerformanceCounter` reaches `target_counter`.
+
+private:
+
+	double spin_threshold_seconds;
+	Uint64 counter_frequency;
+	Uint64 next_frame_counter = 0;
+	int last_frames_per_second = 0;
+};
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "Engine/scene/node_handle.h"
+#include <cstdint>
+#include <functional>
+#include <glm/glm.hpp>
+#include <vector>
+
+using std::vector;
+
+// --- FrameView ---
+// What one view (a camera, a shadow map...) sees this frame.
+// -----------------
+
+struct FrameView {
+	glm::mat4 view_projection = glm::mat4(1.0f);
+
+	vector<NodeHandle> visible_nodes;
+	/// Every node with `Bounds` that isn't outside the view's frustum.
+
+	vector<glm::mat4> world_matrices;
+	/// The world matrix of each visible node, in the same order.
+
+	vector<uint32_t> lods;
+	/// The mesh LOD to draw each visible node with, in the same order.  0 for nodes without `MeshLods`.
+};
+
+// --- FramePacket ---
+// Everything the render thread needs to draw one frame, produced by the game thread.
+// The game thread fills a packet while the render thread draws the previous one, so a packet
+// must only hold copies of game state, never pointers into state the game thread keeps changing.
+// ------------------
+
+struct FramePacket {
+	uint64_t frame_index = 0;
+	float delta_time = 0.0f;
+	float fixed_update_interpolation_alpha = 0.0f;
+	long int time_nanoseconds = 0;
+
+	vector<std::function<void()>> render_commands;
+	/// Executed in order on the render thread before the backend draws the frame.
+
+	vector<FrameView> views;
+	/// One per view set on the render backend, in the same order.  The views' lists are reused
+	// between the frames drawn from this packet.
+
+	void reset() {
+		this->render_commands.clear();
+	}
+};
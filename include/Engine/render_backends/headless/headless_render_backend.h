@@ -0,0 +1,51 @@
+#pragma once
+
+#include "Engine/render_backends/render_backend.h"
+
+namespace Tritium {
+	class Engine;
+};
+
+// --- HeadlessRenderBackend --- 
+// Runs the game loop, callbacks and fixed update loop without a window or a GPU.
+// Used for simulation servers, CI soak runs and for measuring CPU frame cost in isolation.
+// -----------------------------
+
+class HeadlessRenderBackend : public RenderBackend {
+
+public:
+
+/////////////////////
+///// FUNCTIONS /////
+/////////////////////
+
+// ==== Class Functions ====
+// These include things like constructors, destructors and operators.
+// ---
+
+	HeadlessRenderBackend(
+		Tritium::Engine* engine = nullptr,
+		float fixed_frame_delta_time = 0.0f,
+		uint64_t max_frame_count = 0
+	);
+	/// `fixed_frame_delta_time` of 0 runs in real time, anything above steps the simulation by
+	// that amount every frame.  The frame rate is uncapped by default, use
+	// `set_target_frames_per_second` to run at a real time rate.
+
+private:
+
+/////////////////////
+///// FUNCTIONS /////
+/////////////////////
+
+// === Game Loop Functions ===
+
+	void before_start_window(string window_title, int window_width, int window_height) override;
+
+	void before_game_loop() override;
+
+	void after_game_loop() override;
+
+	void update_game(FramePacket& frame_packet) override;
+
+};
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "Engine/mesh/mesh_file.h"
 #include <vulkan/vulkan.hpp>
 #include <vector>
 #include <string>
@@ -41,6 +42,17 @@ public:
 
 	GraphicsPipelineBuilder* add_vertex_input_attribute(uint32_t binding_index, uint32_t location, vk::Format format, uint32_t offset);
 
+	// Adds a binding per vertex stream of the cooked mesh, starting at `first_binding`, and an
+	// attribute per vertex attribute at the location `get_vertex_location` gives its semantic.
+	// Every mesh drawn with the pipeline must have the same layout, float and quantized meshes
+	// need pipelines of their own.
+	GraphicsPipelineBuilder* add_vertex_input_layout(const MeshFile& mesh, uint32_t first_binding = 0);
+
+	// The shader locations of the mesh semantics, in the order Default.vert declares them.
+	static uint32_t get_vertex_location(VertexSemantic semantic);
+
+	static vk::Format get_vertex_format(VertexFormat format);
+
 	GraphicsPipelineBuilder* add_stage(
 		string shader_path,
 		string entry_point,
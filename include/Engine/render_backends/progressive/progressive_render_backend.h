@@ -14,6 +14,7 @@ namespace Tritium {
 	class Engine;
 };
 
+class StagingUploader;
 class VirtualDevice;
 
 // --- ProgressiveRenderBackend --- 
@@ -41,6 +42,8 @@ public:
 	);
 	/// sdl_window_flags must be set in every constructor to include `SDL_WINDOW_VULKAN`
 
+	~ProgressiveRenderBackend();
+
 //////////////////////
 ///// ATTRIBUTES /////
 //////////////////////
@@ -59,7 +62,7 @@ private:
 
 	void after_game_loop() override;
 
-	void update_game() override;
+	void update_game(FramePacket& frame_packet) override;
 
 // ==== Render Functions ====
 // Overload these functions depending on the render engine	
@@ -123,6 +126,9 @@ private:
 
 	std::shared_ptr<VirtualDevice> virtual_device;
 
+	std::unique_ptr<StagingUploader> staging_uploader;
+	/// Loads assets from the engine's file system onto `virtual_device`.
+
 	vk::Queue vk_queue;
 	vk::DebugUtilsMessengerEXT vk_debug_messenger;
 
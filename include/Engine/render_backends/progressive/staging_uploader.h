@@ -0,0 +1,125 @@
+#pragma once
+
+#include "Engine/render_backends/progressive/command_pool.h"
+#include <vulkan/vulkan.hpp>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <string>
+
+class VirtualDevice;
+class VirtualFileSystem;
+
+namespace ThreadPool {
+	class Pool;
+};
+
+// --- StagingUploader ---
+// Loads asset files onto the GPU without an intermediate copy.  Files are read (or decompressed
+// from a pack) straight into one persistently mapped staging buffer, and the copy into device
+// local memory is recorded right away, so an asset costs a single CPU pass over its bytes and
+// no intermediate buffer.
+//
+// Uploads share the staging buffer until it is full or `flush` is called, which submits every
+// recorded copy at once and waits for them, after which the staging space is reused.  Results
+// may only be used by the GPU after the flush that covers them.  Flushing submits to the
+// graphics queue, so uploads run on the thread that owns it.
+//
+// The staging memory is host cached when the device has such memory: the pack reader's
+// decompressor reads back what it just wrote, which is very slow on write combined memory.
+// -----------------------
+
+class StagingUploader {
+public:
+
+	struct UploadedBuffer {
+		vk::Buffer buffer;
+		vk::DeviceMemory memory;
+		vk::DeviceSize size = 0;
+	};
+	/// Owned by the caller.
+
+	struct UploadedImage {
+		vk::Image image;
+		vk::DeviceMemory memory;
+		vk::ImageCreateInfo create_info;
+	};
+	/// Owned by the caller, in `eShaderReadOnlyOptimal` layout once flushed.
+
+/////////////////////
+///// FUNCTIONS /////
+/////////////////////
+
+	StagingUploader(VirtualDevice* virtual_device, VirtualFileSystem* file_system, ThreadPool::Pool* pool, vk::DeviceSize staging_size = DEFAULT_STAGING_SIZE);
+	/// `file_system` may be null, paths are then plain file paths.  `pool` may be null, it
+	// decompresses packed files in parallel.
+
+	StagingUploader(const StagingUploader&) = delete;
+	StagingUploader& operator=(const StagingUploader&) = delete;
+
+	void clean_up();
+	/// Flushes, then destroys the staging buffer.  Must be called before the device is destroyed.
+
+// ==== Uploads ====
+// ---
+
+	UploadedBuffer upload_buffer(const std::string& path, vk::BufferUsageFlags usage);
+	/// The whole file into a new device local buffer.  Throws if the file can't be read or is
+	// larger than the staging buffer.
+
+	UploadedImage upload_texture(const std::string& path);
+	/// A cooked texture (`Engine/texture/texture_file.h`) into a new image with every mip.
+	// Throws if the file can't be read, isn't a valid texture or is larger than the staging buffer.
+
+	void flush();
+	/// Submits the recorded copies and waits for them to finish.
+
+// ==== Getters ====
+// ---
+
+	vk::DeviceSize get_staging_size() const;
+
+	vk::DeviceSize get_staged_size() const;
+	/// Bytes waiting for the next flush.
+
+//////////////////////
+///// ATTRIBUTES /////
+//////////////////////
+
+	static constexpr vk::DeviceSize DEFAULT_STAGING_SIZE = 64ull * 1024 * 1024;
+
+private:
+
+/////////////////////
+///// FUNCTIONS /////
+/////////////////////
+
+	std::span<std::byte> stage_file(const std::string& path, vk::DeviceSize& staging_offset);
+	/// Reads the file into the staging buffer, flushing first when it doesn't fit.
+
+	vk::DeviceMemory allocate_device_local(vk::MemoryRequirements requirements);
+
+	vk::CommandBuffer& get_recording_command_buffer();
+	/// Begins the command buffer on first use after a flush.
+
+//////////////////////
+///// ATTRIBUTES /////
+//////////////////////
+
+	VirtualDevice* virtual_device;
+	VirtualFileSystem* file_system;
+	ThreadPool::Pool* pool;
+
+	vk::Buffer staging_buffer;
+	vk::DeviceMemory staging_memory;
+	std::byte* staging_data = nullptr;
+	/// Mapped for the uploader's whole lifetime.
+	vk::DeviceSize staging_size;
+	vk::DeviceSize staging_used = 0;
+	vk::DeviceSize staging_alignment;
+	/// Of every file, which keeps the texture levels inside it aligned too.
+
+	std::unique_ptr<CommandPool> command_pool;
+	vk::Fence upload_fence;
+	bool recording = false;
+};
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "Engine/texture/texture_file.h"
+#include <vulkan/vulkan.hpp>
+#include <vector>
+
+using std::vector;
+
+// --- TextureImage ---
+// Maps a cooked texture onto the `vk::Image` it is uploaded into.  The file's levels are laid
+// out the way `copyBufferToImage` reads them, so uploading is: copy the file (or just its
+// levels) into a staging buffer, then one copy region per mip level covering every layer.
+// --------------------
+
+namespace TextureImage {
+
+	vk::Format get_format(TextureFormat format);
+	/// Throws for unknown formats.
+
+	vk::ImageCreateInfo get_image_create_info(const TextureFile& texture, vk::ImageUsageFlags usage = vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst);
+	/// An optimally tiled 2D image (array) with every mip level, initially undefined.
+
+	vector<vk::BufferImageCopy> get_copy_regions(const TextureFile& texture, vk::DeviceSize file_offset = 0);
+	/// One region per mip level, for a staging buffer holding the whole file at `file_offset`.
+	// The image must be in `eTransferDstOptimal` layout.
+};
@@ -42,6 +42,12 @@ public:
 
 	vk::Device* get_vulkan_device();
 
+	vk::PhysicalDevice* get_physical_device();
+
+	std::optional<uint32_t> find_memory_type(uint32_t type_bits, vk::MemoryPropertyFlags properties) const;
+	/// The first memory type allowed by `type_bits` (from `vk::MemoryRequirements`) with every
+	// flag in `properties`.
+
 	uint64_t get_suitability() const;
 	
 	static bool check_physical_device_is_suitable(vk::PhysicalDevice vk_physical_device, const vk::SurfaceKHR& vk_surface);
@@ -56,6 +62,8 @@ public:
 	
 	DeviceQueues queues;
 
+	QueueFamilyIndices queue_family_indices;
+
 	std::unique_ptr<SwapChain> swapchain;
 
 	vk::PhysicalDeviceFeatures vk_device_features;
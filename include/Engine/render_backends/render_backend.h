@@ -2,10 +2,22 @@
 
 #define SDL_MAIN_HANDLED
 
+#include "Engine/callbacks/callback_registry.h"
+#include "Engine/events/event_bus.h"
+#include "Engine/events/event_recording.h"
+#include "Engine/render_backends/frame_pacer.h"
+#include "Engine/render_backends/frame_packet.h"
+#include "Engine/spatial/scene_queries.h"
+#include "Engine/spatial/visibility.h"
+#include <atomic>
+#include <condition_variable>
+#include <exception>
 #include <functional>
-#include <unordered_map>
+#include <memory>
+#include <mutex>
 #include <SDL2/SDL.h>
 #include <string>
+#include <thread>
 #include <vector>
 
 using std::string;
@@ -19,6 +31,9 @@ namespace Tritium {
 	class Engine;
 };
 
+class Scene;
+class SceneStreamer;
+
 class RenderBackend {
 
 public:
@@ -36,6 +51,8 @@ public:
 	);
 	/// default settings?
 
+	virtual ~RenderBackend() = default;
+
 // ==== Window Functions ====
 // These functions are related to the SDL window that the backend renders onto.
 // Some of these may be implemented in this base RenderBackend class.
@@ -60,27 +77,146 @@ public:
 	long int get_time_seconds();
 	long int get_time_milliseconds();
 	long int get_time_nanoseconds();
+	/// Time since the game loop started.
+
+	void set_target_frames_per_second(int frames_per_second);
+	/// Caps the draw loop's frame rate.  0 is uncapped.
+
+	void set_unfocused_frames_per_second(int frames_per_second);
+	/// Frame rate cap used while the window doesn't have input focus.  0 disables the throttle.
+
+	void set_minimized_frames_per_second(int frames_per_second);
+	/// Frame rate cap used while the window is minimized.  0 disables the throttle.
+
+	void set_fixed_frame_delta_time(float seconds);
+	/// When greater than 0 every frame simulates exactly this much time regardless of how long it
+	// took, and the fixed update loop is stepped from the game loop instead of running on its
+	// own thread.  Makes runs repeatable for servers, soak tests and benchmarks.
+
+	void set_max_frame_count(uint64_t max_frame_count);
+	/// Stops the game loop after this many frames.  0 runs until the window is closed.
+
+	struct FrameStatistics {
+		uint64_t frame_count = 0;
+		double total_frame_seconds = 0.0;
+		double min_frame_seconds = 0.0;
+		double max_frame_seconds = 0.0;
+
+		void add_frame(double frame_seconds);
+
+		double get_average_frame_seconds() const;
+	};
+
+	FrameStatistics get_frame_statistics();
+	/// CPU time spent on each frame of the last game loop, not counting frame pacing waits.
 	void set_fixed_update_ticks_per_second(int ticksPerSecond);
 	/// sets the amount of updates per second.
 
+	float get_fixed_update_delta_time();
+	/// The simulated time that passes in one fixed update tick, in seconds.
+
+	void set_fixed_update_max_catch_up_ticks(int max_catch_up_ticks);
+	/// The most ticks the fixed update loop will run back to back to catch up after a stall.
+	// Any time beyond that is dropped so a slow tick can't snowball (spiral of death).
+
+	float get_fixed_update_interpolation_alpha();
+	/// How far (0 to 1) the simulation is between the last fixed update tick and the next one.
+	// Used by rendering to interpolate between the previous and current fixed update state.
+
 
 	// = Callback Functions = 
 	// These functions are for adding hooks into the render loop to the scripts attached to Nodes.
 	// --
 
-	void add_on_draw_update_callback(int nodeID, std::function<void(float)> callback);
+	void add_on_draw_update_callback(NodeHandle node, std::function<void(float)> callback, int phase = 0, bool serial = false);
 	/// Callback includes delta_time as an argument.
+	// Callbacks run in ascending `phase` order.  Inside a phase they run in parallel on the
+	// thread pool, unless `serial` is set, then they run one at a time in the order they were added.
 
-	void remove_on_draw_update_callback(int nodeID);
+	void remove_on_draw_update_callback(NodeHandle node);
 	/// Callback includes delta_time as an argument.
 
-	void add_on_fixed_update_callback(int nodeID, std::function<void()> callback);
+	void add_on_fixed_update_callback(NodeHandle node, std::function<void()> callback, int phase = 0, bool serial = false);
 	/// Fixed update is an update loop that runs every game tick
 	// mostly used for physics updates
+	// Fixed update callbacks run on the fixed update thread, not on the thread running the draw loop.
+	// `phase` and `serial` work the same as they do for draw update callbacks.
+	// Fixed update callbacks may add and remove fixed update callbacks, that takes effect once
+	// the tick's callbacks have all run.  So does a change from any thread pool job made during
+	// a tick, other threads wait for a running tick instead.
 
-	void remove_on_fixed_update_callback(int nodeID);
+	void remove_on_fixed_update_callback(NodeHandle node);
 	/// Fixed update is an update loop that runs every game tick
 	// mostly used for physics updates
+	// Deferred until the end of a running tick like adding.
+
+	void set_callback_chunk_size(size_t chunk_size);
+	/// The amount of callbacks a single thread pool job executes.
+
+	// = Event Functions =
+	// --
+
+	EventBus* get_event_bus();
+	/// Each frame's events are batched here and dispatched before the draw update callbacks.
+
+	// = Scene Functions =
+	// --
+
+	void set_scene(Scene* scene);
+	/// The scene whose world transforms the game loop updates each frame, after the draw update
+	// callbacks have moved its nodes.  May be null.  The render thread must not read the scene
+	// directly, it is already being changed for the next frame while a packet is drawn.
+
+	Scene* get_scene();
+
+	void set_scene_streamer(SceneStreamer* scene_streamer);
+	/// Updates the streamer at the sync point, before the scene's commands are played back.  May
+	// be null.  The streamer must stream into the backend's scene.
+
+	size_t add_view(const glm::mat4& view_projection);
+	/// Adds a view whose visible nodes are culled each frame into the frame packet's `views`.
+	// Returns its index.
+
+	void set_view(size_t view, const glm::mat4& view_projection);
+	/// Moves a view, safe to call from draw update callbacks.
+
+	void clear_views();
+
+	void set_lod_pixel_error(float max_pixel_error);
+	/// Nodes with `MeshLods` draw the coarsest LOD whose error projects to at most this many
+	// pixels in the view.  0 always draws LOD 0.
+
+	Visibility& get_visibility();
+
+	SceneQueries& get_scene_queries();
+	/// Raycasts and overlaps for fixed update callbacks, answered at the end of their phase.
+
+	// = Render Thread Functions =
+	// --
+
+	void enqueue_render_command(std::function<void()> render_command);
+	/// Runs `render_command` on the render thread before the frame currently being simulated is drawn.
+	// Safe to call from draw update callbacks, including parallel ones.
+
+	void set_max_frames_in_flight(int max_frames_in_flight);
+	/// How many frames the game loop may run ahead of the render thread.
+	// 1 is the one frame latency mode: frame N+1 is simulated while frame N is drawn, but no further.
+	// Must be called before the game loop starts.
+
+	void set_render_thread_enabled(bool enabled);
+	/// When disabled frame packets are drawn on the game loop's thread right after they are produced.
+	// Must be called before the game loop starts.
+
+	// = Recording / Replay Functions =
+	// These must be called before the game loop starts.
+	// --
+
+	void start_recording(const string& output_path);
+	/// Records every frame's input, window events and fixed update tick schedule.
+
+	void start_replay(const string& input_path);
+	/// Plays a recording back instead of live input, with the recorded frame times and fixed
+	// update ticks, then ends the game loop.  Works with the window hidden or with the headless backend.
 
 //////////////////////
 ///// ATTRIBUTES /////
@@ -113,9 +249,9 @@ protected:
 	// this is where we will deinitialize vulkan stuff or clean it up.
 	// This will be implemented in derived classes.
 
-	virtual void update_game() = 0;
-	/// Runs inside "start_game_loop" for each frame.
-	// Updates the scene and calls all relevant hooks such as "on_draw_update".
+	virtual void update_game(FramePacket& frame_packet) = 0;
+	/// Runs on the render thread for each frame packet the game loop produces.
+	// Draws the frame described by `frame_packet`, its render commands have already run.
 	// This will be implemented in derived classes.
 	// It may call functions from the base class for shared logic between
 	// render backends.
@@ -130,14 +266,21 @@ protected:
 	// everything related to window management
 	// --
 
-	SDL_Window* sdl_window;
+	SDL_Window* sdl_window = nullptr;
 
 	Uint32 sdl_window_flags = SDL_WINDOW_RESIZABLE | SDL_WINDOW_SHOWN;
 	/// This will be set to something different depending on the graphics API(s) that the backend uses.
 
+	Uint32 sdl_init_flags = SDL_INIT_VIDEO;
+	/// The SDL subsystems `start_window` initializes.
+
+	bool creates_window = true;
+	/// Headless backends set this to false to run the game loop without a window.
+
 // === Game Loop ===
 
-	bool window_running = false;
+	std::atomic<bool> window_running = false;
+	/// Read by the fixed update loop which runs on its own thread.
 
 private:
 
@@ -151,43 +294,165 @@ private:
 	/// Initializes the game state and starts the game loop which calls update_game.
 	// Loads in the initial scene file.
 
-	void SDL_forward_event(SDL_Event event);
-	/// This forwards `SDL_Event`s to their hooks or wherever they need to go.
+	void game_loop(bool fixed_step);
+	/// Runs frames until `window_running` is false or the replay ended.  `fixed_step` steps the
+	// fixed update loop from here instead of its own thread.
+
+	void SDL_forward_event(const SDL_Event& sdl_event);
+	/// This forwards `SDL_Event`s to the event bus.
+
+	void update_time(Uint64 current_counter, float simulated_delta_time = 0.0f);
+	/// Updates delta_time and the time since the game loop started from the performance counter,
+	// or by `simulated_delta_time` when it is greater than 0.
+
+	int get_paced_frames_per_second();
+	/// The frame rate cap for this frame after throttling for window focus and minimization.
 
 	void start_fixed_update_game_loop();
-	/// Initializes the fixed update loop and starts it, calling "fixed_update_game" every
-	// itteration.
+	/// Initializes the fixed update loop and starts it on its own thread, calling
+	// "fixed_update_game" every itteration.
+
+	void fixed_update_game_loop();
+	/// The real time fixed update loop.  Runs until `window_running` is false.
+
+	int step_fixed_update(double elapsed_seconds);
+	/// Adds `elapsed_seconds` to the accumulator and runs every fixed update tick that is due,
+	// up to the catch up limit.  Returns the amount of ticks that ran.
+
+	void stop_fixed_update_game_loop();
+	/// Joins the fixed update thread.  Rethrows anything the loop threw.
 
 	void fixed_update_game();
 	/// Runs inside the fixed update loop.  Updates physics and other systems.  Also calls
 	// relevant hooks such as "on_fixed_update".
 
+// === Render Thread ===
+
+	void start_render_thread();
+
+	void stop_render_thread();
+	/// Lets the render thread draw every queued packet, then joins it.  Rethrows anything it threw.
+
+	void render_thread_main();
+
+	void submit_frame_packet();
+	/// Hands the packet the game loop just built to the render thread, blocking while
+	// `max_frames_in_flight` packets are already queued.
+
+	void render_frame(FramePacket& frame_packet);
+	/// Runs a packet's render commands then `update_game`.
+
 // === Callbacks ===
 
 	void execute_on_draw_update_callbacks();
 
 	void execute_on_fixed_update_callbacks();
 
+	void finish_fixed_update_callbacks();
+	/// Applies the adds and removes the callbacks made while they were executing.
+
+	bool is_in_fixed_update_tick() const;
+	/// Whether the calling thread could be running one of the executing fixed update callbacks,
+	// it then can't wait for `on_fixed_update_callbacks_mutex`.  The changes lock must be held.
+
+// === Scene ===
+
+	void update_scene(FramePacket& frame_packet);
+	/// Propagates the scene's world transforms, if a scene is set, and culls every view into
+	// `frame_packet`.
+
+	void cull_views(FramePacket& frame_packet);
+
 //////////////////////
 ///// ATTRIBUTES /////
 //////////////////////
 
 // === Callbacks ===
 
-	std::unordered_map<int, std::function<void(float)>> on_draw_update_callbacks;
-	std::unordered_map<int, std::function<void()>> on_fixed_update_callbacks;
+	CallbackRegistry<float> on_draw_update_callbacks;
+	CallbackRegistry<> on_fixed_update_callbacks;
+	std::recursive_mutex on_fixed_update_callbacks_mutex;
+	/// The fixed update callbacks are executed on a different thread than they are added from.
+	// Recursive since destroying nodes while holding it calls the scene's destroy listener.
+
+	bool executing_fixed_update_callbacks = false;
+	std::thread::id fixed_update_callbacks_thread;
+	vector<std::function<void()>> fixed_update_callback_changes;
+	std::mutex fixed_update_callback_changes_mutex;
+	/// Adds and removes made while the callbacks execute, their jobs on the thread pool can't
+	// take `on_fixed_update_callbacks_mutex` which the fixed update thread holds meanwhile.
 
 // === Time / Time Scales ===
 
-	float delta_time;
-	long int time_seconds;
-	long int time_milliseconds;
-	long int time_nanoseconds;
-	int fixed_update_ticks_per_second;
+	float delta_time = 0.0f;
+	long int time_seconds = 0;
+	long int time_milliseconds = 0;
+	long int time_nanoseconds = 0;
+	Uint64 game_loop_start_counter = 0;
+	Uint64 last_frame_counter = 0;
+	Uint64 simulated_time_nanoseconds = 0;
+	float fixed_frame_delta_time = 0.0f;
+	uint64_t max_frame_count = 0;
+	FrameStatistics frame_statistics;
+	std::atomic<int> fixed_update_ticks_per_second = 60;
+	std::atomic<int> fixed_update_max_catch_up_ticks = 5;
+	std::atomic<float> fixed_update_interpolation_alpha = 0.0f;
+	double fixed_update_accumulator = 0.0;
+	/// Time that has passed but has not been simulated by the fixed update loop yet.
 
-// === SDL2 ===
+// === Frame Pacing ===
+
+	FramePacer frame_pacer;
+	int target_frames_per_second = 0;
+	int unfocused_frames_per_second = 30;
+	int minimized_frames_per_second = 10;
+
+// === Fixed Update Loop ===
+
+	std::thread fixed_update_thread;
+	std::exception_ptr fixed_update_loop_exception;
+	/// Written by the fixed update thread, read once it has been joined.
+
+// === Render Thread ===
+
+	std::thread render_thread;
+	bool render_thread_enabled = true;
+	bool render_thread_running = false;
+	std::exception_ptr render_thread_exception;
+
+	vector<FramePacket> frame_packets;
+	/// A ring of `max_frames_in_flight` + 1 packets, one is always free for the game loop to build.
+
+	size_t frame_packet_write_index = 0;
+	size_t frame_packet_read_index = 0;
+	size_t queued_frame_packet_count = 0;
+	int max_frames_in_flight = 2;
+	std::mutex frame_packet_mutex;
+	std::condition_variable frame_packet_cv;
+	std::mutex render_command_mutex;
+
+// === Scene ===
+
+	Scene* scene = nullptr;
+
+	SceneStreamer* scene_streamer = nullptr;
+
+	Visibility visibility;
+
+	SceneQueries scene_queries;
+
+	vector<glm::mat4> view_projections;
+	std::mutex view_mutex;
+
+	float lod_pixel_error = 1.0f;
+
+// === Events ===
+
+	EventBus event_bus;
 
-	// = Events =
-	SDL_Event sdl_event;
+	std::unique_ptr<EventRecorder> event_recorder;
+	std::unique_ptr<EventReplayer> event_replayer;
+	std::atomic<uint64_t> fixed_update_tick_count = 0;
+	/// Used to record how many fixed update ticks finished between frames.
 
 };
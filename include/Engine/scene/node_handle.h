@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+
+// --- NodeHandle ---
+// Identifies a node everywhere in the engine (scene, callbacks, events, rendering).
+//
+// `index` is the node's slot, so looking a node up is a plain array access.  `generation` is
+// bumped every time the slot is freed, so a handle to a destroyed node can be told apart from
+// the node that reused its slot with one compare instead of silently aliasing it.
+// ------------------
+
+struct NodeHandle {
+	uint32_t index = 0;
+	uint32_t generation = 0;
+	/// 0 is never a live generation, so a default constructed handle is null.
+
+	bool is_null() const {
+		return this->generation == 0;
+	}
+
+	bool operator==(const NodeHandle& other) const = default;
+
+	uint64_t to_uint64() const {
+		return (static_cast<uint64_t>(this->generation) << 32) | this->index;
+	}
+	/// Packs the handle into one integer, for example a `GameEvent` sender.
+
+	static NodeHandle from_uint64(uint64_t packed) {
+		return NodeHandle{ static_cast<uint32_t>(packed), static_cast<uint32_t>(packed >> 32) };
+	}
+};
@@ -0,0 +1,285 @@
+#pragma once
+
+#include "Engine/containers/slot_map.h"
+#include "Engine/ecs/command_buffer.h"
+#include "Engine/ecs/component_store.h"
+#include "Engine/scene/node_handle.h"
+#include <cstdint>
+#include <functional>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <limits>
+#include <span>
+#include <vector>
+
+using std::vector;
+
+namespace ThreadPool {
+	class Pool;
+};
+
+class SceneFile;
+
+// --- Scene ---
+// The node hierarchy and its transforms.
+//
+// Every per node value is stored in its own packed array (structure of arrays) and the arrays
+// are sorted by hierarchy depth, so each depth level is one contiguous run and the children of
+// a node are a contiguous run in the next level.  A node's world matrix then only ever reads a
+// matrix from the level before it, which lets a whole level be computed in parallel.
+//
+// Moving a node only flags it dirty, `update_world_transforms` recomputes the dirty nodes and
+// their subtrees and nothing else.  The local transform setters can be called from parallel
+// draw update callbacks as long as each node is only moved by one callback at a time.
+//
+// Each level keeps free room at its end.  Created and instantiated nodes are appended to their
+// level the next time the arrays are needed, and destroyed nodes leave an empty slot behind, so
+// streaming nodes in and out costs about as much as the nodes themselves.  The arrays are only
+// re-sorted once a level runs out of room, a quarter of the slots are empty or nodes were
+// re-parented, so batch re-parenting where possible.  Structural changes aren't thread safe and
+// must not be made from inside draw or fixed update callbacks, record them into
+// `get_command_buffers()` there instead.
+// -------------
+
+class Scene {
+public:
+
+/////////////////////
+///// FUNCTIONS /////
+/////////////////////
+
+// ==== Class Functions ====
+// ---
+
+	Scene();
+
+// ==== Node Functions ====
+// ---
+
+	NodeHandle create_node(NodeHandle parent = NodeHandle());
+	/// Returns the new node's handle, pass a null parent for a root node.
+	// The node starts at the origin with no rotation and a scale of 1.
+
+	void destroy_node(NodeHandle node);
+	/// Destroys `node` and all of its descendants.  Their handles stop being valid right away.
+
+	void set_parent(NodeHandle node, NodeHandle parent);
+	/// Moves `node` and its subtree under `parent`, or makes it a root with a null parent.
+	// Throws if that would make a node its own ancestor.
+
+	NodeHandle get_parent(NodeHandle node) const;
+	/// Null for root nodes.
+
+	vector<NodeHandle> instantiate(const SceneFile& file);
+	/// Adds every node of `file` with its transform and components, returns their handles in the
+	// file's order (roots first).  Into an empty scene the file's arrays are already in packed
+	// order and are copied in as is.  Throws if the file uses a component this build doesn't know.
+
+	void instantiate_nodes(const SceneFile& file, uint32_t begin, uint32_t end, vector<NodeHandle>& nodes);
+	/// Adds the file's nodes [begin, end) and appends their handles to `nodes`, which must hold
+	// the handles of all the file's earlier nodes.  Parents come before their children in a file,
+	// so a big file can be added a slice per frame.  Nodes whose parent was destroyed since an
+	// earlier slice are skipped with their subtree, their handles are null.
+
+	void instantiate_components(const SceneFile& file, std::span<const ComponentId> component_ids, size_t archetype, uint32_t begin, uint32_t end, std::span<const NodeHandle> nodes);
+	/// Adds the components of rows [begin, end) of one of the file's archetypes, `nodes` being
+	// the handles `instantiate_nodes` returned for the whole file and `component_ids` what
+	// `SceneFile::get_component_ids` returned, resolved once per file.  Rows of nodes that were
+	// destroyed or skipped since are left out.
+
+	using DestroyListener = std::function<void(std::span<const NodeHandle>)>;
+
+	void set_destroy_listener(DestroyListener listener);
+	/// Called by `destroy_node` with every node it destroyed.  The render backend uses this to
+	// drop the destroyed nodes' callbacks.
+
+	ComponentStore& get_components();
+	/// The data attached to the scene's nodes.  Destroying a node removes its components.
+
+	CommandBuffers& get_command_buffers();
+	/// Structural changes recorded from callbacks and parallel jobs, applied by `play_back_commands`.
+
+	void play_back_commands(ThreadPool::Pool* pool);
+	/// Applies the recorded structural changes.  The render backend calls this at the sync point
+	// right before `update_world_transforms`.
+
+	void compact();
+	/// Re-sorts the packed arrays without free room or empty slots, dense indices are then 0 to
+	// `size()` - 1 in depth order.  Scene files are saved that way.
+
+	bool contains(NodeHandle node) const;
+	/// False for null handles and handles to destroyed nodes.
+
+	size_t size() const;
+	/// The amount of live nodes.
+
+// ==== Transform Functions ====
+// ---
+
+	void set_local_position(NodeHandle node, const glm::vec3& position);
+	void set_local_rotation(NodeHandle node, const glm::quat& rotation);
+	void set_local_scale(NodeHandle node, const glm::vec3& scale);
+	void set_local_transform(NodeHandle node, const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale);
+	/// Relative to the parent.  Flags the node so its subtree is recomputed in the next update.
+
+	glm::vec3 get_local_position(NodeHandle node) const;
+	glm::quat get_local_rotation(NodeHandle node) const;
+	glm::vec3 get_local_scale(NodeHandle node) const;
+
+	const glm::mat4& get_world_matrix(NodeHandle node) const;
+	/// As of the last `update_world_transforms`.
+
+	void update_world_transforms(ThreadPool::Pool* pool);
+	/// Recomputes the world matrices of every dirty node and their descendants, one depth
+	// level at a time.  Levels with enough work are split into chunks across `pool`, which may be null.
+	// The game loop calls this after the draw update callbacks when the scene is set on the render backend.
+
+	void set_propagation_chunk_size(size_t chunk_size);
+	/// The amount of nodes a single thread pool job recomputes.
+
+// ==== Dense Storage Access ====
+// For systems that want to walk the packed arrays directly (culling, rendering).
+// Dense indices change with structural changes, don't hold on to them across those.  Ranges can
+// hold empty slots, `get_node_at` returns a null handle for them.
+// ---
+
+	struct IndexRange {
+		uint32_t begin;
+		uint32_t end;
+	};
+
+	uint32_t get_index(NodeHandle node) const;
+	/// The node's position in the packed arrays.
+
+	NodeHandle get_node_at(uint32_t index) const;
+
+	std::span<const glm::mat4> get_world_matrices() const;
+
+	std::span<const IndexRange> get_updated_ranges() const;
+	/// The dense index ranges whose world matrices changed in the last `update_world_transforms`,
+	// sorted by index.
+
+	size_t get_depth_count();
+	/// The amount of depth levels, roots are depth 0.
+
+	IndexRange get_depth_range(size_t depth);
+	/// The dense index range holding every node at `depth`, and the level's empty slots.
+
+//////////////////////
+///// ATTRIBUTES /////
+//////////////////////
+
+	static constexpr uint32_t INVALID_INDEX = std::numeric_limits<uint32_t>::max();
+
+	static constexpr size_t DEFAULT_CHUNK_SIZE = 1024;
+
+	static constexpr uint32_t DIRTY_BLOCK_SIZE = 64;
+	/// The amount of nodes that share a dirty block flag.  An update only looks at the nodes of
+	// flagged blocks, so it doesn't have to scan every node to find the few that moved.
+
+private:
+
+/////////////////////
+///// FUNCTIONS /////
+/////////////////////
+
+	uint32_t get_checked_index(NodeHandle node) const;
+	/// Throws if `node` is null or stale.
+
+	void mark_dirty(uint32_t index);
+
+	void sort_hierarchy();
+	/// Moves added nodes into their levels, re-sorting the packed arrays instead when that isn't
+	// possible or enough slots are empty.
+
+	bool insert_added_nodes();
+	/// Appends the nodes added since the last sort to their levels.  False when a level ran out
+	// of room, the nodes from there on are left at the end.
+
+	uint32_t reserve_child_slot(uint32_t parent);
+	/// A free slot at the end of the child level of `parent` (or the roots' level) which extends
+	// its child run.  `INVALID_INDEX` when the level is full or doesn't exist yet.
+
+	void move_node(uint32_t from, uint32_t to);
+	/// Copies a node to an empty slot, leaving `from` empty.
+
+	void rebuild_hierarchy(bool leave_room);
+	/// Sorts the packed arrays by depth from scratch and compacts out the empty slots.
+
+	void collect_child_ranges(const vector<IndexRange>& ranges, vector<IndexRange>& child_ranges) const;
+	/// Appends the child runs of every node in `ranges`, sorted and merged.
+
+	void propagate_level(
+		ThreadPool::Pool* pool,
+		const vector<IndexRange>& ranges
+	);
+	/// Recomputes the world matrices of every node in `ranges`, which all lie in one depth level.
+
+	static glm::mat4 compose_local_matrix(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale);
+
+//////////////////////
+///// ATTRIBUTES /////
+//////////////////////
+
+// === Node Handles ===
+
+	SlotMap<uint32_t, NodeHandle> node_indices;
+	/// Dense index of each live node.  Updated whenever the packed arrays are re-sorted.
+
+	DestroyListener destroy_listener;
+
+	ComponentStore components;
+
+	CommandBuffers command_buffers;
+
+// === Packed Arrays ===
+// All indexed by dense index.
+
+	vector<NodeHandle> index_nodes;
+	/// The node stored at each dense index, null for empty slots.
+
+	vector<uint32_t> parents;
+	vector<uint32_t> first_children;
+	vector<uint32_t> child_counts;
+	/// Children are the contiguous range [first_child, first_child + child_count) in the next level.
+
+	vector<glm::vec3> local_positions;
+	vector<glm::quat> local_rotations;
+	vector<glm::vec3> local_scales;
+	vector<glm::mat4> world_matrices;
+
+	vector<uint8_t> dirty;
+	vector<uint8_t> dirty_blocks;
+
+	vector<uint32_t> level_offsets;
+	/// Level d is [level_offsets[d], level_offsets[d + 1]).  Nodes added since the last sort come
+	// after the last level.
+	vector<uint32_t> level_ends;
+	/// The level's free room is [level_ends[d], level_offsets[d + 1]).
+
+// === Hierarchy State ===
+
+	bool children_changed = false;
+	/// Nodes were re-parented, the depth levels and child ranges are out of date.
+
+	bool child_runs_in_order = true;
+	/// Every node's child run starts where the previous node's ends, as after a re-sort.  Nodes
+	// appended to their level since then break that.
+
+	size_t unused_slot_count = 0;
+	/// Empty slots left behind by destroyed or moved nodes, compacted out by the next re-sort.
+
+	vector<NodeHandle> added_parents;
+	/// Scratch for `insert_added_nodes`, handles since moving nodes changes their dense indices.
+
+// === Propagation ===
+
+	size_t chunk_size = DEFAULT_CHUNK_SIZE;
+
+	vector<uint32_t> dirty_nodes;
+	vector<IndexRange> level_ranges;
+	vector<IndexRange> child_ranges;
+	vector<IndexRange> propagation_tasks;
+	vector<IndexRange> updated_ranges;
+	/// Kept between updates so the steady state doesn't allocate.
+};
@@ -0,0 +1,195 @@
+#pragma once
+
+#include "Engine/ecs/component.h"
+#include "Engine/io/mapped_file.h"
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using std::vector;
+
+class Scene;
+
+// ==== Binary Layout ====
+// Everything in the file is addressed by its byte offset from the start of the file, never by
+// pointer, so a file can be mapped at any address and used as is.  Arrays are raw, little
+// endian and 16 byte aligned.  Components are stored as their in memory bytes, so a file only
+// loads into builds with the same component layouts (the editor and runtime of one version).
+// ---
+
+struct SceneFileRange {
+	uint64_t offset = 0;
+	uint64_t count = 0;
+	/// In elements of the array's type, not bytes.
+};
+
+struct SceneFileHeader {
+	static constexpr uint32_t MAGIC = 0x4E435354;
+	/// "TSCN"
+	static constexpr uint32_t VERSION = 1;
+
+	uint32_t magic = MAGIC;
+	uint32_t version = VERSION;
+	uint64_t file_size = 0;
+
+	uint32_t node_count = 0;
+	uint32_t reserved = 0;
+
+	SceneFileRange level_offsets;
+	/// uint32_t, depth level d is nodes [level_offsets[d], level_offsets[d + 1]).
+	SceneFileRange parents;
+	SceneFileRange first_children;
+	SceneFileRange child_counts;
+	/// uint32_t per node, the nodes are depth sorted exactly like `Scene`'s packed arrays.
+	SceneFileRange local_positions;
+	SceneFileRange local_rotations;
+	SceneFileRange local_scales;
+
+	SceneFileRange component_types;
+	/// `SceneFileComponentType`
+	SceneFileRange archetypes;
+	/// `SceneFileArchetype`
+};
+
+struct SceneFileComponentType {
+	SceneFileRange name;
+	/// char, the name the component was registered under.
+	uint32_t size = 0;
+	uint32_t alignment = 0;
+};
+
+struct SceneFileArchetype {
+	SceneFileRange component_types;
+	/// uint32_t indices into the header's component types.
+	SceneFileRange nodes;
+	/// uint32_t node indices.
+	SceneFileRange columns;
+	/// One `SceneFileRange` of raw component bytes per component type, each `nodes.count` long.
+};
+
+// --- SceneFile ---
+// A scene saved as one relocatable binary blob: the depth sorted node arrays, local transforms
+// and component columns laid out just like `Scene` and `ComponentStore` hold them in memory.
+//
+// Opening a file maps it and turns its offsets into spans (the only fix-up there is) after
+// checking every range and hierarchy index, nothing is parsed or copied.  `Scene::instantiate`
+// then copies the arrays into a scene with bulk copies.
+//
+// Only trivially copyable components are saved, the rest are left out.
+// -------------------
+
+class SceneFile {
+public:
+
+/////////////////////
+///// FUNCTIONS /////
+/////////////////////
+
+	struct ComponentType {
+		std::string_view name;
+		uint32_t size;
+		uint32_t alignment;
+	};
+
+	struct ArchetypeView {
+		std::span<const uint32_t> component_types;
+		std::span<const uint32_t> nodes;
+		vector<const std::byte*> columns;
+		/// One per component type, in the same order.
+	};
+
+// ==== Class Functions ====
+// ---
+
+	explicit SceneFile(const std::string& path);
+	/// Maps the file.  Throws if it can't be opened or isn't a valid scene file.
+
+	explicit SceneFile(vector<std::byte> bytes);
+	/// Takes over an already loaded file, for scenes read from a pack or over the network.
+
+	SceneFile(const SceneFile&) = delete;
+	SceneFile& operator=(const SceneFile&) = delete;
+
+	SceneFile(SceneFile&&) = default;
+	SceneFile& operator=(SceneFile&&) = default;
+
+// ==== Saving ====
+// ---
+
+	static vector<std::byte> serialize(Scene& scene);
+
+	static void save(Scene& scene, const std::string& path);
+	/// Throws if the file can't be written.
+
+// ==== Getters ====
+// ---
+
+	uint32_t get_node_count() const;
+
+	std::span<const uint32_t> get_level_offsets() const;
+
+	std::span<const uint32_t> get_parents() const;
+	/// `Scene::INVALID_INDEX` for roots.
+
+	std::span<const uint32_t> get_first_children() const;
+
+	std::span<const uint32_t> get_child_counts() const;
+
+	std::span<const glm::vec3> get_local_positions() const;
+
+	std::span<const glm::quat> get_local_rotations() const;
+
+	std::span<const glm::vec3> get_local_scales() const;
+
+	std::span<const ComponentType> get_component_types() const;
+
+	std::span<const ArchetypeView> get_archetypes() const;
+
+	vector<ComponentId> get_component_ids() const;
+	/// This build's id for each of the file's component types.  Throws if one isn't registered
+	// or has a different size.
+
+	size_t size() const;
+	/// In bytes.
+
+private:
+
+/////////////////////
+///// FUNCTIONS /////
+/////////////////////
+
+	void fix_up();
+	/// Validates the file and points the spans into it.
+
+	template<typename T>
+	std::span<const T> get_range(const SceneFileRange& range) const;
+	/// Throws if the range doesn't lie inside the file or isn't aligned for `T`.
+
+//////////////////////
+///// ATTRIBUTES /////
+//////////////////////
+
+	MappedFile mapped_file;
+	vector<std::byte> bytes;
+	/// Only one of the two holds the file.
+
+	std::span<const std::byte> data;
+
+	const SceneFileHeader* header = nullptr;
+
+	std::span<const uint32_t> level_offsets;
+	std::span<const uint32_t> parents;
+	std::span<const uint32_t> first_children;
+	std::span<const uint32_t> child_counts;
+	std::span<const glm::vec3> local_positions;
+	std::span<const glm::quat> local_rotations;
+	std::span<const glm::vec3> local_scales;
+
+	vector<ComponentType> component_types;
+	vector<ArchetypeView> archetypes;
+};
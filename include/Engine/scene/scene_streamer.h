@@ -0,0 +1,233 @@
+#pragma once
+
+#include "Engine/io/async_file_io.h"
+#include "Engine/scene/node_handle.h"
+#include "Engine/scene/scene_file.h"
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <glm/glm.hpp>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using std::vector;
+
+class Scene;
+
+namespace ThreadPool {
+	class Pool;
+};
+
+// --- SceneStreamer ---
+// Keeps the part of a large world around the camera resident.  The world is split into square
+// cells on the XZ plane, each saved as its own scene file with world space roots.
+//
+// Every `update` unloads the cells beyond the unload radius and starts loading the closest
+// missing cells inside the load radius.  Reads run as background priority thread pool jobs that
+// read and validate the whole file, so the game loop never waits on the disk.  With an
+// `AsyncFileIo` set the file is read by it instead and only validated on the pool, and reads of
+// cells that leave the radius before they start are cancelled.  Finished reads
+// are added to the scene a slice at a time (`Scene::instantiate_nodes`, then the component
+// rows), at most `nodes_per_update` nodes and rows per update, and unloading destroys root
+// subtrees under the same limit, so streaming never causes a frame spike.
+//
+// A cell's memory is its file size, the file mirrors its node and component arrays.  Cells are
+// only loaded while the resident, in flight and pending cells fit in the memory budget, making
+// room by unloading cells further away than the one being loaded.
+//
+// The render backend calls `update` at its sync point when the streamer is set on it, so cell
+// nodes must not be destroyed by anything else.
+// ---------------------
+
+class SceneStreamer {
+public:
+
+/////////////////////
+///// FUNCTIONS /////
+/////////////////////
+
+	SceneStreamer(Scene* scene, ThreadPool::Pool* pool, float cell_size);
+	/// `pool` may be null, files are then read on the calling thread.
+
+	SceneStreamer(const SceneStreamer&) = delete;
+	SceneStreamer& operator=(const SceneStreamer&) = delete;
+
+// ==== Cells ====
+// ---
+
+	void add_cell(int32_t x, int32_t z, const std::string& path);
+	/// Registers the scene file of the cell covering [x, x + 1) * cell size on X and the same on Z.
+
+	bool is_cell_resident(int32_t x, int32_t z) const;
+	/// True once every node and component of the cell is in the scene.
+
+// ==== Streaming ====
+// ---
+
+	void set_focus(const glm::vec3& position);
+	/// Where cells are streamed in around, usually the camera.  Thread safe, so it can be set
+	// from draw update callbacks.
+
+	void update();
+	/// Unloads, starts reads and integrates finished reads.  Must run where structural scene
+	// changes are allowed.  Rethrows the error of a failed read, the cell isn't retried.
+
+	void unload_all();
+	/// Drops every cell right away, ignoring the per update limit.
+
+// ==== Settings ====
+// ---
+
+	void set_radii(float load_radius, float unload_radius);
+	/// Cells whose nearest point is within `load_radius` of the focus are loaded, cells beyond
+	// `unload_radius` are unloaded.  The gap between them keeps cells on the edge from flickering.
+
+	void set_memory_budget(size_t bytes);
+
+	void set_nodes_per_update(uint32_t node_count);
+	/// The most nodes and component rows added or destroyed per update.
+
+	void set_max_reads_in_flight(size_t read_count);
+
+	void set_file_io(AsyncFileIo* file_io);
+	/// Reads cells through `file_io` at its lowest priority, null goes back to blocking reads on
+	// the pool.  Must outlive the reads it started, and only be changed while none are in flight.
+
+// ==== Statistics ====
+// ---
+
+	size_t get_memory_usage() const;
+	/// The bytes of every resident, pending and in flight cell.
+
+	size_t get_resident_cell_count() const;
+
+	size_t get_reads_in_flight() const;
+
+//////////////////////
+///// ATTRIBUTES /////
+//////////////////////
+
+	static constexpr float DEFAULT_LOAD_RADIUS_CELLS = 2.5f;
+	static constexpr float DEFAULT_UNLOAD_RADIUS_CELLS = 3.5f;
+	/// In cell sizes.
+
+	static constexpr size_t DEFAULT_MEMORY_BUDGET = 512ull * 1024 * 1024;
+
+	static constexpr uint32_t DEFAULT_NODES_PER_UPDATE = 8192;
+
+	static constexpr size_t DEFAULT_MAX_READS_IN_FLIGHT = 4;
+
+private:
+
+/////////////////////
+///// FUNCTIONS /////
+/////////////////////
+
+	enum class CellState {
+		UNLOADED,
+		READING,
+		INTEGRATING,
+		RESIDENT,
+		UNLOADING,
+		FAILED
+	};
+
+	struct Read {
+		std::atomic<bool> finished = false;
+		std::unique_ptr<SceneFile> file;
+		vector<ComponentId> component_ids;
+		/// Resolved once, every batch of components uses them.
+		vector<uint32_t> root_sizes;
+		/// The node count of every root's subtree.
+		std::exception_ptr error;
+
+		vector<std::byte> bytes;
+		AsyncFileIo::RequestId request_id = 0;
+		/// The destination and request of an `AsyncFileIo` read.
+	};
+	/// Shared with the read job, so a cell can be dropped while its read is still running.
+
+	struct Cell {
+		int32_t x;
+		int32_t z;
+		std::string path;
+		size_t memory_size = 0;
+
+		CellState state = CellState::UNLOADED;
+
+		std::shared_ptr<Read> read;
+
+		vector<NodeHandle> nodes;
+		/// Every node added so far, in file order.
+		size_t next_archetype = 0;
+		uint32_t next_row = 0;
+		/// Where integration continues.
+
+		vector<uint32_t> root_sizes;
+		size_t next_root = 0;
+		/// Roots [next_root, root count) are still in the scene while unloading.
+	};
+
+	struct DetachedRead {
+		std::shared_ptr<Read> read;
+		size_t memory_size;
+	};
+	/// The read of a cell that left the radius before it finished.
+
+	static uint64_t get_key(int32_t x, int32_t z);
+
+	float get_distance(const Cell& cell, const glm::vec3& focus) const;
+	/// From the focus to the nearest point of the cell, on the XZ plane.
+
+	void start_read(Cell& cell);
+
+	static void finish_read(Read& read, vector<std::byte> bytes);
+	/// Parses and validates the read file on the reading thread.
+
+	void detach_read(Cell& cell);
+	/// Keeps a dropped cell's read until it finishes, cancelling it if it hasn't started yet.
+
+	uint32_t integrate(Cell& cell, uint32_t budget);
+	/// Adds up to `budget` nodes or rows, returns how many were added.
+
+	uint32_t unload(Cell& cell, uint32_t budget);
+	/// Destroys root subtrees until `budget` nodes were destroyed, always at least one.
+
+	void drop(Cell& cell);
+	/// Forgets the cell's read and nodes, the nodes must already be destroyed.
+
+	bool make_room(size_t memory_size, float distance, const glm::vec3& focus);
+	/// Starts unloading cells further than `distance` until `memory_size` more bytes fit.
+
+//////////////////////
+///// ATTRIBUTES /////
+//////////////////////
+
+	Scene* scene;
+	ThreadPool::Pool* pool;
+	AsyncFileIo* file_io = nullptr;
+
+	float cell_size;
+	float load_radius;
+	float unload_radius;
+
+	size_t memory_budget = DEFAULT_MEMORY_BUDGET;
+	uint32_t nodes_per_update = DEFAULT_NODES_PER_UPDATE;
+	size_t max_reads_in_flight = DEFAULT_MAX_READS_IN_FLIGHT;
+
+	std::unordered_map<uint64_t, Cell> cells;
+
+	vector<Cell*> active_cells;
+	/// Every cell that isn't unloaded or failed.
+
+	vector<DetachedRead> detached_reads;
+
+	size_t memory_usage = 0;
+	size_t reads_in_flight = 0;
+
+	glm::vec3 focus = glm::vec3(0.0f);
+	mutable std::mutex focus_mutex;
+};
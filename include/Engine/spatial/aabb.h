@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cmath>
+#include <glm/glm.hpp>
+#include <limits>
+
+// --- Aabb ---
+// An axis aligned bounding box.  Default constructed boxes are empty (min above max), merging
+// anything into an empty box gives that thing back.
+// ------------
+
+struct Aabb {
+	glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());
+	glm::vec3 max = glm::vec3(-std::numeric_limits<float>::max());
+
+	bool is_empty() const {
+		return this->min.x > this->max.x || this->min.y > this->max.y || this->min.z > this->max.z;
+	}
+
+	void expand(const Aabb& other) {
+		this->min = glm::min(this->min, other.min);
+		this->max = glm::max(this->max, other.max);
+	}
+
+	void expand(const glm::vec3& point) {
+		this->min = glm::min(this->min, point);
+		this->max = glm::max(this->max, point);
+	}
+
+	glm::vec3 get_center() const {
+		return (this->min + this->max) * 0.5f;
+	}
+
+	float get_surface_area() const {
+		if (this->is_empty()) {
+			return 0.0f;
+		}
+		glm::vec3 size = this->max - this->min;
+		return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+	}
+
+	bool operator==(const Aabb& other) const {
+		return this->min == other.min && this->max == other.max;
+	}
+
+	static Aabb merge(const Aabb& a, const Aabb& b) {
+		Aabb result = a;
+		result.expand(b);
+		return result;
+	}
+
+	static Aabb transform(const Aabb& box, const glm::mat4& matrix) {
+		if (box.is_empty()) {
+			return box;
+		}
+
+		// Transform the center, the extents become the absolute matrix times the extents (Arvo).
+		glm::vec3 center = box.get_center();
+		glm::vec3 extents = box.max - center;
+
+		glm::vec3 newCenter(matrix[3].x, matrix[3].y, matrix[3].z);
+		glm::vec3 newExtents(0.0f);
+
+		for (int column = 0; column < 3; column++) {
+			for (int row = 0; row < 3; row++) {
+				newCenter[row] += matrix[column][row] * center[column];
+				newExtents[row] += std::abs(matrix[column][row]) * extents[column];
+			}
+		}
+
+		Aabb result;
+		result.min = newCenter - newExtents;
+		result.max = newCenter + newExtents;
+		return result;
+	}
+	/// The world space box enclosing `box` once transformed by `matrix`.
+};
+
+// --- Bounds ---
+// Component holding a node's bounds in its local space.  Nodes with it are culled against the
+// views and can be found by spatial queries.
+// --------------
+
+struct Bounds {
+	static constexpr const char* component_name = "Bounds";
+
+	Aabb local;
+};
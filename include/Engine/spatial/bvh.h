@@ -0,0 +1,189 @@
+#pragma once
+
+#include "Engine/scene/node_handle.h"
+#include "Engine/spatial/aabb.h"
+#include "Engine/spatial/bvh_builder.h"
+#include "Engine/spatial/frustum.h"
+#include "Engine/spatial/ray.h"
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+using std::vector;
+
+namespace ThreadPool {
+	class Pool;
+};
+
+struct NearestHit {
+	NodeHandle node;
+	/// Null when nothing was in range.
+	float distance = std::numeric_limits<float>::max();
+};
+
+// --- Bvh ---
+// A bounding volume hierarchy over node bounds, used for view culling.
+//
+// `rebuild` builds the tree top down with `BvhBuilder`.  Leaves hold up to
+// `LEAF_SIZE` items and the item boxes are stored one array per coordinate in leaf order, so a
+// leaf is culled with a single pass of the SIMD kernels and a subtree's items are one
+// contiguous range.
+//
+// Between rebuilds the tree is kept up to date incrementally: moving an item only rewrites its
+// box and `refit` grows or shrinks the boxes on the path to the root, new items wait in a
+// pending list that is culled linearly, and removed items are left behind as empty boxes.
+// `needs_rebuild` reports when that has drifted far enough from a fresh build to rebuild.
+// -----------
+
+class Bvh {
+public:
+
+/////////////////////
+///// FUNCTIONS /////
+/////////////////////
+
+// ==== Item Functions ====
+// ---
+
+	void set_bounds(NodeHandle node, const Aabb& bounds);
+	/// Inserts `node` or moves it to its new world space bounds.
+
+	void remove(NodeHandle node);
+
+	bool contains(NodeHandle node) const;
+
+	void clear();
+
+	size_t size() const;
+	/// The amount of items, including the pending ones.
+
+// ==== Tree Functions ====
+// ---
+
+	void refit();
+	/// Updates the node boxes above every item moved since the last refit.
+
+	bool needs_rebuild() const;
+	/// True once enough items were added, removed or moved that the tree is worth rebuilding.
+
+	void rebuild();
+	/// Builds a new tree over every item, pending ones included.
+
+	void set_rebuild_threshold(float threshold);
+	/// How much the tree's total node surface area may grow, relative to a fresh build, before
+	// `needs_rebuild` asks for a rebuild.  Defaults to 1.5.
+
+// ==== Query Functions ====
+// ---
+
+	void cull(const Frustum& frustum, vector<NodeHandle>& visible, ThreadPool::Pool* pool);
+	/// Fills `visible` with every item whose box isn't outside `frustum`.  Subtrees are culled in
+	// parallel on `pool` if it isn't null, the order of `visible` is the same either way.
+
+	void intersect(RayPacket& packet, RayHit* hits, vector<uint32_t>& stack) const;
+	/// Finds the closest item box each ray of `packet` hits, closer than what's already in `hits`.
+	// `stack` is scratch space, pass one per thread.
+
+	void overlap_sphere(const glm::vec3& center, float radius, vector<NodeHandle>& overlaps, vector<uint32_t>& stack) const;
+	/// Appends every item whose box touches the sphere.
+
+	NearestHit find_nearest(const glm::vec3& point, float max_distance, vector<uint32_t>& stack) const;
+	/// The item whose box is closest to `point`, 0 when `point` is inside it.
+
+	size_t get_tree_node_count() const;
+
+private:
+
+/////////////////////
+///// FUNCTIONS /////
+/////////////////////
+
+	uint32_t add_item(NodeHandle node, const Aabb& bounds);
+
+	void write_item(uint32_t item, NodeHandle node, const Aabb& bounds);
+
+	Aabb get_item_bounds(uint32_t item) const;
+
+	Aabb compute_leaf_bounds(const BvhNode& leaf) const;
+
+	void add_visible_items(uint32_t begin, uint32_t end, vector<NodeHandle>& visible) const;
+
+	struct CullTask {
+		uint32_t node;
+		bool inside;
+		/// Known to be fully inside the frustum, nothing below it needs testing.
+	};
+
+	void cull_subtree(const Frustum& frustum, CullTask root, vector<NodeHandle>& visible, vector<CullTask>& stack, vector<uint32_t>& scratch) const;
+
+	void cull_items(const Frustum& frustum, uint32_t begin, uint32_t end, vector<NodeHandle>& visible, vector<uint32_t>& scratch) const;
+
+	void resize_items(size_t count);
+	/// Keeps the arrays padded for the SIMD kernels.
+
+	BoxArrays get_box_arrays() const;
+
+	Float8 get_distances_squared(uint32_t first, const glm::vec3& point) const;
+	/// Squared distances from `point` to the 8 item boxes starting at `first`.
+
+	uint32_t get_live_mask(uint32_t first, uint32_t end) const;
+	/// One bit per item of the 8 starting at `first` that is before `end` and not removed.
+
+//////////////////////
+///// ATTRIBUTES /////
+//////////////////////
+
+public:
+
+	static constexpr uint32_t LEAF_SIZE = 8;
+	static constexpr uint32_t INVALID_INDEX = BvhNode::INVALID_INDEX;
+
+private:
+
+// === Items ===
+// Built items first in leaf order, then the pending ones.
+
+	vector<float> min_x;
+	vector<float> min_y;
+	vector<float> min_z;
+	vector<float> max_x;
+	vector<float> max_y;
+	vector<float> max_z;
+
+	vector<NodeHandle> item_nodes;
+	/// Null for removed items.
+
+	vector<uint32_t> item_leaves;
+	/// The leaf holding each built item, `INVALID_INDEX` for pending items.
+
+	vector<uint32_t> item_slots;
+	/// The item of each node, indexed by node handle index.
+
+	size_t item_count = 0;
+	size_t built_item_count = 0;
+	size_t removed_item_count = 0;
+
+// === Tree ===
+
+	vector<BvhNode> tree_nodes;
+
+	vector<uint32_t> dirty_leaves;
+	vector<uint8_t> dirty_leaf_flags;
+
+	double surface_area_sum = 0.0;
+	double built_surface_area_sum = 0.0;
+	/// The sum of every tree node's surface area, now and right after the last rebuild.
+
+	float rebuild_threshold = 1.5f;
+
+// === Culling ===
+// Kept between culls so the steady state doesn't allocate.
+
+	vector<CullTask> cull_tasks;
+	vector<CullTask> next_cull_tasks;
+	/// The subtrees culled in parallel, the tree's top levels are split until there are enough.
+
+	vector<vector<NodeHandle>> task_visible;
+	vector<vector<CullTask>> task_stacks;
+	vector<vector<uint32_t>> task_scratch;
+};
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Engine/spatial/aabb.h"
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <limits>
+#include <vector>
+
+using std::vector;
+
+// --- BvhNode ---
+// A node of a binary BVH stored in an array.  The two children of an internal node are next to
+// each other and every subtree's items are one contiguous range of the leaf ordered items.
+// ---------------
+
+struct BvhNode {
+	static constexpr uint32_t INVALID_INDEX = std::numeric_limits<uint32_t>::max();
+
+	Aabb bounds;
+	uint32_t left;
+	/// The first of the two children, `INVALID_INDEX` for leaves.
+	uint32_t parent;
+	uint32_t item_begin;
+	uint32_t item_count;
+	/// The items of the whole subtree.
+
+	bool is_leaf() const {
+		return this->left == INVALID_INDEX;
+	}
+};
+
+struct BvhBuildItem {
+	Aabb bounds;
+	glm::vec3 centroid;
+	uint32_t source;
+	/// Whatever the caller needs to find the item again after it was reordered.
+};
+
+namespace BvhBuilder {
+
+	void build(vector<BvhBuildItem>& items, uint32_t leaf_size, vector<BvhNode>& nodes);
+	/// Builds a tree top down over `items` with a binned surface area heuristic, splitting until
+	// a node has at most `leaf_size` items.  `items` is reordered into leaf order.
+};
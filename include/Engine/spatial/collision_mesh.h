@@ -0,0 +1,58 @@
+#pragma once
+
+#include "Engine/scene/node_handle.h"
+#include "Engine/spatial/aabb.h"
+#include "Engine/spatial/bvh_builder.h"
+#include "Engine/spatial/ray.h"
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <span>
+#include <vector>
+
+using std::vector;
+
+// --- CollisionMesh ---
+// Static world space triangles that rays can hit, level geometry for example.  The triangles
+// sit in a BVH built once by `BvhBuilder`, stored in leaf order as a corner and two edges per
+// triangle, one array per coordinate, so a leaf is tested against a whole `RayPacket` with
+// `Float8` ops.
+// ---------------------
+
+class CollisionMesh {
+public:
+
+	CollisionMesh(NodeHandle node, std::span<const glm::vec3> vertices, std::span<const uint32_t> indices);
+	/// Builds the mesh from a world space triangle list.  Hits report `node`.
+	// Throws if the index count isn't a multiple of 3 or an index is out of range.
+
+	void intersect(RayPacket& packet, RayHit* hits, vector<uint32_t>& stack) const;
+	/// Finds the closest triangle each ray of `packet` hits, closer than what's already in `hits`.
+
+	const Aabb& get_bounds() const;
+
+	size_t get_triangle_count() const;
+
+	static constexpr uint32_t LEAF_SIZE = 4;
+
+private:
+
+	NodeHandle node;
+
+	vector<BvhNode> tree_nodes;
+
+	vector<float> corner_x;
+	vector<float> corner_y;
+	vector<float> corner_z;
+	vector<float> edge1_x;
+	vector<float> edge1_y;
+	vector<float> edge1_z;
+	vector<float> edge2_x;
+	vector<float> edge2_y;
+	vector<float> edge2_z;
+	/// In leaf order.
+
+	vector<uint32_t> triangle_indices;
+	/// The index of each leaf ordered triangle in the original index list, divided by 3.
+
+	Aabb bounds;
+};
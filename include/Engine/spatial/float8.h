@@ -0,0 +1,127 @@
+#pragma once
+
+#include <bit>
+#include <cmath>
+#include <cstdint>
+
+#if defined(__AVX__)
+	#include <immintrin.h>
+	#define FLOAT8_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define FLOAT8_SSE
+#endif
+
+// --- Float8 ---
+// Eight floats operated on together: one AVX register, two SSE registers, or a plain array on
+// other targets.  The spatial queries are written against this so they only have one version.
+//
+// Comparisons return masks (every bit of a lane set when true) to combine with `&`, `|` and
+// `select`, `get_mask` packs them into one bit per lane.
+// --------------
+
+struct Float8 {
+#if defined(FLOAT8_AVX)
+	__m256 value;
+
+	static Float8 load(const float* values) { return Float8{ _mm256_loadu_ps(values) }; }
+	static Float8 broadcast(float value) { return Float8{ _mm256_set1_ps(value) }; }
+	static Float8 zero() { return Float8{ _mm256_setzero_ps() }; }
+	void store(float* values) const { _mm256_storeu_ps(values, this->value); }
+
+	friend Float8 operator+(Float8 a, Float8 b) { return Float8{ _mm256_add_ps(a.value, b.value) }; }
+	friend Float8 operator-(Float8 a, Float8 b) { return Float8{ _mm256_sub_ps(a.value, b.value) }; }
+	friend Float8 operator*(Float8 a, Float8 b) { return Float8{ _mm256_mul_ps(a.value, b.value) }; }
+	friend Float8 operator/(Float8 a, Float8 b) { return Float8{ _mm256_div_ps(a.value, b.value) }; }
+	friend Float8 operator&(Float8 a, Float8 b) { return Float8{ _mm256_and_ps(a.value, b.value) }; }
+	friend Float8 operator|(Float8 a, Float8 b) { return Float8{ _mm256_or_ps(a.value, b.value) }; }
+	friend Float8 operator<(Float8 a, Float8 b) { return Float8{ _mm256_cmp_ps(a.value, b.value, _CMP_LT_OQ) }; }
+	friend Float8 operator<=(Float8 a, Float8 b) { return Float8{ _mm256_cmp_ps(a.value, b.value, _CMP_LE_OQ) }; }
+	friend Float8 operator>(Float8 a, Float8 b) { return Float8{ _mm256_cmp_ps(a.value, b.value, _CMP_GT_OQ) }; }
+	friend Float8 operator>=(Float8 a, Float8 b) { return Float8{ _mm256_cmp_ps(a.value, b.value, _CMP_GE_OQ) }; }
+	static Float8 min(Float8 a, Float8 b) { return Float8{ _mm256_min_ps(a.value, b.value) }; }
+	static Float8 max(Float8 a, Float8 b) { return Float8{ _mm256_max_ps(a.value, b.value) }; }
+	static Float8 sqrt(Float8 a) { return Float8{ _mm256_sqrt_ps(a.value) }; }
+	static Float8 select(Float8 mask, Float8 a, Float8 b) { return Float8{ _mm256_blendv_ps(b.value, a.value, mask.value) }; }
+	uint32_t get_mask() const { return static_cast<uint32_t>(_mm256_movemask_ps(this->value)); }
+#elif defined(FLOAT8_SSE)
+	__m128 low;
+	__m128 high;
+
+	static Float8 load(const float* values) { return Float8{ _mm_loadu_ps(values), _mm_loadu_ps(values + 4) }; }
+	static Float8 broadcast(float value) { return Float8{ _mm_set1_ps(value), _mm_set1_ps(value) }; }
+	static Float8 zero() { return Float8{ _mm_setzero_ps(), _mm_setzero_ps() }; }
+	void store(float* values) const { _mm_storeu_ps(values, this->low); _mm_storeu_ps(values + 4, this->high); }
+
+	friend Float8 operator+(Float8 a, Float8 b) { return Float8{ _mm_add_ps(a.low, b.low), _mm_add_ps(a.high, b.high) }; }
+	friend Float8 operator-(Float8 a, Float8 b) { return Float8{ _mm_sub_ps(a.low, b.low), _mm_sub_ps(a.high, b.high) }; }
+	friend Float8 operator*(Float8 a, Float8 b) { return Float8{ _mm_mul_ps(a.low, b.low), _mm_mul_ps(a.high, b.high) }; }
+	friend Float8 operator/(Float8 a, Float8 b) { return Float8{ _mm_div_ps(a.low, b.low), _mm_div_ps(a.high, b.high) }; }
+	friend Float8 operator&(Float8 a, Float8 b) { return Float8{ _mm_and_ps(a.low, b.low), _mm_and_ps(a.high, b.high) }; }
+	friend Float8 operator|(Float8 a, Float8 b) { return Float8{ _mm_or_ps(a.low, b.low), _mm_or_ps(a.high, b.high) }; }
+	friend Float8 operator<(Float8 a, Float8 b) { return Float8{ _mm_cmplt_ps(a.low, b.low), _mm_cmplt_ps(a.high, b.high) }; }
+	friend Float8 operator<=(Float8 a, Float8 b) { return Float8{ _mm_cmple_ps(a.low, b.low), _mm_cmple_ps(a.high, b.high) }; }
+	friend Float8 operator>(Float8 a, Float8 b) { return Float8{ _mm_cmpgt_ps(a.low, b.low), _mm_cmpgt_ps(a.high, b.high) }; }
+	friend Float8 operator>=(Float8 a, Float8 b) { return Float8{ _mm_cmpge_ps(a.low, b.low), _mm_cmpge_ps(a.high, b.high) }; }
+	static Float8 min(Float8 a, Float8 b) { return Float8{ _mm_min_ps(a.low, b.low), _mm_min_ps(a.high, b.high) }; }
+	static Float8 max(Float8 a, Float8 b) { return Float8{ _mm_max_ps(a.low, b.low), _mm_max_ps(a.high, b.high) }; }
+	static Float8 sqrt(Float8 a) { return Float8{ _mm_sqrt_ps(a.low), _mm_sqrt_ps(a.high) }; }
+	static Float8 select(Float8 mask, Float8 a, Float8 b) {
+		return Float8{
+			_mm_or_ps(_mm_and_ps(mask.low, a.low), _mm_andnot_ps(mask.low, b.low)),
+			_mm_or_ps(_mm_and_ps(mask.high, a.high), _mm_andnot_ps(mask.high, b.high))
+		};
+	}
+	uint32_t get_mask() const {
+		return static_cast<uint32_t>(_mm_movemask_ps(this->low) | (_mm_movemask_ps(this->high) << 4));
+	}
+#else
+	float lanes[8];
+
+	static Float8 load(const float* values) { Float8 result; for (int i = 0; i < 8; i++) { result.lanes[i] = values[i]; } return result; }
+	static Float8 broadcast(float value) { Float8 result; for (int i = 0; i < 8; i++) { result.lanes[i] = value; } return result; }
+	static Float8 zero() { return broadcast(0.0f); }
+	void store(float* values) const { for (int i = 0; i < 8; i++) { values[i] = this->lanes[i]; } }
+
+	template<typename Function>
+	static Float8 apply(Float8 a, Float8 b, Function function) {
+		Float8 result;
+		for (int i = 0; i < 8; i++) {
+			result.lanes[i] = function(a.lanes[i], b.lanes[i]);
+		}
+		return result;
+	}
+
+	static float from_bool(bool value) { return std::bit_cast<float>(value ? 0xFFFFFFFFu : 0u); }
+	static bool to_bool(float value) { return std::bit_cast<uint32_t>(value) != 0; }
+
+	friend Float8 operator+(Float8 a, Float8 b) { return apply(a, b, [](float x, float y) { return x + y; }); }
+	friend Float8 operator-(Float8 a, Float8 b) { return apply(a, b, [](float x, float y) { return x - y; }); }
+	friend Float8 operator*(Float8 a, Float8 b) { return apply(a, b, [](float x, float y) { return x * y; }); }
+	friend Float8 operator/(Float8 a, Float8 b) { return apply(a, b, [](float x, float y) { return x / y; }); }
+	friend Float8 operator&(Float8 a, Float8 b) { return apply(a, b, [](float x, float y) { return std::bit_cast<float>(std::bit_cast<uint32_t>(x) & std::bit_cast<uint32_t>(y)); }); }
+	friend Float8 operator|(Float8 a, Float8 b) { return apply(a, b, [](float x, float y) { return std::bit_cast<float>(std::bit_cast<uint32_t>(x) | std::bit_cast<uint32_t>(y)); }); }
+	friend Float8 operator<(Float8 a, Float8 b) { return apply(a, b, [](float x, float y) { return from_bool(x < y); }); }
+	friend Float8 operator<=(Float8 a, Float8 b) { return apply(a, b, [](float x, float y) { return from_bool(x <= y); }); }
+	friend Float8 operator>(Float8 a, Float8 b) { return apply(a, b, [](float x, float y) { return from_bool(x > y); }); }
+	friend Float8 operator>=(Float8 a, Float8 b) { return apply(a, b, [](float x, float y) { return from_bool(x >= y); }); }
+	// Same operand order as the SSE instructions, so NaN behaves the same way.
+	static Float8 min(Float8 a, Float8 b) { return apply(a, b, [](float x, float y) { return x < y ? x : y; }); }
+	static Float8 max(Float8 a, Float8 b) { return apply(a, b, [](float x, float y) { return x > y ? x : y; }); }
+	static Float8 sqrt(Float8 a) { return apply(a, a, [](float x, float) { return std::sqrt(x); }); }
+	static Float8 select(Float8 mask, Float8 a, Float8 b) {
+		Float8 result;
+		for (int i = 0; i < 8; i++) {
+			result.lanes[i] = to_bool(mask.lanes[i]) ? a.lanes[i] : b.lanes[i];
+		}
+		return result;
+	}
+	uint32_t get_mask() const {
+		uint32_t mask = 0;
+		for (int i = 0; i < 8; i++) {
+			mask |= static_cast<uint32_t>(to_bool(this->lanes[i])) << i;
+		}
+		return mask;
+	}
+#endif
+};
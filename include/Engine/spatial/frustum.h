@@ -0,0 +1,51 @@
+#pragma once
+
+#include "Engine/spatial/aabb.h"
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+// --- Frustum ---
+// The six planes of a view's frustum, normals pointing inwards.  A point is inside a plane when
+// `dot(normal, point) + distance >= 0`.
+// ---------------
+
+struct Frustum {
+	enum class Result {
+		OUTSIDE,
+		INTERSECTING,
+		INSIDE
+	};
+
+	glm::vec4 planes[6];
+	/// Left, right, bottom, top, near, far.  xyz is the normal, w the distance.
+
+	static Frustum from_view_projection(const glm::mat4& view_projection);
+	/// Extracts the planes from a view projection matrix (Gribb and Hartmann).
+
+	Result classify(const Aabb& box) const;
+	/// Conservative, a box near a frustum corner can be reported as intersecting while outside.
+};
+
+// --- BoxArrays ---
+// Boxes stored as one array per coordinate so the culling kernels can load a box per SIMD lane.
+// The arrays must be readable up to `FrustumCulling::LANE_PADDING` entries past the last box.
+// -----------------
+
+struct BoxArrays {
+	const float* min_x;
+	const float* min_y;
+	const float* min_z;
+	const float* max_x;
+	const float* max_y;
+	const float* max_z;
+};
+
+namespace FrustumCulling {
+
+	constexpr size_t LANE_PADDING = 8;
+
+	size_t cull_boxes(const Frustum& frustum, const BoxArrays& boxes, size_t begin, size_t end, uint32_t* visible);
+	/// Writes the index of every box in [begin, end) that isn't outside `frustum` to `visible`
+	// and returns how many there were.  Tests 8 boxes at once with AVX, otherwise 4 with SSE.
+};
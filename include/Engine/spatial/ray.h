@@ -0,0 +1,164 @@
+#pragma once
+
+#include "Engine/scene/node_handle.h"
+#include "Engine/spatial/aabb.h"
+#include "Engine/spatial/bvh_builder.h"
+#include "Engine/spatial/float8.h"
+#include <cmath>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <limits>
+#include <span>
+#include <vector>
+
+using std::vector;
+
+struct Ray {
+	glm::vec3 origin = glm::vec3(0.0f);
+	glm::vec3 direction = glm::vec3(0.0f, 0.0f, -1.0f);
+	/// Hit distances are in multiples of the direction's length, normalize it for world units.
+	float max_distance = std::numeric_limits<float>::max();
+};
+
+struct RayHit {
+	static constexpr uint32_t NO_TRIANGLE = std::numeric_limits<uint32_t>::max();
+
+	NodeHandle node;
+	/// Null when nothing was hit.
+	float distance = std::numeric_limits<float>::max();
+	glm::vec3 normal = glm::vec3(0.0f);
+	/// Only set for triangle hits.
+	uint32_t triangle = NO_TRIANGLE;
+	/// The hit triangle of a `CollisionMesh`, `NO_TRIANGLE` for node bounds.
+
+	bool is_hit() const {
+		return !this->node.is_null();
+	}
+};
+
+// --- RayPacket ---
+// Eight rays traversed through a BVH together.  A node is visited once for the whole packet and
+// tested against all eight rays with one `Float8` op per step, which pays off when the rays are
+// coherent (similar origins and directions).
+//
+// `distance` is each ray's closest hit so far, hits further away are rejected.
+// -----------------
+
+struct RayPacket {
+	static constexpr uint32_t SIZE = 8;
+
+	alignas(32) float origin_x[SIZE];
+	alignas(32) float origin_y[SIZE];
+	alignas(32) float origin_z[SIZE];
+	alignas(32) float direction_x[SIZE];
+	alignas(32) float direction_y[SIZE];
+	alignas(32) float direction_z[SIZE];
+	alignas(32) float inverse_x[SIZE];
+	alignas(32) float inverse_y[SIZE];
+	alignas(32) float inverse_z[SIZE];
+	alignas(32) float distance[SIZE];
+
+	uint32_t active_mask = 0;
+	/// One bit per lane holding a ray.
+
+	void set_ray(uint32_t lane, const Ray& ray) {
+		this->origin_x[lane] = ray.origin.x;
+		this->origin_y[lane] = ray.origin.y;
+		this->origin_z[lane] = ray.origin.z;
+		this->direction_x[lane] = ray.direction.x;
+		this->direction_y[lane] = ray.direction.y;
+		this->direction_z[lane] = ray.direction.z;
+		this->inverse_x[lane] = get_inverse(ray.direction.x);
+		this->inverse_y[lane] = get_inverse(ray.direction.y);
+		this->inverse_z[lane] = get_inverse(ray.direction.z);
+		this->distance[lane] = ray.max_distance;
+		this->active_mask |= 1u << lane;
+	}
+
+	void clear() {
+		// Empty lanes still take part in the math, keep them finite.
+		for (uint32_t lane = 0; lane < SIZE; lane++) {
+			this->origin_x[lane] = this->origin_y[lane] = this->origin_z[lane] = 0.0f;
+			this->direction_x[lane] = this->direction_y[lane] = this->direction_z[lane] = 0.0f;
+			this->inverse_x[lane] = this->inverse_y[lane] = this->inverse_z[lane] = 0.0f;
+			this->distance[lane] = 0.0f;
+		}
+		this->active_mask = 0;
+	}
+
+	uint32_t intersect_box(const Aabb& box, Float8& entry) const {
+		// Slab test.
+		Float8 t1x = (Float8::broadcast(box.min.x) - Float8::load(this->origin_x)) * Float8::load(this->inverse_x);
+		Float8 t2x = (Float8::broadcast(box.max.x) - Float8::load(this->origin_x)) * Float8::load(this->inverse_x);
+		Float8 t1y = (Float8::broadcast(box.min.y) - Float8::load(this->origin_y)) * Float8::load(this->inverse_y);
+		Float8 t2y = (Float8::broadcast(box.max.y) - Float8::load(this->origin_y)) * Float8::load(this->inverse_y);
+		Float8 t1z = (Float8::broadcast(box.min.z) - Float8::load(this->origin_z)) * Float8::load(this->inverse_z);
+		Float8 t2z = (Float8::broadcast(box.max.z) - Float8::load(this->origin_z)) * Float8::load(this->inverse_z);
+
+		Float8 near = Float8::max(Float8::max(Float8::min(t1x, t2x), Float8::min(t1y, t2y)), Float8::min(t1z, t2z));
+		Float8 far = Float8::min(Float8::min(Float8::max(t1x, t2x), Float8::max(t1y, t2y)), Float8::max(t1z, t2z));
+
+		entry = Float8::max(near, Float8::zero());
+		return ((near <= far) & (far >= Float8::zero()) & (entry < Float8::load(this->distance))).get_mask() & this->active_mask;
+	}
+	/// The lanes whose ray enters `box` closer than their closest hit, `entry` is where (0 when
+	// the ray starts inside).
+
+	static float get_inverse(float value) {
+		// Large instead of infinite so an axis aligned ray never makes 0 * inf = NaN.
+		constexpr float LARGE = 1e30f;
+		return std::abs(value) > 1.0f / LARGE ? 1.0f / value : std::copysign(LARGE, value);
+	}
+};
+
+namespace RayTraversal {
+
+	template<typename LeafFunction>
+	void traverse(std::span<const BvhNode> nodes, RayPacket& packet, vector<uint32_t>& stack, LeafFunction&& test_leaf) {
+		if (nodes.empty() || packet.active_mask == 0) {
+			return;
+		}
+
+		stack.clear();
+		stack.push_back(0);
+
+		Float8 entry = Float8::zero();
+
+		while (!stack.empty()) {
+			const BvhNode& node = nodes[stack.back()];
+			stack.pop_back();
+
+			// Re-tested on the way down since the packet's closest hits may have moved closer.
+			uint32_t mask = packet.intersect_box(node.bounds, entry);
+			if (mask == 0) {
+				continue;
+			}
+
+			if (node.is_leaf()) {
+				test_leaf(node, mask);
+				continue;
+			}
+
+			// Visit the child on the side the first ray comes from first, so closer hits are
+			// found early and prune more.
+			const uint32_t lane = static_cast<uint32_t>(std::countr_zero(mask));
+			const glm::vec3 center = node.bounds.get_center();
+			const glm::vec3 leftCenter = nodes[node.left].bounds.get_center();
+			const float along =
+				(leftCenter.x - center.x) * packet.direction_x[lane] +
+				(leftCenter.y - center.y) * packet.direction_y[lane] +
+				(leftCenter.z - center.z) * packet.direction_z[lane];
+
+			if (along > 0.0f) {
+				stack.push_back(node.left);
+				stack.push_back(node.left + 1);
+			}
+			else {
+				stack.push_back(node.left + 1);
+				stack.push_back(node.left);
+			}
+		}
+	}
+	/// Walks every node any ray of `packet` enters, calling `test_leaf(const BvhNode&, uint32_t lane_mask)`
+	// for the leaves.  The leaf test records hits by lowering `packet.distance`.
+};
@@ -0,0 +1,165 @@
+#pragma once
+
+#include "Engine/scene/node_handle.h"
+#include "Engine/spatial/bvh.h"
+#include "Engine/spatial/collision_mesh.h"
+#include "Engine/spatial/ray.h"
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <vector>
+
+using std::vector;
+
+namespace ThreadPool {
+	class Pool;
+};
+
+struct SceneQueryTicket {
+	uint64_t batch = 0;
+	uint32_t recorder = 0;
+	uint32_t index = 0;
+};
+
+// --- SceneQueries ---
+// Raycasts, sphere overlaps and nearest node queries gathered from every callback and run
+// together in one batch.
+//
+// Callbacks record a query and get a ticket back.  The render backend executes the batch at the
+// end of every fixed update phase, so the results are ready for the callbacks of the next phase
+// (the first phase of the next tick for queries made in the last one) and are kept until the
+// batch after that executes.
+//
+// Rays are sorted by direction octant and origin (Morton order) so neighbouring rays go into the
+// same `RayPacket`, and packets run in parallel on the thread pool against the node bounds in
+// the render backend's `Bvh` and every added `CollisionMesh`.
+//
+// Recording is thread safe, each thread pool worker has its own recorder.  Results must only
+// be read from fixed update callbacks, which never run at the same time as a batch.
+// --------------------
+
+class SceneQueries {
+public:
+
+/////////////////////
+///// FUNCTIONS /////
+/////////////////////
+
+	SceneQueries();
+
+// ==== Recording ====
+// ---
+
+	SceneQueryTicket raycast(const Ray& ray);
+
+	SceneQueryTicket overlap_sphere(const glm::vec3& center, float radius);
+
+	SceneQueryTicket find_nearest(const glm::vec3& point, float max_distance);
+
+// ==== Results ====
+// Throw if the ticket's batch hasn't executed yet or its results were already replaced.
+// ---
+
+	const RayHit& get_ray_hit(SceneQueryTicket ticket) const;
+
+	std::span<const NodeHandle> get_overlaps(SceneQueryTicket ticket) const;
+
+	const NearestHit& get_nearest(SceneQueryTicket ticket) const;
+
+// ==== Execution ====
+// ---
+
+	void execute(const Bvh* bvh);
+	/// Runs every query recorded since the last batch, in parallel on the thread pool if one is
+	// set.  `bvh` may be null.
+
+	void set_thread_pool(ThreadPool::Pool* pool);
+	/// Sets up one recorder per worker of `pool`.  Must not be called while anything records,
+	// until then every thread shares a single recorder.
+
+	void add_collision_mesh(const CollisionMesh* mesh);
+
+	void remove_collision_mesh(const CollisionMesh* mesh);
+
+	size_t get_batch_ray_count() const;
+
+private:
+
+/////////////////////
+///// FUNCTIONS /////
+/////////////////////
+
+	struct SphereQuery {
+		glm::vec3 center;
+		float radius;
+	};
+
+	struct NearestQuery {
+		glm::vec3 point;
+		float max_distance;
+	};
+
+	struct Recorder {
+		std::mutex mutex;
+		/// Only ever contended while a batch drains it.
+
+		uint64_t batch = 0;
+		uint64_t result_batch = UINT64_MAX;
+		/// The batch being recorded, and the batch whose results are held.
+
+		vector<Ray> rays;
+		vector<SphereQuery> spheres;
+		vector<NearestQuery> nearest;
+
+		size_t ray_offset = 0;
+		size_t sphere_offset = 0;
+		size_t nearest_offset = 0;
+		/// Where this recorder's queries start in the executed batch.
+	};
+
+	Recorder& get_recorder(uint32_t& recorder_index);
+
+	const Recorder& get_result_recorder(SceneQueryTicket ticket) const;
+
+	void gather(uint64_t batch);
+	/// Moves every recorder's queries into the batch arrays.
+
+	void sort_rays();
+
+	void execute_rays(const Bvh* bvh);
+
+	vector<uint32_t>& get_stack();
+
+//////////////////////
+///// ATTRIBUTES /////
+//////////////////////
+
+	ThreadPool::Pool* pool = nullptr;
+
+	vector<std::unique_ptr<Recorder>> recorders;
+	/// One per worker, the last one is shared by every other thread.
+
+	uint64_t batch = 0;
+
+	vector<const CollisionMesh*> collision_meshes;
+
+// === Batch ===
+// Kept between batches so the steady state doesn't allocate.
+
+	vector<Ray> batch_rays;
+	vector<SphereQuery> batch_spheres;
+	vector<NearestQuery> batch_nearest;
+
+	vector<uint64_t> ray_keys;
+	vector<uint32_t> ray_order;
+	/// Ray indices sorted for coherent packets.
+
+	vector<RayHit> ray_hits;
+	vector<vector<NodeHandle>> overlaps;
+	vector<NearestHit> nearest_hits;
+
+	vector<vector<uint32_t>> stacks;
+	/// Traversal scratch, one per worker plus one for the calling thread.
+};
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "Engine/scene/node_handle.h"
+#include "Engine/spatial/bvh.h"
+#include "Engine/spatial/frustum.h"
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <vector>
+
+using std::vector;
+
+class Scene;
+
+namespace ThreadPool {
+	class Pool;
+};
+
+// --- Visibility ---
+// Keeps a `Bvh` over the world space bounds of every scene node with a `Bounds` component and
+// culls views against it.
+//
+// `update` runs once per frame after the world transforms: it picks up `Bounds` components
+// written since the last update and the nodes whose world matrix changed, refits the tree and
+// rebuilds it when it has degraded.  Destroyed nodes are dropped through `remove_nodes`, a
+// removed `Bounds` component is noticed the next time the node moves.
+//
+// Only one thread changes the tree.  Other threads reading it, like scene queries running on
+// the fixed update thread, hold `get_bvh_mutex()`, which every function changing it holds too.
+// ------------------
+
+class Visibility {
+public:
+
+	void update(Scene& scene);
+
+	void cull(const Frustum& frustum, vector<NodeHandle>& visible, ThreadPool::Pool* pool);
+	/// Fills `visible` with every node whose bounds aren't outside `frustum`.
+
+	void remove_nodes(std::span<const NodeHandle> nodes);
+
+	void clear();
+	/// Forgets every node, used when switching scenes.
+
+	Bvh& get_bvh();
+
+	std::mutex& get_bvh_mutex();
+
+private:
+
+	Bvh bvh;
+	std::mutex bvh_mutex;
+
+	uint64_t bounds_version = 0;
+	/// The component store's change version as of the last update.
+};
@@ -0,0 +1,148 @@
+#pragma once
+
+#include "Engine/io/mapped_file.h"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+using std::vector;
+
+// ==== Binary Layout ====
+// A header with a fixed table of mip levels, then the texel data of every level, each level 16
+// byte aligned.  A level holds all array layers one after the other, tightly packed: exactly
+// what one `vk::BufferImageCopy` per level expects with the file copied into a staging buffer as
+// is.  Block compressed levels round their size up to whole 4x4 blocks.
+// ---
+
+enum class TextureFormat : uint32_t {
+	RGBA8_UNORM,
+	RGBA8_SRGB,
+	BC1_UNORM,
+	BC1_SRGB,
+	/// RGB with 1 bit alpha, 8 bytes a block.
+	BC3_UNORM,
+	BC3_SRGB,
+	/// RGBA, 16 bytes a block.
+	BC5_UNORM,
+	/// Two independent channels, 16 bytes a block.  For normal maps, the shader rebuilds z.
+	BC7_UNORM,
+	BC7_SRGB
+	/// RGBA, 16 bytes a block.
+};
+
+struct TextureFileLevel {
+	uint64_t offset = 0;
+	uint64_t size = 0;
+	/// In bytes, every layer of the level.
+	uint32_t width = 0;
+	uint32_t height = 0;
+};
+
+struct TextureFileHeader {
+	static constexpr uint32_t MAGIC = 0x58455454;
+	/// "TTEX"
+	static constexpr uint32_t VERSION = 1;
+	static constexpr uint32_t MAX_MIP_COUNT = 16;
+
+	uint32_t magic = MAGIC;
+	uint32_t version = VERSION;
+	uint64_t file_size = 0;
+
+	TextureFormat format = TextureFormat::RGBA8_UNORM;
+	uint32_t width = 0;
+	uint32_t height = 0;
+	uint32_t mip_count = 0;
+	uint32_t layer_count = 0;
+	uint32_t reserved = 0;
+
+	TextureFileLevel levels[MAX_MIP_COUNT];
+	/// The first `mip_count` are used, largest first.
+};
+
+// --- TextureFile ---
+// A texture cooked offline by the texture cooker (`src/tools/texture_cooker`): mips built and
+// block compressed ahead of time in the layout a `vk::Image` is filled from.  Opening one maps
+// the file and checks the level table, nothing is decoded.
+// -------------------
+
+class TextureFile {
+public:
+
+/////////////////////
+///// FUNCTIONS /////
+/////////////////////
+
+// ==== Class Functions ====
+// ---
+
+	explicit TextureFile(const std::string& path);
+	/// Maps the file.  Throws if it can't be opened or isn't a valid texture file.
+
+	explicit TextureFile(vector<std::byte> bytes);
+	/// Takes over an already loaded file, for textures read from a pack.
+
+	static TextureFile view(std::span<const std::byte> data);
+	/// Validates a file already in memory without copying it, such as one read straight into a
+	// staging buffer.  `data` must outlive the result.
+
+	TextureFile(const TextureFile&) = delete;
+	TextureFile& operator=(const TextureFile&) = delete;
+
+	TextureFile(TextureFile&&) = default;
+	TextureFile& operator=(TextureFile&&) = default;
+
+	static bool is_block_compressed(TextureFormat format);
+
+	static uint64_t get_layer_size(TextureFormat format, uint32_t width, uint32_t height);
+	/// In bytes, of one layer of one level.  Throws for unknown formats.
+
+// ==== Getters ====
+// ---
+
+	TextureFormat get_format() const;
+
+	uint32_t get_width() const;
+
+	uint32_t get_height() const;
+
+	uint32_t get_mip_count() const;
+
+	uint32_t get_layer_count() const;
+
+	const TextureFileLevel& get_level(uint32_t mip) const;
+
+	std::span<const std::byte> get_level_data(uint32_t mip) const;
+
+	std::span<const std::byte> get_layer_data(uint32_t mip, uint32_t layer) const;
+
+	std::span<const std::byte> get_data() const;
+	/// The whole file, level offsets are relative to its start.
+
+	size_t size() const;
+	/// In bytes.
+
+private:
+
+/////////////////////
+///// FUNCTIONS /////
+/////////////////////
+
+	TextureFile() = default;
+
+	void fix_up();
+	/// Validates the file.
+
+//////////////////////
+///// ATTRIBUTES /////
+//////////////////////
+
+	MappedFile mapped_file;
+	vector<std::byte> bytes;
+	/// At most one of the two holds the file, neither does for a view.
+
+	std::span<const std::byte> data;
+
+	const TextureFileHeader* header = nullptr;
+};
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+
+namespace ThreadPool {
+
+    // Bounded lock-free multi producer / multi consumer queue (Dmitry Vyukov's design).
+    // Every cell carries a sequence number that tells producers and consumers whether it is
+    // free for the current lap, so a push or pop is a single CAS on the shared index.
+    template<typename T>
+    class MPMCQueue {
+        struct Cell {
+            std::atomic<size_t> sequence;
+            T data;
+        };
+
+        std::unique_ptr<Cell[]> cells;
+        size_t mask;
+
+        alignas(64) std::atomic<size_t> enqueue_position{ 0 };
+        alignas(64) std::atomic<size_t> dequeue_position{ 0 };
+
+        static size_t round_up_to_power_of_two(size_t value) {
+            size_t result = 2;
+            while (result < value) {
+                result <<= 1;
+            }
+            return result;
+        }
+
+    public:
+        explicit MPMCQueue(size_t capacity = 1024) {
+            size_t size = round_up_to_power_of_two(capacity);
+            cells.reset(new Cell[size]);
+            mask = size - 1;
+            for (size_t i = 0; i < size; i++) {
+                cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        MPMCQueue(const MPMCQueue&) = delete;
+        MPMCQueue& operator=(const MPMCQueue&) = delete;
+
+        // Returns false when the queue is full, `value` is then left as it was.
+        template<typename U>
+        bool try_push(U&& value) {
+            size_t position = enqueue_position.load(std::memory_order_relaxed);
+            Cell* cell;
+
+            while (true) {
+                cell = &cells[position & mask];
+                size_t sequence = cell->sequence.load(std::memory_order_acquire);
+                intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+
+                if (difference == 0) {
+                    if (enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                        break;
+                    }
+                }
+                else if (difference < 0) {
+                    return false;
+                }
+                else {
+                    position = enqueue_position.load(std::memory_order_relaxed);
+                }
+            }
+
+            cell->data = std::forward<U>(value);
+            cell->sequence.store(position + 1, std::memory_order_release);
+            return true;
+        }
+
+        std::optional<T> try_pop() {
+            size_t position = dequeue_position.load(std::memory_order_relaxed);
+            Cell* cell;
+
+            while (true) {
+                cell = &cells[position & mask];
+                size_t sequence = cell->sequence.load(std::memory_order_acquire);
+                intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+
+                if (difference == 0) {
+                    if (dequeue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                        break;
+                    }
+                }
+                else if (difference < 0) {
+                    return std::nullopt;
+                }
+                else {
+                    position = dequeue_position.load(std::memory_order_relaxed);
+                }
+            }
+
+            std::optional<T> result(std::move(cell->data));
+            cell->sequence.store(position + mask + 1, std::memory_order_release);
+            return result;
+        }
+
+        size_t capacity() const noexcept {
+            return mask + 1;
+        }
+    };
+
+} // namespace ThreadPool
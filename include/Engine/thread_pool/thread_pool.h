@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Engine/thread_pool/chase_lev_deque.h"
+#include "Engine/thread_pool/mpmc_queue.h"
 #include <vector>
 #include <queue>
 #include <thread>
@@ -30,11 +31,28 @@ namespace ThreadPool {
 
         // Submit tasks
 
+        // A worker pushes onto its own deque, any other thread onto the pool's injection queue
+        // which the workers drain before they try to steal.  Without workers the job runs right here.
         void submit(std::function<void()> work, size_t priority = 0);
+
+        // Splits [0, count) into chunks of `chunk_size` and runs `work(begin, end)` for every
+        // chunk across the workers.  The calling thread works on chunks too and this returns once
+        // every chunk has finished, so it is safe to call from inside a job.
+        // Rethrows the first exception thrown by `work`.
+        void parallel_for(
+            size_t count,
+            size_t chunk_size,
+            const std::function<void(size_t, size_t)>& work,
+            size_t priority = 0
+        );
         
         // wait for all tasks to finish
         void wait();
 
+        // The calling thread's index among this pool's workers, or `thread_count` when it isn't
+        // one of them.  Lets jobs pick per worker state without locking.
+        size_t get_current_worker_index() const;
+
         // Attributes
 
         size_t priority_count;
@@ -50,9 +68,15 @@ namespace ThreadPool {
 
         std::optional<Job> try_steal_by_priority(size_t worker_id, std::mt19937& gen);
 
+        void run_job(Job& job);
+
         // Attributes
 
         std::vector<std::unique_ptr<Worker>> workers;
+
+        // One per priority.  Worker deques only take pushes from their owner, so jobs submitted
+        // from outside the pool come in through these.
+        std::vector<std::unique_ptr<MPMCQueue<Job>>> injection_queues;
         std::atomic<bool> shutdown{ false };
         std::atomic<size_t> active_jobs{ 0 };
 
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "Tools/cache/content_hash.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+
+// --- AssetCache ---
+// A local content addressed store of processed assets: each entry is a cooked file named after
+// the key of everything that went into it (`<directory>/<first two digits>/<key>`).  Entries
+// never change once written, so a hit is always valid and stale entries are simply unused.
+// Safe to use from several threads and several processes at once.
+// ------------------
+
+class AssetCache {
+public:
+
+	struct Statistics {
+		size_t hits = 0;
+		size_t misses = 0;
+		uint64_t hit_bytes = 0;
+		/// Copied out of the cache.
+		uint64_t stored_bytes = 0;
+	};
+
+/////////////////////
+///// FUNCTIONS /////
+/////////////////////
+
+// ==== Class Functions ====
+// ---
+
+	explicit AssetCache(const std::string& directory);
+	/// Creates the directory if needed.  Throws if it can't.
+
+	AssetCache(const AssetCache&) = delete;
+	AssetCache& operator=(const AssetCache&) = delete;
+
+// ==== Entries ====
+// ---
+
+	bool fetch(const ContentKey& key, const std::string& output_path);
+	/// Copies the entry to `output_path` and counts a hit, or counts a miss when there is none.
+	// Throws if the copy fails.
+
+	void store(const ContentKey& key, std::span<const std::byte> bytes);
+	/// Written under a temporary name and renamed into place, so no reader ever sees half an
+	// entry.  Throws if it can't be written.
+
+// ==== Getters ====
+// ---
+
+	std::string get_entry_path(const ContentKey& key) const;
+
+	Statistics get_statistics() const;
+
+	const std::string& get_directory() const;
+
+private:
+
+//////////////////////
+///// ATTRIBUTES /////
+//////////////////////
+
+	std::string directory;
+
+	std::atomic<size_t> hits{ 0 };
+	std::atomic<size_t> misses{ 0 };
+	std::atomic<uint64_t> hit_bytes{ 0 };
+	std::atomic<uint64_t> stored_bytes{ 0 };
+};
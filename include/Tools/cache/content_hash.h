@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+
+// --- ContentKey ---
+// A 128 bit content hash, the name of an entry in the asset cache.
+// ------------------
+
+struct ContentKey {
+	uint64_t high = 0;
+	uint64_t low = 0;
+
+	std::string to_string() const;
+	/// 32 lowercase hex digits.
+
+	bool operator==(const ContentKey&) const = default;
+};
+
+// --- ContentHasher ---
+// Streaming XXH64, run twice with different seeds for a 128 bit key: fast enough to hash every
+// source of a project on each build (several GB/s a thread), wide enough that colliding keys
+// aren't a concern.  Not cryptographic, the cache trusts its own directory.
+// ---------------------
+
+class ContentHasher {
+public:
+
+/////////////////////
+///// FUNCTIONS /////
+/////////////////////
+
+// ==== Hashing ====
+// ---
+
+	ContentHasher();
+
+	void update(std::span<const std::byte> bytes);
+
+	void update(const std::string& text);
+	/// Hashes the length too, so consecutive strings can't run into each other.
+
+	void update(uint64_t value);
+
+	ContentKey finish() const;
+	/// Doesn't reset, more can still be added.
+
+private:
+
+	struct Lane {
+		uint64_t seed = 0;
+		uint64_t accumulators[4] = {};
+	};
+
+/////////////////////
+///// FUNCTIONS /////
+/////////////////////
+
+	static void process_stripe(Lane& lane, const std::byte* stripe);
+
+	uint64_t finish_lane(const Lane& lane) const;
+
+//////////////////////
+///// ATTRIBUTES /////
+//////////////////////
+
+	Lane lanes[2];
+
+	std::byte buffer[32] = {};
+	size_t buffer_size = 0;
+	/// The start of a stripe that isn't complete yet.
+
+	uint64_t total_size = 0;
+};
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "Engine/spatial/aabb.h"
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <string>
+#include <vector>
+
+using std::vector;
+
+// --- MeshData ---
+// A mesh as the offline tools work on it: one float array per attribute and one triangle list
+// over all submeshes.  Optional attributes are either empty or hold one value per vertex.
+// ----------------
+
+struct MeshData {
+	struct Submesh {
+		uint32_t first_index = 0;
+		uint32_t index_count = 0;
+		uint32_t material = 0;
+		uint32_t first_meshlet = 0;
+		uint32_t meshlet_count = 0;
+		/// The submesh's run of `meshlets`, empty until they're built.
+	};
+
+	struct Meshlet {
+		uint32_t first_index = 0;
+		uint32_t index_count = 0;
+		glm::vec3 center = glm::vec3(0.0f);
+		float radius = 0.0f;
+		glm::vec3 cone_axis = glm::vec3(0.0f);
+		float cone_cutoff = 1.0f;
+		/// The sine of the cone's half angle, 1 when the triangles face too many ways to cull.
+	};
+
+	struct Lod {
+		uint32_t first_submesh = 0;
+		uint32_t submesh_count = 0;
+		float error = 0.0f;
+		/// The largest distance of the LOD's surface from the full detail one.
+	};
+
+	vector<glm::vec3> positions;
+	vector<glm::vec3> normals;
+	vector<glm::vec2> texcoords;
+	vector<glm::vec4> colors;
+
+	vector<uint32_t> indices;
+	/// Triangle lists, submeshes are consecutive runs.
+
+	vector<Submesh> submeshes;
+	vector<std::string> material_names;
+
+	vector<Lod> lods;
+	/// Consecutive runs of submeshes, finest first.  Empty for a single LOD of every submesh.
+
+	vector<Meshlet> meshlets;
+	/// Small clusters of each submesh's triangles, consecutive runs of its indices.
+
+	size_t get_vertex_count() const {
+		return this->positions.size();
+	}
+
+	size_t get_triangle_count() const {
+		return this->indices.size() / 3;
+	}
+
+	Aabb get_bounds(uint32_t first_index, uint32_t index_count) const;
+	/// Of the vertices the triangles in the index range use.
+
+	void validate() const;
+	/// Throws `std::runtime_error` if the arrays don't line up.
+};
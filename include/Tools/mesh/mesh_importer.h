@@ -0,0 +1,16 @@
+#pragma once
+
+#include "Tools/mesh/mesh_data.h"
+#include <string>
+
+// --- MeshImporter ---
+// Imports source models (anything assimp reads) for the offline tools.  Only tools include
+// this, the runtime and editor load cooked meshes and never link assimp.
+// --------------------
+
+namespace MeshImporter {
+
+	MeshData import(const std::string& path);
+	/// Triangulates, welds identical vertices, generates missing normals and flattens the node
+	// hierarchy into one mesh with one submesh per source mesh.  Throws if nothing can be imported.
+};
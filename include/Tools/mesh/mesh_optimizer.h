@@ -0,0 +1,51 @@
+#pragma once
+
+#include "Tools/mesh/mesh_data.h"
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <span>
+
+// --- MeshOptimizer ---
+// Offline reordering of a mesh's triangles and vertices for the GPU, run by the asset cooker.
+// Nothing about the mesh's appearance changes, only the order things are stored in:
+//
+// - Vertex cache: Tipsify (Sander, Nehab and Barczak 2007) reorders each submesh's triangles so
+//   vertices are reused while they are still in the post-transform cache.  Linear time.
+// - Overdraw: the cache ordered triangles are cut into clusters where the cache order already
+//   starts over, and the clusters are sorted so ones facing out from the mesh's centre draw
+//   first and occlude the rest.  A cluster is only split further while the cache efficiency
+//   stays within `overdraw_threshold` of the cache optimized order.
+// - Vertex fetch: vertices are renumbered in the order the indices first use them, so vertex
+//   fetches walk memory forward.
+//
+// The cache statistics are for a FIFO cache, `acmr` is the average number of vertices
+// transformed per triangle (0.5 at best for large grids, 3 at worst) and `atvr` the number
+// transformed per vertex (1 at best).
+// ---------------------
+
+namespace MeshOptimizer {
+
+	static constexpr uint32_t DEFAULT_CACHE_SIZE = 16;
+	/// Vertices, a conservative size that also suits the GPUs with larger caches.
+
+	static constexpr float DEFAULT_OVERDRAW_THRESHOLD = 1.05f;
+
+	struct CacheStatistics {
+		float acmr = 0.0f;
+		float atvr = 0.0f;
+	};
+
+	CacheStatistics analyze_vertex_cache(std::span<const uint32_t> indices, size_t vertex_count, uint32_t cache_size = DEFAULT_CACHE_SIZE);
+
+	void optimize_vertex_cache(std::span<uint32_t> indices, uint32_t cache_size = DEFAULT_CACHE_SIZE);
+	/// Reorders the triangles of one submesh.
+
+	void optimize_overdraw(std::span<uint32_t> indices, std::span<const glm::vec3> positions, float threshold = DEFAULT_OVERDRAW_THRESHOLD, uint32_t cache_size = DEFAULT_CACHE_SIZE);
+	/// Reorders the triangles of one submesh that were already optimized for the vertex cache.
+
+	void optimize_vertex_fetch(MeshData& mesh);
+	/// Renumbers the vertices in first use order, dropping any that no triangle uses.
+
+	void optimize(MeshData& mesh, uint32_t cache_size = DEFAULT_CACHE_SIZE, float overdraw_threshold = DEFAULT_OVERDRAW_THRESHOLD);
+	/// All three, every submesh on its own.
+};
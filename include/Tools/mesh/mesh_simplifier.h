@@ -0,0 +1,40 @@
+#pragma once
+
+#include "Tools/mesh/mesh_data.h"
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <span>
+#include <vector>
+
+using std::vector;
+
+// --- MeshSimplifier ---
+// Offline quadric error simplification (Garland and Heckbert 1997) for the asset cooker's LOD
+// chains.  Edges are collapsed into one of their two vertices, cheapest first, in passes of
+// independent collapses.  A collapse's error is the area weighted RMS distance of the kept
+// vertex to the original triangles' planes around it, so errors are distances in the mesh's
+// units and compare across LODs.
+//
+// Vertices that share a position are treated as one for the topology.  Vertices on an
+// attribute seam (more than one vertex at the position) or on a border are never moved, so
+// textures don't tear and submeshes simplified on their own still meet without cracks.
+// Collapses that would flip a triangle are skipped.
+// ----------------------
+
+namespace MeshSimplifier {
+
+	static constexpr float DEFAULT_LOD_RATIO = 0.5f;
+	/// Each LOD keeps this fraction of the previous one's triangles.
+
+	static constexpr float DEFAULT_MAX_ERROR = 0.02f;
+	/// Relative to the mesh's bounds diagonal, the chain stops at the first LOD that would exceed it.
+
+	float simplify(std::span<const glm::vec3> positions, std::span<const uint32_t> indices, size_t target_index_count, float max_error, vector<uint32_t>& result);
+	/// Writes `indices` simplified towards `target_index_count` indices to `result`, stopping
+	// early rather than going past `max_error` (a distance).  Returns the largest error introduced.
+
+	uint32_t build_lod_chain(MeshData& mesh, uint32_t max_lod_count, float ratio = DEFAULT_LOD_RATIO, float max_error = DEFAULT_MAX_ERROR);
+	/// Adds LODs 1 and up to `mesh`, each with its own copy of the submeshes over the shared
+	// vertices, until `max_lod_count` LODs exist or simplifying stops paying off.  Returns the
+	// LOD count.
+};
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "Tools/mesh/mesh_data.h"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+using std::vector;
+
+// --- MeshWriter ---
+// Writes `MeshData` as a cooked mesh file (`Engine/mesh/mesh_file.h`).
+// ------------------
+
+namespace MeshWriter {
+
+	enum class Layout {
+		INTERLEAVED,
+		/// One stream with every attribute.
+		SPLIT_POSITIONS,
+		/// Positions in their own stream, the rest interleaved in a second one, so depth and
+		// shadow passes only fetch positions.
+		SEPARATE
+		/// One stream per attribute.
+	};
+
+	enum class Encoding {
+		FLOAT,
+		/// 48 bytes a vertex with every attribute.
+		QUANTIZED
+		/// 20 bytes a vertex: 16 bit normalized positions over the mesh's bounds, octahedral 16 bit
+		// normals, half float texcoords and 8 bit colors.
+	};
+
+	vector<std::byte> serialize(const MeshData& mesh, Layout layout, Encoding encoding = Encoding::FLOAT);
+	/// Throws if the mesh doesn't validate.
+
+	void save(const MeshData& mesh, Layout layout, Encoding encoding, const std::string& path);
+	/// Throws if the file can't be written.
+};
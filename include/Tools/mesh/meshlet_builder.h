@@ -0,0 +1,28 @@
+#pragma once
+
+#include "Tools/mesh/mesh_data.h"
+#include <cstdint>
+
+// --- MeshletBuilder ---
+// Splits each submesh into meshlets: clusters of at most 64 vertices and 124 triangles that
+// can be culled on their own.  Triangles are reordered so a meshlet is a run of the index
+// buffer, a visible set of meshlets draws as a few index ranges.
+//
+// A meshlet grows from a seed triangle by adding the neighbouring triangle that brings in the
+// fewest new vertices, keeping it compact so its bounding sphere and normal cone stay tight.
+// Seeds follow the existing triangle order, so run it after `MeshOptimizer::optimize` (which
+// would otherwise scatter the meshlets again) to keep most of the vertex cache ordering.
+// ----------------------
+
+namespace MeshletBuilder {
+
+	static constexpr uint32_t DEFAULT_MAX_VERTICES = 64;
+	static constexpr uint32_t DEFAULT_MAX_TRIANGLES = 124;
+
+	static constexpr float MIN_CONE_SPREAD = 0.1f;
+	/// Cones wider than this (the cosine of the widest normal from the axis) never cull anything
+	// and are stored disabled.
+
+	void build(MeshData& mesh, uint32_t max_vertices = DEFAULT_MAX_VERTICES, uint32_t max_triangles = DEFAULT_MAX_TRIANGLES);
+	/// Replaces `mesh.meshlets` with meshlets of every submesh, LODs included.
+};
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using std::vector;
+
+namespace ThreadPool {
+	class Pool;
+};
+
+// --- PackWriter ---
+// Builds pack archives (`Engine/io/pack_file.h`).  Files are streamed through in batches of
+// blocks, each batch compressed in parallel on the thread pool and written in order, so packing
+// never holds more than a batch in memory.
+// ------------------
+
+namespace PackWriter {
+
+	struct Source {
+		std::string name;
+		/// The path in the pack, normalized when written.
+		std::string path;
+		/// The file on disk.
+	};
+
+	struct Statistics {
+		size_t file_count = 0;
+		uint64_t size = 0;
+		/// Of the files.
+		uint64_t packed_size = 0;
+		/// Of their blocks in the pack.
+	};
+
+	vector<Source> collect(const std::string& directory);
+	/// Every file under `directory`, named by its path relative to it.
+
+	Statistics save(const vector<Source>& sources, const std::string& path, bool compress, ThreadPool::Pool* pool);
+	/// `pool` may be null.  Throws if two sources have the same name or a file can't be read or
+	// written.
+};
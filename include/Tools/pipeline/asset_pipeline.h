@@ -0,0 +1,80 @@
+#pragma once
+
+#include "Engine/texture/texture_file.h"
+#include "Tools/mesh/mesh_optimizer.h"
+#include "Tools/mesh/mesh_simplifier.h"
+#include "Tools/mesh/mesh_writer.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using std::vector;
+
+namespace ThreadPool {
+	class Pool;
+};
+
+// --- AssetPipeline ---
+// Cooks one source asset into its runtime format with the same steps as the asset and texture
+// cookers, for drivers that process whole projects.  Per asset settings come from an optional
+// `<source>.import` file next to the source, `key = value` lines on top of the driver's
+// defaults.
+// ---------------------
+
+namespace AssetPipeline {
+
+	static constexpr uint32_t VERSION = 1;
+	/// Bump whenever cooking gives different output for the same source and settings, so every
+	// cached result is rebuilt.  File format versions are keyed separately.
+
+	enum class AssetType {
+		NONE,
+		MESH,
+		TEXTURE
+	};
+
+	struct Settings {
+		// Meshes.
+		MeshWriter::Layout layout = MeshWriter::Layout::INTERLEAVED;
+		MeshWriter::Encoding encoding = MeshWriter::Encoding::FLOAT;
+		bool optimize = true;
+		uint32_t cache_size = MeshOptimizer::DEFAULT_CACHE_SIZE;
+		uint32_t lod_count = 1;
+		float lod_ratio = MeshSimplifier::DEFAULT_LOD_RATIO;
+		float lod_max_error = MeshSimplifier::DEFAULT_MAX_ERROR;
+		bool meshlets = false;
+
+		// Textures.
+		std::string texture_format = "bc7";
+		/// bc1, bc3, bc5, bc7 or rgba8.
+		bool linear = false;
+		bool mips = true;
+
+		void set(const std::string& key, const std::string& value);
+		/// The keys are the member names.  Throws for unknown keys or values.
+
+		std::string get_key(AssetType type) const;
+		/// Every setting that affects cooking `type`, in a fixed order.
+
+		TextureFormat get_texture_format() const;
+	};
+
+	AssetType get_asset_type(const std::string& path);
+	/// From the extension.
+
+	const char* get_cooked_extension(AssetType type);
+
+	uint32_t get_format_version(AssetType type);
+	/// The version of the cooked file format.
+
+	Settings load_settings(const std::string& source_path, const Settings& defaults);
+	/// `defaults` with the source's `.import` file applied, if it has one.  Throws if it's invalid.
+
+	vector<std::string> get_dependencies(const std::string& source_path, AssetType type);
+	/// Other files cooking the source reads.  For meshes, the files next to it with the same stem
+	// (a glTF's buffers, an OBJ's materials).
+
+	vector<std::byte> cook(const std::string& source_path, AssetType type, const Settings& settings, ThreadPool::Pool* pool);
+	/// Throws if the source can't be imported.
+};
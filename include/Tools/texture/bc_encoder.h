@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+
+// --- BcEncoder ---
+// Encodes single 4x4 blocks of 8 bit RGBA texels (row major, 64 bytes) into the BCn formats.
+// Endpoints start at the extremes along the block's principal axis and are refined with a
+// least squares fit to the chosen indices.
+//
+// BC7 only uses mode 6 (one subset, RGBA endpoints with 7 bits and a p-bit, 4 bit indices):
+// much faster than searching all eight modes, at some quality cost on blocks with several
+// distinct colors.
+// -----------------
+
+namespace BcEncoder {
+
+	void encode_bc1(const uint8_t* texels, uint8_t* block);
+	/// 8 bytes.  Texels with alpha under 128 are encoded transparent.
+
+	void encode_bc3(const uint8_t* texels, uint8_t* block);
+	/// 16 bytes.
+
+	void encode_bc4(const uint8_t* texels, uint32_t channel, uint8_t* block);
+	/// 8 bytes, one channel of the texels.
+
+	void encode_bc5(const uint8_t* texels, uint8_t* block);
+	/// 16 bytes, the red and green channels.
+
+	void encode_bc7(const uint8_t* texels, uint8_t* block);
+	/// 16 bytes.
+};
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+using std::vector;
+
+// --- ImageData ---
+// An image as the offline texture tools work on it: linear float RGBA, so filtering averages
+// light rather than gamma encoded values.  Colors are converted from sRGB once on import and
+// back when the texels are encoded.
+// -----------------
+
+struct ImageData {
+	uint32_t width = 0;
+	uint32_t height = 0;
+
+	vector<glm::vec4> pixels;
+	/// Row major, `width * height` long.
+
+	const glm::vec4& get_pixel(uint32_t x, uint32_t y) const {
+		return this->pixels[static_cast<size_t>(y) * this->width + x];
+	}
+
+	static float decode_srgb(float value) {
+		return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+	}
+
+	static float encode_srgb(float value) {
+		return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+	}
+};
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "Tools/texture/image_data.h"
+#include <cstdint>
+#include <vector>
+
+using std::vector;
+
+namespace ThreadPool {
+	class Pool;
+};
+
+// --- MipGenerator ---
+// Builds mip chains with a 2x2 box filter over linear float pixels, 4 channels per SSE register
+// or two pixels per AVX one.  Rows are filtered in parallel on the thread pool.  Odd sizes drop
+// to the next size down and repeat their last row or column.
+// --------------------
+
+namespace MipGenerator {
+
+	static constexpr uint32_t ALL_MIPS = 0;
+
+	vector<ImageData> build_mip_chain(ImageData base, uint32_t max_mip_count, ThreadPool::Pool* pool);
+	/// Returns `base` followed by its mips down to 1x1, or to `max_mip_count` levels.  `pool` may
+	// be null.
+
+	ImageData downsample(const ImageData& image, ThreadPool::Pool* pool);
+	/// Half the size, rounded down, at least 1x1.
+};
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "Tools/texture/image_data.h"
+#include <string>
+
+// --- TextureImporter ---
+// Decodes source images (PNG, JPEG, TGA, BMP, PSD...) with stb_image.
+// -----------------------
+
+namespace TextureImporter {
+
+	ImageData import(const std::string& path, bool srgb);
+	/// Always four channels, missing alpha is opaque.  `srgb` images have their color channels
+	// converted to linear, data images (normal maps, masks) are kept as they are.  Throws if the
+	// file can't be decoded.
+};
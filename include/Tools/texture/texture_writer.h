@@ -0,0 +1,29 @@
+#pragma once
+
+#include "Engine/texture/texture_file.h"
+#include "Tools/texture/image_data.h"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+using std::vector;
+
+namespace ThreadPool {
+	class Pool;
+};
+
+// --- TextureWriter ---
+// Encodes mip chains into a cooked texture file (`Engine/texture/texture_file.h`).  Block rows
+// are encoded in parallel on the thread pool, each block is independent.
+// ---------------------
+
+namespace TextureWriter {
+
+	vector<std::byte> serialize(const vector<vector<ImageData>>& layers, TextureFormat format, ThreadPool::Pool* pool);
+	/// `layers[layer][mip]`, every layer with the same size and mip count.  Pixels are linear,
+	// the sRGB formats encode their color channels on the way out.  `pool` may be null.  Throws
+	// if the layers don't match.
+
+	void save(const vector<vector<ImageData>>& layers, TextureFormat format, ThreadPool::Pool* pool, const std::string& path);
+	/// Throws if the file can't be written.
+};
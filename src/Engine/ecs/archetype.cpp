@@ -0,0 +1,103 @@
+#include "Engine/ecs/archetype.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+static constexpr size_t COLUMN_ALIGNMENT = 64;
+/// Columns start on their own cache line.
+
+Archetype::Archetype(const ComponentMask& mask)
+	: mask(mask),
+	column_indices(MAX_COMPONENT_TYPES, -1),
+	add_edges(MAX_COMPONENT_TYPES, nullptr),
+	remove_edges(MAX_COMPONENT_TYPES, nullptr) {
+
+	size_t rowSize = sizeof(NodeHandle);
+	for (size_t id = 0; id < MAX_COMPONENT_TYPES; id++) {
+		if (mask.test(id)) {
+			const ComponentInfo& info = Components::get_info(static_cast<ComponentId>(id));
+			this->column_indices[id] = static_cast<int16_t>(this->columns.size());
+			this->columns.push_back(Column{ static_cast<ComponentId>(id), 0, static_cast<uint32_t>(info.size) });
+			rowSize += info.size;
+		}
+	}
+
+	// Leave room for every column's alignment padding, then lay the columns out after the node handles.
+	size_t paddingSize = 0;
+	for (const Column& column : this->columns) {
+		paddingSize += std::max(COLUMN_ALIGNMENT, Components::get_info(column.id).alignment);
+	}
+
+	if (paddingSize + rowSize > Chunk::SIZE) {
+		throw std::length_error("An archetype's components don't fit in a " + std::to_string(Chunk::SIZE) + " byte chunk.");
+	}
+
+	this->chunk_capacity = static_cast<uint32_t>((Chunk::SIZE - paddingSize) / rowSize);
+
+	size_t offset = sizeof(NodeHandle) * this->chunk_capacity;
+	for (Column& column : this->columns) {
+		size_t alignment = std::max(COLUMN_ALIGNMENT, Components::get_info(column.id).alignment);
+		offset = (offset + alignment - 1) / alignment * alignment;
+		column.offset = static_cast<uint32_t>(offset);
+		offset += static_cast<size_t>(column.size) * this->chunk_capacity;
+	}
+}
+
+Archetype::~Archetype() {
+	for (auto& chunk : this->chunks) {
+		for (uint32_t row = 0; row < chunk->count; row++) {
+			for (const Column& column : this->columns) {
+				Components::destroy(column.id, chunk->data + column.offset + static_cast<size_t>(row) * column.size);
+			}
+		}
+	}
+}
+
+Archetype::Row Archetype::allocate_row(NodeHandle node) {
+	if (this->chunks.empty() || this->chunks.back()->count == this->chunk_capacity) {
+		this->chunks.push_back(std::make_unique<Chunk>());
+		this->chunks.back()->column_versions.assign(this->columns.size(), 0);
+	}
+
+	Chunk& chunk = *this->chunks.back();
+	Row row{ static_cast<uint32_t>(this->chunks.size() - 1), chunk.count };
+
+	this->get_nodes(chunk)[row.row] = node;
+	chunk.count++;
+	this->node_count++;
+
+	return row;
+}
+
+NodeHandle Archetype::remove_row(Row row) {
+	Chunk& chunk = *this->chunks[row.chunk];
+	Chunk& lastChunk = *this->chunks.back();
+	uint32_t lastRow = lastChunk.count - 1;
+
+	for (const Column& column : this->columns) {
+		Components::destroy(column.id, chunk.data + column.offset + static_cast<size_t>(row.row) * column.size);
+	}
+
+	NodeHandle movedNode;
+
+	// Keep the chunks dense by moving the very last row into the hole.
+	if (&chunk != &lastChunk || row.row != lastRow) {
+		for (const Column& column : this->columns) {
+			void* source = lastChunk.data + column.offset + static_cast<size_t>(lastRow) * column.size;
+			Components::move_construct(column.id, chunk.data + column.offset + static_cast<size_t>(row.row) * column.size, source);
+			Components::destroy(column.id, source);
+		}
+
+		movedNode = this->get_nodes(lastChunk)[lastRow];
+		this->get_nodes(chunk)[row.row] = movedNode;
+	}
+
+	lastChunk.count--;
+	this->node_count--;
+
+	if (lastChunk.count == 0) {
+		this->chunks.pop_back();
+	}
+
+	return movedNode;
+}
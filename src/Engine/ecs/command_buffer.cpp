@@ -0,0 +1,134 @@
+#include "Engine/ecs/command_buffer.h"
+#include "Engine/scene/scene.h"
+#include <algorithm>
+
+// === CommandBuffer ===
+
+CommandBuffer::~CommandBuffer() {
+	this->clear();
+}
+
+void CommandBuffer::play_back(Scene& scene) {
+	ComponentStore& components = scene.get_components();
+
+	// Indexed because a command could be recorded while playing back (from a listener).
+	for (size_t i = 0; i < this->commands.size(); i++) {
+		Command command = this->commands[i];
+
+		if (!scene.contains(command.node)) {
+			if (command.discard != nullptr) {
+				command.discard(command.payload);
+			}
+			continue;
+		}
+
+		try {
+			command.apply(&scene, components, command);
+		}
+		catch (...) {
+			// The applied commands' payloads are gone, only the failed command and the ones after
+			// it still own theirs.  They're dropped too, so nothing is applied twice.
+			this->commands.erase(this->commands.begin(), this->commands.begin() + i);
+			this->clear();
+			throw;
+		}
+	}
+
+	this->commands.clear();
+	this->block_index = 0;
+	this->block_used = 0;
+	this->large_payloads.clear();
+}
+
+void CommandBuffer::clear() {
+	for (const Command& command : this->commands) {
+		if (command.discard != nullptr) {
+			command.discard(command.payload);
+		}
+	}
+
+	this->commands.clear();
+	this->block_index = 0;
+	this->block_used = 0;
+	this->large_payloads.clear();
+}
+
+void* CommandBuffer::allocate_payload(size_t size, size_t alignment) {
+	if (size > BLOCK_SIZE) {
+		this->large_payloads.push_back(std::make_unique<std::byte[]>(size));
+		return this->large_payloads.back().get();
+	}
+
+	size_t offset = (this->block_used + alignment - 1) / alignment * alignment;
+
+	if (this->blocks.empty() || offset + size > BLOCK_SIZE) {
+		// Move on to the next block, reusing the ones from earlier frames.
+		if (!this->blocks.empty()) {
+			this->block_index++;
+		}
+		if (this->block_index == this->blocks.size()) {
+			this->blocks.push_back(std::make_unique<std::byte[]>(BLOCK_SIZE));
+		}
+		offset = 0;
+	}
+
+	this->block_used = offset + size;
+	return this->blocks[this->block_index].get() + offset;
+}
+
+void CommandBuffer::destroy_node(NodeHandle node) {
+	this->commands.push_back(Command{
+		[](Scene* scene, ComponentStore&, const Command& command) {
+			scene->destroy_node(command.node);
+		},
+		nullptr,
+		node,
+		NodeHandle(),
+		nullptr
+	});
+}
+
+void CommandBuffer::set_parent(NodeHandle node, NodeHandle parent) {
+	this->commands.push_back(Command{
+		[](Scene* scene, ComponentStore&, const Command& command) {
+			// The new parent may have been destroyed after this was recorded.
+			if (command.other.is_null() || scene->contains(command.other)) {
+				scene->set_parent(command.node, command.other);
+			}
+		},
+		nullptr,
+		node,
+		parent,
+		nullptr
+	});
+}
+
+size_t CommandBuffer::size() const {
+	return this->commands.size();
+}
+
+// === CommandBuffers ===
+
+void CommandBuffers::play_back(Scene& scene, ThreadPool::Pool* pool) {
+	for (auto& buffer : this->worker_buffers) {
+		buffer->play_back(scene);
+	}
+	this->shared_buffer.play_back(scene);
+
+	// Nothing records during playback, so the buffers can be resized for the next frame here.
+	size_t workerCount = pool != nullptr ? pool->thread_count : 0;
+	this->pool = pool;
+
+	while (this->worker_buffers.size() < workerCount) {
+		this->worker_buffers.push_back(std::make_unique<CommandBuffer>());
+	}
+	this->worker_buffers.resize(workerCount);
+}
+
+void CommandBuffers::destroy_node(NodeHandle node) {
+	this->record([&](CommandBuffer& buffer) { buffer.destroy_node(node); });
+}
+
+void CommandBuffers::set_parent(NodeHandle node, NodeHandle parent) {
+	this->record([&](CommandBuffer& buffer) { buffer.set_parent(node, parent); });
+}
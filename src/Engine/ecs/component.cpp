@@ -0,0 +1,48 @@
+#include "Engine/ecs/component.h"
+#include <array>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+namespace Components {
+
+	namespace {
+		// A fixed array so registering a new type never moves the infos other threads are reading.
+		std::array<ComponentInfo, MAX_COMPONENT_TYPES> componentInfos;
+		size_t componentCount = 0;
+		std::mutex registrationMutex;
+	}
+
+	ComponentId register_component(const ComponentInfo& info) {
+		std::lock_guard<std::mutex> lock(registrationMutex);
+
+		if (componentCount >= MAX_COMPONENT_TYPES) {
+			throw std::length_error(std::string("Too many component types, can't register ") + info.name);
+		}
+
+		// Scene files find their components by name, two types can't share one.
+		for (size_t id = 0; id < componentCount; id++) {
+			if (std::string_view(info.name) == componentInfos[id].name) {
+				throw std::invalid_argument(std::string("Another component type is already named ") + info.name);
+			}
+		}
+
+		componentInfos[componentCount] = info;
+		return static_cast<ComponentId>(componentCount++);
+	}
+
+	const ComponentInfo& get_info(ComponentId id) {
+		return componentInfos[id];
+	}
+
+	std::optional<ComponentId> find_id(std::string_view name) {
+		std::lock_guard<std::mutex> lock(registrationMutex);
+
+		for (size_t id = 0; id < componentCount; id++) {
+			if (name == componentInfos[id].name) {
+				return static_cast<ComponentId>(id);
+			}
+		}
+		return std::nullopt;
+	}
+};
@@ -0,0 +1,294 @@
+#include "Engine/ecs/component_store.h"
+#include <cstring>
+#include <string>
+
+// CODE FORMATTING INFORMATION:
+// Simple functions like getters and setters go at the bottom.
+// Organize from most complex at the top to least complex at the bottom.
+
+static constexpr ComponentId NO_COMPONENT = static_cast<ComponentId>(MAX_COMPONENT_TYPES);
+
+// === Moving Nodes Between Archetypes ===
+
+ComponentStore::Location& ComponentStore::move_node(NodeHandle node, Location* location, Archetype* target, ComponentId added_id) {
+	Archetype::Row newRow = target->allocate_row(node);
+
+	if (location != nullptr) {
+		Archetype* source = location->archetype;
+		Chunk& sourceChunk = *source->chunks[location->row.chunk];
+		Chunk& targetChunk = *target->chunks[newRow.chunk];
+
+		for (const Archetype::Column& column : target->columns) {
+			if (column.id == added_id) {
+				continue;
+			}
+
+			Components::move_construct(
+				column.id,
+				target->get_component(targetChunk, column.id, newRow.row),
+				source->get_component(sourceChunk, column.id, location->row.row)
+			);
+		}
+
+		// Destroys what was moved out and whatever component was removed.
+		this->remove_row(*location);
+	}
+	else {
+		if (node.index >= this->locations.size()) {
+			this->locations.resize(static_cast<size_t>(node.index) + 1, Location{ nullptr, Archetype::Row{ 0, 0 } });
+		}
+
+		// A destroyed node that never had its components removed still owns this slot's row.
+		Location& staleLocation = this->locations[node.index];
+		if (staleLocation.archetype != nullptr) {
+			this->remove_row(staleLocation);
+			this->node_count--;
+		}
+
+		this->node_count++;
+	}
+
+	target->mark_chunk_changed(*target->chunks[newRow.chunk], this->advance_change_version());
+
+	Location& newLocation = this->locations[node.index];
+	newLocation = Location{ target, newRow };
+	return newLocation;
+}
+
+void ComponentStore::add_components(std::span<const NodeHandle> nodes, std::span<const ComponentId> ids, std::span<const std::byte* const> columns) {
+	if (ids.size() != columns.size()) {
+		throw std::invalid_argument("Every added component needs exactly one column.");
+	}
+
+	ComponentMask mask;
+	for (ComponentId id : ids) {
+		if (!Components::get_info(id).trivially_relocatable) {
+			throw std::invalid_argument(std::string("Only trivially copyable components can be added from raw columns, ") + Components::get_info(id).name + " isn't.");
+		}
+		mask.set(id);
+	}
+
+	if (nodes.empty() || mask.none()) {
+		return;
+	}
+
+	Archetype* archetype = this->find_or_create_archetype(mask);
+	const uint64_t version = this->advance_change_version();
+
+	// Rows are allocated one by one but copied a run of consecutive rows in one chunk at a time.
+	auto copyRun = [&](size_t begin, size_t end, Archetype::Row row) {
+		Chunk& chunk = *archetype->chunks[row.chunk];
+		for (size_t c = 0; c < ids.size(); c++) {
+			const size_t size = Components::get_info(ids[c]).size;
+			std::memcpy(archetype->get_component(chunk, ids[c], row.row), columns[c] + begin * size, (end - begin) * size);
+		}
+		archetype->mark_chunk_changed(chunk, version);
+	};
+
+	// Checked before anything changes, a stale handle must never take a live node's row.
+	for (NodeHandle node : nodes) {
+		if (this->find_location(node) != nullptr) {
+			throw std::logic_error("Components can only be added from raw columns to nodes without components.");
+		}
+
+		if (node.index < this->locations.size() && this->locations[node.index].archetype != nullptr) {
+			const Location& location = this->locations[node.index];
+			const NodeHandle owner = location.archetype->get_nodes(*location.archetype->chunks[location.row.chunk])[location.row.row];
+			if (owner.generation > node.generation) {
+				throw std::invalid_argument("Components can't be added to node " + std::to_string(node.index) + ", it was destroyed.");
+			}
+		}
+	}
+
+	// Clear out stale rows first, removing a row moves another one and would break up the runs.
+	for (NodeHandle node : nodes) {
+		if (node.index >= this->locations.size()) {
+			this->locations.resize(static_cast<size_t>(node.index) + 1, Location{ nullptr, Archetype::Row{ 0, 0 } });
+		}
+
+		// A destroyed node that never had its components removed still owns this slot's row.
+		Location& location = this->locations[node.index];
+		if (location.archetype != nullptr) {
+			this->remove_row(location);
+			this->node_count--;
+		}
+	}
+
+	size_t runBegin = 0;
+	Archetype::Row runRow{ 0, 0 };
+
+	for (size_t i = 0; i < nodes.size(); i++) {
+		const NodeHandle node = nodes[i];
+		Archetype::Row row = archetype->allocate_row(node);
+		this->locations[node.index] = Location{ archetype, row };
+		this->node_count++;
+
+		if (i == runBegin) {
+			runRow = row;
+		}
+		else if (row.chunk != runRow.chunk) {
+			copyRun(runBegin, i, runRow);
+			runBegin = i;
+			runRow = row;
+		}
+	}
+
+	copyRun(runBegin, nodes.size(), runRow);
+}
+
+void ComponentStore::remove_row(Location& location) {
+	NodeHandle movedNode = location.archetype->remove_row(location.row);
+
+	if (!movedNode.is_null()) {
+		this->locations[movedNode.index].row = location.row;
+		location.archetype->mark_chunk_changed(*location.archetype->chunks[location.row.chunk], this->advance_change_version());
+	}
+
+	location.archetype = nullptr;
+}
+
+void ComponentStore::remove_component(NodeHandle node, ComponentId id) {
+	Location* location = this->find_location(node);
+
+	if (location == nullptr || !location->archetype->has_component(id)) {
+		return;
+	}
+
+	Archetype* source = location->archetype;
+	Archetype* target = source->remove_edges[id];
+
+	if (target == nullptr) {
+		ComponentMask mask = source->mask;
+		mask.reset(id);
+
+		// Removing the last component leaves the node out of every archetype.
+		if (mask.none()) {
+			this->remove_row(*location);
+			this->node_count--;
+			return;
+		}
+
+		target = this->find_or_create_archetype(mask);
+		source->remove_edges[id] = target;
+		target->add_edges[id] = source;
+	}
+
+	this->move_node(node, location, target, NO_COMPONENT);
+}
+
+void ComponentStore::remove_node(NodeHandle node) {
+	Location* location = this->find_location(node);
+
+	if (location != nullptr) {
+		this->remove_row(*location);
+		this->node_count--;
+	}
+}
+
+Archetype* ComponentStore::get_add_target(Location* location, ComponentId id) {
+	if (location == nullptr) {
+		ComponentMask mask;
+		mask.set(id);
+		return this->find_or_create_archetype(mask);
+	}
+
+	Archetype* source = location->archetype;
+
+	if (source->add_edges[id] == nullptr) {
+		ComponentMask mask = source->mask;
+		mask.set(id);
+
+		Archetype* target = this->find_or_create_archetype(mask);
+		source->add_edges[id] = target;
+		target->remove_edges[id] = source;
+	}
+
+	return source->add_edges[id];
+}
+
+Archetype* ComponentStore::find_or_create_archetype(const ComponentMask& mask) {
+	auto it = this->archetype_lookup.find(mask);
+	if (it != this->archetype_lookup.end()) {
+		return it->second;
+	}
+
+	this->archetypes.push_back(std::make_unique<Archetype>(mask));
+	Archetype* archetype = this->archetypes.back().get();
+	this->archetype_lookup.emplace(mask, archetype);
+	return archetype;
+}
+
+// === Queries ===
+
+void ComponentStore::update_query_cache(QueryCache& cache) {
+	std::lock_guard<std::mutex> lock(this->query_cache_mutex);
+	for (; cache.archetypes_checked < this->archetypes.size(); cache.archetypes_checked++) {
+		Archetype* archetype = this->archetypes[cache.archetypes_checked].get();
+
+		if ((archetype->mask & cache.included) == cache.included && (archetype->mask & cache.excluded).none()) {
+			cache.archetypes.push_back(archetype);
+		}
+	}
+}
+
+QueryCache* ComponentStore::get_query_cache(const ComponentMask& included, const ComponentMask& excluded) {
+	std::lock_guard<std::mutex> lock(this->query_cache_mutex);
+
+	// There are only ever a handful of distinct queries.
+	for (auto& cache : this->query_caches) {
+		if (cache->included == included && cache->excluded == excluded) {
+			return cache.get();
+		}
+	}
+
+	auto cache = std::make_unique<QueryCache>();
+	cache->included = included;
+	cache->excluded = excluded;
+	this->query_caches.push_back(std::move(cache));
+	return this->query_caches.back().get();
+}
+
+// === Getters ===
+
+ComponentStore::Location* ComponentStore::find_location(NodeHandle node) {
+	if (node.index >= this->locations.size()) {
+		return nullptr;
+	}
+
+	Location& location = this->locations[node.index];
+	if (location.archetype == nullptr) {
+		return nullptr;
+	}
+
+	// The slot may belong to an older node with the same index.
+	Chunk& chunk = *location.archetype->chunks[location.row.chunk];
+	if (location.archetype->get_nodes(chunk)[location.row.row] != node) {
+		return nullptr;
+	}
+
+	return &location;
+}
+
+bool ComponentStore::contains(NodeHandle node) {
+	return this->find_location(node) != nullptr;
+}
+
+uint64_t ComponentStore::get_change_version() const {
+	return this->change_version.load(std::memory_order_relaxed);
+}
+
+uint64_t ComponentStore::advance_change_version() {
+	return this->change_version.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+size_t ComponentStore::get_archetype_count() const {
+	return this->archetypes.size();
+}
+
+Archetype& ComponentStore::get_archetype(size_t index) {
+	return *this->archetypes[index];
+}
+
+size_t ComponentStore::size() const {
+	return this->node_count;
+}
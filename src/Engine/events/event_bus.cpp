@@ -0,0 +1,220 @@
+#include "Engine/events/event_bus.h"
+#include "Engine/thread_pool/thread_pool.h"
+#include <algorithm>
+
+EventBus::EventBus(size_t game_event_queue_capacity)
+	: game_event_queue(game_event_queue_capacity) {
+
+}
+
+// === Dispatching ===
+
+void EventBus::dispatch(ThreadPool::Pool* pool) {
+	// Drain the cross thread queue into this frame's batch.
+	Uint32 now = SDL_GetTicks();
+	std::optional<GameEvent> gameEvent;
+	while ((gameEvent = this->game_event_queue.try_pop()).has_value()) {
+		if (gameEvent->timestamp == 0) {
+			gameEvent->timestamp = now;
+		}
+		this->game_channel.batch.push_back(*gameEvent);
+	}
+
+	this->window_channel.dispatch(pool);
+	this->input_channel.dispatch(pool);
+	this->game_channel.dispatch(pool);
+}
+
+template<typename T>
+void EventBus::Channel<T>::dispatch(ThreadPool::Pool* pool) {
+	if (this->batch.empty()) {
+		return;
+	}
+
+	std::span<const T> events(this->batch);
+
+	if (pool != nullptr && this->parallel_subscribers.size() > 1) {
+		// One subscriber per job, each one already processes a whole batch.
+		pool->parallel_for(this->parallel_subscribers.size(), 1, [this, events](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++) {
+				this->parallel_subscribers[i].callback(events);
+			}
+		});
+	}
+	else {
+		for (const auto& subscriber : this->parallel_subscribers) {
+			subscriber.callback(events);
+		}
+	}
+
+	for (const auto& subscriber : this->serial_subscribers) {
+		subscriber.callback(events);
+	}
+}
+
+void EventBus::clear() {
+	this->input_channel.batch.clear();
+	this->window_channel.batch.clear();
+	this->game_channel.batch.clear();
+}
+
+// === Producing ===
+
+void EventBus::push_SDL_event(const SDL_Event& sdl_event) {
+	InputEvent inputEvent{};
+	inputEvent.timestamp = sdl_event.common.timestamp;
+
+	switch (sdl_event.type) {
+
+	case SDL_KEYDOWN:
+	case SDL_KEYUP:
+		inputEvent.type = sdl_event.type == SDL_KEYDOWN ? Events::InputType::KEY_DOWN : Events::InputType::KEY_UP;
+		inputEvent.keycode = sdl_event.key.keysym.sym;
+		inputEvent.scancode = sdl_event.key.keysym.scancode;
+		inputEvent.modifiers = sdl_event.key.keysym.mod;
+		inputEvent.repeat = sdl_event.key.repeat != 0;
+		this->push_input_event(inputEvent);
+		break;
+
+	case SDL_MOUSEMOTION:
+		inputEvent.type = Events::InputType::MOUSE_MOTION;
+		inputEvent.device = sdl_event.motion.which;
+		inputEvent.x = sdl_event.motion.x;
+		inputEvent.y = sdl_event.motion.y;
+		inputEvent.x_relative = sdl_event.motion.xrel;
+		inputEvent.y_relative = sdl_event.motion.yrel;
+		this->push_input_event(inputEvent);
+		break;
+
+	case SDL_MOUSEBUTTONDOWN:
+	case SDL_MOUSEBUTTONUP:
+		inputEvent.type = sdl_event.type == SDL_MOUSEBUTTONDOWN ? Events::InputType::MOUSE_BUTTON_DOWN : Events::InputType::MOUSE_BUTTON_UP;
+		inputEvent.device = sdl_event.button.which;
+		inputEvent.button = sdl_event.button.button;
+		inputEvent.x = sdl_event.button.x;
+		inputEvent.y = sdl_event.button.y;
+		this->push_input_event(inputEvent);
+		break;
+
+	case SDL_MOUSEWHEEL:
+		inputEvent.type = Events::InputType::MOUSE_WHEEL;
+		inputEvent.device = sdl_event.wheel.which;
+		inputEvent.value_x = sdl_event.wheel.preciseX;
+		inputEvent.value_y = sdl_event.wheel.preciseY;
+		this->push_input_event(inputEvent);
+		break;
+
+	case SDL_CONTROLLERBUTTONDOWN:
+	case SDL_CONTROLLERBUTTONUP:
+		inputEvent.type = sdl_event.type == SDL_CONTROLLERBUTTONDOWN ? Events::InputType::CONTROLLER_BUTTON_DOWN : Events::InputType::CONTROLLER_BUTTON_UP;
+		inputEvent.device = sdl_event.cbutton.which;
+		inputEvent.button = sdl_event.cbutton.button;
+		this->push_input_event(inputEvent);
+		break;
+
+	case SDL_CONTROLLERAXISMOTION:
+		inputEvent.type = Events::InputType::CONTROLLER_AXIS_MOTION;
+		inputEvent.device = sdl_event.caxis.which;
+		inputEvent.button = sdl_event.caxis.axis;
+		inputEvent.value_x = std::max(sdl_event.caxis.value / 32767.0f, -1.0f);
+		this->push_input_event(inputEvent);
+		break;
+
+	case SDL_QUIT:
+		this->push_window_event(WindowEvent{ Events::WindowType::QUIT, sdl_event.quit.timestamp, 0, 0 });
+		break;
+
+	case SDL_WINDOWEVENT: {
+		WindowEvent windowEvent{ Events::WindowType::SHOWN, sdl_event.window.timestamp, sdl_event.window.data1, sdl_event.window.data2 };
+
+		switch (sdl_event.window.event) {
+		case SDL_WINDOWEVENT_SHOWN: windowEvent.type = Events::WindowType::SHOWN; break;
+		case SDL_WINDOWEVENT_HIDDEN: windowEvent.type = Events::WindowType::HIDDEN; break;
+		case SDL_WINDOWEVENT_MOVED: windowEvent.type = Events::WindowType::MOVED; break;
+		case SDL_WINDOWEVENT_SIZE_CHANGED: windowEvent.type = Events::WindowType::RESIZED; break;
+		case SDL_WINDOWEVENT_MINIMIZED: windowEvent.type = Events::WindowType::MINIMIZED; break;
+		case SDL_WINDOWEVENT_MAXIMIZED: windowEvent.type = Events::WindowType::MAXIMIZED; break;
+		case SDL_WINDOWEVENT_RESTORED: windowEvent.type = Events::WindowType::RESTORED; break;
+		case SDL_WINDOWEVENT_FOCUS_GAINED: windowEvent.type = Events::WindowType::FOCUS_GAINED; break;
+		case SDL_WINDOWEVENT_FOCUS_LOST: windowEvent.type = Events::WindowType::FOCUS_LOST; break;
+		case SDL_WINDOWEVENT_CLOSE: windowEvent.type = Events::WindowType::CLOSE; break;
+		default:
+			// SDL_WINDOWEVENT_RESIZED is always followed by SIZE_CHANGED, the rest aren't forwarded.
+			return;
+		}
+
+		this->push_window_event(windowEvent);
+		break;
+	}
+
+	default:
+		break;
+	}
+}
+
+void EventBus::push_input_event(const InputEvent& event) {
+	this->input_channel.batch.push_back(event);
+}
+
+void EventBus::push_window_event(const WindowEvent& event) {
+	this->window_channel.batch.push_back(event);
+}
+
+bool EventBus::post_game_event(const GameEvent& event) {
+	return this->game_event_queue.try_push(event);
+}
+
+// === Subscribing ===
+
+int EventBus::subscribe_input(InputSubscriber subscriber, bool parallel) {
+	auto& subscribers = parallel ? this->input_channel.parallel_subscribers : this->input_channel.serial_subscribers;
+	subscribers.push_back({ this->next_subscription_id, std::move(subscriber) });
+	return this->next_subscription_id++;
+}
+
+int EventBus::subscribe_window(WindowSubscriber subscriber, bool parallel) {
+	auto& subscribers = parallel ? this->window_channel.parallel_subscribers : this->window_channel.serial_subscribers;
+	subscribers.push_back({ this->next_subscription_id, std::move(subscriber) });
+	return this->next_subscription_id++;
+}
+
+int EventBus::subscribe_game(GameSubscriber subscriber, bool parallel) {
+	auto& subscribers = parallel ? this->game_channel.parallel_subscribers : this->game_channel.serial_subscribers;
+	subscribers.push_back({ this->next_subscription_id, std::move(subscriber) });
+	return this->next_subscription_id++;
+}
+
+void EventBus::unsubscribe(int subscription_id) {
+	if (this->input_channel.unsubscribe(subscription_id)) return;
+	if (this->window_channel.unsubscribe(subscription_id)) return;
+	this->game_channel.unsubscribe(subscription_id);
+}
+
+template<typename T>
+bool EventBus::Channel<T>::unsubscribe(int subscription_id) {
+	auto matches = [subscription_id](const Subscriber& subscriber) { return subscriber.id == subscription_id; };
+
+	for (auto* subscribers : { &this->serial_subscribers, &this->parallel_subscribers }) {
+		auto it = std::find_if(subscribers->begin(), subscribers->end(), matches);
+		if (it != subscribers->end()) {
+			subscribers->erase(it);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// === Getters ===
+
+std::span<const InputEvent> EventBus::get_input_events() const {
+	return this->input_channel.batch;
+}
+
+std::span<const WindowEvent> EventBus::get_window_events() const {
+	return this->window_channel.batch;
+}
+
+std::span<const GameEvent> EventBus::get_game_events() const {
+	return this->game_channel.batch;
+}
@@ -0,0 +1,140 @@
+#include "Engine/events/event_recording.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+
+////////////////////
+// EVENT RECORDER //
+////////////////////
+
+EventRecorder::EventRecorder(const string& output_path, uint32_t fixed_update_ticks_per_second) {
+	namespace fs = std::filesystem;
+
+	fs::path path(output_path);
+	if (path.has_parent_path()) {
+		fs::create_directories(path.parent_path());
+	}
+
+	this->file = std::ofstream(output_path, std::ios::out | std::ios::binary | std::ios::trunc);
+
+	if (!this->file.is_open()) {
+		throw std::runtime_error("Failed to open event recording file: " + output_path);
+	}
+
+	EventRecordingHeader header;
+	header.fixed_update_ticks_per_second = fixed_update_ticks_per_second;
+	this->file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+EventRecorder::~EventRecorder() {
+	if (this->file.is_open())
+		this->file.close();
+}
+
+void EventRecorder::record_frame(
+	float delta_time,
+	float fixed_update_interpolation_alpha,
+	uint32_t fixed_update_ticks,
+	std::span<const InputEvent> input_events,
+	std::span<const WindowEvent> window_events
+) {
+	if (input_events.size() > UINT16_MAX || window_events.size() > UINT16_MAX) {
+		throw std::runtime_error("Too many events in one frame to record.");
+	}
+
+	RecordedFrameHeader frameHeader{
+		delta_time,
+		fixed_update_interpolation_alpha,
+		fixed_update_ticks,
+		static_cast<uint16_t>(input_events.size()),
+		static_cast<uint16_t>(window_events.size())
+	};
+
+	this->file.write(reinterpret_cast<const char*>(&frameHeader), sizeof(frameHeader));
+	this->file.write(reinterpret_cast<const char*>(input_events.data()), input_events.size_bytes());
+	this->file.write(reinterpret_cast<const char*>(window_events.data()), window_events.size_bytes());
+
+	if (!this->file) {
+		throw std::runtime_error("Failed to write to the event recording file.");
+	}
+
+	this->frame_count++;
+}
+
+uint64_t EventRecorder::get_frame_count() const {
+	return this->frame_count;
+}
+
+////////////////////
+// EVENT REPLAYER //
+////////////////////
+
+EventReplayer::EventReplayer(const string& input_path) {
+	std::ifstream file(input_path, std::ios::ate | std::ios::binary);
+
+	if (!file.is_open()) {
+		throw std::runtime_error("Failed to open event recording file: " + input_path);
+	}
+
+	size_t fileSize = static_cast<size_t>(file.tellg());
+	this->data.resize(fileSize);
+	file.seekg(0);
+	file.read(this->data.data(), fileSize);
+
+	if (fileSize < sizeof(EventRecordingHeader)) {
+		throw std::runtime_error("Event recording file is too small: " + input_path);
+	}
+
+	std::memcpy(&this->header, this->data.data(), sizeof(EventRecordingHeader));
+
+	if (this->header.magic != EventRecordingHeader::MAGIC || this->header.version != EventRecordingHeader::VERSION) {
+		throw std::runtime_error("Not a supported event recording file: " + input_path);
+	}
+
+	if (this->header.input_event_size != sizeof(InputEvent) || this->header.window_event_size != sizeof(WindowEvent)) {
+		throw std::runtime_error("Event recording was made by a build with a different event layout: " + input_path);
+	}
+
+	this->rewind();
+}
+
+bool EventReplayer::next_frame(RecordedFrame& frame) {
+	if (this->read_offset + sizeof(RecordedFrameHeader) > this->data.size()) {
+		return false;
+	}
+
+	std::memcpy(&frame.header, this->data.data() + this->read_offset, sizeof(RecordedFrameHeader));
+	this->read_offset += sizeof(RecordedFrameHeader);
+
+	size_t payloadSize = frame.header.input_event_count * sizeof(InputEvent)
+		+ frame.header.window_event_count * sizeof(WindowEvent);
+
+	if (this->read_offset + payloadSize > this->data.size()) {
+		// The recording was cut off mid frame, treat it as the end.
+		this->read_offset = this->data.size();
+		return false;
+	}
+
+	frame.input_events = this->read_array(this->input_events, frame.header.input_event_count);
+	frame.window_events = this->read_array(this->window_events, frame.header.window_event_count);
+
+	return true;
+}
+
+template<typename T>
+std::span<const T> EventReplayer::read_array(vector<T>& events, size_t count) {
+	events.resize(count);
+	std::memcpy(events.data(), this->data.data() + this->read_offset, count * sizeof(T));
+	this->read_offset += count * sizeof(T);
+
+	return events;
+}
+
+const EventRecordingHeader& EventReplayer::get_header() const {
+	return this->header;
+}
+
+void EventReplayer::rewind() {
+	this->read_offset = sizeof(EventRecordingHeader);
+}
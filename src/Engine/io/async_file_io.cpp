@@ -0,0 +1,592 @@
+#include "Engine/io/async_file_io.h"
+#include "Engine/thread_pool/thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif // _WIN32
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define HAS_IO_URING
+#include <cstring>
+#include <linux/io_uring.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+// CODE FORMATTING INFORMATION:
+// Simple functions like getters and setters go at the bottom.
+// Organize from most complex at the top to least complex at the bottom.
+
+static constexpr size_t MAX_READ_SIZE = 1ull << 30;
+/// Larger reads are split, the kernel caps a single read just under 2GB anyway.
+
+// === Ring ===
+
+#ifdef HAS_IO_URING
+
+static constexpr uint64_t WAKE_USER_DATA = std::numeric_limits<uint64_t>::max();
+/// Marks the completion of the read on the wake up eventfd, every other one is a slot index.
+
+// Called through `syscall` directly so there is no dependency on liburing.
+static int enter_ring(int ring_file, uint32_t submit_count, uint32_t wait_count) {
+	return static_cast<int>(syscall(__NR_io_uring_enter, ring_file, submit_count, wait_count, IORING_ENTER_GETEVENTS, nullptr, 0));
+}
+
+struct AsyncFileIo::Ring {
+
+	struct Slot {
+		Pending pending;
+		int file = -1;
+		size_t bytes_read = 0;
+	};
+
+	static std::unique_ptr<Ring> create(uint32_t entry_count) {
+		io_uring_params params{};
+		int ringFile = static_cast<int>(syscall(__NR_io_uring_setup, entry_count, &params));
+		if (ringFile < 0) {
+			return nullptr;
+		}
+
+		auto ring = std::make_unique<Ring>();
+		ring->ring_file = ringFile;
+
+		// IORING_OP_READ came in the same kernel (5.6) as this feature flag.
+		if ((params.features & IORING_FEAT_RW_CUR_POS) == 0) {
+			return nullptr;
+		}
+
+		ring->sq_mapping_size = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+		ring->cq_mapping_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+		const bool singleMapping = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+		if (singleMapping) {
+			ring->sq_mapping_size = std::max(ring->sq_mapping_size, ring->cq_mapping_size);
+			ring->cq_mapping_size = ring->sq_mapping_size;
+		}
+
+		void* sqMapping = mmap(nullptr, ring->sq_mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFile, IORING_OFF_SQ_RING);
+		if (sqMapping == MAP_FAILED) {
+			return nullptr;
+		}
+		ring->sq_mapping = static_cast<std::byte*>(sqMapping);
+
+		if (singleMapping) {
+			ring->cq_mapping = ring->sq_mapping;
+		}
+		else {
+			void* cqMapping = mmap(nullptr, ring->cq_mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFile, IORING_OFF_CQ_RING);
+			if (cqMapping == MAP_FAILED) {
+				return nullptr;
+			}
+			ring->cq_mapping = static_cast<std::byte*>(cqMapping);
+		}
+
+		ring->sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+		void* sqes = mmap(nullptr, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFile, IORING_OFF_SQES);
+		if (sqes == MAP_FAILED) {
+			return nullptr;
+		}
+		ring->sqes = static_cast<io_uring_sqe*>(sqes);
+
+		ring->wake_file = eventfd(0, EFD_CLOEXEC);
+		if (ring->wake_file < 0) {
+			return nullptr;
+		}
+
+		ring->sq_head = reinterpret_cast<uint32_t*>(ring->sq_mapping + params.sq_off.head);
+		ring->sq_tail = reinterpret_cast<uint32_t*>(ring->sq_mapping + params.sq_off.tail);
+		ring->sq_mask = *reinterpret_cast<uint32_t*>(ring->sq_mapping + params.sq_off.ring_mask);
+		ring->sq_array = reinterpret_cast<uint32_t*>(ring->sq_mapping + params.sq_off.array);
+		ring->cq_head = reinterpret_cast<uint32_t*>(ring->cq_mapping + params.cq_off.head);
+		ring->cq_tail = reinterpret_cast<uint32_t*>(ring->cq_mapping + params.cq_off.tail);
+		ring->cq_mask = *reinterpret_cast<uint32_t*>(ring->cq_mapping + params.cq_off.ring_mask);
+		ring->cqes = reinterpret_cast<io_uring_cqe*>(ring->cq_mapping + params.cq_off.cqes);
+		ring->local_tail = *ring->sq_tail;
+
+		return ring;
+	}
+
+	~Ring() {
+		if (this->sqes != nullptr) {
+			munmap(this->sqes, this->sqes_size);
+		}
+		if (this->cq_mapping != nullptr && this->cq_mapping != this->sq_mapping) {
+			munmap(this->cq_mapping, this->cq_mapping_size);
+		}
+		if (this->sq_mapping != nullptr) {
+			munmap(this->sq_mapping, this->sq_mapping_size);
+		}
+		if (this->wake_file >= 0) {
+			::close(this->wake_file);
+		}
+		if (this->ring_file >= 0) {
+			::close(this->ring_file);
+		}
+	}
+
+	io_uring_sqe& get_sqe() {
+		// Never more than the slots plus the wake up read are in flight, which fits the ring.
+		uint32_t index = this->local_tail & this->sq_mask;
+		this->local_tail++;
+
+		this->sq_array[index] = index;
+		std::memset(&this->sqes[index], 0, sizeof(io_uring_sqe));
+		return this->sqes[index];
+	}
+
+	void prepare_read(uint32_t slot_index) {
+		Slot& slot = this->slots[slot_index];
+		std::span<std::byte> destination = slot.pending.request.destination;
+
+		io_uring_sqe& sqe = this->get_sqe();
+		sqe.opcode = IORING_OP_READ;
+		sqe.fd = slot.file;
+		sqe.off = slot.pending.request.offset + slot.bytes_read;
+		sqe.addr = reinterpret_cast<uint64_t>(destination.data() + slot.bytes_read);
+		sqe.len = static_cast<uint32_t>(std::min(destination.size() - slot.bytes_read, MAX_READ_SIZE));
+		sqe.user_data = slot_index;
+	}
+
+	void prepare_wake_read() {
+		io_uring_sqe& sqe = this->get_sqe();
+		sqe.opcode = IORING_OP_READ;
+		sqe.fd = this->wake_file;
+		sqe.addr = reinterpret_cast<uint64_t>(&this->wake_value);
+		sqe.len = sizeof(this->wake_value);
+		sqe.user_data = WAKE_USER_DATA;
+		this->wake_armed = true;
+	}
+
+	uint32_t publish() {
+		// The kernel reads the entries once it sees the new tail, and its head tells which
+		// entries an earlier interrupted enter left unsubmitted.
+		std::atomic_ref<uint32_t>(*this->sq_tail).store(this->local_tail, std::memory_order_release);
+		return this->local_tail - std::atomic_ref<uint32_t>(*this->sq_head).load(std::memory_order_acquire);
+	}
+
+	void wake() {
+		uint64_t value = 1;
+		[[maybe_unused]] ssize_t written = ::write(this->wake_file, &value, sizeof(value));
+	}
+
+	int ring_file = -1;
+	int wake_file = -1;
+	uint64_t wake_value = 0;
+	bool wake_armed = false;
+
+	std::byte* sq_mapping = nullptr;
+	size_t sq_mapping_size = 0;
+	std::byte* cq_mapping = nullptr;
+	size_t cq_mapping_size = 0;
+	io_uring_sqe* sqes = nullptr;
+	size_t sqes_size = 0;
+
+	uint32_t* sq_head = nullptr;
+	uint32_t* sq_tail = nullptr;
+	uint32_t* sq_array = nullptr;
+	uint32_t sq_mask = 0;
+	uint32_t local_tail = 0;
+	/// The tail with the entries prepared since the last publish.
+
+	uint32_t* cq_head = nullptr;
+	uint32_t* cq_tail = nullptr;
+	uint32_t cq_mask = 0;
+	io_uring_cqe* cqes = nullptr;
+
+	vector<Slot> slots;
+	vector<uint32_t> free_slots;
+};
+
+void AsyncFileIo::run_ring() {
+	Ring& ring = *this->ring;
+	vector<Pending> issued;
+	vector<uint32_t> continued;
+	/// Slots whose read came back short and goes on from where it stopped.
+
+	while (true) {
+		{
+			std::lock_guard<std::mutex> lock(this->mutex);
+			if (this->stopping && this->in_flight_count == 0) {
+				break;
+			}
+
+			Pending pending;
+			while (issued.size() < ring.free_slots.size() && this->try_pop(pending)) {
+				issued.push_back(std::move(pending));
+			}
+			this->in_flight_count += issued.size();
+		}
+
+		// Files are opened here rather than through the ring, the reads need the descriptor.
+		size_t finishedCount = 0;
+		for (Pending& pending : issued) {
+			int file = ::open(pending.request.path.c_str(), O_RDONLY | O_CLOEXEC);
+			if (file < 0) {
+				Result result;
+				result.error = std::error_code(errno, std::generic_category());
+				this->deliver(pending.request, result);
+				finishedCount++;
+				continue;
+			}
+
+			uint32_t slotIndex = ring.free_slots.back();
+			ring.free_slots.pop_back();
+
+			Ring::Slot& slot = ring.slots[slotIndex];
+			slot.pending = std::move(pending);
+			slot.file = file;
+			slot.bytes_read = 0;
+			ring.prepare_read(slotIndex);
+		}
+		issued.clear();
+
+		for (uint32_t slotIndex : continued) {
+			ring.prepare_read(slotIndex);
+		}
+		continued.clear();
+
+		if (!ring.wake_armed) {
+			ring.prepare_wake_read();
+		}
+
+		// One system call submits the whole batch and sleeps until something completes.  The
+		// wake up read is always pending, so new requests and stopping end the wait too.
+		int entered = enter_ring(ring.ring_file, ring.publish(), 1);
+		if (entered < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+			throw std::system_error(errno, std::generic_category(), "io_uring_enter failed");
+		}
+
+		uint32_t head = std::atomic_ref<uint32_t>(*ring.cq_head).load(std::memory_order_relaxed);
+		const uint32_t tail = std::atomic_ref<uint32_t>(*ring.cq_tail).load(std::memory_order_acquire);
+		for (; head != tail; head++) {
+			const io_uring_cqe& cqe = ring.cqes[head & ring.cq_mask];
+			if (cqe.user_data == WAKE_USER_DATA) {
+				ring.wake_armed = false;
+				continue;
+			}
+
+			const uint32_t slotIndex = static_cast<uint32_t>(cqe.user_data);
+			Ring::Slot& slot = ring.slots[slotIndex];
+			const size_t size = slot.pending.request.destination.size();
+
+			if (cqe.res == -EAGAIN || cqe.res == -EINTR) {
+				continued.push_back(slotIndex);
+				continue;
+			}
+			if (cqe.res > 0) {
+				slot.bytes_read += static_cast<size_t>(cqe.res);
+				if (slot.bytes_read < size) {
+					continued.push_back(slotIndex);
+					continue;
+				}
+			}
+
+			Result result;
+			result.bytes_read = slot.bytes_read;
+			if (cqe.res < 0) {
+				result.error = std::error_code(-cqe.res, std::generic_category());
+			}
+
+			::close(slot.file);
+			slot.file = -1;
+			this->deliver(slot.pending.request, result);
+			slot.pending = Pending();
+			ring.free_slots.push_back(slotIndex);
+			finishedCount++;
+		}
+		std::atomic_ref<uint32_t>(*ring.cq_head).store(head, std::memory_order_release);
+
+		if (finishedCount > 0) {
+			std::lock_guard<std::mutex> lock(this->mutex);
+			this->in_flight_count -= finishedCount;
+		}
+	}
+}
+
+#else
+
+struct AsyncFileIo::Ring {
+};
+
+void AsyncFileIo::run_ring() {
+}
+
+#endif // HAS_IO_URING
+
+// === Class Functions ===
+
+AsyncFileIo::AsyncFileIo(ThreadPool::Pool* pool, uint32_t queue_depth, bool allow_io_uring)
+	: pool(pool),
+	queue_depth(std::max(queue_depth, 1u))
+{
+	if (pool == nullptr) {
+		throw std::invalid_argument("Asynchronous file reads need a thread pool.");
+	}
+	this->queues.resize(pool->priority_count);
+
+#ifdef HAS_IO_URING
+	if (allow_io_uring) {
+		// One more entry for the wake up read.
+		this->ring = Ring::create(this->queue_depth + 1);
+	}
+
+	if (this->ring != nullptr) {
+		this->ring->slots.resize(this->queue_depth);
+		for (uint32_t i = this->queue_depth; i-- > 0;) {
+			this->ring->free_slots.push_back(i);
+		}
+
+		this->backend = Backend::IO_URING;
+		this->ring_thread = std::thread(&AsyncFileIo::run_ring, this);
+	}
+#endif // HAS_IO_URING
+}
+
+AsyncFileIo::~AsyncFileIo() {
+	std::unique_lock<std::mutex> lock(this->mutex);
+	this->stopping = true;
+
+	Pending pending;
+	while (this->try_pop(pending)) {
+		Result result;
+		result.cancelled = true;
+		this->deliver(pending.request, result);
+	}
+	lock.unlock();
+
+#ifdef HAS_IO_URING
+	if (this->ring_thread.joinable()) {
+		this->ring->wake();
+		this->ring_thread.join();
+	}
+#endif // HAS_IO_URING
+
+	this->wait();
+}
+
+// === Requests ===
+
+vector<AsyncFileIo::RequestId> AsyncFileIo::submit(vector<Request> requests) {
+	vector<RequestId> ids;
+	ids.reserve(requests.size());
+
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		if (this->stopping) {
+			throw std::logic_error("Reads can't be submitted while the file reader is being destroyed.");
+		}
+
+		for (Request& request : requests) {
+			request.priority = std::min(request.priority, this->queues.size() - 1);
+			const size_t priority = request.priority;
+
+			ids.push_back(this->next_id++);
+			this->queues[priority].push_back(Pending{ ids.back(), std::move(request) });
+		}
+		this->queued_count += requests.size();
+		this->unfinished_count += requests.size();
+	}
+
+	if (this->backend == Backend::IO_URING) {
+#ifdef HAS_IO_URING
+		this->ring->wake();
+#endif // HAS_IO_URING
+	}
+	else {
+		this->dispatch_to_pool();
+	}
+
+	return ids;
+}
+
+void AsyncFileIo::dispatch_to_pool() {
+	vector<Pending> started;
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		Pending pending;
+		while (this->in_flight_count < this->queue_depth && this->try_pop(pending)) {
+			started.push_back(std::move(pending));
+			this->in_flight_count++;
+		}
+	}
+
+	for (Pending& pending : started) {
+		const size_t priority = pending.request.priority;
+
+		auto job = [this, pending = std::move(pending)]() mutable {
+			Result result = read_file(pending.request);
+
+			// The slot is free as soon as the read is, the callback may take a while.
+			{
+				std::lock_guard<std::mutex> lock(this->mutex);
+				this->in_flight_count--;
+			}
+			this->dispatch_to_pool();
+
+			this->complete(pending.request, result);
+		};
+		this->pool->submit(std::move(job), priority);
+	}
+}
+
+AsyncFileIo::Result AsyncFileIo::read_file(const Request& request) {
+	Result result;
+	std::span<std::byte> destination = request.destination;
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(request.path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		result.error = std::error_code(static_cast<int>(GetLastError()), std::system_category());
+		return result;
+	}
+
+	while (result.bytes_read < destination.size()) {
+		const uint64_t offset = request.offset + result.bytes_read;
+		OVERLAPPED overlapped{};
+		overlapped.Offset = static_cast<DWORD>(offset);
+		overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+		DWORD readSize = 0;
+		const DWORD size = static_cast<DWORD>(std::min(destination.size() - result.bytes_read, MAX_READ_SIZE));
+		if (!ReadFile(file, destination.data() + result.bytes_read, size, &readSize, &overlapped)) {
+			if (GetLastError() != ERROR_HANDLE_EOF) {
+				result.error = std::error_code(static_cast<int>(GetLastError()), std::system_category());
+			}
+			break;
+		}
+		if (readSize == 0) {
+			break;
+		}
+		result.bytes_read += readSize;
+	}
+
+	CloseHandle(file);
+#else
+	int file = ::open(request.path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (file < 0) {
+		result.error = std::error_code(errno, std::generic_category());
+		return result;
+	}
+
+	while (result.bytes_read < destination.size()) {
+		const size_t size = std::min(destination.size() - result.bytes_read, MAX_READ_SIZE);
+		ssize_t readSize = ::pread(file, destination.data() + result.bytes_read, size, static_cast<off_t>(request.offset + result.bytes_read));
+		if (readSize < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			result.error = std::error_code(errno, std::generic_category());
+			break;
+		}
+		if (readSize == 0) {
+			break;
+		}
+		result.bytes_read += static_cast<size_t>(readSize);
+	}
+
+	::close(file);
+#endif // _WIN32
+
+	return result;
+}
+
+void AsyncFileIo::deliver(Request& request, const Result& result) {
+	const size_t priority = request.priority;
+	auto job = [this, request = std::move(request), result]() mutable {
+		this->complete(request, result);
+	};
+	this->pool->submit(std::move(job), priority);
+}
+
+void AsyncFileIo::complete(Request& request, const Result& result) {
+	try {
+		if (request.on_complete) {
+			request.on_complete(result);
+		}
+	}
+	catch (...) {
+	}
+
+	// Notifying under the lock keeps the waiting destructor from finishing before this returns.
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->unfinished_count--;
+	if (this->unfinished_count == 0) {
+		this->finished_condition.notify_all();
+	}
+}
+
+bool AsyncFileIo::cancel(RequestId id) {
+	std::lock_guard<std::mutex> lock(this->mutex);
+
+	for (std::deque<Pending>& queue : this->queues) {
+		auto it = std::find_if(queue.begin(), queue.end(), [id](const Pending& pending) {
+			return pending.id == id;
+		});
+		if (it == queue.end()) {
+			continue;
+		}
+
+		Pending pending = std::move(*it);
+		queue.erase(it);
+		this->queued_count--;
+
+		Result result;
+		result.cancelled = true;
+		this->deliver(pending.request, result);
+		return true;
+	}
+
+	return false;
+}
+
+bool AsyncFileIo::try_pop(Pending& pending) {
+	for (std::deque<Pending>& queue : this->queues) {
+		if (!queue.empty()) {
+			pending = std::move(queue.front());
+			queue.pop_front();
+			this->queued_count--;
+			return true;
+		}
+	}
+	return false;
+}
+
+void AsyncFileIo::wait() {
+	std::unique_lock<std::mutex> lock(this->mutex);
+	this->finished_condition.wait(lock, [this] {
+		return this->unfinished_count == 0;
+	});
+}
+
+AsyncFileIo::RequestId AsyncFileIo::submit(Request request) {
+	vector<Request> requests;
+	requests.push_back(std::move(request));
+	return this->submit(std::move(requests))[0];
+}
+
+// === Getters ===
+
+AsyncFileIo::Backend AsyncFileIo::get_backend() const {
+	return this->backend;
+}
+
+size_t AsyncFileIo::get_queued_count() const {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return this->queued_count;
+}
+
+size_t AsyncFileIo::get_in_flight_count() const {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return this->in_flight_count;
+}
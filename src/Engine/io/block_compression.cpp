@@ -0,0 +1,209 @@
+#include "Engine/io/block_compression.h"
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+// CODE FORMATTING INFORMATION:
+// Simple functions like getters and setters go at the bottom.
+// Organize from most complex at the top to least complex at the bottom.
+
+static constexpr size_t MIN_MATCH = 4;
+
+static constexpr size_t LAST_LITERALS = 5;
+/// The format requires a block to end with at least this many literals.
+
+static constexpr size_t MATCH_FIND_LIMIT = 12;
+/// And its last match to start at least this far from the end.
+
+static constexpr size_t MAX_OFFSET = 65535;
+
+static constexpr uint32_t HASH_BITS = 13;
+
+static constexpr uint32_t SKIP_TRIGGER = 6;
+/// Every 2^SKIP_TRIGGER bytes without a match the search steps one byte further, so
+// incompressible data is skipped through quickly.
+
+static uint32_t read_u32(const std::byte* bytes) {
+	uint32_t value;
+	std::memcpy(&value, bytes, sizeof(value));
+	return value;
+}
+
+static uint32_t hash_sequence(uint32_t sequence) {
+	return (sequence * 2654435761u) >> (32 - HASH_BITS);
+}
+
+static void throw_malformed() {
+	throw std::runtime_error("Malformed compressed block.");
+}
+
+static std::byte* write_length(std::byte* output, size_t length) {
+	// Lengths past the token's 15 continue in bytes of 255 and a final remainder.
+	for (; length >= 255; length -= 255) {
+		*output++ = std::byte{ 255 };
+	}
+	*output++ = static_cast<std::byte>(length);
+	return output;
+}
+
+static std::byte* write_sequence(std::byte* output, const std::byte* literals, size_t literal_count, size_t offset, size_t match_length) {
+	const size_t matchCode = match_length - MIN_MATCH;
+	std::byte* token = output++;
+	*token = static_cast<std::byte>(((literal_count >= 15 ? 15 : literal_count) << 4) | (matchCode >= 15 ? 15 : matchCode));
+
+	if (literal_count >= 15) {
+		output = write_length(output, literal_count - 15);
+	}
+	std::memcpy(output, literals, literal_count);
+	output += literal_count;
+
+	output[0] = static_cast<std::byte>(offset & 0xFF);
+	output[1] = static_cast<std::byte>(offset >> 8);
+	output += 2;
+
+	if (matchCode >= 15) {
+		output = write_length(output, matchCode - 15);
+	}
+	return output;
+}
+
+// === Compression ===
+
+size_t BlockCompression::compress(std::span<const std::byte> source, std::span<std::byte> destination) {
+	if (source.size() > MAX_BLOCK_SIZE || destination.size() < get_max_compressed_size(source.size())) {
+		throw std::invalid_argument("Blocks are at most 64 KB and need room for their worst case.");
+	}
+
+	const std::byte* input = source.data();
+	const size_t size = source.size();
+	std::byte* output = destination.data();
+
+	size_t anchor = 0;
+	if (size > MATCH_FIND_LIMIT) {
+		// Positions fit in 16 bits since blocks are at most 64 KB.  Stale or empty slots are
+		// caught by comparing the bytes.
+		uint16_t table[1u << HASH_BITS] = {};
+
+		const size_t matchFindEnd = size - MATCH_FIND_LIMIT;
+		const size_t matchEnd = size - LAST_LITERALS;
+		size_t position = 1;
+		table[hash_sequence(read_u32(input))] = 0;
+
+		while (position <= matchFindEnd) {
+			const uint32_t sequence = read_u32(input + position);
+			const uint32_t hash = hash_sequence(sequence);
+			size_t candidate = table[hash];
+			table[hash] = static_cast<uint16_t>(position);
+
+			if (candidate >= position || position - candidate > MAX_OFFSET || read_u32(input + candidate) != sequence) {
+				position += 1 + ((position - anchor) >> SKIP_TRIGGER);
+				continue;
+			}
+
+			// Grow the match backwards into the pending literals, then forwards.
+			while (position > anchor && candidate > 0 && input[position - 1] == input[candidate - 1]) {
+				position--;
+				candidate--;
+			}
+			size_t matchLength = MIN_MATCH;
+			while (position + matchLength < matchEnd && input[position + matchLength] == input[candidate + matchLength]) {
+				matchLength++;
+			}
+
+			output = write_sequence(output, input + anchor, position - anchor, position - candidate, matchLength);
+			position += matchLength;
+			anchor = position;
+
+			if (position <= matchFindEnd) {
+				table[hash_sequence(read_u32(input + position - 2))] = static_cast<uint16_t>(position - 2);
+			}
+		}
+	}
+
+	// The last sequence is literals only.
+	const size_t literalCount = size - anchor;
+	*output++ = static_cast<std::byte>((literalCount >= 15 ? 15 : literalCount) << 4);
+	if (literalCount >= 15) {
+		output = write_length(output, literalCount - 15);
+	}
+	if (literalCount > 0) {
+		std::memcpy(output, input + anchor, literalCount);
+		output += literalCount;
+	}
+
+	return static_cast<size_t>(output - destination.data());
+}
+
+void BlockCompression::decompress(std::span<const std::byte> source, std::span<std::byte> destination) {
+	const std::byte* input = source.data();
+	const std::byte* inputEnd = input + source.size();
+	std::byte* output = destination.data();
+	std::byte* const outputStart = output;
+	std::byte* const outputEnd = output + destination.size();
+
+	auto readLength = [&input, inputEnd](size_t length) {
+		if (length != 15) {
+			return length;
+		}
+		std::byte next;
+		do {
+			if (input == inputEnd) {
+				throw_malformed();
+			}
+			next = *input++;
+			length += static_cast<size_t>(next);
+		} while (next == std::byte{ 255 });
+		return length;
+	};
+
+	while (true) {
+		if (input == inputEnd) {
+			throw_malformed();
+		}
+		const uint32_t token = static_cast<uint32_t>(*input++);
+
+		const size_t literalCount = readLength(token >> 4);
+		if (literalCount > static_cast<size_t>(inputEnd - input) || literalCount > static_cast<size_t>(outputEnd - output)) {
+			throw_malformed();
+		}
+		if (literalCount > 0) {
+			std::memcpy(output, input, literalCount);
+			input += literalCount;
+			output += literalCount;
+		}
+
+		if (input == inputEnd) {
+			break;
+		}
+
+		if (inputEnd - input < 2) {
+			throw_malformed();
+		}
+		const size_t offset = static_cast<size_t>(input[0]) | (static_cast<size_t>(input[1]) << 8);
+		input += 2;
+		if (offset == 0 || offset > static_cast<size_t>(output - outputStart)) {
+			throw_malformed();
+		}
+
+		const size_t matchLength = readLength(token & 15) + MIN_MATCH;
+		if (matchLength > static_cast<size_t>(outputEnd - output)) {
+			throw_malformed();
+		}
+
+		const std::byte* match = output - offset;
+		if (offset >= matchLength) {
+			std::memcpy(output, match, matchLength);
+			output += matchLength;
+		}
+		else {
+			// Overlapping, the match repeats bytes it is writing.
+			for (size_t i = 0; i < matchLength; i++) {
+				*output++ = *match++;
+			}
+		}
+	}
+
+	if (output != outputEnd) {
+		throw_malformed();
+	}
+}
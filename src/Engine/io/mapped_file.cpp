@@ -0,0 +1,136 @@
+#include "Engine/io/mapped_file.h"
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // _WIN32
+
+// === Class Functions ===
+
+MappedFile::MappedFile(const std::string& path) {
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		throw std::runtime_error("Couldn't open \"" + path + "\".");
+	}
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize)) {
+		CloseHandle(file);
+		throw std::runtime_error("Couldn't get the size of \"" + path + "\".");
+	}
+
+	if (fileSize.QuadPart == 0) {
+		CloseHandle(file);
+		this->empty_file = true;
+		return;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	void* view = mapping != nullptr ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+	if (view == nullptr) {
+		if (mapping != nullptr) {
+			CloseHandle(mapping);
+		}
+		CloseHandle(file);
+		throw std::runtime_error("Couldn't map \"" + path + "\".");
+	}
+
+	this->file_handle = file;
+	this->mapping_handle = mapping;
+	this->data = static_cast<const std::byte*>(view);
+	this->data_size = static_cast<size_t>(fileSize.QuadPart);
+#else
+	int file = open(path.c_str(), O_RDONLY);
+	if (file < 0) {
+		throw std::runtime_error("Couldn't open \"" + path + "\".");
+	}
+
+	struct stat status;
+	if (fstat(file, &status) != 0) {
+		::close(file);
+		throw std::runtime_error("Couldn't get the size of \"" + path + "\".");
+	}
+
+	if (status.st_size == 0) {
+		::close(file);
+		this->empty_file = true;
+		return;
+	}
+
+	void* view = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+
+	// The mapping keeps its own reference to the file.
+	::close(file);
+
+	if (view == MAP_FAILED) {
+		throw std::runtime_error("Couldn't map \"" + path + "\".");
+	}
+
+	this->data = static_cast<const std::byte*>(view);
+	this->data_size = static_cast<size_t>(status.st_size);
+#endif // _WIN32
+}
+
+MappedFile::~MappedFile() {
+	this->close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+	*this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+	if (this != &other) {
+		this->close();
+
+		std::swap(this->data, other.data);
+		std::swap(this->data_size, other.data_size);
+		std::swap(this->empty_file, other.empty_file);
+#ifdef _WIN32
+		std::swap(this->file_handle, other.file_handle);
+		std::swap(this->mapping_handle, other.mapping_handle);
+#endif // _WIN32
+	}
+	return *this;
+}
+
+void MappedFile::close() {
+	if (this->data != nullptr) {
+#ifdef _WIN32
+		UnmapViewOfFile(this->data);
+		CloseHandle(this->mapping_handle);
+		CloseHandle(this->file_handle);
+		this->file_handle = nullptr;
+		this->mapping_handle = nullptr;
+#else
+		munmap(const_cast<std::byte*>(this->data), this->data_size);
+#endif // _WIN32
+	}
+
+	this->data = nullptr;
+	this->data_size = 0;
+	this->empty_file = false;
+}
+
+// === Getters ===
+
+bool MappedFile::is_open() const {
+	return this->data != nullptr || this->empty_file;
+}
+
+std::span<const std::byte> MappedFile::get_data() const {
+	return std::span<const std::byte>(this->data, this->data_size);
+}
+
+size_t MappedFile::size() const {
+	return this->data_size;
+}
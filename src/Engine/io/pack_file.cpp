@@ -0,0 +1,210 @@
+#include "Engine/io/pack_file.h"
+#include "Engine/io/block_compression.h"
+#include "Engine/thread_pool/thread_pool.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+// CODE FORMATTING INFORMATION:
+// Simple functions like getters and setters go at the bottom.
+// Organize from most complex at the top to least complex at the bottom.
+
+static constexpr size_t BLOCKS_PER_JOB = 4;
+/// 256 KB a thread pool job, enough to outweigh scheduling it.
+
+static constexpr uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+static constexpr uint64_t FNV_PRIME = 1099511628211ull;
+
+static void throw_invalid(const std::string& reason) {
+	throw std::runtime_error("Invalid pack file: " + reason);
+}
+
+static bool is_range_inside(uint64_t offset, uint64_t count, uint64_t element_size, uint64_t file_size) {
+	return offset <= file_size && count <= (file_size - offset) / element_size;
+}
+
+static bool is_entry_before(const PackFileEntry& entry, uint64_t hash, std::string_view name, std::string_view names) {
+	if (entry.path_hash != hash) {
+		return entry.path_hash < hash;
+	}
+	return names.substr(entry.name_offset, entry.name_size) < name;
+}
+
+// === Class Functions ===
+
+PackFile::PackFile(const std::string& path)
+	: mapped_file(path)
+{
+	this->data = this->mapped_file.get_data();
+	this->fix_up();
+}
+
+std::string PackFile::normalize_path(std::string_view path) {
+	std::string normalized;
+	normalized.reserve(path.size());
+
+	for (size_t i = 0; i < path.size(); i++) {
+		const char c = path[i] == '\\' ? '/' : path[i];
+		const bool segmentStart = normalized.empty() || normalized.back() == '/';
+
+		if (c == '/' && segmentStart) {
+			continue;
+		}
+		// "./" segments, keeping names that merely start with a dot (".testing").
+		if (c == '.' && segmentStart && (i + 1 == path.size() || path[i + 1] == '/' || path[i + 1] == '\\')) {
+			i++;
+			continue;
+		}
+		normalized.push_back(c);
+	}
+
+	return normalized;
+}
+
+uint64_t PackFile::hash_path(std::string_view normalized_path) {
+	uint64_t hash = FNV_OFFSET_BASIS;
+	for (char c : normalized_path) {
+		hash ^= static_cast<uint8_t>(c);
+		hash *= FNV_PRIME;
+	}
+	return hash;
+}
+
+// === Loading ===
+
+void PackFile::fix_up() {
+	if (this->data.size() < sizeof(PackFileHeader)) {
+		throw_invalid("too small for a header.");
+	}
+
+	this->header = reinterpret_cast<const PackFileHeader*>(this->data.data());
+
+	if (this->header->magic != PackFileHeader::MAGIC) {
+		throw_invalid("not a pack file.");
+	}
+	if (this->header->version != PackFileHeader::VERSION) {
+		throw_invalid("version " + std::to_string(this->header->version) + ", expected " + std::to_string(PackFileHeader::VERSION) + ".");
+	}
+	if (this->header->file_size != this->data.size()) {
+		throw_invalid("the file is " + std::to_string(this->data.size()) + " bytes but should be " + std::to_string(this->header->file_size) + ".");
+	}
+	if (this->header->block_size == 0 || this->header->block_size > BlockCompression::MAX_BLOCK_SIZE) {
+		throw_invalid("blocks of " + std::to_string(this->header->block_size) + " bytes.");
+	}
+
+	const uint64_t fileSize = this->data.size();
+	if (this->header->entries_offset % alignof(PackFileEntry) != 0 || this->header->blocks_offset % alignof(PackFileBlock) != 0
+		|| !is_range_inside(this->header->entries_offset, this->header->entry_count, sizeof(PackFileEntry), fileSize)
+		|| !is_range_inside(this->header->blocks_offset, this->header->block_count, sizeof(PackFileBlock), fileSize)
+		|| !is_range_inside(this->header->names_offset, this->header->names_size, 1, fileSize)) {
+		throw_invalid("the table of contents lies outside the file.");
+	}
+
+	this->entries = std::span<const PackFileEntry>(reinterpret_cast<const PackFileEntry*>(this->data.data() + this->header->entries_offset), this->header->entry_count);
+	this->blocks = std::span<const PackFileBlock>(reinterpret_cast<const PackFileBlock*>(this->data.data() + this->header->blocks_offset), this->header->block_count);
+	this->names = std::string_view(reinterpret_cast<const char*>(this->data.data() + this->header->names_offset), this->header->names_size);
+
+	for (const PackFileBlock& block : this->blocks) {
+		if (block.size == 0 || block.size > this->header->block_size || block.compressed_size > block.size
+			|| !is_range_inside(block.offset, block.compressed_size, 1, fileSize)) {
+			throw_invalid("a block lies outside the file.");
+		}
+	}
+
+	// Lookups binary search the entries and read blocks without checking, so everything they
+	// rely on is checked once here.
+	for (size_t i = 0; i < this->entries.size(); i++) {
+		const PackFileEntry& entry = this->entries[i];
+		if (entry.name_offset > this->names.size() || entry.name_size > this->names.size() - entry.name_offset) {
+			throw_invalid("a name lies outside the file.");
+		}
+
+		const std::string_view name = this->names.substr(entry.name_offset, entry.name_size);
+		if (entry.path_hash != hash_path(name)) {
+			throw_invalid("\"" + std::string(name) + "\" has the wrong hash.");
+		}
+		if (i > 0 && !is_entry_before(this->entries[i - 1], entry.path_hash, name, this->names)) {
+			throw_invalid("the entries aren't sorted.");
+		}
+
+		const uint64_t blockSize = this->header->block_size;
+		if (entry.first_block > this->blocks.size() || entry.block_count > this->blocks.size() - entry.first_block
+			|| entry.block_count != (entry.size + blockSize - 1) / blockSize) {
+			throw_invalid("\"" + std::string(name) + "\" has the wrong blocks.");
+		}
+		for (uint32_t b = 0; b < entry.block_count; b++) {
+			const uint64_t expected = std::min(blockSize, entry.size - b * blockSize);
+			if (this->blocks[entry.first_block + b].size != expected) {
+				throw_invalid("\"" + std::string(name) + "\" has the wrong blocks.");
+			}
+		}
+	}
+}
+
+// === Reading ===
+
+const PackFileEntry* PackFile::find(std::string_view path) const {
+	const std::string normalized = normalize_path(path);
+	const uint64_t hash = hash_path(normalized);
+
+	auto entry = std::lower_bound(this->entries.begin(), this->entries.end(), hash, [this, &normalized](const PackFileEntry& entry, uint64_t hash) {
+		return is_entry_before(entry, hash, normalized, this->names);
+	});
+
+	if (entry == this->entries.end() || entry->path_hash != hash || this->get_name(*entry) != normalized) {
+		return nullptr;
+	}
+	return &*entry;
+}
+
+void PackFile::read(const PackFileEntry& entry, std::span<std::byte> destination, ThreadPool::Pool* pool) const {
+	if (destination.size() != entry.size) {
+		throw std::invalid_argument("Reading \"" + std::string(this->get_name(entry)) + "\" into " + std::to_string(destination.size()) + " bytes, it is " + std::to_string(entry.size) + ".");
+	}
+
+	auto readBlocks = [this, &entry, destination](size_t begin, size_t end) {
+		this->read_blocks(entry, destination, begin, end);
+	};
+
+	if (pool != nullptr && entry.block_count > BLOCKS_PER_JOB) {
+		pool->parallel_for(entry.block_count, BLOCKS_PER_JOB, readBlocks);
+	}
+	else {
+		readBlocks(0, entry.block_count);
+	}
+}
+
+vector<std::byte> PackFile::read(const PackFileEntry& entry, ThreadPool::Pool* pool) const {
+	vector<std::byte> bytes(entry.size);
+	this->read(entry, bytes, pool);
+	return bytes;
+}
+
+void PackFile::read_blocks(const PackFileEntry& entry, std::span<std::byte> destination, size_t begin, size_t end) const {
+	for (size_t b = begin; b < end; b++) {
+		const PackFileBlock& block = this->blocks[entry.first_block + b];
+		std::span<const std::byte> source = this->data.subspan(block.offset, block.compressed_size);
+		std::span<std::byte> output = destination.subspan(b * this->header->block_size, block.size);
+
+		if (block.compressed_size == block.size) {
+			std::memcpy(output.data(), source.data(), block.size);
+		}
+		else {
+			BlockCompression::decompress(source, output);
+		}
+	}
+}
+
+// === Getters ===
+
+std::span<const PackFileEntry> PackFile::get_entries() const {
+	return this->entries;
+}
+
+std::string_view PackFile::get_name(const PackFileEntry& entry) const {
+	return this->names.substr(entry.name_offset, entry.name_size);
+}
+
+size_t PackFile::size() const {
+	return this->data.size();
+}
@@ -0,0 +1,104 @@
+#include "Engine/io/virtual_file_system.h"
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <system_error>
+
+// CODE FORMATTING INFORMATION:
+// Simple functions like getters and setters go at the bottom.
+// Organize from most complex at the top to least complex at the bottom.
+
+// === Mounting ===
+
+void VirtualFileSystem::mount(const std::string& pack_path) {
+	this->packs.emplace_back(pack_path);
+}
+
+void VirtualFileSystem::set_loose_root(const std::string& directory) {
+	this->loose_root = directory;
+	this->loose_files = !directory.empty();
+}
+
+// === Reading ===
+
+bool VirtualFileSystem::exists(const std::string& path) const {
+	if (this->is_packed(path)) {
+		return true;
+	}
+
+	std::error_code errorCode;
+	return this->loose_files && std::filesystem::is_regular_file(this->get_loose_path(path), errorCode);
+}
+
+bool VirtualFileSystem::is_packed(const std::string& path) const {
+	const PackFileEntry* entry;
+	return this->find(path, entry) != nullptr;
+}
+
+uint64_t VirtualFileSystem::get_size(const std::string& path) const {
+	const PackFileEntry* entry;
+	if (this->find(path, entry) != nullptr) {
+		return entry->size;
+	}
+
+	if (this->loose_files) {
+		std::error_code errorCode;
+		const uintmax_t size = std::filesystem::file_size(this->get_loose_path(path), errorCode);
+		if (!errorCode) {
+			return size;
+		}
+	}
+
+	throw std::runtime_error("No file \"" + path + "\" in the mounted packs" + (this->loose_files ? " or on disk." : "."));
+}
+
+vector<std::byte> VirtualFileSystem::read(const std::string& path, ThreadPool::Pool* pool) const {
+	const PackFileEntry* entry;
+	if (const PackFile* pack = this->find(path, entry)) {
+		return pack->read(*entry, pool);
+	}
+
+	vector<std::byte> bytes(this->get_size(path));
+	this->read_into(path, bytes, pool);
+	return bytes;
+}
+
+void VirtualFileSystem::read_into(const std::string& path, std::span<std::byte> destination, ThreadPool::Pool* pool) const {
+	const PackFileEntry* entry;
+	if (const PackFile* pack = this->find(path, entry)) {
+		pack->read(*entry, destination, pool);
+		return;
+	}
+
+	if (destination.size() != this->get_size(path)) {
+		throw std::invalid_argument("Reading \"" + path + "\" into " + std::to_string(destination.size()) + " bytes, it is " + std::to_string(this->get_size(path)) + ".");
+	}
+
+	const std::string loosePath = this->get_loose_path(path);
+	std::ifstream stream(loosePath, std::ios::binary);
+	stream.read(reinterpret_cast<char*>(destination.data()), static_cast<std::streamsize>(destination.size()));
+	if (!stream) {
+		throw std::runtime_error("Couldn't read \"" + loosePath + "\".");
+	}
+}
+
+const PackFile* VirtualFileSystem::find(const std::string& path, const PackFileEntry*& entry) const {
+	for (size_t i = this->packs.size(); i-- > 0;) {
+		entry = this->packs[i].find(path);
+		if (entry != nullptr) {
+			return &this->packs[i];
+		}
+	}
+	entry = nullptr;
+	return nullptr;
+}
+
+std::string VirtualFileSystem::get_loose_path(const std::string& path) const {
+	return (std::filesystem::path(this->loose_root) / PackFile::normalize_path(path)).string();
+}
+
+// === Getters ===
+
+size_t VirtualFileSystem::get_pack_count() const {
+	return this->packs.size();
+}
@@ -0,0 +1,170 @@
+#include "Engine/mesh/mesh_clusters.h"
+#include "Engine/spatial/float8.h"
+#include "Engine/thread_pool/thread_pool.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+// CODE FORMATTING INFORMATION:
+// Simple functions like getters and setters go at the bottom.
+// Organize from most complex at the top to least complex at the bottom.
+
+static constexpr size_t CLUSTER_CULL_CHUNK_SIZE = 1024;
+/// Clusters one thread pool job tests, smaller submeshes are culled on the calling thread.
+
+static constexpr float MIN_CAMERA_W = 1e-6f;
+/// Below it the camera is at infinity (an orthographic view) and cones aren't tested.
+
+// === Class Functions ===
+
+MeshClusters::MeshClusters(const MeshFile& mesh) {
+	std::span<const MeshFileMeshlet> meshlets = mesh.get_meshlets();
+	this->cluster_count = meshlets.size();
+
+	const size_t paddedCount = meshlets.size() + FrustumCulling::LANE_PADDING;
+	for (vector<float>* array : { &this->center_x, &this->center_y, &this->center_z, &this->radius, &this->cone_axis_x, &this->cone_axis_y, &this->cone_axis_z }) {
+		array->assign(paddedCount, 0.0f);
+	}
+	this->cone_cutoff.assign(paddedCount, 1.0f);
+	this->first_index.assign(paddedCount, 0);
+	this->index_count.assign(paddedCount, 0);
+
+	for (size_t i = 0; i < meshlets.size(); i++) {
+		const MeshFileMeshlet& meshlet = meshlets[i];
+		this->center_x[i] = meshlet.center.x;
+		this->center_y[i] = meshlet.center.y;
+		this->center_z[i] = meshlet.center.z;
+		this->radius[i] = meshlet.radius;
+		this->cone_axis_x[i] = meshlet.cone_axis.x;
+		this->cone_axis_y[i] = meshlet.cone_axis.y;
+		this->cone_axis_z[i] = meshlet.cone_axis.z;
+		this->cone_cutoff[i] = meshlet.cone_cutoff;
+		this->first_index[i] = meshlet.first_index;
+		this->index_count[i] = meshlet.index_count;
+	}
+}
+
+// === Culling ===
+
+size_t MeshClusters::cull(const glm::mat4& view_projection, const glm::mat4& world_matrix, uint32_t first_cluster, uint32_t cluster_count, vector<IndexRange>& visible, ThreadPool::Pool* pool, bool backface_culling) {
+	visible.clear();
+
+	const size_t begin = std::min<size_t>(first_cluster, this->cluster_count);
+	const size_t end = std::min<size_t>(begin + cluster_count, this->cluster_count);
+	if (begin == end) {
+		return 0;
+	}
+
+	// Planes of the view projection times the world matrix are the frustum's planes in mesh space.
+	const glm::mat4 meshViewProjection = view_projection * world_matrix;
+	const Frustum frustum = Frustum::from_view_projection(meshViewProjection);
+
+	// A perspective projection maps the camera to x = y = w = 0, the camera is the point the
+	// inverse maps (0, 0, 1, 0) to.  Mirroring world matrices flip which side is the back.
+	const glm::vec4 camera = glm::inverse(meshViewProjection) * glm::vec4(0.0f, 0.0f, 1.0f, 0.0f);
+	const float handedness = glm::dot(glm::cross(glm::vec3(world_matrix[0]), glm::vec3(world_matrix[1])), glm::vec3(world_matrix[2]));
+	const bool coneCulling = backface_culling && std::abs(camera.w) > MIN_CAMERA_W && handedness > 0.0f;
+	const glm::vec3 cameraPosition = coneCulling ? glm::vec3(camera) / camera.w : glm::vec3(0.0f);
+
+	const size_t count = end - begin;
+	const size_t chunkCount = (count + CLUSTER_CULL_CHUNK_SIZE - 1) / CLUSTER_CULL_CHUNK_SIZE;
+
+	// Every chunk writes to its own part of the scratch ranges, at most one range per cluster.
+	this->chunk_ranges.resize(count);
+	this->chunk_range_counts.resize(chunkCount);
+	this->chunk_cluster_counts.resize(chunkCount);
+
+	auto cull_chunks = [&, this](size_t chunkBegin, size_t chunkEnd) {
+		for (size_t chunk = chunkBegin; chunk < chunkEnd; chunk++) {
+			const size_t rangeBegin = begin + chunk * CLUSTER_CULL_CHUNK_SIZE;
+			const size_t rangeEnd = std::min(rangeBegin + CLUSTER_CULL_CHUNK_SIZE, end);
+			this->chunk_cluster_counts[chunk] = 0;
+			this->chunk_range_counts[chunk] = this->cull_range(frustum, cameraPosition, coneCulling, rangeBegin, rangeEnd,
+				this->chunk_ranges.data() + chunk * CLUSTER_CULL_CHUNK_SIZE, this->chunk_cluster_counts[chunk]);
+		}
+	};
+
+	if (pool != nullptr && chunkCount > 1) {
+		pool->parallel_for(chunkCount, 1, cull_chunks);
+	}
+	else {
+		cull_chunks(0, chunkCount);
+	}
+
+	// Compact the chunks' ranges, merging across chunk boundaries too.
+	size_t visibleClusterCount = 0;
+	for (size_t chunk = 0; chunk < chunkCount; chunk++) {
+		visibleClusterCount += this->chunk_cluster_counts[chunk];
+
+		const IndexRange* ranges = this->chunk_ranges.data() + chunk * CLUSTER_CULL_CHUNK_SIZE;
+		for (size_t r = 0; r < this->chunk_range_counts[chunk]; r++) {
+			if (!visible.empty() && visible.back().first_index + visible.back().index_count == ranges[r].first_index) {
+				visible.back().index_count += ranges[r].index_count;
+			}
+			else {
+				visible.push_back(ranges[r]);
+			}
+		}
+	}
+
+	return visibleClusterCount;
+}
+
+size_t MeshClusters::cull_range(const Frustum& frustum, const glm::vec3& camera, bool cone_culling, size_t begin, size_t end, IndexRange* visible, size_t& visible_cluster_count) const {
+	size_t rangeCount = 0;
+
+	const Float8 cameraX = Float8::broadcast(camera.x);
+	const Float8 cameraY = Float8::broadcast(camera.y);
+	const Float8 cameraZ = Float8::broadcast(camera.z);
+
+	for (size_t i = begin; i < end; i += 8) {
+		const Float8 centerX = Float8::load(this->center_x.data() + i);
+		const Float8 centerY = Float8::load(this->center_y.data() + i);
+		const Float8 centerZ = Float8::load(this->center_z.data() + i);
+		const Float8 radius = Float8::load(this->radius.data() + i);
+		const Float8 negativeRadius = Float8::zero() - radius;
+
+		// A sphere is outside when it's entirely behind one of the planes.
+		uint32_t mask = end - i >= 8 ? 0xFFu : (1u << (end - i)) - 1u;
+		for (const glm::vec4& plane : frustum.planes) {
+			const Float8 distance = centerX * Float8::broadcast(plane.x) + centerY * Float8::broadcast(plane.y)
+				+ centerZ * Float8::broadcast(plane.z) + Float8::broadcast(plane.w);
+			mask &= (distance >= negativeRadius).get_mask();
+		}
+
+		if (cone_culling && mask != 0) {
+			const Float8 toClusterX = centerX - cameraX;
+			const Float8 toClusterY = centerY - cameraY;
+			const Float8 toClusterZ = centerZ - cameraZ;
+			const Float8 along = toClusterX * Float8::load(this->cone_axis_x.data() + i)
+				+ toClusterY * Float8::load(this->cone_axis_y.data() + i)
+				+ toClusterZ * Float8::load(this->cone_axis_z.data() + i);
+			const Float8 distance = Float8::sqrt(toClusterX * toClusterX + toClusterY * toClusterY + toClusterZ * toClusterZ);
+			const Float8 backfacing = along >= Float8::load(this->cone_cutoff.data() + i) * distance + radius;
+			mask &= ~backfacing.get_mask();
+		}
+
+		while (mask != 0) {
+			const size_t cluster = i + static_cast<size_t>(std::countr_zero(mask));
+			mask &= mask - 1;
+
+			const uint32_t firstIndex = this->first_index[cluster];
+			const uint32_t indexCount = this->index_count[cluster];
+			if (rangeCount > 0 && visible[rangeCount - 1].first_index + visible[rangeCount - 1].index_count == firstIndex) {
+				visible[rangeCount - 1].index_count += indexCount;
+			}
+			else {
+				visible[rangeCount++] = IndexRange{ firstIndex, indexCount };
+			}
+			visible_cluster_count++;
+		}
+	}
+
+	return rangeCount;
+}
+
+// === Getters ===
+
+size_t MeshClusters::get_cluster_count() const {
+	return this->cluster_count;
+}
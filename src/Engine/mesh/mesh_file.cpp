@@ -0,0 +1,268 @@
+#include "Engine/mesh/mesh_file.h"
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+// CODE FORMATTING INFORMATION:
+// Simple functions like getters and setters go at the bottom.
+// Organize from most complex at the top to least complex at the bottom.
+
+static_assert(sizeof(Aabb) == 6 * sizeof(float), "Mesh files store bounds as packed floats.");
+
+static void throw_invalid(const std::string& reason) {
+	throw std::runtime_error("Invalid mesh file: " + reason);
+}
+
+template<typename T>
+static bool has_invalid_index(std::span<const std::byte> index_data, uint32_t vertex_count) {
+	const size_t count = index_data.size() / sizeof(T);
+
+	// No early exit, so the loop vectorizes and runs at memory speed.
+	T maxIndex = 0;
+	for (size_t i = 0; i < count; i++) {
+		T index;
+		std::memcpy(&index, index_data.data() + i * sizeof(T), sizeof(T));
+		maxIndex = index > maxIndex ? index : maxIndex;
+	}
+	return count != 0 && maxIndex >= vertex_count;
+}
+
+// === Class Functions ===
+
+MeshFile::MeshFile(const std::string& path)
+	: mapped_file(path)
+{
+	this->data = this->mapped_file.get_data();
+	this->fix_up();
+}
+
+MeshFile::MeshFile(vector<std::byte> bytes)
+	: bytes(std::move(bytes))
+{
+	this->data = this->bytes;
+	this->fix_up();
+}
+
+uint32_t MeshFile::get_format_size(VertexFormat format) {
+	switch (format) {
+	case VertexFormat::FLOAT2:
+		return 2 * sizeof(float);
+	case VertexFormat::FLOAT3:
+		return 3 * sizeof(float);
+	case VertexFormat::FLOAT4:
+		return 4 * sizeof(float);
+	case VertexFormat::HALF2:
+	case VertexFormat::SNORM16x2:
+	case VertexFormat::UNORM8x4:
+		return 4;
+	case VertexFormat::HALF4:
+	case VertexFormat::UNORM16x4:
+		return 8;
+	}
+	throw std::invalid_argument("Unknown vertex format " + std::to_string(static_cast<uint32_t>(format)) + ".");
+}
+
+// === Loading ===
+
+void MeshFile::fix_up() {
+	if (this->data.size() < sizeof(MeshFileHeader)) {
+		throw_invalid("too small for a header.");
+	}
+
+	this->header = reinterpret_cast<const MeshFileHeader*>(this->data.data());
+
+	if (this->header->magic != MeshFileHeader::MAGIC) {
+		throw_invalid("not a mesh file.");
+	}
+	if (this->header->version != MeshFileHeader::VERSION) {
+		throw_invalid("version " + std::to_string(this->header->version) + ", expected " + std::to_string(MeshFileHeader::VERSION) + ".");
+	}
+	if (this->header->file_size != this->data.size()) {
+		throw_invalid("the file is " + std::to_string(this->data.size()) + " bytes but should be " + std::to_string(this->header->file_size) + ".");
+	}
+
+	const uint32_t vertexCount = this->header->vertex_count;
+	const uint32_t indexCount = this->header->index_count;
+
+	// === Vertices ===
+
+	this->streams.clear();
+	for (const MeshFileVertexStream& stream : this->get_range<MeshFileVertexStream>(this->header->streams)) {
+		if (stream.stride == 0 || stream.data.count != static_cast<uint64_t>(vertexCount) * stream.stride) {
+			throw_invalid("a vertex stream doesn't hold one vertex per vertex.");
+		}
+		this->streams.push_back(StreamView{ this->get_range<std::byte>(stream.data), stream.stride });
+	}
+
+	this->attributes = this->get_range<MeshFileVertexAttribute>(this->header->attributes);
+	for (const MeshFileVertexAttribute& attribute : this->attributes) {
+		if (attribute.stream >= this->streams.size()) {
+			throw_invalid("an attribute is in a stream that doesn't exist.");
+		}
+
+		uint32_t formatSize;
+		try {
+			formatSize = get_format_size(attribute.format);
+		}
+		catch (const std::invalid_argument&) {
+			throw_invalid("an attribute has an unknown format.");
+		}
+
+		if (static_cast<uint64_t>(attribute.offset) + formatSize > this->streams[attribute.stream].stride) {
+			throw_invalid("an attribute doesn't fit in its stream's vertices.");
+		}
+	}
+
+	// === Indices ===
+
+	const uint32_t indexSize = this->header->index_size;
+	if (indexSize != sizeof(uint16_t) && indexSize != sizeof(uint32_t)) {
+		throw_invalid("indices must be 2 or 4 bytes.");
+	}
+	if (indexCount % 3 != 0 || this->header->indices.count != static_cast<uint64_t>(indexCount) * indexSize) {
+		throw_invalid("the index buffer doesn't hold whole triangles.");
+	}
+
+	this->index_data = this->get_range<std::byte>(this->header->indices);
+
+	// The index buffer goes to the GPU untouched, an index past the vertices would read out of bounds.
+	const bool invalidIndex = indexSize == sizeof(uint16_t)
+		? has_invalid_index<uint16_t>(this->index_data, vertexCount)
+		: has_invalid_index<uint32_t>(this->index_data, vertexCount);
+	if (invalidIndex) {
+		throw_invalid("an index points past the vertices.");
+	}
+
+	// === Submeshes ===
+
+	this->material_names.clear();
+	for (const MeshFileRange& name : this->get_range<MeshFileRange>(this->header->material_names)) {
+		std::span<const char> characters = this->get_range<char>(name);
+		this->material_names.push_back(std::string_view(characters.data(), characters.size()));
+	}
+
+	this->meshlets = this->get_range<MeshFileMeshlet>(this->header->meshlets);
+
+	this->submeshes = this->get_range<MeshFileSubmesh>(this->header->submeshes);
+	for (const MeshFileSubmesh& submesh : this->submeshes) {
+		if (submesh.first_index % 3 != 0 || submesh.index_count % 3 != 0 || static_cast<uint64_t>(submesh.first_index) + submesh.index_count > indexCount) {
+			throw_invalid("a submesh's triangles lie outside the index buffer.");
+		}
+		if (submesh.material >= this->material_names.size()) {
+			throw_invalid("a submesh uses a material that doesn't exist.");
+		}
+		if (static_cast<uint64_t>(submesh.first_meshlet) + submesh.meshlet_count > this->meshlets.size()) {
+			throw_invalid("a submesh's meshlets lie outside the meshlet table.");
+		}
+		// Meshlets are drawn as index ranges, they must not reach into another submesh.
+		for (const MeshFileMeshlet& meshlet : this->meshlets.subspan(submesh.first_meshlet, submesh.meshlet_count)) {
+			if (meshlet.first_index < submesh.first_index || static_cast<uint64_t>(meshlet.first_index) + meshlet.index_count > static_cast<uint64_t>(submesh.first_index) + submesh.index_count) {
+				throw_invalid("a meshlet's triangles lie outside its submesh.");
+			}
+		}
+	}
+
+	// === LODs ===
+
+	this->lods = this->get_range<MeshFileLod>(this->header->lods);
+	if (this->lods.empty()) {
+		throw_invalid("a mesh needs at least one LOD.");
+	}
+
+	uint64_t nextSubmesh = 0;
+	float previousError = 0.0f;
+	for (const MeshFileLod& lod : this->lods) {
+		if (lod.first_submesh != nextSubmesh) {
+			throw_invalid("the LODs aren't consecutive runs of submeshes.");
+		}
+		if (!(lod.error >= previousError)) {
+			throw_invalid("the LOD errors decrease along the chain.");
+		}
+		nextSubmesh += lod.submesh_count;
+		previousError = lod.error;
+	}
+	if (nextSubmesh != this->submeshes.size()) {
+		throw_invalid("the LODs don't cover the submeshes.");
+	}
+}
+
+template<typename T>
+std::span<const T> MeshFile::get_range(const MeshFileRange& range) const {
+	const size_t size = this->data.size();
+	if (range.offset > size || range.count > (size - range.offset) / sizeof(T) || range.offset % alignof(T) != 0) {
+		throw_invalid("a range lies outside the file.");
+	}
+	return std::span<const T>(reinterpret_cast<const T*>(this->data.data() + range.offset), static_cast<size_t>(range.count));
+}
+
+// === Getters ===
+
+uint32_t MeshFile::get_vertex_count() const {
+	return this->header->vertex_count;
+}
+
+uint32_t MeshFile::get_index_count() const {
+	return this->header->index_count;
+}
+
+uint32_t MeshFile::get_index_size() const {
+	return this->header->index_size;
+}
+
+std::span<const MeshFileVertexAttribute> MeshFile::get_attributes() const {
+	return this->attributes;
+}
+
+const MeshFileVertexAttribute* MeshFile::find_attribute(VertexSemantic semantic) const {
+	for (const MeshFileVertexAttribute& attribute : this->attributes) {
+		if (attribute.semantic == semantic) {
+			return &attribute;
+		}
+	}
+	return nullptr;
+}
+
+std::span<const MeshFile::StreamView> MeshFile::get_streams() const {
+	return this->streams;
+}
+
+std::span<const std::byte> MeshFile::get_index_data() const {
+	return this->index_data;
+}
+
+std::span<const MeshFileSubmesh> MeshFile::get_submeshes() const {
+	return this->submeshes;
+}
+
+std::span<const MeshFileSubmesh> MeshFile::get_lod_submeshes(size_t lod) const {
+	return this->submeshes.subspan(this->lods[lod].first_submesh, this->lods[lod].submesh_count);
+}
+
+std::span<const MeshFileLod> MeshFile::get_lods() const {
+	return this->lods;
+}
+
+std::span<const MeshFileMeshlet> MeshFile::get_meshlets() const {
+	return this->meshlets;
+}
+
+std::span<const std::string_view> MeshFile::get_material_names() const {
+	return this->material_names;
+}
+
+const Aabb& MeshFile::get_bounds() const {
+	return this->header->bounds;
+}
+
+glm::mat4 MeshFile::get_position_transform() const {
+	glm::mat4 transform(1.0f);
+	transform[0][0] = this->header->position_scale.x;
+	transform[1][1] = this->header->position_scale.y;
+	transform[2][2] = this->header->position_scale.z;
+	transform[3] = glm::vec4(this->header->position_offset, 1.0f);
+	return transform;
+}
+
+size_t MeshFile::size() const {
+	return this->data.size();
+}
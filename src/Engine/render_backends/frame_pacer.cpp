@@ -0,0 +1,60 @@
+#include "Engine/render_backends/frame_pacer.h"
+#include <chrono>
+#include <thread>
+
+FramePacer::FramePacer(double spin_threshold_seconds)
+	: spin_threshold_seconds(spin_threshold_seconds), counter_frequency(SDL_GetPerformanceFrequency()) {
+
+}
+
+void FramePacer::wait_for_next_frame(int frames_per_second) {
+	if (frames_per_second <= 0) {
+		this->reset();
+		return;
+	}
+
+	Uint64 now = SDL_GetPerformanceCounter();
+	Uint64 frameTicks = this->counter_frequency / frames_per_second;
+
+	// Start a fresh schedule when the rate changes or when we have fallen more than a whole
+	// frame behind, otherwise we would run a burst of frames back to back to catch up.
+	if (this->next_frame_counter == 0
+		|| frames_per_second != this->last_frames_per_second
+		|| now > this->next_frame_counter + frameTicks) {
+		this->next_frame_counter = now + frameTicks;
+		this->last_frames_per_second = frames_per_second;
+	}
+
+	this->wait_until(this->next_frame_counter);
+
+	// Deadlines advance by a fixed step so small wake up errors don't accumulate as drift.
+	this->next_frame_counter += frameTicks;
+}
+
+void FramePacer::wait_until(Uint64 target_counter) {
+	const Uint64 spinTicks = static_cast<Uint64>(this->spin_threshold_seconds * this->counter_frequency);
+
+	Uint64 now = SDL_GetPerformanceCounter();
+
+	// Sleep through most of the wait.
+	while (now + spinTicks < target_counter) {
+		double sleepSeconds = static_cast<double>(target_counter - now - spinTicks) / this->counter_frequency;
+		std::this_thread::sleep_for(std::chrono::duration<double>(sleepSeconds));
+		now = SDL_GetPerformanceCounter();
+	}
+
+	// Spin through the rest, sleep can overshoot by more than a millisecond.
+	while (now < target_counter) {
+		std::this_thread::yield();
+		now = SDL_GetPerformanceCounter();
+	}
+}
+
+void FramePacer::reset() {
+	this->next_frame_counter = 0;
+	this->last_frames_per_second = 0;
+}
+
+void FramePacer::set_spin_threshold_seconds(double spin_threshold_seconds) {
+	this->spin_threshold_seconds = spin_threshold_seconds;
+}
@@ -0,0 +1,38 @@
+#include "Engine/render_backends/headless/headless_render_backend.h"
+
+// ==== Class Functions ====
+
+HeadlessRenderBackend::HeadlessRenderBackend(
+	Tritium::Engine* engine,
+	float fixed_frame_delta_time,
+	uint64_t max_frame_count
+)
+	: RenderBackend(
+		engine
+	)
+{
+	// Events are still initialized so the process can be asked to quit.
+	this->sdl_init_flags = SDL_INIT_TIMER | SDL_INIT_EVENTS;
+	this->creates_window = false;
+
+	this->set_fixed_frame_delta_time(fixed_frame_delta_time);
+	this->set_max_frame_count(max_frame_count);
+}
+
+// === Game Loop Hooks ===
+
+void HeadlessRenderBackend::before_start_window([[maybe_unused]] string window_title, [[maybe_unused]] int window_width, [[maybe_unused]] int window_height) {
+	// There is no window to prepare.
+}
+
+void HeadlessRenderBackend::before_game_loop() {
+	// There is no graphics api to initialize.
+}
+
+void HeadlessRenderBackend::after_game_loop() {
+	// There is no graphics api to clean up.
+}
+
+void HeadlessRenderBackend::update_game([[maybe_unused]] FramePacket& frame_packet) {
+	// Nothing is drawn, the frame's cost is the events, callbacks and fixed updates.
+}
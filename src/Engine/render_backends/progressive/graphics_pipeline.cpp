@@ -1,9 +1,11 @@
 #include "Engine/render_backends/progressive/graphics_pipeline.h"
 #include "Engine/engine.h"
+#include "Engine/io/virtual_file_system.h"
 #include "Engine/logging/logger.h"
 #include "Engine/render_backends/progressive/virtual_device.h"
 #include "Engine/render_backends/progressive/render_pass.h"
 #include <fstream>
+#include <stdexcept>
 
 ///////////////////////////////
 // GRAPHICS PIPELINE BUILDER //
@@ -175,7 +177,15 @@ GraphicsPipelineBuilder* GraphicsPipelineBuilder::add_stage(
 	string entry_point,
 	vk::ShaderStageFlagBits stage
 ) {
-	auto shaderCode = this->read_binary(shader_path);
+	vector<char> shaderCode;
+	if (this->engine->file_system != nullptr) {
+		// Read from the mounted packs straight into the code, falling back to loose files.
+		shaderCode.resize(this->engine->file_system->get_size(shader_path));
+		this->engine->file_system->read_into(shader_path, std::as_writable_bytes(std::span<char>(shaderCode)), this->engine->thread_pool);
+	}
+	else {
+		shaderCode = this->read_binary(shader_path);
+	}
 
 	vk::ShaderModule shaderModule = this->create_shader_module(shaderCode);
 	
@@ -231,6 +241,60 @@ GraphicsPipelineBuilder* GraphicsPipelineBuilder::add_vertex_input_attribute(uin
 	return this;
 }
 
+GraphicsPipelineBuilder* GraphicsPipelineBuilder::add_vertex_input_layout(const MeshFile& mesh, uint32_t first_binding) {
+	std::span<const MeshFile::StreamView> streams = mesh.get_streams();
+	for (uint32_t stream = 0; stream < streams.size(); stream++) {
+		this->add_vertex_input_binding(first_binding + stream, streams[stream].stride, vk::VertexInputRate::eVertex);
+	}
+
+	for (const MeshFileVertexAttribute& attribute : mesh.get_attributes()) {
+		this->add_vertex_input_attribute(
+			first_binding + attribute.stream,
+			get_vertex_location(attribute.semantic),
+			get_vertex_format(attribute.format),
+			attribute.offset
+		);
+	}
+	return this;
+}
+
+uint32_t GraphicsPipelineBuilder::get_vertex_location(VertexSemantic semantic) {
+	switch (semantic) {
+	case VertexSemantic::POSITION:
+		return 0;
+	case VertexSemantic::COLOR:
+		return 1;
+	case VertexSemantic::TEXCOORD:
+		return 2;
+	case VertexSemantic::NORMAL:
+		return 3;
+	}
+	throw std::invalid_argument("Unknown vertex semantic.");
+}
+
+vk::Format GraphicsPipelineBuilder::get_vertex_format(VertexFormat format) {
+	// Every format here is in the set Vulkan requires vertex buffer support for.
+	switch (format) {
+	case VertexFormat::FLOAT2:
+		return vk::Format::eR32G32Sfloat;
+	case VertexFormat::FLOAT3:
+		return vk::Format::eR32G32B32Sfloat;
+	case VertexFormat::FLOAT4:
+		return vk::Format::eR32G32B32A32Sfloat;
+	case VertexFormat::HALF2:
+		return vk::Format::eR16G16Sfloat;
+	case VertexFormat::HALF4:
+		return vk::Format::eR16G16B16A16Sfloat;
+	case VertexFormat::UNORM16x4:
+		return vk::Format::eR16G16B16A16Unorm;
+	case VertexFormat::SNORM16x2:
+		return vk::Format::eR16G16Snorm;
+	case VertexFormat::UNORM8x4:
+		return vk::Format::eR8G8B8A8Unorm;
+	}
+	throw std::invalid_argument("Unknown vertex format.");
+}
+
 GraphicsPipelineBuilder* GraphicsPipelineBuilder::set_primitive_topology(vk::PrimitiveTopology vk_primitive_topology) {
 	this->vk_primitive_topology = vk_primitive_topology;
 	return this;
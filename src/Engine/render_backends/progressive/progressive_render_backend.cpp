@@ -1,6 +1,7 @@
 #include "Engine/render_backends/progressive/progressive_render_backend.h"
 #include "Engine/constants.h"
 #include "Engine/render_backends/progressive/extensions.h"
+#include "Engine/render_backends/progressive/staging_uploader.h"
 #include "Engine/render_backends/progressive/virtual_device.h"
 #include "Engine/render_backends/progressive/constants.h"
 #include "Engine/engine.h"
@@ -24,6 +25,9 @@ ProgressiveRenderBackend::ProgressiveRenderBackend(
 	this->sdl_window_flags = SDL_WINDOW_VULKAN | sdl_only_window_flags;
 }
 
+//  This is required for the smart pointers to be deleted properly
+ProgressiveRenderBackend::~ProgressiveRenderBackend() = default;
+
 // === Game Loop Hooks ===
 
 void ProgressiveRenderBackend::before_start_window(string window_title, int window_width, int window_height) {
@@ -44,8 +48,10 @@ void ProgressiveRenderBackend::after_game_loop() {
 	}
 }
 
-void ProgressiveRenderBackend::update_game() {
+void ProgressiveRenderBackend::update_game([[maybe_unused]] FramePacket& frame_packet) {
 	// This is where the screen is updated with the vulkan surface.
+	// This runs on the render thread, everything it needs from the game is in `frame_packet`:
+	// each view's culled `visible_nodes` with their `world_matrices`.
 }
 
 bool ProgressiveRenderBackend::initialize_vulkan() {
@@ -64,6 +70,10 @@ bool ProgressiveRenderBackend::initialize_vulkan() {
 	if (!this->vk_create_virtual_devices()) {
 		throw std::runtime_error("Failed to create virtual devices.");
 	}
+
+	this->staging_uploader = std::make_unique<StagingUploader>(this->virtual_device.get(), this->engine->file_system, this->engine->thread_pool);
+
+	return true;
 }
 
 bool ProgressiveRenderBackend::vk_cleanup() {
@@ -71,6 +81,12 @@ bool ProgressiveRenderBackend::vk_cleanup() {
 		VK_Extension::destroy_debug_utils_messenger_ext(this->vk_instance, this->vk_debug_messenger, nullptr);
 	}
 
+	// Waits for the last uploads, the device must still exist.
+	if (this->staging_uploader) {
+		this->staging_uploader->clean_up();
+		this->staging_uploader.reset();
+	}
+
 	// clean up virtual devices
 	for (const auto& virtualDevice : this->virtual_devices) {
 		virtualDevice->clean_up();
@@ -201,6 +217,8 @@ bool ProgressiveRenderBackend::vk_create_virtual_devices() {
 	}
 
 	this->virtual_device = this->virtual_device_priority_map.rbegin()->second;
+
+	return true;
 }
 
 
@@ -0,0 +1,299 @@
+#include "Engine/render_backends/progressive/staging_uploader.h"
+#include "Engine/io/virtual_file_system.h"
+#include "Engine/render_backends/progressive/texture_image.h"
+#include "Engine/render_backends/progressive/virtual_device.h"
+#include "Engine/texture/texture_file.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <system_error>
+#include <vector>
+
+using std::vector;
+
+// CODE FORMATTING INFORMATION:
+// Simple functions like getters and setters go at the bottom.
+// Organize from most complex at the top to least complex at the bottom.
+
+static const std::string UPLOAD_COMMAND_BUFFER = "upload";
+
+static constexpr vk::DeviceSize FILE_ALIGNMENT = 16;
+/// The largest texel block, cooked texture levels are aligned to it inside their file.
+
+// === Class Functions ===
+
+StagingUploader::StagingUploader(VirtualDevice* virtual_device, VirtualFileSystem* file_system, ThreadPool::Pool* pool, vk::DeviceSize staging_size)
+	: virtual_device(virtual_device),
+	file_system(file_system),
+	pool(pool),
+	staging_size(staging_size)
+{
+	if (staging_size == 0) {
+		throw std::invalid_argument("The staging buffer can't be empty.");
+	}
+
+	vk::Device* device = virtual_device->get_vulkan_device();
+
+	this->staging_alignment = std::max<vk::DeviceSize>(FILE_ALIGNMENT, virtual_device->vk_device_properties.limits.optimalBufferCopyOffsetAlignment);
+
+	this->staging_buffer = device->createBuffer(vk::BufferCreateInfo(
+		{},
+		staging_size,
+		vk::BufferUsageFlagBits::eTransferSrc,
+		vk::SharingMode::eExclusive
+	));
+
+	vk::MemoryRequirements requirements = device->getBufferMemoryRequirements(this->staging_buffer);
+	const vk::MemoryPropertyFlags hostMemory = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent;
+
+	std::optional<uint32_t> memoryType = virtual_device->find_memory_type(requirements.memoryTypeBits, hostMemory | vk::MemoryPropertyFlagBits::eHostCached);
+	if (!memoryType.has_value()) {
+		memoryType = virtual_device->find_memory_type(requirements.memoryTypeBits, hostMemory);
+	}
+	if (!memoryType.has_value()) {
+		throw std::runtime_error("The GPU has no host visible memory for the staging buffer.");
+	}
+
+	this->staging_memory = device->allocateMemory(vk::MemoryAllocateInfo(requirements.size, memoryType.value()));
+	device->bindBufferMemory(this->staging_buffer, this->staging_memory, 0);
+	this->staging_data = static_cast<std::byte*>(device->mapMemory(this->staging_memory, 0, VK_WHOLE_SIZE));
+
+	// Graphics queues can always transfer.
+	this->command_pool = std::make_unique<CommandPool>(
+		vk::CommandPoolCreateFlagBits::eTransient | vk::CommandPoolCreateFlagBits::eResetCommandBuffer,
+		virtual_device->queue_family_indices.graphics.value(),
+		virtual_device
+	);
+
+	vector<std::string> commandBufferNames = { UPLOAD_COMMAND_BUFFER };
+	this->command_pool->create_command_buffers(commandBufferNames, vk::CommandBufferLevel::ePrimary);
+
+	this->upload_fence = device->createFence(vk::FenceCreateInfo());
+}
+
+void StagingUploader::clean_up() {
+	this->flush();
+
+	vk::Device* device = this->virtual_device->get_vulkan_device();
+	device->destroyFence(this->upload_fence);
+	this->command_pool->clean_up();
+
+	device->unmapMemory(this->staging_memory);
+	this->staging_data = nullptr;
+	device->destroyBuffer(this->staging_buffer);
+	device->freeMemory(this->staging_memory);
+}
+
+// === Uploads ===
+
+StagingUploader::UploadedImage StagingUploader::upload_texture(const std::string& path) {
+	vk::DeviceSize stagingOffset;
+	std::span<std::byte> staged = this->stage_file(path, stagingOffset);
+
+	vk::Device* device = this->virtual_device->get_vulkan_device();
+	UploadedImage uploaded;
+
+	try {
+		// Validated where it was read to, the level table is all that is looked at.
+		TextureFile texture = TextureFile::view(staged);
+
+		uploaded.create_info = TextureImage::get_image_create_info(texture);
+		uploaded.image = device->createImage(uploaded.create_info);
+		uploaded.memory = this->allocate_device_local(device->getImageMemoryRequirements(uploaded.image));
+		device->bindImageMemory(uploaded.image, uploaded.memory, 0);
+
+		vk::CommandBuffer& commandBuffer = this->get_recording_command_buffer();
+		const vk::ImageSubresourceRange subresources(vk::ImageAspectFlagBits::eColor, 0, texture.get_mip_count(), 0, texture.get_layer_count());
+
+		commandBuffer.pipelineBarrier(
+			vk::PipelineStageFlagBits::eTopOfPipe,
+			vk::PipelineStageFlagBits::eTransfer,
+			{},
+			nullptr,
+			nullptr,
+			vk::ImageMemoryBarrier(
+				{},
+				vk::AccessFlagBits::eTransferWrite,
+				vk::ImageLayout::eUndefined,
+				vk::ImageLayout::eTransferDstOptimal,
+				VK_QUEUE_FAMILY_IGNORED,
+				VK_QUEUE_FAMILY_IGNORED,
+				uploaded.image,
+				subresources
+			)
+		);
+
+		vector<vk::BufferImageCopy> regions = TextureImage::get_copy_regions(texture, stagingOffset);
+		commandBuffer.copyBufferToImage(this->staging_buffer, uploaded.image, vk::ImageLayout::eTransferDstOptimal, regions);
+
+		commandBuffer.pipelineBarrier(
+			vk::PipelineStageFlagBits::eTransfer,
+			vk::PipelineStageFlagBits::eAllCommands,
+			{},
+			nullptr,
+			nullptr,
+			vk::ImageMemoryBarrier(
+				vk::AccessFlagBits::eTransferWrite,
+				vk::AccessFlagBits::eShaderRead,
+				vk::ImageLayout::eTransferDstOptimal,
+				vk::ImageLayout::eShaderReadOnlyOptimal,
+				VK_QUEUE_FAMILY_IGNORED,
+				VK_QUEUE_FAMILY_IGNORED,
+				uploaded.image,
+				subresources
+			)
+		);
+	}
+	catch (...) {
+		// Nothing was recorded, the staged file's space can be reused.
+		this->staging_used = stagingOffset;
+		device->destroyImage(uploaded.image);
+		device->freeMemory(uploaded.memory);
+		throw;
+	}
+
+	return uploaded;
+}
+
+StagingUploader::UploadedBuffer StagingUploader::upload_buffer(const std::string& path, vk::BufferUsageFlags usage) {
+	vk::DeviceSize stagingOffset;
+	std::span<std::byte> staged = this->stage_file(path, stagingOffset);
+
+	if (staged.empty()) {
+		throw std::invalid_argument("\"" + path + "\" is empty, buffers can't be.");
+	}
+
+	vk::Device* device = this->virtual_device->get_vulkan_device();
+	UploadedBuffer uploaded;
+	uploaded.size = staged.size();
+
+	try {
+		uploaded.buffer = device->createBuffer(vk::BufferCreateInfo(
+			{},
+			uploaded.size,
+			usage | vk::BufferUsageFlagBits::eTransferDst,
+			vk::SharingMode::eExclusive
+		));
+		uploaded.memory = this->allocate_device_local(device->getBufferMemoryRequirements(uploaded.buffer));
+		device->bindBufferMemory(uploaded.buffer, uploaded.memory, 0);
+	}
+	catch (...) {
+		this->staging_used = stagingOffset;
+		device->destroyBuffer(uploaded.buffer);
+		device->freeMemory(uploaded.memory);
+		throw;
+	}
+
+	this->get_recording_command_buffer().copyBuffer(this->staging_buffer, uploaded.buffer, vk::BufferCopy(stagingOffset, 0, uploaded.size));
+
+	return uploaded;
+}
+
+std::span<std::byte> StagingUploader::stage_file(const std::string& path, vk::DeviceSize& staging_offset) {
+	vk::DeviceSize size;
+	if (this->file_system != nullptr) {
+		size = this->file_system->get_size(path);
+	}
+	else {
+		std::error_code errorCode;
+		size = std::filesystem::file_size(path, errorCode);
+		if (errorCode) {
+			throw std::runtime_error("Couldn't find \"" + path + "\": " + errorCode.message());
+		}
+	}
+
+	if (size > this->staging_size) {
+		throw std::invalid_argument("\"" + path + "\" is larger than the " + std::to_string(this->staging_size) + " byte staging buffer.");
+	}
+
+	vk::DeviceSize offset = (this->staging_used + this->staging_alignment - 1) / this->staging_alignment * this->staging_alignment;
+	if (offset + size > this->staging_size) {
+		this->flush();
+		offset = 0;
+	}
+
+	// The only pass over the file's bytes on the CPU: read or decompressed right where the
+	// GPU copies them from.
+	std::span<std::byte> destination(this->staging_data + offset, static_cast<size_t>(size));
+	if (this->file_system != nullptr) {
+		this->file_system->read_into(path, destination, this->pool);
+	}
+	else {
+		std::ifstream stream(path, std::ios::binary);
+		stream.read(reinterpret_cast<char*>(destination.data()), static_cast<std::streamsize>(destination.size()));
+		if (!stream) {
+			throw std::runtime_error("Couldn't read \"" + path + "\".");
+		}
+	}
+
+	this->staging_used = offset + size;
+	staging_offset = offset;
+	return destination;
+}
+
+void StagingUploader::flush() {
+	if (!this->recording) {
+		this->staging_used = 0;
+		return;
+	}
+
+	vk::CommandBuffer& commandBuffer = this->command_pool->get_command_buffer(UPLOAD_COMMAND_BUFFER);
+
+	// Later submissions see the copied data whatever they read it with.
+	commandBuffer.pipelineBarrier(
+		vk::PipelineStageFlagBits::eTransfer,
+		vk::PipelineStageFlagBits::eAllCommands,
+		{},
+		vk::MemoryBarrier(vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eMemoryRead),
+		nullptr,
+		nullptr
+	);
+
+	this->command_pool->stop_recording_command_buffer(UPLOAD_COMMAND_BUFFER);
+	this->recording = false;
+
+	vk::SubmitInfo submitInfo;
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &commandBuffer;
+	this->virtual_device->queues.graphics.submit(submitInfo, this->upload_fence);
+
+	vk::Device* device = this->virtual_device->get_vulkan_device();
+	if (device->waitForFences(this->upload_fence, VK_TRUE, std::numeric_limits<uint64_t>::max()) != vk::Result::eSuccess) {
+		throw std::runtime_error("Waiting for the asset uploads failed.");
+	}
+	device->resetFences(this->upload_fence);
+	commandBuffer.reset();
+
+	this->staging_used = 0;
+}
+
+vk::DeviceMemory StagingUploader::allocate_device_local(vk::MemoryRequirements requirements) {
+	// One allocation per asset until the backend has a suballocator.
+	std::optional<uint32_t> memoryType = this->virtual_device->find_memory_type(requirements.memoryTypeBits, vk::MemoryPropertyFlagBits::eDeviceLocal);
+	if (!memoryType.has_value()) {
+		throw std::runtime_error("The GPU has no device local memory for the asset.");
+	}
+
+	return this->virtual_device->get_vulkan_device()->allocateMemory(vk::MemoryAllocateInfo(requirements.size, memoryType.value()));
+}
+
+vk::CommandBuffer& StagingUploader::get_recording_command_buffer() {
+	if (!this->recording) {
+		this->command_pool->start_recording_command_buffer(UPLOAD_COMMAND_BUFFER, vk::CommandBufferUsageFlagBits::eOneTimeSubmit);
+		this->recording = true;
+	}
+	return this->command_pool->get_command_buffer(UPLOAD_COMMAND_BUFFER);
+}
+
+// === Getters ===
+
+vk::DeviceSize StagingUploader::get_staging_size() const {
+	return this->staging_size;
+}
+
+vk::DeviceSize StagingUploader::get_staged_size() const {
+	return this->staging_used;
+}
@@ -0,0 +1,65 @@
+#include "Engine/render_backends/progressive/texture_image.h"
+#include <stdexcept>
+#include <string>
+
+vk::Format TextureImage::get_format(TextureFormat format) {
+	switch (format) {
+	case TextureFormat::RGBA8_UNORM:
+		return vk::Format::eR8G8B8A8Unorm;
+	case TextureFormat::RGBA8_SRGB:
+		return vk::Format::eR8G8B8A8Srgb;
+	case TextureFormat::BC1_UNORM:
+		return vk::Format::eBc1RgbaUnormBlock;
+	case TextureFormat::BC1_SRGB:
+		return vk::Format::eBc1RgbaSrgbBlock;
+	case TextureFormat::BC3_UNORM:
+		return vk::Format::eBc3UnormBlock;
+	case TextureFormat::BC3_SRGB:
+		return vk::Format::eBc3SrgbBlock;
+	case TextureFormat::BC5_UNORM:
+		return vk::Format::eBc5UnormBlock;
+	case TextureFormat::BC7_UNORM:
+		return vk::Format::eBc7UnormBlock;
+	case TextureFormat::BC7_SRGB:
+		return vk::Format::eBc7SrgbBlock;
+	}
+	throw std::invalid_argument("Unknown texture format " + std::to_string(static_cast<uint32_t>(format)) + ".");
+}
+
+vk::ImageCreateInfo TextureImage::get_image_create_info(const TextureFile& texture, vk::ImageUsageFlags usage) {
+	return vk::ImageCreateInfo(
+		{},
+		vk::ImageType::e2D,
+		get_format(texture.get_format()),
+		vk::Extent3D(texture.get_width(), texture.get_height(), 1),
+		texture.get_mip_count(),
+		texture.get_layer_count(),
+		vk::SampleCountFlagBits::e1,
+		vk::ImageTiling::eOptimal,
+		usage,
+		vk::SharingMode::eExclusive,
+		0,
+		nullptr,
+		vk::ImageLayout::eUndefined
+	);
+}
+
+vector<vk::BufferImageCopy> TextureImage::get_copy_regions(const TextureFile& texture, vk::DeviceSize file_offset) {
+	vector<vk::BufferImageCopy> regions;
+	regions.reserve(texture.get_mip_count());
+
+	for (uint32_t mip = 0; mip < texture.get_mip_count(); mip++) {
+		const TextureFileLevel& level = texture.get_level(mip);
+		// A row length and height of 0 mean tightly packed, layers follow each other.
+		regions.push_back(vk::BufferImageCopy(
+			file_offset + level.offset,
+			0,
+			0,
+			vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, mip, 0, texture.get_layer_count()),
+			vk::Offset3D(0, 0, 0),
+			vk::Extent3D(level.width, level.height, 1)
+		));
+	}
+
+	return regions;
+}
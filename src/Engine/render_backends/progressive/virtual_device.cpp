@@ -48,10 +48,10 @@ VirtualDevice::VirtualDevice(Tritium::Engine* engine, SDL_Window* sdl_window, vk
 	suitability = this->vk_measure_physical_device_suitability();
 
 	// This populates the queue family indices
-	QueueFamilyIndices queueFamilyIndices = QueueFamilyIndices(this->vk_physical_device, *vk_surface);
+	this->queue_family_indices = QueueFamilyIndices(this->vk_physical_device, *vk_surface);
 
 	// create the vk::Device
-	this->vk_create_logical_device(queueFamilyIndices);
+	this->vk_create_logical_device(this->queue_family_indices);
 
 	// create the swapchain
 	this->swapchain = std::make_unique<SwapChain>(this->engine, this->sdl_window, &this->vk_physical_device, this, this->vk_surface, vk::ImageUsageFlagBits::eColorAttachment, prefered_present_mode);
@@ -152,6 +152,22 @@ vk::Device* VirtualDevice::get_vulkan_device() {
 	return &this->vk_device;
 }
 
+vk::PhysicalDevice* VirtualDevice::get_physical_device() {
+	return &this->vk_physical_device;
+}
+
+std::optional<uint32_t> VirtualDevice::find_memory_type(uint32_t type_bits, vk::MemoryPropertyFlags properties) const {
+	vk::PhysicalDeviceMemoryProperties memoryProperties = this->vk_physical_device.getMemoryProperties();
+
+	for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++) {
+		if ((type_bits & (1u << i)) != 0 && (memoryProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+			return i;
+		}
+	}
+
+	return std::nullopt;
+}
+
 uint64_t VirtualDevice::vk_measure_physical_device_suitability() {
 	uint64_t score = 0;
 	vk::PhysicalDeviceProperties physicalDeviceProperties = this->vk_physical_device.getProperties();
@@ -1,19 +1,48 @@
 // See .h file for comment explanations of === header === sections
 #include "Engine/render_backends/render_backend.h"
 #include "Engine/engine.h"
+#include "Engine/mesh/mesh_lods.h"
+#include "Engine/scene/scene.h"
+#include "Engine/scene/scene_streamer.h"
+#include "Engine/thread_pool/thread_pool.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <iostream>
 #include <stdexcept>
+#include <thread>
 
 // CODE FORMATTING INFORMATION:
 // Simple functions like getters and setters go at the bottom.
 // Organize from most complex at the top to least complex at the bottom.
 // Unless it makes more sense to put a specific function above another.
 
+REGISTER_COMPONENT(MeshLods);
+
+static constexpr size_t WORLD_MATRIX_COPY_CHUNK_SIZE = 4096;
+
+static constexpr int DEFAULT_LOD_VIEWPORT_HEIGHT = 1080;
+/// Pixels LOD errors are measured in when there's no window, e.g. with the headless backend.
+
+static constexpr float MIN_LOD_DISTANCE = 0.001f;
+/// Keeps the projected error finite for bounds reaching behind the camera.
+
 RenderBackend::RenderBackend(
 	Tritium::Engine* engine
 ) :
 	engine(engine)
 {
+	// Queries recorded in one fixed update phase are answered before the next phase runs.  The
+	// draw loop updates the BVH outside the fixed update callbacks' lock, so it has its own.
+	this->on_fixed_update_callbacks.set_phase_end_callback([this]() {
+		if (this->scene == nullptr) {
+			this->scene_queries.execute(nullptr);
+			return;
+		}
+
+		std::lock_guard<std::mutex> lock(this->visibility.get_bvh_mutex());
+		this->scene_queries.execute(&this->visibility.get_bvh());
+	});
 };
 
 bool RenderBackend::start_window(string window_title, int window_width, int window_height) {
@@ -23,28 +52,34 @@ bool RenderBackend::start_window(string window_title, int window_width, int wind
 	this->before_start_window(window_title, window_width, window_height);
 	
 	// === Start SDL2 ===
-	if (SDL_Init(SDL_INIT_VIDEO) != 0) {
+	if (SDL_Init(this->sdl_init_flags) != 0) {
 		throw std::runtime_error(string("SDL_Init failed: ") + SDL_GetError());
 		return false;
 	}
 
-	this->sdl_window = SDL_CreateWindow(
-		window_title.c_str(),
-		SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
-		window_width, window_height,
-		this->sdl_window_flags
-	);
+	// Headless backends run the game loop without a window.
+	if (this->creates_window) {
+		this->sdl_window = SDL_CreateWindow(
+			window_title.c_str(),
+			SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
+			window_width, window_height,
+			this->sdl_window_flags
+		);
 
-	if (!this->sdl_window) {
-		SDL_Quit();
-		throw std::runtime_error(string("SDL_Init failed: ") + SDL_GetError());
-		return false;
+		if (!this->sdl_window) {
+			SDL_Quit();
+			throw std::runtime_error(string("SDL_Init failed: ") + SDL_GetError());
+			return false;
+		}
 	}
 
 	// === Start the loop that renders the game ===
 	this->start_game_loop();
 
-	SDL_DestroyWindow(this->sdl_window);
+	if (this->sdl_window != nullptr) {
+		SDL_DestroyWindow(this->sdl_window);
+		this->sdl_window = nullptr;
+	}
 	
 	SDL_Quit();
 
@@ -56,67 +91,704 @@ void RenderBackend::start_game_loop() {
 	// Initialize render backend api
 	this->before_game_loop();
 
-	Uint32 lastTime = SDL_GetTicks();
+	this->game_loop_start_counter = SDL_GetPerformanceCounter();
+	this->last_frame_counter = this->game_loop_start_counter;
+	this->simulated_time_nanoseconds = 0;
+	this->fixed_update_accumulator = 0.0;
+	this->fixed_update_tick_count = 0;
+	this->frame_statistics = FrameStatistics();
+	this->frame_pacer.reset();
+	this->scene_queries.set_thread_pool(this->engine->thread_pool);
+
+	const bool replaying = this->event_replayer != nullptr;
+	const bool fixedStep = this->fixed_frame_delta_time > 0.0f || replaying;
+
+	// Whatever stops the loop, both threads are joined and the render backend api is
+	// deinitialized before the first exception is rethrown.  Throwing past a joinable thread
+	// would terminate the process.
+	std::exception_ptr firstException;
+	auto captureException = [&firstException](const std::function<void()>& step) {
+		try {
+			step();
+		}
+		catch (...) {
+			if (!firstException) {
+				firstException = std::current_exception();
+			}
+		}
+	};
+
+	captureException([this, fixedStep]() {
+		// Start loop
+		this->window_running = true;
+
+		// Frames are drawn on the render thread while the next one is simulated here.
+		this->start_render_thread();
+
+		// In real time the fixed update loop runs alongside this loop on its own thread,
+		// with a fixed frame step or a replay it is stepped from this loop instead so runs are repeatable.
+		if (!fixedStep) {
+			this->start_fixed_update_game_loop();
+		}
+
+		this->game_loop(fixedStep);
+	});
+
+	this->window_running = false;
+
+	// Wait for the last fixed update tick and the last frame before tearing down the render backend api
+	captureException([this]() { this->stop_fixed_update_game_loop(); });
+	captureException([this]() { this->stop_render_thread(); });
+
+	this->event_recorder.reset();
+	this->event_replayer.reset();
+	
+	// Deinitialize render backend api
+	captureException([this]() { this->after_game_loop(); });
+
+	if (firstException) {
+		std::rethrow_exception(firstException);
+	}
+}
+
+void RenderBackend::game_loop(bool fixed_step) {
+	const Uint64 counterFrequency = SDL_GetPerformanceFrequency();
+	const bool replaying = this->event_replayer != nullptr;
+
+	uint64_t recordedFixedUpdateTicks = 0;
 
-	// Start loop
-	this->window_running = true;
 	while (this->window_running) {
-		
+		Uint64 frameStartCounter = SDL_GetPerformanceCounter();
+
+		RecordedFrame replayFrame;
+		if (replaying && !this->event_replayer->next_frame(replayFrame)) {
+			// The whole recording has been played.
+			break;
+		}
+
 		// Get delta_time
-		
-		Uint32 currentTime = SDL_GetTicks();
-		
-		this->delta_time = (currentTime - lastTime) / 1000.0f; // seconds
-		
-		lastTime = currentTime;
+		this->update_time(
+			frameStartCounter,
+			replaying ? replayFrame.header.delta_time : this->fixed_frame_delta_time
+		);
+
+		FramePacket& framePacket = this->frame_packets[this->frame_packet_write_index];
+		framePacket.reset();
+		framePacket.frame_index = this->frame_statistics.frame_count;
+		framePacket.delta_time = this->delta_time;
+		framePacket.time_nanoseconds = this->time_nanoseconds;
 		
 		// SDL Event Handling
-		SDL_Event event;
-		while (SDL_PollEvent(&event)) {
-			this->SDL_forward_event(event);
+		this->event_bus.clear();
+
+		SDL_Event sdl_event;
+		while (SDL_PollEvent(&sdl_event)) {
+			this->SDL_forward_event(sdl_event);
+		}
+
+		if (replaying) {
+			for (const InputEvent& inputEvent : replayFrame.input_events) {
+				this->event_bus.push_input_event(inputEvent);
+			}
+			for (const WindowEvent& windowEvent : replayFrame.window_events) {
+				this->event_bus.push_window_event(windowEvent);
+			}
+		}
+
+		// Subscribers see this frame's events before any draw update callback runs.
+		this->event_bus.dispatch(this->engine->thread_pool);
+
+		int steppedFixedUpdateTicks = 0;
+		if (replaying) {
+			// Run exactly the ticks the recorded run did.
+			for (uint32_t i = 0; i < replayFrame.header.fixed_update_ticks; i++) {
+				this->fixed_update_game();
+			}
+			this->fixed_update_interpolation_alpha.store(
+				replayFrame.header.fixed_update_interpolation_alpha,
+				std::memory_order_relaxed
+			);
+		}
+		else if (fixed_step) {
+			steppedFixedUpdateTicks = this->step_fixed_update(this->delta_time);
+		}
+
+		// Recorded after stepping, a replay runs the ticks after dispatching the events too.
+		if (this->event_recorder != nullptr) {
+			uint32_t fixedUpdateTicks = static_cast<uint32_t>(steppedFixedUpdateTicks);
+			if (!fixed_step) {
+				// Whatever the fixed update thread finished since the last recorded frame.
+				uint64_t tickCount = this->fixed_update_tick_count.load(std::memory_order_relaxed);
+				fixedUpdateTicks = static_cast<uint32_t>(tickCount - recordedFixedUpdateTicks);
+				recordedFixedUpdateTicks = tickCount;
+			}
+
+			this->event_recorder->record_frame(
+				this->delta_time,
+				this->get_fixed_update_interpolation_alpha(),
+				fixedUpdateTicks,
+				this->event_bus.get_input_events(),
+				this->event_bus.get_window_events()
+			);
 		}
 
 		this->execute_on_draw_update_callbacks();
+
+		this->update_scene(framePacket);
+
+		framePacket.fixed_update_interpolation_alpha = this->get_fixed_update_interpolation_alpha();
 		
-		// Update the game
-		this->update_game();
+		// Hand the frame to the render thread
+		this->submit_frame_packet();
+
+		this->frame_statistics.add_frame(
+			static_cast<double>(SDL_GetPerformanceCounter() - frameStartCounter) / counterFrequency
+		);
+
+		if (this->max_frame_count > 0 && this->frame_statistics.frame_count >= this->max_frame_count) {
+			this->window_running = false;
+		}
+
+		// Wait out the rest of the frame if we are running faster than the cap.
+		this->frame_pacer.wait_for_next_frame(this->get_paced_frames_per_second());
+	}
+}
+
+// === Render Thread ===
+
+void RenderBackend::start_render_thread() {
+	this->frame_packets.clear();
+	this->frame_packets.resize(static_cast<size_t>(this->max_frames_in_flight) + 1);
+	this->frame_packet_write_index = 0;
+	this->frame_packet_read_index = 0;
+	this->queued_frame_packet_count = 0;
+	this->render_thread_exception = nullptr;
+
+	if (!this->render_thread_enabled) {
+		return;
+	}
+
+	this->render_thread_running = true;
+	this->render_thread = std::thread(&RenderBackend::render_thread_main, this);
+}
+
+void RenderBackend::stop_render_thread() {
+	if (!this->render_thread.joinable()) {
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(this->frame_packet_mutex);
+		this->render_thread_running = false;
+	}
+	this->frame_packet_cv.notify_all();
+
+	this->render_thread.join();
+
+	if (this->render_thread_exception) {
+		std::rethrow_exception(this->render_thread_exception);
+	}
+}
+
+void RenderBackend::render_thread_main() {
+	try {
+		while (true) {
+			size_t readIndex;
+			{
+				std::unique_lock<std::mutex> lock(this->frame_packet_mutex);
+				this->frame_packet_cv.wait(lock, [this] {
+					return this->queued_frame_packet_count > 0 || !this->render_thread_running;
+				});
+
+				// Finish drawing what was queued before stopping.
+				if (this->queued_frame_packet_count == 0) {
+					break;
+				}
+
+				readIndex = this->frame_packet_read_index;
+			}
+
+			// The packet belongs to this thread until it is released below.
+			this->render_frame(this->frame_packets[readIndex]);
+
+			{
+				std::lock_guard<std::mutex> lock(this->frame_packet_mutex);
+				this->frame_packet_read_index = (readIndex + 1) % this->frame_packets.size();
+				this->queued_frame_packet_count--;
+			}
+			this->frame_packet_cv.notify_all();
+		}
+	}
+	catch (...) {
+		std::lock_guard<std::mutex> lock(this->frame_packet_mutex);
+		this->render_thread_exception = std::current_exception();
+		this->render_thread_running = false;
+		this->window_running = false;
+
+		// Release the game loop if it is waiting on a packet slot.
+		this->queued_frame_packet_count = 0;
+		this->frame_packet_cv.notify_all();
+	}
+}
+
+void RenderBackend::submit_frame_packet() {
+	if (!this->render_thread_enabled) {
+		this->render_frame(this->frame_packets[this->frame_packet_write_index]);
+		return;
+	}
+
+	{
+		std::unique_lock<std::mutex> lock(this->frame_packet_mutex);
+
+		// Bound the latency: don't get more than `max_frames_in_flight` frames ahead.
+		this->frame_packet_cv.wait(lock, [this] {
+			return this->queued_frame_packet_count < static_cast<size_t>(this->max_frames_in_flight)
+				|| !this->render_thread_running;
+		});
+
+		if (!this->render_thread_running) {
+			return;
+		}
+
+		this->queued_frame_packet_count++;
+		this->frame_packet_write_index = (this->frame_packet_write_index + 1) % this->frame_packets.size();
+	}
+	this->frame_packet_cv.notify_all();
+}
+
+void RenderBackend::render_frame(FramePacket& frame_packet) {
+	for (auto& renderCommand : frame_packet.render_commands) {
+		renderCommand();
+	}
+
+	this->update_game(frame_packet);
+}
+
+void RenderBackend::enqueue_render_command(std::function<void()> render_command) {
+	std::lock_guard<std::mutex> lock(this->render_command_mutex);
+	if (this->frame_packets.empty()) {
+		throw std::runtime_error("Render commands can only be enqueued while the game loop is running.");
+	}
+	this->frame_packets[this->frame_packet_write_index].render_commands.push_back(std::move(render_command));
+}
+
+// === Recording / Replay ===
+
+void RenderBackend::start_recording(const string& output_path) {
+	this->event_recorder = std::make_unique<EventRecorder>(
+		output_path,
+		static_cast<uint32_t>(this->fixed_update_ticks_per_second.load())
+	);
+}
+
+void RenderBackend::start_replay(const string& input_path) {
+	this->event_replayer = std::make_unique<EventReplayer>(input_path);
+	this->set_fixed_update_ticks_per_second(static_cast<int>(this->event_replayer->get_header().fixed_update_ticks_per_second));
+}
+
+// === Fixed Update Loop ===
+
+void RenderBackend::start_fixed_update_game_loop() {
+	if (this->engine == nullptr || this->engine->thread_pool == nullptr) {
+		throw std::runtime_error("The fixed update loop requires an engine with a thread pool.");
+	}
+
+	this->fixed_update_loop_exception = nullptr;
+
+	// The loop lives for the whole game loop, so it gets its own thread instead of holding a worker.
+	this->fixed_update_thread = std::thread([this]() {
+		try {
+			this->fixed_update_game_loop();
+		}
+		catch (...) {
+			// Handed to the draw loop's thread, which rethrows it once it joined this one.
+			this->fixed_update_loop_exception = std::current_exception();
+			this->window_running = false;
+		}
+	});
+}
+
+void RenderBackend::fixed_update_game_loop() {
+	const double counterFrequency = static_cast<double>(SDL_GetPerformanceFrequency());
+	Uint64 lastCounter = SDL_GetPerformanceCounter();
+
+	while (this->window_running.load(std::memory_order_acquire)) {
+		Uint64 currentCounter = SDL_GetPerformanceCounter();
+		this->step_fixed_update((currentCounter - lastCounter) / counterFrequency);
+		lastCounter = currentCounter;
+
+		// Sleep until the next tick is due.
+		double tickDuration = this->get_fixed_update_delta_time();
+		std::this_thread::sleep_for(std::chrono::duration<double>(tickDuration - this->fixed_update_accumulator));
+	}
+}
+
+int RenderBackend::step_fixed_update(double elapsed_seconds) {
+	const double tickDuration = this->get_fixed_update_delta_time();
+	const int maxCatchUpTicks = this->fixed_update_max_catch_up_ticks.load(std::memory_order_relaxed);
+
+	this->fixed_update_accumulator += elapsed_seconds;
+
+	int ticks = 0;
+	while (this->fixed_update_accumulator >= tickDuration && ticks < maxCatchUpTicks) {
+		this->fixed_update_game();
+		this->fixed_update_accumulator -= tickDuration;
+		ticks++;
+	}
+
+	// We fell too far behind, drop the time we couldn't catch up on so the next
+	// step doesn't try to simulate even more ticks (spiral of death).
+	if (this->fixed_update_accumulator >= tickDuration) {
+		this->fixed_update_accumulator = std::fmod(this->fixed_update_accumulator, tickDuration);
+	}
+
+	this->fixed_update_interpolation_alpha.store(
+		static_cast<float>(this->fixed_update_accumulator / tickDuration),
+		std::memory_order_relaxed
+	);
+
+	return ticks;
+}
+
+void RenderBackend::stop_fixed_update_game_loop() {
+	if (!this->fixed_update_thread.joinable()) {
+		return;
+	}
+
+	// `window_running` is already false here, the loop exits after its current tick.
+	this->fixed_update_thread.join();
+
+	if (this->fixed_update_loop_exception) {
+		std::exception_ptr exception = this->fixed_update_loop_exception;
+		this->fixed_update_loop_exception = nullptr;
+		std::rethrow_exception(exception);
 	}
-	
-	// Deinitialize render backend api
-	this->after_game_loop();
+}
+
+void RenderBackend::fixed_update_game() {
+	this->execute_on_fixed_update_callbacks();
+
+	this->fixed_update_tick_count.fetch_add(1, std::memory_order_relaxed);
+}
+
+void RenderBackend::update_time(Uint64 current_counter, float simulated_delta_time) {
+	const Uint64 counterFrequency = SDL_GetPerformanceFrequency();
+
+	// With a fixed frame step or a replay every frame simulates a set amount of time
+	// no matter how long it really took.
+	if (simulated_delta_time > 0.0f) {
+		this->delta_time = simulated_delta_time;
+		this->simulated_time_nanoseconds += static_cast<Uint64>(simulated_delta_time * 1000000000.0);
+		this->time_nanoseconds = static_cast<long int>(this->simulated_time_nanoseconds);
+		this->time_milliseconds = this->time_nanoseconds / 1000000;
+		this->time_seconds = this->time_nanoseconds / 1000000000;
+		return;
+	}
+
+	this->delta_time = static_cast<float>(
+		static_cast<double>(current_counter - this->last_frame_counter) / counterFrequency
+	);
+	this->last_frame_counter = current_counter;
+
+	// Split into whole seconds and the remainder so the nanosecond conversion can't overflow.
+	Uint64 elapsed = current_counter - this->game_loop_start_counter;
+	Uint64 elapsedSeconds = elapsed / counterFrequency;
+	Uint64 remainderNanoseconds = (elapsed % counterFrequency) * 1000000000ull / counterFrequency;
+
+	this->time_seconds = static_cast<long int>(elapsedSeconds);
+	this->time_nanoseconds = static_cast<long int>(elapsedSeconds * 1000000000ull + remainderNanoseconds);
+	this->time_milliseconds = this->time_nanoseconds / 1000000;
+}
+
+int RenderBackend::get_paced_frames_per_second() {
+	int framesPerSecond = this->target_frames_per_second;
+
+	if (this->sdl_window == nullptr) {
+		return framesPerSecond;
+	}
+
+	// Pick the lowest cap that applies, 0 means no cap.
+	auto applyCap = [&framesPerSecond](int cap) {
+		if (cap > 0 && (framesPerSecond <= 0 || cap < framesPerSecond)) {
+			framesPerSecond = cap;
+		}
+	};
+
+	Uint32 sdl_windowFlags = SDL_GetWindowFlags(this->sdl_window);
+
+	if (sdl_windowFlags & SDL_WINDOW_MINIMIZED) {
+		applyCap(this->minimized_frames_per_second);
+	}
+	else if (!(sdl_windowFlags & SDL_WINDOW_INPUT_FOCUS)) {
+		applyCap(this->unfocused_frames_per_second);
+	}
+
+	return framesPerSecond;
 }
 
 // === SDL EVENT FORWARDER ===
 
-void RenderBackend::SDL_forward_event(SDL_Event event) {
-	if (event.type == SDL_QUIT) {
+void RenderBackend::SDL_forward_event(const SDL_Event& sdl_event) {
+	if (sdl_event.type == SDL_QUIT) {
 		this->window_running = false;
 	}
-	// TODO: Forward events to an event handling system
+
+	// During a replay the recorded events stand in for live input.
+	if (this->event_replayer != nullptr) {
+		return;
+	}
+
+	this->event_bus.push_SDL_event(sdl_event);
+}
+
+// === Scene ===
+
+void RenderBackend::update_scene(FramePacket& frame_packet) {
+	if (this->scene == nullptr) {
+		frame_packet.views.clear();
+		return;
+	}
+
+	// Fixed update callbacks can write any component and move nodes from the fixed update
+	// thread, so no tick runs until the visible nodes' matrices were copied into the packet.
+	std::lock_guard<std::recursive_mutex> lock(this->on_fixed_update_callbacks_mutex);
+	if (this->scene_streamer != nullptr) {
+		this->scene_streamer->update();
+	}
+	this->scene->play_back_commands(this->engine->thread_pool);
+	this->scene->update_world_transforms(this->engine->thread_pool);
+
+	this->visibility.update(*this->scene);
+	this->cull_views(frame_packet);
+}
+
+void RenderBackend::cull_views(FramePacket& frame_packet) {
+	{
+		std::lock_guard<std::mutex> lock(this->view_mutex);
+		frame_packet.views.resize(this->view_projections.size());
+		for (size_t i = 0; i < this->view_projections.size(); i++) {
+			frame_packet.views[i].view_projection = this->view_projections[i];
+		}
+	}
+
+	ThreadPool::Pool* pool = this->engine->thread_pool;
+	ComponentStore& components = this->scene->get_components();
+
+	int viewportHeight = DEFAULT_LOD_VIEWPORT_HEIGHT;
+	if (this->sdl_window != nullptr) {
+		int viewportWidth;
+		SDL_GetWindowSize(this->sdl_window, &viewportWidth, &viewportHeight);
+	}
+
+	for (FrameView& view : frame_packet.views) {
+		this->visibility.cull(Frustum::from_view_projection(view.view_projection), view.visible_nodes, pool);
+
+		// A point's distance along the view axis is its clip w, and one unit at w = 1 covers the
+		// projection's y scale times half the viewport vertically.  For orthographic views the w
+		// row has no direction and every distance is 1.
+		const glm::mat4& viewProjection = view.view_projection;
+		const glm::vec4 clipW(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]);
+		const float clipWScale = glm::length(glm::vec3(clipW));
+		const float pixelsPerUnit = glm::length(glm::vec3(viewProjection[0][1], viewProjection[1][1], viewProjection[2][1])) * viewportHeight * 0.5f;
+		const float maxPixelError = this->lod_pixel_error;
+
+		// The render thread can't read the scene, so it gets copies of the matrices.
+		view.world_matrices.resize(view.visible_nodes.size());
+		view.lods.resize(view.visible_nodes.size());
+		auto copy_matrices = [&, this](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++) {
+				const glm::mat4& worldMatrix = this->scene->get_world_matrix(view.visible_nodes[i]);
+				view.world_matrices[i] = worldMatrix;
+				view.lods[i] = 0;
+
+				const MeshLods* lods = components.get_component<const MeshLods>(view.visible_nodes[i]);
+				const Bounds* bounds = components.get_component<const Bounds>(view.visible_nodes[i]);
+				if (lods == nullptr || bounds == nullptr || maxPixelError <= 0.0f) {
+					continue;
+				}
+
+				// The error is taken at the point of the bounding sphere nearest to the camera.
+				const float worldScale = std::sqrt(std::max({
+					glm::dot(glm::vec3(worldMatrix[0]), glm::vec3(worldMatrix[0])),
+					glm::dot(glm::vec3(worldMatrix[1]), glm::vec3(worldMatrix[1])),
+					glm::dot(glm::vec3(worldMatrix[2]), glm::vec3(worldMatrix[2]))
+				}));
+				const glm::vec4 center = worldMatrix * glm::vec4(bounds->local.get_center(), 1.0f);
+				const float radius = glm::length(bounds->local.max - bounds->local.min) * 0.5f * worldScale;
+				const float distance = std::max(glm::dot(clipW, center) - radius * clipWScale, MIN_LOD_DISTANCE);
+
+				view.lods[i] = lods->select(pixelsPerUnit * worldScale / distance, maxPixelError);
+			}
+		};
+
+		if (pool != nullptr) {
+			pool->parallel_for(view.visible_nodes.size(), WORLD_MATRIX_COPY_CHUNK_SIZE, copy_matrices);
+		}
+		else {
+			copy_matrices(0, view.visible_nodes.size());
+		}
+	}
+}
+
+size_t RenderBackend::add_view(const glm::mat4& view_projection) {
+	std::lock_guard<std::mutex> lock(this->view_mutex);
+	this->view_projections.push_back(view_projection);
+	return this->view_projections.size() - 1;
+}
+
+void RenderBackend::set_view(size_t view, const glm::mat4& view_projection) {
+	std::lock_guard<std::mutex> lock(this->view_mutex);
+	if (view >= this->view_projections.size()) {
+		throw std::out_of_range("View index out of range.");
+	}
+	this->view_projections[view] = view_projection;
+}
+
+void RenderBackend::clear_views() {
+	std::lock_guard<std::mutex> lock(this->view_mutex);
+	this->view_projections.clear();
+}
+
+void RenderBackend::set_lod_pixel_error(float max_pixel_error) {
+	this->lod_pixel_error = std::max(0.0f, max_pixel_error);
+}
+
+Visibility& RenderBackend::get_visibility() {
+	return this->visibility;
+}
+
+SceneQueries& RenderBackend::get_scene_queries() {
+	return this->scene_queries;
+}
+
+void RenderBackend::set_scene(Scene* scene) {
+	if (this->scene != nullptr) {
+		this->scene->set_destroy_listener(nullptr);
+	}
+
+	this->scene = scene;
+	this->visibility.clear();
+
+	if (this->scene != nullptr) {
+		// Destroyed nodes' callbacks go with them, otherwise they would keep running.
+		this->scene->set_destroy_listener([this](std::span<const NodeHandle> nodes) {
+			std::lock_guard<std::recursive_mutex> lock(this->on_fixed_update_callbacks_mutex);
+			for (NodeHandle node : nodes) {
+				this->on_draw_update_callbacks.remove(node);
+				this->on_fixed_update_callbacks.remove(node);
+			}
+			this->visibility.remove_nodes(nodes);
+		});
+	}
+}
+
+Scene* RenderBackend::get_scene() {
+	return this->scene;
+}
+
+void RenderBackend::set_scene_streamer(SceneStreamer* scene_streamer) {
+	this->scene_streamer = scene_streamer;
 }
 
 // === Callback Functions ===
 
 void RenderBackend::execute_on_draw_update_callbacks() {
-	for (const auto& [nodeID, callback] : this->on_draw_update_callbacks) {
-		callback(this->delta_time);
+	this->on_draw_update_callbacks.execute(this->engine->thread_pool, this->delta_time);
+}
+
+void RenderBackend::execute_on_fixed_update_callbacks() {
+	std::lock_guard<std::recursive_mutex> lock(this->on_fixed_update_callbacks_mutex);
+	{
+		std::lock_guard<std::mutex> changesLock(this->fixed_update_callback_changes_mutex);
+		this->executing_fixed_update_callbacks = true;
+		this->fixed_update_callbacks_thread = std::this_thread::get_id();
+	}
+
+	try {
+		this->on_fixed_update_callbacks.execute(this->engine->thread_pool);
+	}
+	catch (...) {
+		this->finish_fixed_update_callbacks();
+		throw;
+	}
+	this->finish_fixed_update_callbacks();
+}
+
+void RenderBackend::finish_fixed_update_callbacks() {
+	vector<std::function<void()>> changes;
+	{
+		std::lock_guard<std::mutex> changesLock(this->fixed_update_callback_changes_mutex);
+		this->executing_fixed_update_callbacks = false;
+		changes.swap(this->fixed_update_callback_changes);
+	}
+
+	// In the order they were made, a remove after an add of the same node wins.
+	for (std::function<void()>& change : changes) {
+		change();
 	}
 }
 
-void RenderBackend::add_on_draw_update_callback(int nodeID, std::function<void(float)> callback) {
-	this->on_draw_update_callbacks.insert_or_assign(nodeID, callback);
+bool RenderBackend::is_in_fixed_update_tick() const {
+	ThreadPool::Pool* pool = this->engine->thread_pool;
+	return this->executing_fixed_update_callbacks
+		&& (std::this_thread::get_id() == this->fixed_update_callbacks_thread
+			|| (pool != nullptr && pool->get_current_worker_index() < pool->thread_count));
+}
+
+void RenderBackend::add_on_draw_update_callback(NodeHandle node, std::function<void(float)> callback, int phase, bool serial) {
+	this->on_draw_update_callbacks.add(node, std::move(callback), phase, serial);
+}
+
+void RenderBackend::remove_on_draw_update_callback(NodeHandle node) {
+	this->on_draw_update_callbacks.remove(node);
 }
 
-void RenderBackend::remove_on_draw_update_callback(int nodeID) {
-	this->on_draw_update_callbacks.erase(nodeID);
+void RenderBackend::add_on_fixed_update_callback(NodeHandle node, std::function<void()> callback, int phase, bool serial) {
+	// Checked up front, a deferred add can't throw to its caller anymore.
+	if (node.is_null()) {
+		throw std::invalid_argument("Callbacks can't be added for a null node.");
+	}
+
+	// Made from inside a tick, waiting for the lock the tick holds would never end.
+	{
+		std::lock_guard<std::mutex> changesLock(this->fixed_update_callback_changes_mutex);
+		if (this->is_in_fixed_update_tick()) {
+			this->fixed_update_callback_changes.push_back([this, node, callback = std::move(callback), phase, serial]() mutable {
+				this->on_fixed_update_callbacks.add(node, std::move(callback), phase, serial);
+			});
+			return;
+		}
+	}
+
+	std::lock_guard<std::recursive_mutex> lock(this->on_fixed_update_callbacks_mutex);
+	this->on_fixed_update_callbacks.add(node, std::move(callback), phase, serial);
+}
+
+void RenderBackend::remove_on_fixed_update_callback(NodeHandle node) {
+	{
+		std::lock_guard<std::mutex> changesLock(this->fixed_update_callback_changes_mutex);
+		if (this->is_in_fixed_update_tick()) {
+			this->fixed_update_callback_changes.push_back([this, node]() {
+				this->on_fixed_update_callbacks.remove(node);
+			});
+			return;
+		}
+	}
+
+	std::lock_guard<std::recursive_mutex> lock(this->on_fixed_update_callbacks_mutex);
+	this->on_fixed_update_callbacks.remove(node);
 }
 
-void RenderBackend::add_on_fixed_update_callback(int nodeID, std::function<void()> callback) {
-	this->on_fixed_update_callbacks.insert_or_assign(nodeID, callback);
+void RenderBackend::set_callback_chunk_size(size_t chunk_size) {
+	this->on_draw_update_callbacks.set_chunk_size(chunk_size);
+	std::lock_guard<std::recursive_mutex> lock(this->on_fixed_update_callbacks_mutex);
+	this->on_fixed_update_callbacks.set_chunk_size(chunk_size);
 }
 
-void RenderBackend::remove_on_fixed_update_callback(int nodeID) {
-	this->on_fixed_update_callbacks.erase(nodeID);
+// === Events ===
+
+EventBus* RenderBackend::get_event_bus() {
+	return &this->event_bus;
 }
 
 // === Time / Time Scale ===
@@ -134,6 +806,70 @@ long int RenderBackend::get_time_nanoseconds() {
 	return this->time_nanoseconds;
 }
 
+void RenderBackend::FrameStatistics::add_frame(double frame_seconds) {
+	this->frame_count++;
+	this->total_frame_seconds += frame_seconds;
+	this->min_frame_seconds = this->frame_count == 1 ? frame_seconds : std::min(this->min_frame_seconds, frame_seconds);
+	this->max_frame_seconds = std::max(this->max_frame_seconds, frame_seconds);
+}
+
+double RenderBackend::FrameStatistics::get_average_frame_seconds() const {
+	return this->frame_count > 0 ? this->total_frame_seconds / this->frame_count : 0.0;
+}
+
+RenderBackend::FrameStatistics RenderBackend::get_frame_statistics() {
+	return this->frame_statistics;
+}
+
+void RenderBackend::set_fixed_frame_delta_time(float seconds) {
+	this->fixed_frame_delta_time = seconds;
+}
+
+void RenderBackend::set_max_frame_count(uint64_t max_frame_count) {
+	this->max_frame_count = max_frame_count;
+}
+
+void RenderBackend::set_max_frames_in_flight(int max_frames_in_flight) {
+	if (max_frames_in_flight <= 0) {
+		throw std::invalid_argument("Max frames in flight must be greater than 0.");
+	}
+	this->max_frames_in_flight = max_frames_in_flight;
+}
+
+void RenderBackend::set_render_thread_enabled(bool enabled) {
+	this->render_thread_enabled = enabled;
+}
+
+void RenderBackend::set_target_frames_per_second(int frames_per_second) {
+	this->target_frames_per_second = frames_per_second;
+}
+
+void RenderBackend::set_unfocused_frames_per_second(int frames_per_second) {
+	this->unfocused_frames_per_second = frames_per_second;
+}
+
+void RenderBackend::set_minimized_frames_per_second(int frames_per_second) {
+	this->minimized_frames_per_second = frames_per_second;
+}
+
 void RenderBackend::set_fixed_update_ticks_per_second(int ticksPerSecond) {
+	if (ticksPerSecond <= 0) {
+		throw std::invalid_argument("Fixed update ticks per second must be greater than 0.");
+	}
 	this->fixed_update_ticks_per_second = ticksPerSecond;
 }
+
+float RenderBackend::get_fixed_update_delta_time() {
+	return 1.0f / this->fixed_update_ticks_per_second.load(std::memory_order_relaxed);
+}
+
+void RenderBackend::set_fixed_update_max_catch_up_ticks(int max_catch_up_ticks) {
+	if (max_catch_up_ticks <= 0) {
+		throw std::invalid_argument("Fixed update max catch up ticks must be greater than 0.");
+	}
+	this->fixed_update_max_catch_up_ticks = max_catch_up_ticks;
+}
+
+float RenderBackend::get_fixed_update_interpolation_alpha() {
+	return this->fixed_update_interpolation_alpha.load(std::memory_order_relaxed);
+}
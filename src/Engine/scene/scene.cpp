@@ -0,0 +1,858 @@
+#include "Engine/scene/scene.h"
+#include "Engine/scene/scene_file.h"
+#include "Engine/thread_pool/thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+// CODE FORMATTING INFORMATION:
+// Simple functions like getters and setters go at the bottom.
+// Organize from most complex at the top to least complex at the bottom.
+
+static constexpr uint32_t LEVEL_SLACK_DIVISOR = 4;
+static constexpr uint32_t MIN_LEVEL_SLACK = 64;
+/// A re-sort leaves room for a quarter of each level (at least 64 nodes) at its end, so nodes
+// added afterwards can be appended to their level without moving any other level.
+
+static constexpr size_t COMPACTION_DIVISOR = 4;
+/// Destroyed and moved out nodes are compacted once they make up a quarter of the live nodes.
+
+Scene::Scene() {
+	this->level_offsets.push_back(0);
+}
+
+// === World Transform Propagation ===
+
+void Scene::update_world_transforms(ThreadPool::Pool* pool) {
+	this->sort_hierarchy();
+	this->updated_ranges.clear();
+
+	// Collect the dirty nodes in index order, only looking inside flagged blocks.
+	this->dirty_nodes.clear();
+	const uint32_t indexCount = static_cast<uint32_t>(this->index_nodes.size());
+
+	for (size_t block = 0; block < this->dirty_blocks.size(); block++) {
+		if (this->dirty_blocks[block] == 0) {
+			continue;
+		}
+		this->dirty_blocks[block] = 0;
+
+		uint32_t blockBegin = static_cast<uint32_t>(block) * DIRTY_BLOCK_SIZE;
+		uint32_t blockEnd = std::min(blockBegin + DIRTY_BLOCK_SIZE, indexCount);
+
+		for (uint32_t i = blockBegin; i < blockEnd; i++) {
+			if (this->dirty[i] != 0) {
+				this->dirty[i] = 0;
+				this->dirty_nodes.push_back(i);
+			}
+		}
+	}
+
+	if (this->dirty_nodes.empty()) {
+		return;
+	}
+
+	// Walk down the levels.  Each level recomputes the children of everything the level above
+	// recomputed plus its own dirty nodes, merged into sorted runs so a moved subtree root turns
+	// into one contiguous range per level instead of a list of nodes.
+	this->child_ranges.clear();
+	size_t dirtyPosition = 0;
+	size_t depth = 0;
+	const size_t depthCount = this->level_offsets.size() - 1;
+
+	while (!this->child_ranges.empty() || dirtyPosition < this->dirty_nodes.size()) {
+		if (this->child_ranges.empty()) {
+			// Nothing carried down, skip straight to the next level with a dirty node.
+			uint32_t nextDirty = this->dirty_nodes[dirtyPosition];
+			depth = std::upper_bound(this->level_offsets.begin(), this->level_offsets.end(), nextDirty) - this->level_offsets.begin() - 1;
+		}
+
+		if (depth >= depthCount) {
+			break;
+		}
+
+		const uint32_t levelEnd = this->level_offsets[depth + 1];
+
+		// Merge the carried down child ranges with this level's dirty nodes.
+		// A dirty node whose parent was recomputed is already inside a child range.
+		this->level_ranges.clear();
+		auto appendRange = [this](IndexRange range) {
+			if (!this->level_ranges.empty() && range.begin <= this->level_ranges.back().end) {
+				this->level_ranges.back().end = std::max(this->level_ranges.back().end, range.end);
+			}
+			else {
+				this->level_ranges.push_back(range);
+			}
+		};
+
+		size_t childPosition = 0;
+		while (childPosition < this->child_ranges.size()
+			|| (dirtyPosition < this->dirty_nodes.size() && this->dirty_nodes[dirtyPosition] < levelEnd)) {
+
+			bool takeDirty = childPosition == this->child_ranges.size()
+				|| (dirtyPosition < this->dirty_nodes.size()
+					&& this->dirty_nodes[dirtyPosition] < levelEnd
+					&& this->dirty_nodes[dirtyPosition] < this->child_ranges[childPosition].begin);
+
+			if (takeDirty) {
+				uint32_t index = this->dirty_nodes[dirtyPosition++];
+				appendRange(IndexRange{ index, index + 1 });
+			}
+			else {
+				appendRange(this->child_ranges[childPosition++]);
+			}
+		}
+
+		this->propagate_level(pool, this->level_ranges);
+
+		this->child_ranges.clear();
+		for (const IndexRange& range : this->level_ranges) {
+			this->updated_ranges.push_back(range);
+		}
+		this->collect_child_ranges(this->level_ranges, this->child_ranges);
+
+		depth++;
+	}
+}
+
+void Scene::collect_child_ranges(const vector<IndexRange>& ranges, vector<IndexRange>& child_ranges) const {
+	auto appendChildren = [&child_ranges](uint32_t childBegin, uint32_t childEnd) {
+		if (childBegin == childEnd) {
+			return;
+		}
+
+		if (!child_ranges.empty() && child_ranges.back().end == childBegin) {
+			child_ranges.back().end = childEnd;
+		}
+		else {
+			child_ranges.push_back(IndexRange{ childBegin, childEnd });
+		}
+	};
+
+	// Right after a re-sort the children of a run of nodes are one run in the next level.
+	if (this->child_runs_in_order) {
+		for (const IndexRange& range : ranges) {
+			appendChildren(this->first_children[range.begin], this->first_children[range.end - 1] + this->child_counts[range.end - 1]);
+		}
+		return;
+	}
+
+	// Added nodes were appended to the end of their level, so every node's run is looked at and
+	// the runs are put back in index order.
+	bool sorted = true;
+	for (const IndexRange& range : ranges) {
+		for (uint32_t i = range.begin; i < range.end; i++) {
+			if (this->child_counts[i] == 0) {
+				continue;
+			}
+
+			uint32_t childBegin = this->first_children[i];
+			sorted = sorted && (child_ranges.empty() || child_ranges.back().end <= childBegin);
+			appendChildren(childBegin, childBegin + this->child_counts[i]);
+		}
+	}
+
+	if (sorted) {
+		return;
+	}
+
+	std::sort(child_ranges.begin(), child_ranges.end(), [](const IndexRange& a, const IndexRange& b) {
+		return a.begin < b.begin;
+	});
+
+	// Child runs never overlap, only touching ones are merged.
+	size_t merged = 0;
+	for (size_t i = 1; i < child_ranges.size(); i++) {
+		if (child_ranges[merged].end == child_ranges[i].begin) {
+			child_ranges[merged].end = child_ranges[i].end;
+		}
+		else {
+			child_ranges[++merged] = child_ranges[i];
+		}
+	}
+	child_ranges.resize(merged + 1);
+}
+
+void Scene::propagate_level(ThreadPool::Pool* pool, const vector<IndexRange>& ranges) {
+	auto propagate = [this](uint32_t begin, uint32_t end) {
+		for (uint32_t i = begin; i < end; i++) {
+			const glm::mat4 local = compose_local_matrix(
+				this->local_positions[i],
+				this->local_rotations[i],
+				this->local_scales[i]
+			);
+
+			uint32_t parent = this->parents[i];
+			this->world_matrices[i] = parent == INVALID_INDEX ? local : this->world_matrices[parent] * local;
+		}
+	};
+
+	size_t nodeCount = 0;
+	for (const IndexRange& range : ranges) {
+		nodeCount += range.end - range.begin;
+	}
+
+	// Small levels aren't worth waking workers for.
+	if (pool == nullptr || nodeCount <= this->chunk_size) {
+		for (const IndexRange& range : ranges) {
+			propagate(range.begin, range.end);
+		}
+		return;
+	}
+
+	// Split the ranges into chunk sized tasks, every node in a level only reads the level above
+	// so the tasks never touch each others' output.
+	this->propagation_tasks.clear();
+	for (const IndexRange& range : ranges) {
+		for (uint32_t begin = range.begin; begin < range.end; begin += static_cast<uint32_t>(this->chunk_size)) {
+			uint32_t end = static_cast<uint32_t>(std::min<size_t>(begin + this->chunk_size, range.end));
+			this->propagation_tasks.push_back(IndexRange{ begin, end });
+		}
+	}
+
+	pool->parallel_for(this->propagation_tasks.size(), 1, [this, &propagate](size_t begin, size_t end) {
+		for (size_t task = begin; task < end; task++) {
+			propagate(this->propagation_tasks[task].begin, this->propagation_tasks[task].end);
+		}
+	});
+}
+
+glm::mat4 Scene::compose_local_matrix(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale) {
+	// translate * rotate * scale without the full matrix products.
+	glm::mat4 matrix = glm::mat4_cast(rotation);
+	matrix[0] *= scale.x;
+	matrix[1] *= scale.y;
+	matrix[2] *= scale.z;
+	matrix[3] = glm::vec4(position, 1.0f);
+	return matrix;
+}
+
+// === Hierarchy Sorting ===
+
+void Scene::sort_hierarchy() {
+	// Re-parenting can move whole subtrees to other levels, only a re-sort handles that.  Added
+	// nodes are appended to their levels, a re-sort only happens once a level runs out of room.
+	if (this->children_changed || !this->insert_added_nodes()) {
+		this->rebuild_hierarchy(true);
+	}
+	else if (this->unused_slot_count > std::max<size_t>(this->node_indices.size() / COMPACTION_DIVISOR, MIN_LEVEL_SLACK)) {
+		this->rebuild_hierarchy(true);
+	}
+}
+
+bool Scene::insert_added_nodes() {
+	const uint32_t sortedEnd = this->level_offsets.back();
+	const uint32_t addedEnd = static_cast<uint32_t>(this->index_nodes.size());
+	if (sortedEnd == addedEnd) {
+		return true;
+	}
+
+	// Inserting can move sorted nodes, so parents are tracked by handle until they're placed.
+	// Parents always come before their children.
+	this->added_parents.clear();
+	for (uint32_t i = sortedEnd; i < addedEnd; i++) {
+		uint32_t parent = this->parents[i];
+		this->added_parents.push_back(parent == INVALID_INDEX ? NodeHandle() : this->index_nodes[parent]);
+	}
+
+	uint32_t added = sortedEnd;
+	for (; added < addedEnd; added++) {
+		NodeHandle parent = this->added_parents[added - sortedEnd];
+		uint32_t parentIndex = parent.is_null() ? INVALID_INDEX : this->node_indices[parent];
+
+		uint32_t slot = this->reserve_child_slot(parentIndex);
+		if (slot == INVALID_INDEX) {
+			break;
+		}
+
+		this->move_node(added, slot);
+		this->parents[slot] = parentIndex;
+		this->first_children[slot] = 0;
+		this->child_counts[slot] = 0;
+		this->child_runs_in_order = false;
+	}
+
+	if (added < addedEnd) {
+		// A level is full.  The re-sort picks up the nodes that weren't placed, their parents may
+		// have moved since they were added.
+		for (uint32_t i = added; i < addedEnd; i++) {
+			NodeHandle parent = this->added_parents[i - sortedEnd];
+			this->parents[i] = parent.is_null() ? INVALID_INDEX : this->node_indices[parent];
+		}
+		return false;
+	}
+
+	this->index_nodes.resize(sortedEnd);
+	this->parents.resize(sortedEnd);
+	this->first_children.resize(sortedEnd);
+	this->child_counts.resize(sortedEnd);
+	this->local_positions.resize(sortedEnd);
+	this->local_rotations.resize(sortedEnd);
+	this->local_scales.resize(sortedEnd);
+	this->world_matrices.resize(sortedEnd);
+	this->dirty.resize(sortedEnd);
+	this->dirty_blocks.resize((sortedEnd + DIRTY_BLOCK_SIZE - 1) / DIRTY_BLOCK_SIZE);
+
+	return true;
+}
+
+uint32_t Scene::reserve_child_slot(uint32_t parent) {
+	size_t depth = 0;
+	if (parent != INVALID_INDEX) {
+		depth = std::upper_bound(this->level_offsets.begin(), this->level_offsets.end(), parent) - this->level_offsets.begin();
+	}
+
+	if (depth >= this->level_ends.size()) {
+		// The first node this deep.
+		return INVALID_INDEX;
+	}
+
+	uint32_t& levelEnd = this->level_ends[depth];
+	const uint32_t freeSlots = this->level_offsets[depth + 1] - levelEnd;
+
+	if (parent == INVALID_INDEX) {
+		return freeSlots > 0 ? levelEnd++ : INVALID_INDEX;
+	}
+
+	const uint32_t firstChild = this->first_children[parent];
+	const uint32_t childCount = this->child_counts[parent];
+
+	if (childCount == 0 || firstChild + childCount == levelEnd) {
+		if (freeSlots == 0) {
+			return INVALID_INDEX;
+		}
+		if (childCount == 0) {
+			this->first_children[parent] = levelEnd;
+		}
+		this->child_counts[parent]++;
+		return levelEnd++;
+	}
+
+	// Siblings have to stay contiguous, so the existing children move to the end of the level
+	// first.  Destroyed ones are left behind.
+	uint32_t liveCount = 0;
+	for (uint32_t child = firstChild; child < firstChild + childCount; child++) {
+		liveCount += this->index_nodes[child].is_null() ? 0 : 1;
+	}
+
+	if (freeSlots < liveCount + 1) {
+		return INVALID_INDEX;
+	}
+
+	this->first_children[parent] = levelEnd;
+	for (uint32_t child = firstChild; child < firstChild + childCount; child++) {
+		if (!this->index_nodes[child].is_null()) {
+			this->move_node(child, levelEnd++);
+			this->unused_slot_count++;
+		}
+	}
+	this->child_counts[parent] = liveCount + 1;
+
+	return levelEnd++;
+}
+
+void Scene::move_node(uint32_t from, uint32_t to) {
+	this->index_nodes[to] = this->index_nodes[from];
+	this->parents[to] = this->parents[from];
+	this->first_children[to] = this->first_children[from];
+	this->child_counts[to] = this->child_counts[from];
+	this->local_positions[to] = this->local_positions[from];
+	this->local_rotations[to] = this->local_rotations[from];
+	this->local_scales[to] = this->local_scales[from];
+	this->world_matrices[to] = this->world_matrices[from];
+
+	this->node_indices[this->index_nodes[to]] = to;
+	for (uint32_t child = this->first_children[to]; child < this->first_children[to] + this->child_counts[to]; child++) {
+		this->parents[child] = to;
+	}
+
+	if (this->dirty[from] != 0) {
+		this->mark_dirty(to);
+	}
+
+	this->index_nodes[from] = NodeHandle();
+	this->child_counts[from] = 0;
+	this->dirty[from] = 0;
+}
+
+void Scene::rebuild_hierarchy(bool leave_room) {
+	const uint32_t oldCount = static_cast<uint32_t>(this->index_nodes.size());
+
+	auto isLive = [this](uint32_t index) {
+		return !this->index_nodes[index].is_null();
+	};
+
+	// Bucket every live node's children by parent (counting sort), keeping their current order
+	// so siblings stay in a stable order across re-sorts.
+	vector<uint32_t> childOffsets(static_cast<size_t>(oldCount) + 1, 0);
+	for (uint32_t i = 0; i < oldCount; i++) {
+		if (isLive(i) && this->parents[i] != INVALID_INDEX) {
+			childOffsets[this->parents[i] + 1]++;
+		}
+	}
+	for (uint32_t i = 0; i < oldCount; i++) {
+		childOffsets[i + 1] += childOffsets[i];
+	}
+
+	vector<uint32_t> children(childOffsets[oldCount]);
+	{
+		vector<uint32_t> fillPositions(childOffsets.begin(), childOffsets.end() - 1);
+		for (uint32_t i = 0; i < oldCount; i++) {
+			if (isLive(i) && this->parents[i] != INVALID_INDEX) {
+				children[fillPositions[this->parents[i]]++] = i;
+			}
+		}
+	}
+
+	// Breadth first from the roots gives the depth sorted order, with each node's children
+	// landing next to each other in the level below.
+	vector<uint32_t> order;
+	order.reserve(this->node_indices.size());
+	for (uint32_t i = 0; i < oldCount; i++) {
+		if (isLive(i) && this->parents[i] == INVALID_INDEX) {
+			order.push_back(i);
+		}
+	}
+
+	vector<uint32_t> orderLevelOffsets{ 0 };
+	size_t levelBegin = 0;
+	while (levelBegin < order.size()) {
+		size_t levelEnd = order.size();
+		for (size_t k = levelBegin; k < levelEnd; k++) {
+			uint32_t oldIndex = order[k];
+			order.insert(order.end(), children.begin() + childOffsets[oldIndex], children.begin() + childOffsets[oldIndex + 1]);
+		}
+		orderLevelOffsets.push_back(static_cast<uint32_t>(levelEnd));
+		levelBegin = levelEnd;
+	}
+
+	// Every level gets its free room at its end.
+	const size_t depthCount = orderLevelOffsets.size() - 1;
+	this->level_offsets.assign(1, 0);
+	this->level_ends.clear();
+	for (size_t depth = 0; depth < depthCount; depth++) {
+		uint32_t levelSize = orderLevelOffsets[depth + 1] - orderLevelOffsets[depth];
+		uint32_t room = leave_room ? std::max(levelSize / LEVEL_SLACK_DIVISOR, MIN_LEVEL_SLACK) : 0;
+		this->level_ends.push_back(this->level_offsets.back() + levelSize);
+		this->level_offsets.push_back(this->level_ends.back() + room);
+	}
+
+	const uint32_t newCount = this->level_offsets.back();
+
+	vector<uint32_t> oldToNew(oldCount, INVALID_INDEX);
+	vector<uint32_t> newToOld(newCount, INVALID_INDEX);
+	for (size_t depth = 0; depth < depthCount; depth++) {
+		for (uint32_t k = orderLevelOffsets[depth]; k < orderLevelOffsets[depth + 1]; k++) {
+			uint32_t newIndex = this->level_offsets[depth] + (k - orderLevelOffsets[depth]);
+			oldToNew[order[k]] = newIndex;
+			newToOld[newIndex] = order[k];
+		}
+	}
+
+	// Gather every array into the new order, free slots get a harmless root at the origin.
+	auto gather = [&newToOld](auto& values, auto freeValue) {
+		std::remove_reference_t<decltype(values)> sorted;
+		sorted.reserve(newToOld.size());
+		for (uint32_t oldIndex : newToOld) {
+			sorted.push_back(oldIndex == INVALID_INDEX ? freeValue : values[oldIndex]);
+		}
+		values.swap(sorted);
+	};
+
+	gather(this->index_nodes, NodeHandle());
+	gather(this->local_positions, glm::vec3(0.0f));
+	gather(this->local_rotations, glm::quat(1.0f, 0.0f, 0.0f, 0.0f));
+	gather(this->local_scales, glm::vec3(1.0f));
+	gather(this->world_matrices, glm::mat4(1.0f));
+	gather(this->dirty, uint8_t(0));
+
+	vector<uint32_t> newParents(newCount, INVALID_INDEX);
+	vector<uint32_t> newFirstChildren(newCount, 0);
+	vector<uint32_t> newChildCounts(newCount, 0);
+
+	// Children are laid out in their parents' order, each parent's run starts where the
+	// previous one's ended.  Childless nodes point there too so runs of nodes map to runs of
+	// children.
+	for (size_t depth = 0; depth < depthCount; depth++) {
+		uint32_t nextChild = depth + 1 < depthCount ? this->level_offsets[depth + 1] : newCount;
+		for (uint32_t i = this->level_offsets[depth]; i < this->level_ends[depth]; i++) {
+			uint32_t oldIndex = newToOld[i];
+			uint32_t parent = this->parents[oldIndex];
+
+			newParents[i] = parent == INVALID_INDEX ? INVALID_INDEX : oldToNew[parent];
+			newFirstChildren[i] = nextChild;
+			newChildCounts[i] = childOffsets[oldIndex + 1] - childOffsets[oldIndex];
+			nextChild += newChildCounts[i];
+		}
+	}
+
+	this->parents.swap(newParents);
+	this->first_children.swap(newFirstChildren);
+	this->child_counts.swap(newChildCounts);
+
+	for (uint32_t i = 0; i < newCount; i++) {
+		if (!this->index_nodes[i].is_null()) {
+			this->node_indices[this->index_nodes[i]] = i;
+		}
+	}
+
+	this->dirty_blocks.assign((newCount + DIRTY_BLOCK_SIZE - 1) / DIRTY_BLOCK_SIZE, 0);
+	for (uint32_t i = 0; i < newCount; i++) {
+		if (this->dirty[i] != 0) {
+			this->dirty_blocks[i / DIRTY_BLOCK_SIZE] = 1;
+		}
+	}
+
+	this->children_changed = false;
+	this->child_runs_in_order = true;
+	this->unused_slot_count = 0;
+}
+
+// === Node Functions ===
+
+NodeHandle Scene::create_node(NodeHandle parent) {
+	uint32_t parentIndex = parent.is_null() ? INVALID_INDEX : this->get_checked_index(parent);
+
+	// New nodes go at the end until the next sort moves them into their level.
+	uint32_t index = static_cast<uint32_t>(this->index_nodes.size());
+	NodeHandle node = this->node_indices.insert(index);
+
+	this->index_nodes.push_back(node);
+	this->parents.push_back(parentIndex);
+	this->first_children.push_back(0);
+	this->child_counts.push_back(0);
+	this->local_positions.push_back(glm::vec3(0.0f));
+	this->local_rotations.push_back(glm::quat(1.0f, 0.0f, 0.0f, 0.0f));
+	this->local_scales.push_back(glm::vec3(1.0f));
+	this->world_matrices.push_back(glm::mat4(1.0f));
+	this->dirty.push_back(0);
+	this->dirty_blocks.resize((this->index_nodes.size() + DIRTY_BLOCK_SIZE - 1) / DIRTY_BLOCK_SIZE, 0);
+
+	this->mark_dirty(index);
+
+	return node;
+}
+
+vector<NodeHandle> Scene::instantiate(const SceneFile& file) {
+	// Resolved first so a file that doesn't fit this build throws before anything was added.
+	vector<ComponentId> componentIds = file.get_component_ids();
+
+	vector<NodeHandle> nodes;
+	nodes.reserve(file.get_node_count());
+	this->instantiate_nodes(file, 0, file.get_node_count(), nodes);
+
+	for (size_t archetype = 0; archetype < file.get_archetypes().size(); archetype++) {
+		this->instantiate_components(file, componentIds, archetype, 0, static_cast<uint32_t>(file.get_archetypes()[archetype].nodes.size()), nodes);
+	}
+
+	return nodes;
+}
+
+void Scene::instantiate_nodes(const SceneFile& file, uint32_t begin, uint32_t end, vector<NodeHandle>& nodes) {
+	if (begin > end || end > file.get_node_count() || nodes.size() != begin) {
+		throw std::out_of_range("Scene file nodes must be instantiated in order, without gaps.");
+	}
+
+	const uint32_t count = end - begin;
+	const uint32_t base = static_cast<uint32_t>(this->index_nodes.size());
+
+	// A whole file going into an empty scene is already sorted, otherwise the new nodes go at
+	// the end like created nodes until the next sort moves them into their levels.
+	const bool inPackedOrder = base == 0 && begin == 0 && end == file.get_node_count();
+
+	// Parents always come before their children in a file, those from earlier calls are looked
+	// up since a re-sort may have moved them since.  Nodes whose parent was destroyed in the
+	// meantime are skipped along with their subtree and get a null handle.
+	uint32_t addedCount = 0;
+	this->node_indices.reserve(this->node_indices.slot_count() + count);
+	this->parents.reserve(static_cast<size_t>(base) + count);
+
+	for (uint32_t parent : file.get_parents().subspan(begin, count)) {
+		uint32_t parentIndex = INVALID_INDEX;
+		if (parent != INVALID_INDEX) {
+			const uint32_t* index = this->node_indices.get(nodes[parent]);
+			if (index == nullptr) {
+				nodes.push_back(NodeHandle());
+				continue;
+			}
+			parentIndex = *index;
+		}
+
+		NodeHandle node = this->node_indices.insert(base + addedCount++);
+		nodes.push_back(node);
+		this->index_nodes.push_back(node);
+		this->parents.push_back(parentIndex);
+	}
+
+	const size_t newSize = static_cast<size_t>(base) + addedCount;
+
+	if (inPackedOrder) {
+		this->first_children.assign(file.get_first_children().begin(), file.get_first_children().end());
+		this->child_counts.assign(file.get_child_counts().begin(), file.get_child_counts().end());
+		this->level_offsets.assign(file.get_level_offsets().begin(), file.get_level_offsets().end());
+		this->level_ends.assign(this->level_offsets.begin() + 1, this->level_offsets.end());
+		this->child_runs_in_order = true;
+	}
+	else {
+		this->first_children.resize(newSize, 0);
+		this->child_counts.resize(newSize, 0);
+	}
+
+	auto appendRange = [&nodes, begin, count, addedCount](auto& values, auto source) {
+		source = source.subspan(begin, count);
+		if (addedCount == count) {
+			values.insert(values.end(), source.begin(), source.end());
+			return;
+		}
+		for (uint32_t i = 0; i < count; i++) {
+			if (!nodes[begin + i].is_null()) {
+				values.push_back(source[i]);
+			}
+		}
+	};
+
+	appendRange(this->local_positions, file.get_local_positions());
+	appendRange(this->local_rotations, file.get_local_rotations());
+	appendRange(this->local_scales, file.get_local_scales());
+	this->world_matrices.resize(newSize, glm::mat4(1.0f));
+
+	// Every new node is dirty, the next update computes their world matrices.
+	this->dirty.resize(newSize, 1);
+	this->dirty_blocks.resize((newSize + DIRTY_BLOCK_SIZE - 1) / DIRTY_BLOCK_SIZE, 0);
+	std::fill(this->dirty_blocks.begin() + base / DIRTY_BLOCK_SIZE, this->dirty_blocks.end(), 1);
+}
+
+void Scene::instantiate_components(const SceneFile& file, std::span<const ComponentId> component_ids, size_t archetype, uint32_t begin, uint32_t end, std::span<const NodeHandle> nodes) {
+	if (archetype >= file.get_archetypes().size()) {
+		throw std::out_of_range("Scene file archetype " + std::to_string(archetype) + " doesn't exist.");
+	}
+
+	const SceneFile::ArchetypeView& view = file.get_archetypes()[archetype];
+	if (begin > end || end > view.nodes.size()) {
+		throw std::out_of_range("Scene file archetype rows out of range.");
+	}
+	if (nodes.size() != file.get_node_count()) {
+		throw std::out_of_range("Components can only be instantiated once every node of the file was.");
+	}
+	if (component_ids.size() != file.get_component_types().size()) {
+		throw std::invalid_argument("The component ids don't belong to the scene file.");
+	}
+
+	vector<NodeHandle> rowNodes;
+	rowNodes.reserve(end - begin);
+	for (uint32_t node : view.nodes.subspan(begin, end - begin)) {
+		rowNodes.push_back(nodes[node]);
+	}
+
+	vector<ComponentId> ids;
+	for (uint32_t type : view.component_types) {
+		ids.push_back(component_ids[type]);
+	}
+
+	// Nodes destroyed (or skipped) since they were instantiated get no components, the rows
+	// around them are added a run of live nodes at a time.
+	vector<const std::byte*> columns(ids.size());
+	size_t runBegin = 0;
+	while (runBegin < rowNodes.size()) {
+		if (!this->contains(rowNodes[runBegin])) {
+			runBegin++;
+			continue;
+		}
+
+		size_t runEnd = runBegin + 1;
+		while (runEnd < rowNodes.size() && this->contains(rowNodes[runEnd])) {
+			runEnd++;
+		}
+
+		for (size_t c = 0; c < ids.size(); c++) {
+			const size_t row = static_cast<size_t>(begin) + runBegin;
+			columns[c] = view.columns[c] + row * file.get_component_types()[view.component_types[c]].size;
+		}
+
+		this->components.add_components(std::span<const NodeHandle>(rowNodes).subspan(runBegin, runEnd - runBegin), ids, columns);
+		runBegin = runEnd;
+	}
+}
+
+void Scene::destroy_node(NodeHandle node) {
+	this->get_checked_index(node);
+
+	// The walk below needs up to date child ranges.
+	this->sort_hierarchy();
+
+	vector<NodeHandle> destroyedNodes;
+	vector<uint32_t> stack{ this->node_indices[node] };
+	while (!stack.empty()) {
+		uint32_t index = stack.back();
+		stack.pop_back();
+
+		// Child runs keep their destroyed nodes until the next compaction.
+		if (this->index_nodes[index].is_null()) {
+			continue;
+		}
+
+		destroyedNodes.push_back(this->index_nodes[index]);
+		this->components.remove_node(this->index_nodes[index]);
+		this->node_indices.erase(this->index_nodes[index]);
+		this->index_nodes[index] = NodeHandle();
+
+		for (uint32_t child = 0; child < this->child_counts[index]; child++) {
+			stack.push_back(this->first_children[index] + child);
+		}
+		this->child_counts[index] = 0;
+		this->dirty[index] = 0;
+	}
+
+	// Compacted out lazily, until then the destroyed nodes' slots are skipped.
+	this->unused_slot_count += destroyedNodes.size();
+
+	if (this->destroy_listener) {
+		this->destroy_listener(destroyedNodes);
+	}
+}
+
+void Scene::set_parent(NodeHandle node, NodeHandle parent) {
+	uint32_t index = this->get_checked_index(node);
+	uint32_t parentIndex = parent.is_null() ? INVALID_INDEX : this->get_checked_index(parent);
+
+	for (uint32_t ancestor = parentIndex; ancestor != INVALID_INDEX; ancestor = this->parents[ancestor]) {
+		if (ancestor == index) {
+			throw std::invalid_argument("A node can't be parented to its own descendant.");
+		}
+	}
+
+	this->parents[index] = parentIndex;
+	this->mark_dirty(index);
+	this->children_changed = true;
+}
+
+uint32_t Scene::get_checked_index(NodeHandle node) const {
+	const uint32_t* index = this->node_indices.get(node);
+	if (index == nullptr) {
+		throw std::out_of_range("Node " + std::to_string(node.index) + " (generation " + std::to_string(node.generation) + ") doesn't exist in the scene, it may have been destroyed.");
+	}
+	return *index;
+}
+
+void Scene::mark_dirty(uint32_t index) {
+	// Different nodes in one block can be moved from different threads.
+	this->dirty[index] = 1;
+	std::atomic_ref<uint8_t>(this->dirty_blocks[index / DIRTY_BLOCK_SIZE]).store(1, std::memory_order_relaxed);
+}
+
+// === Transform Setters ===
+
+void Scene::set_local_position(NodeHandle node, const glm::vec3& position) {
+	uint32_t index = this->get_checked_index(node);
+	this->local_positions[index] = position;
+	this->mark_dirty(index);
+}
+
+void Scene::set_local_rotation(NodeHandle node, const glm::quat& rotation) {
+	uint32_t index = this->get_checked_index(node);
+	this->local_rotations[index] = rotation;
+	this->mark_dirty(index);
+}
+
+void Scene::set_local_scale(NodeHandle node, const glm::vec3& scale) {
+	uint32_t index = this->get_checked_index(node);
+	this->local_scales[index] = scale;
+	this->mark_dirty(index);
+}
+
+void Scene::set_local_transform(NodeHandle node, const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale) {
+	uint32_t index = this->get_checked_index(node);
+	this->local_positions[index] = position;
+	this->local_rotations[index] = rotation;
+	this->local_scales[index] = scale;
+	this->mark_dirty(index);
+}
+
+void Scene::play_back_commands(ThreadPool::Pool* pool) {
+	this->command_buffers.play_back(*this, pool);
+}
+
+void Scene::set_destroy_listener(DestroyListener listener) {
+	this->destroy_listener = std::move(listener);
+}
+
+void Scene::set_propagation_chunk_size(size_t chunk_size) {
+	if (chunk_size == 0) {
+		throw std::invalid_argument("Propagation chunk size must be greater than 0.");
+	}
+	this->chunk_size = chunk_size;
+}
+
+void Scene::compact() {
+	this->rebuild_hierarchy(false);
+}
+
+// === Getters ===
+
+NodeHandle Scene::get_parent(NodeHandle node) const {
+	uint32_t parentIndex = this->parents[this->get_checked_index(node)];
+	return parentIndex == INVALID_INDEX ? NodeHandle() : this->index_nodes[parentIndex];
+}
+
+ComponentStore& Scene::get_components() {
+	return this->components;
+}
+
+CommandBuffers& Scene::get_command_buffers() {
+	return this->command_buffers;
+}
+
+bool Scene::contains(NodeHandle node) const {
+	return this->node_indices.contains(node);
+}
+
+size_t Scene::size() const {
+	return this->node_indices.size();
+}
+
+glm::vec3 Scene::get_local_position(NodeHandle node) const {
+	return this->local_positions[this->get_checked_index(node)];
+}
+
+glm::quat Scene::get_local_rotation(NodeHandle node) const {
+	return this->local_rotations[this->get_checked_index(node)];
+}
+
+glm::vec3 Scene::get_local_scale(NodeHandle node) const {
+	return this->local_scales[this->get_checked_index(node)];
+}
+
+const glm::mat4& Scene::get_world_matrix(NodeHandle node) const {
+	return this->world_matrices[this->get_checked_index(node)];
+}
+
+uint32_t Scene::get_index(NodeHandle node) const {
+	return this->get_checked_index(node);
+}
+
+NodeHandle Scene::get_node_at(uint32_t index) const {
+	return this->index_nodes[index];
+}
+
+std::span<const glm::mat4> Scene::get_world_matrices() const {
+	return this->world_matrices;
+}
+
+std::span<const Scene::IndexRange> Scene::get_updated_ranges() const {
+	return this->updated_ranges;
+}
+
+size_t Scene::get_depth_count() {
+	this->sort_hierarchy();
+	return this->level_offsets.size() - 1;
+}
+
+Scene::IndexRange Scene::get_depth_range(size_t depth) {
+	this->sort_hierarchy();
+	if (depth + 1 >= this->level_offsets.size()) {
+		throw std::out_of_range("Depth " + std::to_string(depth) + " is deeper than the scene.");
+	}
+	return IndexRange{ this->level_offsets[depth], this->level_offsets[depth + 1] };
+}
@@ -0,0 +1,397 @@
+#include "Engine/scene/scene_file.h"
+#include "Engine/scene/scene.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+// CODE FORMATTING INFORMATION:
+// Simple functions like getters and setters go at the bottom.
+// Organize from most complex at the top to least complex at the bottom.
+
+static constexpr size_t ARRAY_ALIGNMENT = 16;
+
+static_assert(sizeof(glm::vec3) == 3 * sizeof(float) && sizeof(glm::quat) == 4 * sizeof(float),
+	"Scene files store transforms as packed floats.");
+
+static void throw_invalid(const std::string& reason) {
+	throw std::runtime_error("Invalid scene file: " + reason);
+}
+
+// === Class Functions ===
+
+SceneFile::SceneFile(const std::string& path)
+	: mapped_file(path)
+{
+	this->data = this->mapped_file.get_data();
+	this->fix_up();
+}
+
+SceneFile::SceneFile(vector<std::byte> bytes)
+	: bytes(std::move(bytes))
+{
+	this->data = this->bytes;
+	this->fix_up();
+}
+
+// === Loading ===
+
+void SceneFile::fix_up() {
+	if (this->data.size() < sizeof(SceneFileHeader)) {
+		throw_invalid("too small for a header.");
+	}
+
+	this->header = reinterpret_cast<const SceneFileHeader*>(this->data.data());
+
+	if (this->header->magic != SceneFileHeader::MAGIC) {
+		throw_invalid("not a scene file.");
+	}
+	if (this->header->version != SceneFileHeader::VERSION) {
+		throw_invalid("version " + std::to_string(this->header->version) + ", expected " + std::to_string(SceneFileHeader::VERSION) + ".");
+	}
+	if (this->header->file_size != this->data.size()) {
+		throw_invalid("the file is " + std::to_string(this->data.size()) + " bytes but should be " + std::to_string(this->header->file_size) + ".");
+	}
+
+	const uint32_t nodeCount = this->header->node_count;
+
+	auto getNodeArray = [this, nodeCount](const SceneFileRange& range, auto* type) {
+		using T = std::remove_pointer_t<decltype(type)>;
+		if (range.count != nodeCount) {
+			throw_invalid("a node array doesn't hold one value per node.");
+		}
+		return this->get_range<T>(range);
+	};
+
+	this->level_offsets = this->get_range<uint32_t>(this->header->level_offsets);
+	this->parents = getNodeArray(this->header->parents, static_cast<uint32_t*>(nullptr));
+	this->first_children = getNodeArray(this->header->first_children, static_cast<uint32_t*>(nullptr));
+	this->child_counts = getNodeArray(this->header->child_counts, static_cast<uint32_t*>(nullptr));
+	this->local_positions = getNodeArray(this->header->local_positions, static_cast<glm::vec3*>(nullptr));
+	this->local_rotations = getNodeArray(this->header->local_rotations, static_cast<glm::quat*>(nullptr));
+	this->local_scales = getNodeArray(this->header->local_scales, static_cast<glm::vec3*>(nullptr));
+
+	// The hierarchy is used as is, check it's exactly what `Scene` would have sorted it into:
+	// levels in order, every parent in the level above, children in their parent's run.
+	if (this->level_offsets.empty() || this->level_offsets.front() != 0 || this->level_offsets.back() != nodeCount) {
+		throw_invalid("the depth levels don't cover the nodes.");
+	}
+	for (size_t depth = 1; depth < this->level_offsets.size(); depth++) {
+		if (this->level_offsets[depth] <= this->level_offsets[depth - 1]) {
+			throw_invalid("empty or unordered depth level.");
+		}
+	}
+
+	const uint32_t rootCount = this->level_offsets.size() > 1 ? this->level_offsets[1] : 0;
+	uint64_t nextChild = rootCount;
+	size_t depth = 0;
+
+	for (uint32_t i = 0; i < nodeCount; i++) {
+		while (i >= this->level_offsets[depth + 1]) {
+			depth++;
+		}
+
+		const uint32_t parent = this->parents[i];
+		const bool validParent = depth == 0
+			? parent == Scene::INVALID_INDEX
+			: parent >= this->level_offsets[depth - 1] && parent < this->level_offsets[depth];
+
+		if (!validParent || this->first_children[i] != nextChild) {
+			throw_invalid("node " + std::to_string(i) + " isn't in depth sorted order.");
+		}
+		nextChild += this->child_counts[i];
+	}
+
+	if (nextChild != nodeCount) {
+		throw_invalid("the child counts don't add up to the node count.");
+	}
+
+	for (uint32_t i = 0; i < nodeCount; i++) {
+		for (uint32_t child = this->first_children[i]; child < this->first_children[i] + this->child_counts[i]; child++) {
+			if (this->parents[child] != i) {
+				throw_invalid("node " + std::to_string(child) + " is in the child run of a node that isn't its parent.");
+			}
+		}
+	}
+
+	// Components.
+	this->component_types.clear();
+	for (const SceneFileComponentType& type : this->get_range<SceneFileComponentType>(this->header->component_types)) {
+		std::span<const char> name = this->get_range<char>(type.name);
+		this->component_types.push_back(ComponentType{ std::string_view(name.data(), name.size()), type.size, type.alignment });
+	}
+
+	// Every node has its components in at most one row, a second one would only fail once nodes
+	// were already added.
+	vector<bool> nodeHasRow(nodeCount, false);
+
+	this->archetypes.clear();
+	for (const SceneFileArchetype& archetype : this->get_range<SceneFileArchetype>(this->header->archetypes)) {
+		ArchetypeView view;
+		view.component_types = this->get_range<uint32_t>(archetype.component_types);
+		view.nodes = this->get_range<uint32_t>(archetype.nodes);
+
+		std::span<const SceneFileRange> columns = this->get_range<SceneFileRange>(archetype.columns);
+		if (columns.size() != view.component_types.size()) {
+			throw_invalid("an archetype doesn't have one column per component.");
+		}
+
+		for (uint32_t node : view.nodes) {
+			if (node >= nodeCount) {
+				throw_invalid("an archetype holds a node that doesn't exist.");
+			}
+			if (nodeHasRow[node]) {
+				throw_invalid("node " + std::to_string(node) + " has more than one archetype row.");
+			}
+			nodeHasRow[node] = true;
+		}
+
+		for (size_t c = 0; c < columns.size(); c++) {
+			if (view.component_types[c] >= this->component_types.size()) {
+				throw_invalid("an archetype holds a component type that doesn't exist.");
+			}
+
+			const ComponentType& type = this->component_types[view.component_types[c]];
+			if (columns[c].count != view.nodes.size() || type.alignment == 0 || columns[c].offset % type.alignment != 0) {
+				throw_invalid("a component column doesn't match its archetype.");
+			}
+
+			std::span<const std::byte> column = this->get_range<std::byte>(SceneFileRange{ columns[c].offset, columns[c].count * type.size });
+			view.columns.push_back(column.data());
+		}
+
+		this->archetypes.push_back(std::move(view));
+	}
+}
+
+template<typename T>
+std::span<const T> SceneFile::get_range(const SceneFileRange& range) const {
+	const size_t size = this->data.size();
+	if (range.offset > size || range.count > (size - range.offset) / sizeof(T) || range.offset % alignof(T) != 0) {
+		throw_invalid("a range lies outside the file.");
+	}
+	return std::span<const T>(reinterpret_cast<const T*>(this->data.data() + range.offset), static_cast<size_t>(range.count));
+}
+
+// === Saving ===
+
+vector<std::byte> SceneFile::serialize(Scene& scene) {
+	// From here on the scene's dense indices are the file's node indices.
+	scene.compact();
+	const size_t depthCount = scene.get_depth_count();
+	const uint32_t nodeCount = static_cast<uint32_t>(scene.size());
+
+	vector<std::byte> file(sizeof(SceneFileHeader));
+
+	auto append = [&file](const void* values, size_t count, size_t element_size, size_t alignment) {
+		size_t offset = (file.size() + alignment - 1) / alignment * alignment;
+		file.resize(offset + count * element_size);
+		if (count != 0) {
+			std::memcpy(file.data() + offset, values, count * element_size);
+		}
+		return SceneFileRange{ offset, count };
+	};
+
+	auto appendArray = [&append](const auto& values) {
+		using T = std::remove_cvref_t<decltype(values[0])>;
+		return append(values.data(), values.size(), sizeof(T), std::max(ARRAY_ALIGNMENT, alignof(T)));
+	};
+
+	SceneFileHeader header;
+	header.node_count = nodeCount;
+
+	// === Nodes ===
+
+	vector<uint32_t> levelOffsets{ 0 };
+	for (size_t depth = 0; depth < depthCount; depth++) {
+		levelOffsets.push_back(scene.get_depth_range(depth).end);
+	}
+
+	vector<uint32_t> parents(nodeCount);
+	vector<uint32_t> firstChildren(nodeCount);
+	vector<uint32_t> childCounts(nodeCount, 0);
+	vector<glm::vec3> positions(nodeCount);
+	vector<glm::quat> rotations(nodeCount);
+	vector<glm::vec3> scales(nodeCount);
+
+	for (uint32_t i = 0; i < nodeCount; i++) {
+		NodeHandle node = scene.get_node_at(i);
+		NodeHandle parent = scene.get_parent(node);
+
+		parents[i] = parent.is_null() ? Scene::INVALID_INDEX : scene.get_index(parent);
+		if (!parent.is_null()) {
+			childCounts[parents[i]]++;
+		}
+
+		positions[i] = scene.get_local_position(node);
+		rotations[i] = scene.get_local_rotation(node);
+		scales[i] = scene.get_local_scale(node);
+	}
+
+	// Breadth first order, every node's children start where its predecessors' children end.
+	uint32_t nextChild = levelOffsets.size() > 1 ? levelOffsets[1] : 0;
+	for (uint32_t i = 0; i < nodeCount; i++) {
+		firstChildren[i] = nextChild;
+		nextChild += childCounts[i];
+	}
+
+	header.level_offsets = appendArray(levelOffsets);
+	header.parents = appendArray(parents);
+	header.first_children = appendArray(firstChildren);
+	header.child_counts = appendArray(childCounts);
+	header.local_positions = appendArray(positions);
+	header.local_rotations = appendArray(rotations);
+	header.local_scales = appendArray(scales);
+
+	// === Components ===
+
+	ComponentStore& components = scene.get_components();
+
+	vector<ComponentId> typeIds;
+	vector<int32_t> typeIndices(MAX_COMPONENT_TYPES, -1);
+	vector<SceneFileArchetype> archetypeRecords;
+
+	vector<uint32_t> nodes;
+	vector<uint32_t> types;
+	vector<SceneFileRange> columns;
+
+	for (size_t a = 0; a < components.get_archetype_count(); a++) {
+		Archetype& archetype = components.get_archetype(a);
+
+		types.clear();
+		columns.clear();
+		for (const Archetype::Column& column : archetype.columns) {
+			if (!Components::get_info(column.id).trivially_relocatable) {
+				continue;
+			}
+
+			if (typeIndices[column.id] < 0) {
+				typeIndices[column.id] = static_cast<int32_t>(typeIds.size());
+				typeIds.push_back(column.id);
+			}
+			types.push_back(static_cast<uint32_t>(typeIndices[column.id]));
+		}
+
+		if (archetype.size() == 0 || types.empty()) {
+			continue;
+		}
+
+		nodes.clear();
+		for (auto& chunk : archetype.chunks) {
+			const NodeHandle* chunkNodes = archetype.get_nodes(*chunk);
+			for (uint32_t row = 0; row < chunk->count; row++) {
+				nodes.push_back(scene.get_index(chunkNodes[row]));
+			}
+		}
+
+		for (uint32_t type : types) {
+			const ComponentId id = typeIds[type];
+			const ComponentInfo& info = Components::get_info(id);
+
+			// The column's chunks are stitched together into one run.
+			SceneFileRange range = append(nullptr, 0, info.size, std::max(ARRAY_ALIGNMENT, info.alignment));
+			for (auto& chunk : archetype.chunks) {
+				append(archetype.get_component(*chunk, id, 0), chunk->count, info.size, 1);
+			}
+			range.count = archetype.size();
+			columns.push_back(range);
+		}
+
+		SceneFileArchetype record;
+		record.nodes = appendArray(nodes);
+		record.component_types = appendArray(types);
+		record.columns = appendArray(columns);
+		archetypeRecords.push_back(record);
+	}
+
+	vector<SceneFileComponentType> typeRecords;
+	for (ComponentId id : typeIds) {
+		const ComponentInfo& info = Components::get_info(id);
+
+		SceneFileComponentType record;
+		record.name = append(info.name, std::strlen(info.name), 1, 1);
+		record.size = static_cast<uint32_t>(info.size);
+		record.alignment = static_cast<uint32_t>(info.alignment);
+		typeRecords.push_back(record);
+	}
+
+	header.component_types = appendArray(typeRecords);
+	header.archetypes = appendArray(archetypeRecords);
+
+	header.file_size = file.size();
+	std::memcpy(file.data(), &header, sizeof(header));
+
+	return file;
+}
+
+void SceneFile::save(Scene& scene, const std::string& path) {
+	vector<std::byte> file = serialize(scene);
+
+	std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+	stream.write(reinterpret_cast<const char*>(file.data()), static_cast<std::streamsize>(file.size()));
+
+	if (!stream) {
+		throw std::runtime_error("Couldn't write the scene file \"" + path + "\".");
+	}
+}
+
+// === Getters ===
+
+uint32_t SceneFile::get_node_count() const {
+	return this->header->node_count;
+}
+
+std::span<const uint32_t> SceneFile::get_level_offsets() const {
+	return this->level_offsets;
+}
+
+std::span<const uint32_t> SceneFile::get_parents() const {
+	return this->parents;
+}
+
+std::span<const uint32_t> SceneFile::get_first_children() const {
+	return this->first_children;
+}
+
+std::span<const uint32_t> SceneFile::get_child_counts() const {
+	return this->child_counts;
+}
+
+std::span<const glm::vec3> SceneFile::get_local_positions() const {
+	return this->local_positions;
+}
+
+std::span<const glm::quat> SceneFile::get_local_rotations() const {
+	return this->local_rotations;
+}
+
+std::span<const glm::vec3> SceneFile::get_local_scales() const {
+	return this->local_scales;
+}
+
+std::span<const SceneFile::ComponentType> SceneFile::get_component_types() const {
+	return this->component_types;
+}
+
+std::span<const SceneFile::ArchetypeView> SceneFile::get_archetypes() const {
+	return this->archetypes;
+}
+
+vector<ComponentId> SceneFile::get_component_ids() const {
+	vector<ComponentId> ids;
+	for (const ComponentType& type : this->component_types) {
+		std::optional<ComponentId> id = Components::find_id(type.name);
+		if (!id.has_value() || Components::get_info(*id).size != type.size) {
+			throw std::runtime_error("The scene file's component \"" + std::string(type.name) + "\" isn't registered in this build or has a different size.");
+		}
+		ids.push_back(*id);
+	}
+	return ids;
+}
+
+size_t SceneFile::size() const {
+	return this->data.size();
+}
@@ -0,0 +1,488 @@
+#include "Engine/scene/scene_streamer.h"
+#include "Engine/scene/scene.h"
+#include "Engine/thread_pool/thread_pool.h"
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+// CODE FORMATTING INFORMATION:
+// Simple functions like getters and setters go at the bottom.
+// Organize from most complex at the top to least complex at the bottom.
+
+// === Class Functions ===
+
+SceneStreamer::SceneStreamer(Scene* scene, ThreadPool::Pool* pool, float cell_size)
+	: scene(scene),
+	pool(pool),
+	cell_size(cell_size),
+	load_radius(cell_size * DEFAULT_LOAD_RADIUS_CELLS),
+	unload_radius(cell_size * DEFAULT_UNLOAD_RADIUS_CELLS)
+{
+	if (scene == nullptr) {
+		throw std::invalid_argument("A scene streamer needs a scene.");
+	}
+	if (!(cell_size > 0.0f)) {
+		throw std::invalid_argument("Streaming cells must have a positive size.");
+	}
+}
+
+// === Streaming ===
+
+void SceneStreamer::update() {
+	glm::vec3 focus;
+	{
+		std::lock_guard<std::mutex> lock(this->focus_mutex);
+		focus = this->focus;
+	}
+
+	std::exception_ptr error;
+
+	// Reads of dropped cells still hold their memory and a read slot until they finish.
+	std::erase_if(this->detached_reads, [this](const DetachedRead& detached) {
+		if (!detached.read->finished.load(std::memory_order_acquire)) {
+			return false;
+		}
+		this->memory_usage -= detached.memory_size;
+		this->reads_in_flight--;
+		return true;
+	});
+
+	// === Finished Reads ===
+
+	for (Cell* cell : this->active_cells) {
+		if (cell->state != CellState::READING || !cell->read->finished.load(std::memory_order_acquire)) {
+			continue;
+		}
+
+		this->reads_in_flight--;
+
+		if (cell->read->error) {
+			if (!error) {
+				error = cell->read->error;
+			}
+			this->drop(*cell);
+			cell->state = CellState::FAILED;
+			continue;
+		}
+
+		cell->state = CellState::INTEGRATING;
+		cell->root_sizes = std::move(cell->read->root_sizes);
+		cell->nodes.reserve(cell->read->file->get_node_count());
+	}
+
+	// === Unloading ===
+
+	for (Cell* cell : this->active_cells) {
+		if (this->get_distance(*cell, focus) <= this->unload_radius) {
+			continue;
+		}
+
+		if (cell->state == CellState::READING) {
+			this->detach_read(*cell);
+		}
+		else if (cell->state == CellState::INTEGRATING || cell->state == CellState::RESIDENT) {
+			cell->state = CellState::UNLOADING;
+		}
+	}
+
+	uint32_t budget = this->nodes_per_update;
+
+	// Unload before integrating, destroying frees memory for the cells waiting to load.
+	for (Cell* cell : this->active_cells) {
+		if (cell->state != CellState::UNLOADING || budget == 0) {
+			continue;
+		}
+
+		budget -= std::min(budget, this->unload(*cell, budget));
+
+		if (cell->next_root >= std::min(cell->root_sizes.size(), cell->nodes.size())) {
+			this->drop(*cell);
+			cell->state = CellState::UNLOADED;
+		}
+	}
+
+	// === Integration ===
+
+	vector<Cell*> integrating;
+	for (Cell* cell : this->active_cells) {
+		if (cell->state == CellState::INTEGRATING) {
+			integrating.push_back(cell);
+		}
+	}
+
+	std::sort(integrating.begin(), integrating.end(), [this, &focus](Cell* a, Cell* b) {
+		return this->get_distance(*a, focus) < this->get_distance(*b, focus);
+	});
+
+	for (Cell* cell : integrating) {
+		if (budget == 0) {
+			break;
+		}
+
+		budget -= std::min(budget, this->integrate(*cell, budget));
+
+		const SceneFile& file = *cell->read->file;
+		if (cell->nodes.size() == file.get_node_count() && cell->next_archetype == file.get_archetypes().size()) {
+			cell->state = CellState::RESIDENT;
+			cell->read.reset();
+		}
+	}
+
+	std::erase_if(this->active_cells, [](Cell* cell) {
+		return cell->state == CellState::UNLOADED || cell->state == CellState::FAILED;
+	});
+
+	// === Starting Reads ===
+
+	vector<std::pair<float, Cell*>> candidates;
+
+	const int32_t minX = static_cast<int32_t>(std::floor((focus.x - this->load_radius) / this->cell_size));
+	const int32_t maxX = static_cast<int32_t>(std::floor((focus.x + this->load_radius) / this->cell_size));
+	const int32_t minZ = static_cast<int32_t>(std::floor((focus.z - this->load_radius) / this->cell_size));
+	const int32_t maxZ = static_cast<int32_t>(std::floor((focus.z + this->load_radius) / this->cell_size));
+
+	for (int32_t z = minZ; z <= maxZ; z++) {
+		for (int32_t x = minX; x <= maxX; x++) {
+			auto it = this->cells.find(get_key(x, z));
+			if (it == this->cells.end() || it->second.state != CellState::UNLOADED) {
+				continue;
+			}
+
+			float distance = this->get_distance(it->second, focus);
+			if (distance <= this->load_radius) {
+				candidates.emplace_back(distance, &it->second);
+			}
+		}
+	}
+
+	std::sort(candidates.begin(), candidates.end(), [](const auto& a, const auto& b) {
+		return a.first < b.first;
+	});
+
+	for (auto& [distance, cell] : candidates) {
+		if (this->reads_in_flight >= this->max_reads_in_flight) {
+			break;
+		}
+
+		// The rest are further away, they don't get to push out what this one couldn't.
+		if (this->memory_usage + cell->memory_size > this->memory_budget && !this->make_room(cell->memory_size, distance, focus)) {
+			break;
+		}
+
+		this->start_read(*cell);
+		this->active_cells.push_back(cell);
+	}
+
+	if (error) {
+		std::rethrow_exception(error);
+	}
+}
+
+void SceneStreamer::start_read(Cell& cell) {
+	cell.state = CellState::READING;
+	cell.read = std::make_shared<Read>();
+
+	this->memory_usage += cell.memory_size;
+	this->reads_in_flight++;
+
+	if (this->file_io != nullptr) {
+		// The buffer lives in the shared read, so a dropped cell's read still has somewhere to go.
+		cell.read->bytes.resize(cell.memory_size);
+
+		AsyncFileIo::Request request;
+		request.path = cell.path;
+		request.destination = cell.read->bytes;
+		request.priority = std::numeric_limits<size_t>::max();
+		request.on_complete = [read = cell.read, path = cell.path](const AsyncFileIo::Result& result) {
+			try {
+				if (result.error) {
+					throw std::runtime_error("Couldn't read the scene cell \"" + path + "\": " + result.error.message());
+				}
+				if (!result.cancelled) {
+					if (result.bytes_read != read->bytes.size()) {
+						throw std::runtime_error("The scene cell \"" + path + "\" changed size since it was added.");
+					}
+					finish_read(*read, std::move(read->bytes));
+				}
+			}
+			catch (...) {
+				read->error = std::current_exception();
+			}
+
+			read->finished.store(true, std::memory_order_release);
+		};
+
+		cell.read->request_id = this->file_io->submit(std::move(request));
+		return;
+	}
+
+	auto job = [read = cell.read, path = cell.path]() {
+		try {
+			std::ifstream stream(path, std::ios::binary | std::ios::ate);
+			if (!stream) {
+				throw std::runtime_error("Couldn't open the scene cell \"" + path + "\".");
+			}
+
+			vector<std::byte> bytes(static_cast<size_t>(stream.tellg()));
+			stream.seekg(0);
+			stream.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+			if (!stream) {
+				throw std::runtime_error("Couldn't read the scene cell \"" + path + "\".");
+			}
+
+			finish_read(*read, std::move(bytes));
+		}
+		catch (...) {
+			read->error = std::current_exception();
+		}
+
+		read->finished.store(true, std::memory_order_release);
+	};
+
+	if (this->pool != nullptr) {
+		this->pool->submit(std::move(job), this->pool->priority_count - 1);
+	}
+	else {
+		job();
+	}
+}
+
+void SceneStreamer::finish_read(Read& read, vector<std::byte> bytes) {
+	// Everything that can fail is checked here, integrating can't throw halfway through.
+	read.file = std::make_unique<SceneFile>(std::move(bytes));
+	read.component_ids = read.file->get_component_ids();
+
+	// Parents come before their children, so one backwards pass sums every subtree.
+	std::span<const uint32_t> parents = read.file->get_parents();
+	vector<uint32_t> subtreeSizes(parents.size(), 1);
+	for (size_t i = parents.size(); i-- > 0;) {
+		if (parents[i] != Scene::INVALID_INDEX) {
+			subtreeSizes[parents[i]] += subtreeSizes[i];
+		}
+	}
+
+	const size_t rootCount = read.file->get_level_offsets().size() > 1 ? read.file->get_level_offsets()[1] : 0;
+	read.root_sizes.assign(subtreeSizes.begin(), subtreeSizes.begin() + rootCount);
+}
+
+void SceneStreamer::detach_read(Cell& cell) {
+	// A cancelled read still finishes, its callback runs either way.
+	if (this->file_io != nullptr && cell.read->request_id != 0) {
+		this->file_io->cancel(cell.read->request_id);
+	}
+
+	this->detached_reads.push_back(DetachedRead{ std::move(cell.read), cell.memory_size });
+	cell.state = CellState::UNLOADED;
+}
+
+uint32_t SceneStreamer::integrate(Cell& cell, uint32_t budget) {
+	const SceneFile& file = *cell.read->file;
+	uint32_t added = 0;
+
+	// Nodes first, every component row needs its node.
+	const uint32_t nodeCount = file.get_node_count();
+	if (cell.nodes.size() < nodeCount) {
+		uint32_t begin = static_cast<uint32_t>(cell.nodes.size());
+		uint32_t end = begin + std::min(budget, nodeCount - begin);
+		this->scene->instantiate_nodes(file, begin, end, cell.nodes);
+		added += end - begin;
+	}
+
+	std::span<const SceneFile::ArchetypeView> archetypes = file.get_archetypes();
+	while (added < budget && cell.nodes.size() == nodeCount && cell.next_archetype < archetypes.size()) {
+		uint32_t rowCount = static_cast<uint32_t>(archetypes[cell.next_archetype].nodes.size());
+		uint32_t end = cell.next_row + std::min(budget - added, rowCount - cell.next_row);
+
+		this->scene->instantiate_components(file, cell.read->component_ids, cell.next_archetype, cell.next_row, end, cell.nodes);
+		added += end - cell.next_row;
+		cell.next_row = end;
+
+		if (cell.next_row == rowCount) {
+			cell.next_archetype++;
+			cell.next_row = 0;
+		}
+	}
+
+	return added;
+}
+
+uint32_t SceneStreamer::unload(Cell& cell, uint32_t budget) {
+	// Roots are the file's first nodes, a partly integrated cell may not have all of them yet.
+	const size_t rootCount = std::min(cell.root_sizes.size(), cell.nodes.size());
+	uint32_t destroyed = 0;
+
+	while (cell.next_root < rootCount && (destroyed == 0 || destroyed + cell.root_sizes[cell.next_root] <= budget)) {
+		NodeHandle root = cell.nodes[cell.next_root];
+		if (this->scene->contains(root)) {
+			this->scene->destroy_node(root);
+		}
+
+		destroyed += cell.root_sizes[cell.next_root];
+		cell.next_root++;
+	}
+
+	return destroyed;
+}
+
+bool SceneStreamer::make_room(size_t memory_size, float distance, const glm::vec3& focus) {
+	vector<std::pair<float, Cell*>> further;
+	size_t freeable = 0;
+	size_t unloading = 0;
+
+	for (Cell* cell : this->active_cells) {
+		if (cell->state == CellState::UNLOADING) {
+			unloading += cell->memory_size;
+			continue;
+		}
+
+		float cellDistance = this->get_distance(*cell, focus);
+		if (cellDistance > distance && (cell->state == CellState::INTEGRATING || cell->state == CellState::RESIDENT)) {
+			further.emplace_back(cellDistance, cell);
+			freeable += cell->memory_size;
+		}
+	}
+
+	// Only unload anything when it would actually make enough room.
+	if (this->memory_usage - unloading - freeable + memory_size > this->memory_budget) {
+		return false;
+	}
+
+	std::sort(further.begin(), further.end(), [](const auto& a, const auto& b) {
+		return a.first > b.first;
+	});
+
+	size_t remaining = this->memory_usage - unloading;
+	for (auto& [cellDistance, cell] : further) {
+		if (remaining + memory_size <= this->memory_budget) {
+			break;
+		}
+		cell->state = CellState::UNLOADING;
+		remaining -= cell->memory_size;
+	}
+
+	// The memory is only free once the unloading finishes, the cell loads in a later update.
+	return this->memory_usage + memory_size <= this->memory_budget;
+}
+
+void SceneStreamer::unload_all() {
+	for (Cell* cell : this->active_cells) {
+		if (cell->state == CellState::READING) {
+			this->detach_read(*cell);
+			continue;
+		}
+
+		this->unload(*cell, std::numeric_limits<uint32_t>::max());
+		this->drop(*cell);
+		cell->state = CellState::UNLOADED;
+	}
+
+	this->active_cells.clear();
+}
+
+void SceneStreamer::drop(Cell& cell) {
+	if (cell.state != CellState::UNLOADED && cell.state != CellState::FAILED) {
+		this->memory_usage -= cell.memory_size;
+	}
+
+	cell.read.reset();
+	cell.nodes = vector<NodeHandle>();
+	cell.root_sizes = vector<uint32_t>();
+	cell.next_archetype = 0;
+	cell.next_row = 0;
+	cell.next_root = 0;
+}
+
+// === Cells ===
+
+void SceneStreamer::add_cell(int32_t x, int32_t z, const std::string& path) {
+	std::error_code errorCode;
+	uintmax_t fileSize = std::filesystem::file_size(path, errorCode);
+	if (errorCode) {
+		throw std::runtime_error("Couldn't find the scene cell \"" + path + "\": " + errorCode.message());
+	}
+
+	auto [it, inserted] = this->cells.try_emplace(get_key(x, z));
+	if (!inserted) {
+		throw std::invalid_argument("Cell " + std::to_string(x) + ", " + std::to_string(z) + " was already added.");
+	}
+
+	Cell& cell = it->second;
+	cell.x = x;
+	cell.z = z;
+	cell.path = path;
+	cell.memory_size = static_cast<size_t>(fileSize);
+}
+
+bool SceneStreamer::is_cell_resident(int32_t x, int32_t z) const {
+	auto it = this->cells.find(get_key(x, z));
+	return it != this->cells.end() && it->second.state == CellState::RESIDENT;
+}
+
+uint64_t SceneStreamer::get_key(int32_t x, int32_t z) {
+	return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(z);
+}
+
+float SceneStreamer::get_distance(const Cell& cell, const glm::vec3& focus) const {
+	float minX = static_cast<float>(cell.x) * this->cell_size;
+	float minZ = static_cast<float>(cell.z) * this->cell_size;
+
+	float dx = std::max({ minX - focus.x, 0.0f, focus.x - (minX + this->cell_size) });
+	float dz = std::max({ minZ - focus.z, 0.0f, focus.z - (minZ + this->cell_size) });
+	return std::sqrt(dx * dx + dz * dz);
+}
+
+// === Setters ===
+
+void SceneStreamer::set_focus(const glm::vec3& position) {
+	std::lock_guard<std::mutex> lock(this->focus_mutex);
+	this->focus = position;
+}
+
+void SceneStreamer::set_radii(float load_radius, float unload_radius) {
+	if (load_radius < 0.0f || unload_radius < load_radius) {
+		throw std::invalid_argument("The unload radius can't be smaller than the load radius.");
+	}
+	this->load_radius = load_radius;
+	this->unload_radius = unload_radius;
+}
+
+void SceneStreamer::set_memory_budget(size_t bytes) {
+	this->memory_budget = bytes;
+}
+
+void SceneStreamer::set_nodes_per_update(uint32_t node_count) {
+	this->nodes_per_update = std::max<uint32_t>(node_count, 1);
+}
+
+void SceneStreamer::set_max_reads_in_flight(size_t read_count) {
+	this->max_reads_in_flight = std::max<size_t>(read_count, 1);
+}
+
+void SceneStreamer::set_file_io(AsyncFileIo* file_io) {
+	this->file_io = file_io;
+}
+
+// === Getters ===
+
+size_t SceneStreamer::get_memory_usage() const {
+	return this->memory_usage;
+}
+
+size_t SceneStreamer::get_resident_cell_count() const {
+	size_t count = 0;
+	for (const Cell* cell : this->active_cells) {
+		if (cell->state == CellState::RESIDENT) {
+			count++;
+		}
+	}
+	return count;
+}
+
+size_t SceneStreamer::get_reads_in_flight() const {
+	return this->reads_in_flight;
+}
@@ -0,0 +1,568 @@
+#include "Engine/spatial/bvh.h"
+#include "Engine/thread_pool/thread_pool.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <stdexcept>
+
+// CODE FORMATTING INFORMATION:
+// Simple functions like getters and setters go at the bottom.
+// Organize from most complex at the top to least complex at the bottom.
+
+static constexpr size_t MIN_REBUILD_ITEMS = 64;
+static constexpr size_t TASKS_PER_WORKER = 4;
+
+// === Building ===
+
+void Bvh::rebuild() {
+	vector<BvhBuildItem> buildItems;
+	buildItems.reserve(this->item_count - this->removed_item_count);
+
+	for (uint32_t item = 0; item < this->item_count; item++) {
+		if (this->item_nodes[item].is_null()) {
+			continue;
+		}
+		Aabb bounds = this->get_item_bounds(item);
+		buildItems.push_back(BvhBuildItem{ bounds, bounds.get_center(), item });
+	}
+
+	BvhBuilder::build(buildItems, LEAF_SIZE, this->tree_nodes);
+
+	// Rewrite the items in leaf order.
+	vector<NodeHandle> sourceNodes(buildItems.size());
+	for (size_t i = 0; i < buildItems.size(); i++) {
+		sourceNodes[i] = this->item_nodes[buildItems[i].source];
+	}
+
+	this->item_count = 0;
+	this->resize_items(buildItems.size());
+	this->item_count = buildItems.size();
+	this->built_item_count = buildItems.size();
+	this->removed_item_count = 0;
+
+	for (uint32_t i = 0; i < buildItems.size(); i++) {
+		this->write_item(i, sourceNodes[i], buildItems[i].bounds);
+		this->item_slots[sourceNodes[i].index] = i;
+	}
+
+	this->surface_area_sum = 0.0;
+	for (uint32_t nodeIndex = 0; nodeIndex < this->tree_nodes.size(); nodeIndex++) {
+		const BvhNode& node = this->tree_nodes[nodeIndex];
+		this->surface_area_sum += node.bounds.get_surface_area();
+
+		if (node.is_leaf()) {
+			std::fill(
+				this->item_leaves.begin() + node.item_begin,
+				this->item_leaves.begin() + node.item_begin + node.item_count,
+				nodeIndex
+			);
+		}
+	}
+	this->built_surface_area_sum = this->surface_area_sum;
+
+	this->dirty_leaves.clear();
+	this->dirty_leaf_flags.assign(this->tree_nodes.size(), 0);
+}
+
+// === Refitting ===
+
+void Bvh::refit() {
+	for (uint32_t leaf : this->dirty_leaves) {
+		this->dirty_leaf_flags[leaf] = 0;
+
+		Aabb bounds = this->compute_leaf_bounds(this->tree_nodes[leaf]);
+		uint32_t nodeIndex = leaf;
+
+		// Walk up until a box stops changing, everything above it is still right.
+		while (!(bounds == this->tree_nodes[nodeIndex].bounds)) {
+			BvhNode& node = this->tree_nodes[nodeIndex];
+			this->surface_area_sum += bounds.get_surface_area() - node.bounds.get_surface_area();
+			node.bounds = bounds;
+
+			if (node.parent == INVALID_INDEX) {
+				break;
+			}
+
+			nodeIndex = node.parent;
+			uint32_t left = this->tree_nodes[nodeIndex].left;
+			bounds = Aabb::merge(this->tree_nodes[left].bounds, this->tree_nodes[left + 1].bounds);
+		}
+	}
+
+	this->dirty_leaves.clear();
+}
+
+Aabb Bvh::compute_leaf_bounds(const BvhNode& leaf) const {
+	Aabb bounds;
+	for (uint32_t item = leaf.item_begin; item < leaf.item_begin + leaf.item_count; item++) {
+		bounds.expand(this->get_item_bounds(item));
+	}
+	return bounds;
+}
+
+bool Bvh::needs_rebuild() const {
+	size_t pendingCount = this->item_count - this->built_item_count;
+
+	if (pendingCount > std::max(MIN_REBUILD_ITEMS, this->built_item_count / 8)) {
+		return true;
+	}
+	if (this->removed_item_count > std::max(MIN_REBUILD_ITEMS, this->item_count / 4)) {
+		return true;
+	}
+	return this->built_surface_area_sum > 0.0
+		&& this->surface_area_sum > this->built_surface_area_sum * this->rebuild_threshold;
+}
+
+// === Culling ===
+
+void Bvh::cull(const Frustum& frustum, vector<NodeHandle>& visible, ThreadPool::Pool* pool) {
+	visible.clear();
+
+	this->cull_tasks.clear();
+	if (!this->tree_nodes.empty()) {
+		this->cull_tasks.push_back(CullTask{ 0, false });
+	}
+
+	// Split the top of the tree into enough subtrees to keep every worker busy.  Expanding in
+	// place keeps the subtrees in item order.
+	const size_t targetTaskCount = pool != nullptr ? pool->thread_count * TASKS_PER_WORKER : 1;
+
+	while (!this->cull_tasks.empty() && this->cull_tasks.size() < targetTaskCount) {
+		bool expanded = false;
+		this->next_cull_tasks.clear();
+
+		for (const CullTask& task : this->cull_tasks) {
+			const BvhNode& node = this->tree_nodes[task.node];
+
+			if (task.inside || node.is_leaf()) {
+				this->next_cull_tasks.push_back(task);
+				continue;
+			}
+
+			for (uint32_t child = node.left; child <= node.left + 1; child++) {
+				Frustum::Result result = frustum.classify(this->tree_nodes[child].bounds);
+				if (result != Frustum::Result::OUTSIDE) {
+					this->next_cull_tasks.push_back(CullTask{ child, result == Frustum::Result::INSIDE });
+				}
+			}
+			expanded = true;
+		}
+
+		std::swap(this->cull_tasks, this->next_cull_tasks);
+		if (!expanded) {
+			break;
+		}
+	}
+
+	const size_t taskCount = this->cull_tasks.size();
+	if (this->task_visible.size() < taskCount + 1) {
+		this->task_visible.resize(taskCount + 1);
+		this->task_stacks.resize(taskCount + 1);
+		this->task_scratch.resize(taskCount + 1);
+	}
+
+	auto run_task = [this, &frustum](size_t task) {
+		this->task_visible[task].clear();
+		this->cull_subtree(frustum, this->cull_tasks[task], this->task_visible[task], this->task_stacks[task], this->task_scratch[task]);
+	};
+
+	if (pool != nullptr && taskCount > 1) {
+		pool->parallel_for(taskCount, 1, [&run_task](size_t begin, size_t end) {
+			for (size_t task = begin; task < end; task++) {
+				run_task(task);
+			}
+		});
+	}
+	else {
+		for (size_t task = 0; task < taskCount; task++) {
+			run_task(task);
+		}
+	}
+
+	for (size_t task = 0; task < taskCount; task++) {
+		visible.insert(visible.end(), this->task_visible[task].begin(), this->task_visible[task].end());
+	}
+
+	// Items added since the last rebuild aren't in the tree yet.
+	this->cull_items(frustum, static_cast<uint32_t>(this->built_item_count), static_cast<uint32_t>(this->item_count), visible, this->task_scratch[taskCount]);
+}
+
+void Bvh::cull_subtree(const Frustum& frustum, CullTask root, vector<NodeHandle>& visible, vector<CullTask>& stack, vector<uint32_t>& scratch) const {
+	stack.clear();
+	stack.push_back(root);
+
+	while (!stack.empty()) {
+		CullTask task = stack.back();
+		stack.pop_back();
+
+		const BvhNode& node = this->tree_nodes[task.node];
+
+		if (!task.inside) {
+			Frustum::Result result = frustum.classify(node.bounds);
+			if (result == Frustum::Result::OUTSIDE) {
+				continue;
+			}
+			task.inside = result == Frustum::Result::INSIDE;
+		}
+
+		if (task.inside) {
+			this->add_visible_items(node.item_begin, node.item_begin + node.item_count, visible);
+		}
+		else if (node.is_leaf()) {
+			this->cull_items(frustum, node.item_begin, node.item_begin + node.item_count, visible, scratch);
+		}
+		else {
+			// Right first so the left subtree comes out first, in item order.
+			stack.push_back(CullTask{ node.left + 1, false });
+			stack.push_back(CullTask{ node.left, false });
+		}
+	}
+}
+
+void Bvh::cull_items(const Frustum& frustum, uint32_t begin, uint32_t end, vector<NodeHandle>& visible, vector<uint32_t>& scratch) const {
+	if (begin >= end) {
+		return;
+	}
+
+	if (scratch.size() < end - begin) {
+		scratch.resize(end - begin);
+	}
+
+	size_t visibleCount = FrustumCulling::cull_boxes(frustum, this->get_box_arrays(), begin, end, scratch.data());
+
+	for (size_t i = 0; i < visibleCount; i++) {
+		NodeHandle node = this->item_nodes[scratch[i]];
+		if (!node.is_null()) {
+			visible.push_back(node);
+		}
+	}
+}
+
+void Bvh::add_visible_items(uint32_t begin, uint32_t end, vector<NodeHandle>& visible) const {
+	for (uint32_t item = begin; item < end; item++) {
+		if (!this->item_nodes[item].is_null()) {
+			visible.push_back(this->item_nodes[item]);
+		}
+	}
+}
+
+// === Scene Queries ===
+
+void Bvh::intersect(RayPacket& packet, RayHit* hits, vector<uint32_t>& stack) const {
+	auto test_items = [this, &packet, hits](uint32_t begin, uint32_t end, uint32_t lane_mask) {
+		Float8 entry = Float8::zero();
+
+		for (uint32_t item = begin; item < end; item++) {
+			if (this->item_nodes[item].is_null()) {
+				continue;
+			}
+
+			uint32_t mask = packet.intersect_box(this->get_item_bounds(item), entry) & lane_mask;
+			if (mask == 0) {
+				continue;
+			}
+
+			alignas(32) float entries[RayPacket::SIZE];
+			entry.store(entries);
+
+			for (; mask != 0; mask &= mask - 1) {
+				uint32_t lane = static_cast<uint32_t>(std::countr_zero(mask));
+				packet.distance[lane] = entries[lane];
+				hits[lane].node = this->item_nodes[item];
+				hits[lane].distance = entries[lane];
+				hits[lane].normal = glm::vec3(0.0f);
+				hits[lane].triangle = RayHit::NO_TRIANGLE;
+			}
+		}
+	};
+
+	RayTraversal::traverse(this->tree_nodes, packet, stack, [&test_items](const BvhNode& leaf, uint32_t lane_mask) {
+		test_items(leaf.item_begin, leaf.item_begin + leaf.item_count, lane_mask);
+	});
+
+	test_items(static_cast<uint32_t>(this->built_item_count), static_cast<uint32_t>(this->item_count), packet.active_mask);
+}
+
+void Bvh::overlap_sphere(const glm::vec3& center, float radius, vector<NodeHandle>& overlaps, vector<uint32_t>& stack) const {
+	const float radiusSquared = radius * radius;
+
+	auto test_items = [this, &center, radiusSquared, &overlaps](uint32_t begin, uint32_t end) {
+		for (uint32_t first = begin; first < end; first += 8) {
+			uint32_t mask = (this->get_distances_squared(first, center) <= Float8::broadcast(radiusSquared)).get_mask();
+			mask &= this->get_live_mask(first, end);
+
+			for (; mask != 0; mask &= mask - 1) {
+				overlaps.push_back(this->item_nodes[first + std::countr_zero(mask)]);
+			}
+		}
+	};
+
+	stack.clear();
+	if (!this->tree_nodes.empty()) {
+		stack.push_back(0);
+	}
+
+	while (!stack.empty()) {
+		const BvhNode& node = this->tree_nodes[stack.back()];
+		stack.pop_back();
+
+		glm::vec3 offset = glm::clamp(center, node.bounds.min, node.bounds.max) - center;
+		if (glm::dot(offset, offset) > radiusSquared) {
+			continue;
+		}
+
+		if (node.is_leaf()) {
+			test_items(node.item_begin, node.item_begin + node.item_count);
+		}
+		else {
+			stack.push_back(node.left + 1);
+			stack.push_back(node.left);
+		}
+	}
+
+	test_items(static_cast<uint32_t>(this->built_item_count), static_cast<uint32_t>(this->item_count));
+}
+
+NearestHit Bvh::find_nearest(const glm::vec3& point, float max_distance, vector<uint32_t>& stack) const {
+	float bestSquared = max_distance < std::sqrt(std::numeric_limits<float>::max())
+		? max_distance * max_distance
+		: std::numeric_limits<float>::max();
+	NodeHandle bestNode;
+
+	auto test_items = [this, &point, &bestSquared, &bestNode](uint32_t begin, uint32_t end) {
+		alignas(32) float distances[8];
+
+		for (uint32_t first = begin; first < end; first += 8) {
+			Float8 distancesSquared = this->get_distances_squared(first, point);
+			uint32_t mask = (distancesSquared <= Float8::broadcast(bestSquared)).get_mask();
+			mask &= this->get_live_mask(first, end);
+			if (mask == 0) {
+				continue;
+			}
+
+			distancesSquared.store(distances);
+			for (; mask != 0; mask &= mask - 1) {
+				uint32_t lane = static_cast<uint32_t>(std::countr_zero(mask));
+				if (distances[lane] <= bestSquared) {
+					bestSquared = distances[lane];
+					bestNode = this->item_nodes[first + lane];
+				}
+			}
+		}
+	};
+
+	auto get_node_distance_squared = [&point](const BvhNode& node) {
+		glm::vec3 offset = glm::clamp(point, node.bounds.min, node.bounds.max) - point;
+		return glm::dot(offset, offset);
+	};
+
+	// Pending items first, they give the tree walk a distance to prune with.
+	test_items(static_cast<uint32_t>(this->built_item_count), static_cast<uint32_t>(this->item_count));
+
+	stack.clear();
+	if (!this->tree_nodes.empty()) {
+		stack.push_back(0);
+	}
+
+	while (!stack.empty()) {
+		const BvhNode& node = this->tree_nodes[stack.back()];
+		stack.pop_back();
+
+		if (get_node_distance_squared(node) > bestSquared) {
+			continue;
+		}
+
+		if (node.is_leaf()) {
+			test_items(node.item_begin, node.item_begin + node.item_count);
+			continue;
+		}
+
+		// The closer child goes on top of the stack.
+		const BvhNode& left = this->tree_nodes[node.left];
+		const BvhNode& right = this->tree_nodes[node.left + 1];
+		if (get_node_distance_squared(left) <= get_node_distance_squared(right)) {
+			stack.push_back(node.left + 1);
+			stack.push_back(node.left);
+		}
+		else {
+			stack.push_back(node.left);
+			stack.push_back(node.left + 1);
+		}
+	}
+
+	if (bestNode.is_null()) {
+		return NearestHit();
+	}
+	return NearestHit{ bestNode, std::sqrt(bestSquared) };
+}
+
+Float8 Bvh::get_distances_squared(uint32_t first, const glm::vec3& point) const {
+	// The distance to a box is the distance to the point clamped into it.
+	Float8 x = Float8::broadcast(point.x);
+	Float8 y = Float8::broadcast(point.y);
+	Float8 z = Float8::broadcast(point.z);
+
+	Float8 offsetX = Float8::max(Float8::min(x, Float8::load(&this->max_x[first])), Float8::load(&this->min_x[first])) - x;
+	Float8 offsetY = Float8::max(Float8::min(y, Float8::load(&this->max_y[first])), Float8::load(&this->min_y[first])) - y;
+	Float8 offsetZ = Float8::max(Float8::min(z, Float8::load(&this->max_z[first])), Float8::load(&this->min_z[first])) - z;
+
+	return offsetX * offsetX + offsetY * offsetY + offsetZ * offsetZ;
+}
+
+uint32_t Bvh::get_live_mask(uint32_t first, uint32_t end) const {
+	uint32_t mask = 0;
+	for (uint32_t lane = 0; lane < 8 && first + lane < end; lane++) {
+		mask |= static_cast<uint32_t>(!this->item_nodes[first + lane].is_null()) << lane;
+	}
+	return mask;
+}
+
+// === Items ===
+
+void Bvh::set_bounds(NodeHandle node, const Aabb& bounds) {
+	if (node.index < this->item_slots.size() && this->item_slots[node.index] != INVALID_INDEX) {
+		uint32_t item = this->item_slots[node.index];
+
+		if (this->item_nodes[item] == node) {
+			this->write_item(item, node, bounds);
+
+			uint32_t leaf = this->item_leaves[item];
+			if (leaf != INVALID_INDEX && !this->dirty_leaf_flags[leaf]) {
+				this->dirty_leaf_flags[leaf] = 1;
+				this->dirty_leaves.push_back(leaf);
+			}
+			return;
+		}
+
+		// The slot still holds an older node with the same index.
+		this->remove(this->item_nodes[item]);
+	}
+
+	this->add_item(node, bounds);
+}
+
+uint32_t Bvh::add_item(NodeHandle node, const Aabb& bounds) {
+	uint32_t item = static_cast<uint32_t>(this->item_count);
+
+	this->resize_items(this->item_count + 1);
+	this->item_count++;
+	this->write_item(item, node, bounds);
+	this->item_leaves[item] = INVALID_INDEX;
+
+	if (node.index >= this->item_slots.size()) {
+		this->item_slots.resize(static_cast<size_t>(node.index) + 1, INVALID_INDEX);
+	}
+	this->item_slots[node.index] = item;
+
+	return item;
+}
+
+void Bvh::remove(NodeHandle node) {
+	if (!this->contains(node)) {
+		return;
+	}
+
+	uint32_t item = this->item_slots[node.index];
+	this->item_slots[node.index] = INVALID_INDEX;
+
+	// Left behind as an empty box, which every frustum test rejects, until the next rebuild.
+	this->write_item(item, NodeHandle(), Aabb());
+	this->removed_item_count++;
+
+	uint32_t leaf = this->item_leaves[item];
+	if (leaf != INVALID_INDEX && !this->dirty_leaf_flags[leaf]) {
+		this->dirty_leaf_flags[leaf] = 1;
+		this->dirty_leaves.push_back(leaf);
+	}
+}
+
+void Bvh::write_item(uint32_t item, NodeHandle node, const Aabb& bounds) {
+	this->min_x[item] = bounds.min.x;
+	this->min_y[item] = bounds.min.y;
+	this->min_z[item] = bounds.min.z;
+	this->max_x[item] = bounds.max.x;
+	this->max_y[item] = bounds.max.y;
+	this->max_z[item] = bounds.max.z;
+	this->item_nodes[item] = node;
+}
+
+void Bvh::resize_items(size_t count) {
+	// The padding is empty boxes, the kernels may read it but it is never visible.
+	const Aabb empty;
+	const size_t paddedCount = count + FrustumCulling::LANE_PADDING;
+
+	this->min_x.resize(paddedCount, empty.min.x);
+	this->min_y.resize(paddedCount, empty.min.y);
+	this->min_z.resize(paddedCount, empty.min.z);
+	this->max_x.resize(paddedCount, empty.max.x);
+	this->max_y.resize(paddedCount, empty.max.y);
+	this->max_z.resize(paddedCount, empty.max.z);
+
+	this->item_nodes.resize(count);
+	this->item_leaves.resize(count, INVALID_INDEX);
+}
+
+void Bvh::clear() {
+	this->min_x.clear();
+	this->min_y.clear();
+	this->min_z.clear();
+	this->max_x.clear();
+	this->max_y.clear();
+	this->max_z.clear();
+	this->item_nodes.clear();
+	this->item_leaves.clear();
+	this->item_slots.clear();
+	this->item_count = 0;
+	this->built_item_count = 0;
+	this->removed_item_count = 0;
+
+	this->tree_nodes.clear();
+	this->dirty_leaves.clear();
+	this->dirty_leaf_flags.clear();
+	this->surface_area_sum = 0.0;
+	this->built_surface_area_sum = 0.0;
+}
+
+// === Setters ===
+
+void Bvh::set_rebuild_threshold(float threshold) {
+	if (threshold < 1.0f) {
+		throw std::invalid_argument("Bvh rebuild threshold must be at least 1.");
+	}
+	this->rebuild_threshold = threshold;
+}
+
+// === Getters ===
+
+Aabb Bvh::get_item_bounds(uint32_t item) const {
+	Aabb bounds;
+	bounds.min = glm::vec3(this->min_x[item], this->min_y[item], this->min_z[item]);
+	bounds.max = glm::vec3(this->max_x[item], this->max_y[item], this->max_z[item]);
+	return bounds;
+}
+
+BoxArrays Bvh::get_box_arrays() const {
+	return BoxArrays{
+		this->min_x.data(),
+		this->min_y.data(),
+		this->min_z.data(),
+		this->max_x.data(),
+		this->max_y.data(),
+		this->max_z.data()
+	};
+}
+
+bool Bvh::contains(NodeHandle node) const {
+	return !node.is_null()
+		&& node.index < this->item_slots.size()
+		&& this->item_slots[node.index] != INVALID_INDEX
+		&& this->item_nodes[this->item_slots[node.index]] == node;
+}
+
+size_t Bvh::size() const {
+	return this->item_count - this->removed_item_count;
+}
+
+size_t Bvh::get_tree_node_count() const {
+	return this->tree_nodes.size();
+}
@@ -0,0 +1,142 @@
+#include "Engine/spatial/bvh_builder.h"
+#include <algorithm>
+#include <array>
+
+static constexpr uint32_t BIN_COUNT = 16;
+
+namespace {
+
+	struct Bin {
+		Aabb bounds;
+		uint32_t count = 0;
+	};
+};
+
+void BvhBuilder::build(vector<BvhBuildItem>& items, uint32_t leaf_size, vector<BvhNode>& nodes) {
+	nodes.clear();
+
+	if (!items.empty()) {
+		Aabb rootBounds;
+		for (const BvhBuildItem& buildItem : items) {
+			rootBounds.expand(buildItem.bounds);
+		}
+		nodes.push_back(BvhNode{ rootBounds, BvhNode::INVALID_INDEX, BvhNode::INVALID_INDEX, 0, static_cast<uint32_t>(items.size()) });
+	}
+
+	vector<uint32_t> stack;
+	if (!nodes.empty()) {
+		stack.push_back(0);
+	}
+
+	while (!stack.empty()) {
+		uint32_t nodeIndex = stack.back();
+		stack.pop_back();
+
+		const uint32_t begin = nodes[nodeIndex].item_begin;
+		const uint32_t count = nodes[nodeIndex].item_count;
+
+		if (count <= leaf_size) {
+			continue;
+		}
+
+		auto first = items.begin() + begin;
+		auto last = first + count;
+
+		Aabb centroidBounds;
+		for (auto it = first; it != last; it++) {
+			centroidBounds.expand(it->centroid);
+		}
+
+		glm::vec3 extent = centroidBounds.max - centroidBounds.min;
+		int axis = 0;
+		if (extent.y > extent[axis]) {
+			axis = 1;
+		}
+		if (extent.z > extent[axis]) {
+			axis = 2;
+		}
+
+		uint32_t leftCount = 0;
+		Aabb leftBounds;
+		Aabb rightBounds;
+
+		if (extent[axis] > 0.0f) {
+			// Bin the centroids along the widest axis and split where the surface area heuristic
+			// is lowest.
+			std::array<Bin, BIN_COUNT> bins;
+			const float binScale = BIN_COUNT / extent[axis];
+			const float axisMin = centroidBounds.min[axis];
+
+			auto get_bin = [&](const BvhBuildItem& buildItem) {
+				uint32_t bin = static_cast<uint32_t>((buildItem.centroid[axis] - axisMin) * binScale);
+				return std::min(bin, BIN_COUNT - 1);
+			};
+
+			for (auto it = first; it != last; it++) {
+				Bin& bin = bins[get_bin(*it)];
+				bin.bounds.expand(it->bounds);
+				bin.count++;
+			}
+
+			std::array<float, BIN_COUNT> rightCosts;
+			Aabb sweepBounds;
+			uint32_t sweepCount = 0;
+			for (uint32_t i = BIN_COUNT - 1; i > 0; i--) {
+				sweepBounds.expand(bins[i].bounds);
+				sweepCount += bins[i].count;
+				rightCosts[i] = sweepCount * sweepBounds.get_surface_area();
+			}
+
+			float bestCost = std::numeric_limits<float>::max();
+			uint32_t bestSplit = 0;
+			sweepBounds = Aabb();
+			sweepCount = 0;
+			for (uint32_t i = 0; i < BIN_COUNT - 1; i++) {
+				sweepBounds.expand(bins[i].bounds);
+				sweepCount += bins[i].count;
+
+				if (sweepCount == 0 || sweepCount == count) {
+					continue;
+				}
+
+				float cost = sweepCount * sweepBounds.get_surface_area() + rightCosts[i + 1];
+				if (cost < bestCost) {
+					bestCost = cost;
+					bestSplit = i;
+				}
+			}
+
+			if (bestCost < std::numeric_limits<float>::max()) {
+				auto middle = std::partition(first, last, [&](const BvhBuildItem& buildItem) {
+					return get_bin(buildItem) <= bestSplit;
+				});
+				leftCount = static_cast<uint32_t>(middle - first);
+
+				for (uint32_t i = 0; i < BIN_COUNT; i++) {
+					(i <= bestSplit ? leftBounds : rightBounds).expand(bins[i].bounds);
+				}
+			}
+		}
+
+		if (leftCount == 0) {
+			// Every centroid is in the same spot, split the items in half.
+			leftCount = count / 2;
+			std::nth_element(first, first + leftCount, last, [axis](const BvhBuildItem& a, const BvhBuildItem& b) {
+				return a.centroid[axis] < b.centroid[axis];
+			});
+
+			for (auto it = first; it != last; it++) {
+				(it < first + leftCount ? leftBounds : rightBounds).expand(it->bounds);
+			}
+		}
+
+		uint32_t left = static_cast<uint32_t>(nodes.size());
+		nodes[nodeIndex].left = left;
+		nodes.push_back(BvhNode{ leftBounds, BvhNode::INVALID_INDEX, nodeIndex, begin, leftCount });
+		nodes.push_back(BvhNode{ rightBounds, BvhNode::INVALID_INDEX, nodeIndex, begin + leftCount, count - leftCount });
+
+		stack.push_back(left + 1);
+		stack.push_back(left);
+	}
+
+}
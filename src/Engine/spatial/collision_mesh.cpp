@@ -0,0 +1,146 @@
+#include "Engine/spatial/collision_mesh.h"
+#include <bit>
+#include <stdexcept>
+
+// === Class Functions ===
+
+CollisionMesh::CollisionMesh(NodeHandle node, std::span<const glm::vec3> vertices, std::span<const uint32_t> indices)
+	: node(node)
+{
+	if (indices.size() % 3 != 0) {
+		throw std::invalid_argument("Collision mesh index count must be a multiple of 3.");
+	}
+
+	const size_t triangleCount = indices.size() / 3;
+
+	vector<BvhBuildItem> buildItems;
+	buildItems.reserve(triangleCount);
+
+	for (size_t triangle = 0; triangle < triangleCount; triangle++) {
+		Aabb triangleBounds;
+		for (size_t corner = 0; corner < 3; corner++) {
+			uint32_t index = indices[triangle * 3 + corner];
+			if (index >= vertices.size()) {
+				throw std::out_of_range("Collision mesh index out of range.");
+			}
+			triangleBounds.expand(vertices[index]);
+		}
+
+		buildItems.push_back(BvhBuildItem{ triangleBounds, triangleBounds.get_center(), static_cast<uint32_t>(triangle) });
+		this->bounds.expand(triangleBounds);
+	}
+
+	BvhBuilder::build(buildItems, LEAF_SIZE, this->tree_nodes);
+
+	this->corner_x.resize(triangleCount);
+	this->corner_y.resize(triangleCount);
+	this->corner_z.resize(triangleCount);
+	this->edge1_x.resize(triangleCount);
+	this->edge1_y.resize(triangleCount);
+	this->edge1_z.resize(triangleCount);
+	this->edge2_x.resize(triangleCount);
+	this->edge2_y.resize(triangleCount);
+	this->edge2_z.resize(triangleCount);
+	this->triangle_indices.resize(triangleCount);
+
+	for (size_t i = 0; i < triangleCount; i++) {
+		uint32_t triangle = buildItems[i].source;
+		const glm::vec3& a = vertices[indices[triangle * 3]];
+		glm::vec3 edge1 = vertices[indices[triangle * 3 + 1]] - a;
+		glm::vec3 edge2 = vertices[indices[triangle * 3 + 2]] - a;
+
+		this->corner_x[i] = a.x;
+		this->corner_y[i] = a.y;
+		this->corner_z[i] = a.z;
+		this->edge1_x[i] = edge1.x;
+		this->edge1_y[i] = edge1.y;
+		this->edge1_z[i] = edge1.z;
+		this->edge2_x[i] = edge2.x;
+		this->edge2_y[i] = edge2.y;
+		this->edge2_z[i] = edge2.z;
+		this->triangle_indices[i] = triangle;
+	}
+}
+
+// === Ray Queries ===
+
+void CollisionMesh::intersect(RayPacket& packet, RayHit* hits, vector<uint32_t>& stack) const {
+	const Float8 originX = Float8::load(packet.origin_x);
+	const Float8 originY = Float8::load(packet.origin_y);
+	const Float8 originZ = Float8::load(packet.origin_z);
+	const Float8 directionX = Float8::load(packet.direction_x);
+	const Float8 directionY = Float8::load(packet.direction_y);
+	const Float8 directionZ = Float8::load(packet.direction_z);
+	const Float8 zero = Float8::zero();
+	const Float8 one = Float8::broadcast(1.0f);
+	const Float8 epsilon = Float8::broadcast(1e-12f);
+
+	RayTraversal::traverse(this->tree_nodes, packet, stack, [&](const BvhNode& leaf, uint32_t lane_mask) {
+		for (uint32_t i = leaf.item_begin; i < leaf.item_begin + leaf.item_count; i++) {
+			// Moller-Trumbore, one triangle against every ray of the packet.
+			const Float8 edge1X = Float8::broadcast(this->edge1_x[i]);
+			const Float8 edge1Y = Float8::broadcast(this->edge1_y[i]);
+			const Float8 edge1Z = Float8::broadcast(this->edge1_z[i]);
+			const Float8 edge2X = Float8::broadcast(this->edge2_x[i]);
+			const Float8 edge2Y = Float8::broadcast(this->edge2_y[i]);
+			const Float8 edge2Z = Float8::broadcast(this->edge2_z[i]);
+
+			Float8 pX = directionY * edge2Z - directionZ * edge2Y;
+			Float8 pY = directionZ * edge2X - directionX * edge2Z;
+			Float8 pZ = directionX * edge2Y - directionY * edge2X;
+			Float8 determinant = edge1X * pX + edge1Y * pY + edge1Z * pZ;
+			Float8 inverseDeterminant = one / determinant;
+
+			Float8 tX = originX - Float8::broadcast(this->corner_x[i]);
+			Float8 tY = originY - Float8::broadcast(this->corner_y[i]);
+			Float8 tZ = originZ - Float8::broadcast(this->corner_z[i]);
+			Float8 u = (tX * pX + tY * pY + tZ * pZ) * inverseDeterminant;
+
+			Float8 qX = tY * edge1Z - tZ * edge1Y;
+			Float8 qY = tZ * edge1X - tX * edge1Z;
+			Float8 qZ = tX * edge1Y - tY * edge1X;
+			Float8 v = (directionX * qX + directionY * qY + directionZ * qZ) * inverseDeterminant;
+			Float8 distance = (edge2X * qX + edge2Y * qY + edge2Z * qZ) * inverseDeterminant;
+
+			uint32_t mask = (
+				(determinant * determinant > epsilon)
+				& (u >= zero)
+				& (v >= zero)
+				& (u + v <= one)
+				& (distance >= zero)
+				& (distance < Float8::load(packet.distance))
+			).get_mask() & lane_mask;
+
+			if (mask == 0) {
+				continue;
+			}
+
+			alignas(32) float distances[RayPacket::SIZE];
+			distance.store(distances);
+
+			glm::vec3 normal = glm::normalize(glm::cross(
+				glm::vec3(this->edge1_x[i], this->edge1_y[i], this->edge1_z[i]),
+				glm::vec3(this->edge2_x[i], this->edge2_y[i], this->edge2_z[i])
+			));
+
+			for (; mask != 0; mask &= mask - 1) {
+				uint32_t lane = static_cast<uint32_t>(std::countr_zero(mask));
+				packet.distance[lane] = distances[lane];
+				hits[lane].node = this->node;
+				hits[lane].distance = distances[lane];
+				hits[lane].normal = normal;
+				hits[lane].triangle = this->triangle_indices[i];
+			}
+		}
+	});
+}
+
+// === Getters ===
+
+const Aabb& CollisionMesh::get_bounds() const {
+	return this->bounds;
+}
+
+size_t CollisionMesh::get_triangle_count() const {
+	return this->triangle_indices.size();
+}
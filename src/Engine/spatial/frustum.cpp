@@ -0,0 +1,181 @@
+#include "Engine/spatial/frustum.h"
+#include <bit>
+#include <cmath>
+
+#if defined(__AVX__)
+	#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define FRUSTUM_CULLING_SSE
+	#include <emmintrin.h>
+#endif
+
+// === Frustum ===
+
+Frustum Frustum::from_view_projection(const glm::mat4& view_projection) {
+	// glm matrices are column major, the rows are read across the columns.
+	auto row = [&view_projection](int index) {
+		return glm::vec4(view_projection[0][index], view_projection[1][index], view_projection[2][index], view_projection[3][index]);
+	};
+
+	glm::vec4 row0 = row(0);
+	glm::vec4 row1 = row(1);
+	glm::vec4 row2 = row(2);
+	glm::vec4 row3 = row(3);
+
+	Frustum frustum;
+	frustum.planes[0] = row3 + row0;
+	frustum.planes[1] = row3 - row0;
+	frustum.planes[2] = row3 + row1;
+	frustum.planes[3] = row3 - row1;
+	// The -1 to 1 depth near plane, it also holds (more loosely) for Vulkan's 0 to 1 depth range.
+	frustum.planes[4] = row3 + row2;
+	frustum.planes[5] = row3 - row2;
+
+	for (glm::vec4& plane : frustum.planes) {
+		float length = std::sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+		if (length > 0.0f) {
+			plane *= 1.0f / length;
+		}
+	}
+
+	return frustum;
+}
+
+Frustum::Result Frustum::classify(const Aabb& box) const {
+	if (box.is_empty()) {
+		return Result::OUTSIDE;
+	}
+
+	Result result = Result::INSIDE;
+
+	for (const glm::vec4& plane : this->planes) {
+		// The corner furthest along the normal, and the one furthest against it.
+		glm::vec3 positive(
+			plane.x >= 0.0f ? box.max.x : box.min.x,
+			plane.y >= 0.0f ? box.max.y : box.min.y,
+			plane.z >= 0.0f ? box.max.z : box.min.z
+		);
+		glm::vec3 negative(
+			plane.x >= 0.0f ? box.min.x : box.max.x,
+			plane.y >= 0.0f ? box.min.y : box.max.y,
+			plane.z >= 0.0f ? box.min.z : box.max.z
+		);
+
+		if (plane.x * positive.x + plane.y * positive.y + plane.z * positive.z + plane.w < 0.0f) {
+			return Result::OUTSIDE;
+		}
+		if (plane.x * negative.x + plane.y * negative.y + plane.z * negative.z + plane.w < 0.0f) {
+			result = Result::INTERSECTING;
+		}
+	}
+
+	return result;
+}
+
+// === Culling Kernels ===
+
+namespace {
+
+	struct PlaneCorner {
+		const float* x;
+		const float* y;
+		const float* z;
+		float normal_x;
+		float normal_y;
+		float normal_z;
+		float distance;
+	};
+
+	void get_plane_corners(const Frustum& frustum, const BoxArrays& boxes, PlaneCorner* corners) {
+		// The plane is the same for every box, so which corner to test is picked once per plane
+		// instead of per box.
+		for (int i = 0; i < 6; i++) {
+			const glm::vec4& plane = frustum.planes[i];
+			corners[i] = PlaneCorner{
+				plane.x >= 0.0f ? boxes.max_x : boxes.min_x,
+				plane.y >= 0.0f ? boxes.max_y : boxes.min_y,
+				plane.z >= 0.0f ? boxes.max_z : boxes.min_z,
+				plane.x,
+				plane.y,
+				plane.z,
+				plane.w
+			};
+		}
+	}
+
+	size_t write_visible(uint32_t mask, size_t first, size_t lanes, size_t end, uint32_t* visible) {
+		if (first + lanes > end) {
+			mask &= (1u << (end - first)) - 1;
+		}
+
+		size_t count = 0;
+		while (mask != 0) {
+			int lane = std::countr_zero(mask);
+			visible[count++] = static_cast<uint32_t>(first + lane);
+			mask &= mask - 1;
+		}
+		return count;
+	}
+};
+
+size_t FrustumCulling::cull_boxes(const Frustum& frustum, const BoxArrays& boxes, size_t begin, size_t end, uint32_t* visible) {
+	PlaneCorner corners[6];
+	get_plane_corners(frustum, boxes, corners);
+
+	size_t visibleCount = 0;
+
+#if defined(__AVX__)
+	for (size_t i = begin; i < end; i += 8) {
+		__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+
+		for (const PlaneCorner& corner : corners) {
+			__m256 distance = _mm256_add_ps(
+				_mm256_add_ps(
+					_mm256_mul_ps(_mm256_loadu_ps(corner.x + i), _mm256_set1_ps(corner.normal_x)),
+					_mm256_mul_ps(_mm256_loadu_ps(corner.y + i), _mm256_set1_ps(corner.normal_y))
+				),
+				_mm256_add_ps(
+					_mm256_mul_ps(_mm256_loadu_ps(corner.z + i), _mm256_set1_ps(corner.normal_z)),
+					_mm256_set1_ps(corner.distance)
+				)
+			);
+			inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, _mm256_setzero_ps(), _CMP_GE_OQ));
+		}
+
+		visibleCount += write_visible(static_cast<uint32_t>(_mm256_movemask_ps(inside)), i, 8, end, visible + visibleCount);
+	}
+#elif defined(FRUSTUM_CULLING_SSE)
+	for (size_t i = begin; i < end; i += 4) {
+		__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+
+		for (const PlaneCorner& corner : corners) {
+			__m128 distance = _mm_add_ps(
+				_mm_add_ps(
+					_mm_mul_ps(_mm_loadu_ps(corner.x + i), _mm_set1_ps(corner.normal_x)),
+					_mm_mul_ps(_mm_loadu_ps(corner.y + i), _mm_set1_ps(corner.normal_y))
+				),
+				_mm_add_ps(
+					_mm_mul_ps(_mm_loadu_ps(corner.z + i), _mm_set1_ps(corner.normal_z)),
+					_mm_set1_ps(corner.distance)
+				)
+			);
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, _mm_setzero_ps()));
+		}
+
+		visibleCount += write_visible(static_cast<uint32_t>(_mm_movemask_ps(inside)), i, 4, end, visible + visibleCount);
+	}
+#else
+	for (size_t i = begin; i < end; i++) {
+		bool inside = true;
+		for (const PlaneCorner& corner : corners) {
+			// Written so NaN (an empty box times a zero normal) counts as outside.
+			inside = inside && corner.x[i] * corner.normal_x + corner.y[i] * corner.normal_y + corner.z[i] * corner.normal_z + corner.distance >= 0.0f;
+		}
+		if (inside) {
+			visible[visibleCount++] = static_cast<uint32_t>(i);
+		}
+	}
+#endif
+
+	return visibleCount;
+}
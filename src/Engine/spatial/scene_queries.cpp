@@ -0,0 +1,274 @@
+#include "Engine/spatial/scene_queries.h"
+#include "Engine/thread_pool/thread_pool.h"
+#include <algorithm>
+#include <stdexcept>
+
+// CODE FORMATTING INFORMATION:
+// Simple functions like getters and setters go at the bottom.
+// Organize from most complex at the top to least complex at the bottom.
+
+static constexpr size_t PACKETS_PER_JOB = 8;
+static constexpr size_t QUERIES_PER_JOB = 64;
+
+// === Class Functions ===
+
+SceneQueries::SceneQueries() {
+	this->set_thread_pool(nullptr);
+}
+
+// === Execution ===
+
+void SceneQueries::execute(const Bvh* bvh) {
+	ThreadPool::Pool* pool = this->pool;
+
+	this->gather(this->batch);
+	this->batch++;
+
+	this->execute_rays(bvh);
+
+	this->overlaps.resize(std::max(this->overlaps.size(), this->batch_spheres.size()));
+	this->nearest_hits.resize(this->batch_nearest.size());
+
+	auto run_spheres = [this, bvh](size_t begin, size_t end) {
+		vector<uint32_t>& stack = this->get_stack();
+		for (size_t i = begin; i < end; i++) {
+			this->overlaps[i].clear();
+			if (bvh != nullptr) {
+				bvh->overlap_sphere(this->batch_spheres[i].center, this->batch_spheres[i].radius, this->overlaps[i], stack);
+			}
+		}
+	};
+
+	auto run_nearest = [this, bvh](size_t begin, size_t end) {
+		vector<uint32_t>& stack = this->get_stack();
+		for (size_t i = begin; i < end; i++) {
+			this->nearest_hits[i] = bvh != nullptr
+				? bvh->find_nearest(this->batch_nearest[i].point, this->batch_nearest[i].max_distance, stack)
+				: NearestHit();
+		}
+	};
+
+	if (pool != nullptr) {
+		pool->parallel_for(this->batch_spheres.size(), QUERIES_PER_JOB, run_spheres);
+		pool->parallel_for(this->batch_nearest.size(), QUERIES_PER_JOB, run_nearest);
+	}
+	else {
+		run_spheres(0, this->batch_spheres.size());
+		run_nearest(0, this->batch_nearest.size());
+	}
+}
+
+void SceneQueries::execute_rays(const Bvh* bvh) {
+	const size_t rayCount = this->batch_rays.size();
+	this->ray_hits.assign(rayCount, RayHit());
+
+	if (rayCount == 0) {
+		return;
+	}
+
+	this->sort_rays();
+
+	const size_t packetCount = (rayCount + RayPacket::SIZE - 1) / RayPacket::SIZE;
+
+	auto run_packets = [this, bvh, rayCount](size_t begin, size_t end) {
+		vector<uint32_t>& stack = this->get_stack();
+		RayPacket packet;
+		RayHit hits[RayPacket::SIZE];
+
+		for (size_t packetIndex = begin; packetIndex < end; packetIndex++) {
+			const size_t first = packetIndex * RayPacket::SIZE;
+			const uint32_t laneCount = static_cast<uint32_t>(std::min<size_t>(RayPacket::SIZE, rayCount - first));
+
+			packet.clear();
+			for (uint32_t lane = 0; lane < laneCount; lane++) {
+				packet.set_ray(lane, this->batch_rays[this->ray_order[first + lane]]);
+				hits[lane] = RayHit();
+			}
+
+			if (bvh != nullptr) {
+				bvh->intersect(packet, hits, stack);
+			}
+			for (const CollisionMesh* mesh : this->collision_meshes) {
+				mesh->intersect(packet, hits, stack);
+			}
+
+			for (uint32_t lane = 0; lane < laneCount; lane++) {
+				this->ray_hits[this->ray_order[first + lane]] = hits[lane];
+			}
+		}
+	};
+
+	if (this->pool != nullptr) {
+		this->pool->parallel_for(packetCount, PACKETS_PER_JOB, run_packets);
+	}
+	else {
+		run_packets(0, packetCount);
+	}
+}
+
+void SceneQueries::sort_rays() {
+	const size_t rayCount = this->batch_rays.size();
+
+	Aabb origins;
+	for (const Ray& ray : this->batch_rays) {
+		origins.expand(ray.origin);
+	}
+
+	// 10 bits per axis of the origin interleaved, under the direction's octant.
+	auto spread_bits = [](uint32_t value) {
+		uint64_t bits = value & 0x3FF;
+		bits = (bits | (bits << 16)) & 0x030000FF;
+		bits = (bits | (bits << 8)) & 0x0300F00F;
+		bits = (bits | (bits << 4)) & 0x030C30C3;
+		bits = (bits | (bits << 2)) & 0x09249249;
+		return bits;
+	};
+
+	glm::vec3 extent = origins.max - origins.min;
+	glm::vec3 scale(
+		extent.x > 0.0f ? 1023.0f / extent.x : 0.0f,
+		extent.y > 0.0f ? 1023.0f / extent.y : 0.0f,
+		extent.z > 0.0f ? 1023.0f / extent.z : 0.0f
+	);
+
+	this->ray_keys.resize(rayCount);
+	this->ray_order.resize(rayCount);
+
+	for (size_t i = 0; i < rayCount; i++) {
+		const Ray& ray = this->batch_rays[i];
+		glm::vec3 cell = (ray.origin - origins.min) * scale;
+
+		uint64_t octant =
+			(ray.direction.x < 0.0f ? 1u : 0u) |
+			(ray.direction.y < 0.0f ? 2u : 0u) |
+			(ray.direction.z < 0.0f ? 4u : 0u);
+
+		this->ray_keys[i] = (octant << 30)
+			| spread_bits(static_cast<uint32_t>(cell.x))
+			| (spread_bits(static_cast<uint32_t>(cell.y)) << 1)
+			| (spread_bits(static_cast<uint32_t>(cell.z)) << 2);
+		this->ray_order[i] = static_cast<uint32_t>(i);
+	}
+
+	std::sort(this->ray_order.begin(), this->ray_order.end(), [this](uint32_t a, uint32_t b) {
+		return this->ray_keys[a] < this->ray_keys[b];
+	});
+}
+
+void SceneQueries::gather(uint64_t batch) {
+	this->batch_rays.clear();
+	this->batch_spheres.clear();
+	this->batch_nearest.clear();
+
+	for (auto& recorder : this->recorders) {
+		std::lock_guard<std::mutex> lock(recorder->mutex);
+
+		recorder->ray_offset = this->batch_rays.size();
+		recorder->sphere_offset = this->batch_spheres.size();
+		recorder->nearest_offset = this->batch_nearest.size();
+
+		this->batch_rays.insert(this->batch_rays.end(), recorder->rays.begin(), recorder->rays.end());
+		this->batch_spheres.insert(this->batch_spheres.end(), recorder->spheres.begin(), recorder->spheres.end());
+		this->batch_nearest.insert(this->batch_nearest.end(), recorder->nearest.begin(), recorder->nearest.end());
+
+		recorder->rays.clear();
+		recorder->spheres.clear();
+		recorder->nearest.clear();
+
+		// Anything recorded from here on belongs to the next batch.
+		recorder->result_batch = recorder->batch;
+		recorder->batch = batch + 1;
+	}
+}
+
+// === Recording ===
+
+SceneQueryTicket SceneQueries::raycast(const Ray& ray) {
+	uint32_t recorderIndex;
+	Recorder& recorder = this->get_recorder(recorderIndex);
+
+	std::lock_guard<std::mutex> lock(recorder.mutex);
+	recorder.rays.push_back(ray);
+	return SceneQueryTicket{ recorder.batch, recorderIndex, static_cast<uint32_t>(recorder.rays.size() - 1) };
+}
+
+SceneQueryTicket SceneQueries::overlap_sphere(const glm::vec3& center, float radius) {
+	uint32_t recorderIndex;
+	Recorder& recorder = this->get_recorder(recorderIndex);
+
+	std::lock_guard<std::mutex> lock(recorder.mutex);
+	recorder.spheres.push_back(SphereQuery{ center, radius });
+	return SceneQueryTicket{ recorder.batch, recorderIndex, static_cast<uint32_t>(recorder.spheres.size() - 1) };
+}
+
+SceneQueryTicket SceneQueries::find_nearest(const glm::vec3& point, float max_distance) {
+	uint32_t recorderIndex;
+	Recorder& recorder = this->get_recorder(recorderIndex);
+
+	std::lock_guard<std::mutex> lock(recorder.mutex);
+	recorder.nearest.push_back(NearestQuery{ point, max_distance });
+	return SceneQueryTicket{ recorder.batch, recorderIndex, static_cast<uint32_t>(recorder.nearest.size() - 1) };
+}
+
+SceneQueries::Recorder& SceneQueries::get_recorder(uint32_t& recorder_index) {
+	size_t workerIndex = this->pool != nullptr ? this->pool->get_current_worker_index() : SIZE_MAX;
+	recorder_index = static_cast<uint32_t>(std::min(workerIndex, this->recorders.size() - 1));
+	return *this->recorders[recorder_index];
+}
+
+// === Results ===
+
+const SceneQueries::Recorder& SceneQueries::get_result_recorder(SceneQueryTicket ticket) const {
+	if (ticket.recorder >= this->recorders.size() || this->recorders[ticket.recorder]->result_batch != ticket.batch) {
+		throw std::logic_error("Scene query results are only available from the batch after the query until the next one.");
+	}
+	return *this->recorders[ticket.recorder];
+}
+
+const RayHit& SceneQueries::get_ray_hit(SceneQueryTicket ticket) const {
+	return this->ray_hits[this->get_result_recorder(ticket).ray_offset + ticket.index];
+}
+
+std::span<const NodeHandle> SceneQueries::get_overlaps(SceneQueryTicket ticket) const {
+	return this->overlaps[this->get_result_recorder(ticket).sphere_offset + ticket.index];
+}
+
+const NearestHit& SceneQueries::get_nearest(SceneQueryTicket ticket) const {
+	return this->nearest_hits[this->get_result_recorder(ticket).nearest_offset + ticket.index];
+}
+
+// === Setters ===
+
+void SceneQueries::set_thread_pool(ThreadPool::Pool* pool) {
+	this->pool = pool;
+
+	const size_t workerCount = pool != nullptr ? pool->thread_count : 0;
+
+	this->recorders.clear();
+	for (size_t i = 0; i < workerCount + 1; i++) {
+		this->recorders.push_back(std::make_unique<Recorder>());
+		this->recorders.back()->batch = this->batch;
+	}
+
+	this->stacks.resize(workerCount + 1);
+}
+
+void SceneQueries::add_collision_mesh(const CollisionMesh* mesh) {
+	this->collision_meshes.push_back(mesh);
+}
+
+void SceneQueries::remove_collision_mesh(const CollisionMesh* mesh) {
+	std::erase(this->collision_meshes, mesh);
+}
+
+// === Getters ===
+
+vector<uint32_t>& SceneQueries::get_stack() {
+	// The calling thread may not be a worker, it gets the last stack.
+	size_t workerIndex = this->pool != nullptr ? this->pool->get_current_worker_index() : SIZE_MAX;
+	return this->stacks[std::min(workerIndex, this->stacks.size() - 1)];
+}
+
+size_t SceneQueries::get_batch_ray_count() const {
+	return this->batch_rays.size();
+}
@@ -0,0 +1,74 @@
+#include "Engine/spatial/visibility.h"
+#include "Engine/scene/scene.h"
+
+// Scene files holding bounds can be loaded before anything culls.
+REGISTER_COMPONENT(Bounds);
+
+// === Updating ===
+
+void Visibility::update(Scene& scene) {
+	ComponentStore& components = scene.get_components();
+	std::lock_guard<std::mutex> lock(this->bvh_mutex);
+
+	// Bounds that were added or changed, only their chunks are visited.
+	components.query<const Bounds>()
+		.changed_since<const Bounds>(this->bounds_version)
+		.for_each(nullptr, [this, &scene](NodeHandle node, const Bounds& bounds) {
+			this->bvh.set_bounds(node, Aabb::transform(bounds.local, scene.get_world_matrix(node)));
+		});
+
+	// Nodes that moved.
+	for (const Scene::IndexRange& range : scene.get_updated_ranges()) {
+		for (uint32_t index = range.begin; index < range.end; index++) {
+			NodeHandle node = scene.get_node_at(index);
+
+			if (!this->bvh.contains(node)) {
+				continue;
+			}
+
+			const Bounds* bounds = components.get_component<const Bounds>(node);
+			if (bounds == nullptr) {
+				this->bvh.remove(node);
+				continue;
+			}
+
+			this->bvh.set_bounds(node, Aabb::transform(bounds->local, scene.get_world_matrix(node)));
+		}
+	}
+
+	this->bounds_version = components.get_change_version();
+
+	if (this->bvh.needs_rebuild()) {
+		this->bvh.rebuild();
+	}
+	else {
+		this->bvh.refit();
+	}
+}
+
+void Visibility::cull(const Frustum& frustum, vector<NodeHandle>& visible, ThreadPool::Pool* pool) {
+	this->bvh.cull(frustum, visible, pool);
+}
+
+void Visibility::remove_nodes(std::span<const NodeHandle> nodes) {
+	std::lock_guard<std::mutex> lock(this->bvh_mutex);
+	for (NodeHandle node : nodes) {
+		this->bvh.remove(node);
+	}
+}
+
+void Visibility::clear() {
+	std::lock_guard<std::mutex> lock(this->bvh_mutex);
+	this->bvh.clear();
+	this->bounds_version = 0;
+}
+
+// === Getters ===
+
+Bvh& Visibility::get_bvh() {
+	return this->bvh;
+}
+
+std::mutex& Visibility::get_bvh_mutex() {
+	return this->bvh_mutex;
+}
@@ -0,0 +1,158 @@
+#include "Engine/texture/texture_file.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+// CODE FORMATTING INFORMATION:
+// Simple functions like getters and setters go at the bottom.
+// Organize from most complex at the top to least complex at the bottom.
+
+static constexpr uint64_t LEVEL_ALIGNMENT = 16;
+
+static void throw_invalid(const std::string& reason) {
+	throw std::runtime_error("Invalid texture file: " + reason);
+}
+
+// === Class Functions ===
+
+TextureFile::TextureFile(const std::string& path)
+	: mapped_file(path)
+{
+	this->data = this->mapped_file.get_data();
+	this->fix_up();
+}
+
+TextureFile::TextureFile(vector<std::byte> bytes)
+	: bytes(std::move(bytes))
+{
+	this->data = this->bytes;
+	this->fix_up();
+}
+
+TextureFile TextureFile::view(std::span<const std::byte> data) {
+	TextureFile texture;
+	texture.data = data;
+	texture.fix_up();
+	return texture;
+}
+
+bool TextureFile::is_block_compressed(TextureFormat format) {
+	return format != TextureFormat::RGBA8_UNORM && format != TextureFormat::RGBA8_SRGB;
+}
+
+uint64_t TextureFile::get_layer_size(TextureFormat format, uint32_t width, uint32_t height) {
+	const uint64_t blockCount = static_cast<uint64_t>((width + 3) / 4) * ((height + 3) / 4);
+
+	switch (format) {
+	case TextureFormat::RGBA8_UNORM:
+	case TextureFormat::RGBA8_SRGB:
+		return static_cast<uint64_t>(width) * height * 4;
+	case TextureFormat::BC1_UNORM:
+	case TextureFormat::BC1_SRGB:
+		return blockCount * 8;
+	case TextureFormat::BC3_UNORM:
+	case TextureFormat::BC3_SRGB:
+	case TextureFormat::BC5_UNORM:
+	case TextureFormat::BC7_UNORM:
+	case TextureFormat::BC7_SRGB:
+		return blockCount * 16;
+	}
+	throw std::invalid_argument("Unknown texture format " + std::to_string(static_cast<uint32_t>(format)) + ".");
+}
+
+// === Loading ===
+
+void TextureFile::fix_up() {
+	if (this->data.size() < sizeof(TextureFileHeader)) {
+		throw_invalid("too small for a header.");
+	}
+
+	this->header = reinterpret_cast<const TextureFileHeader*>(this->data.data());
+
+	if (this->header->magic != TextureFileHeader::MAGIC) {
+		throw_invalid("not a texture file.");
+	}
+	if (this->header->version != TextureFileHeader::VERSION) {
+		throw_invalid("version " + std::to_string(this->header->version) + ", expected " + std::to_string(TextureFileHeader::VERSION) + ".");
+	}
+	if (this->header->file_size != this->data.size()) {
+		throw_invalid("the file is " + std::to_string(this->data.size()) + " bytes but should be " + std::to_string(this->header->file_size) + ".");
+	}
+
+	if (this->header->width == 0 || this->header->height == 0 || this->header->layer_count == 0) {
+		throw_invalid("the texture is empty.");
+	}
+	if (this->header->mip_count == 0 || this->header->mip_count > TextureFileHeader::MAX_MIP_COUNT
+		|| (std::max(this->header->width, this->header->height) >> (this->header->mip_count - 1)) == 0) {
+		throw_invalid(std::to_string(this->header->mip_count) + " mip levels for a " + std::to_string(this->header->width) + "x" + std::to_string(this->header->height) + " texture.");
+	}
+
+	try {
+		get_layer_size(this->header->format, 1, 1);
+	}
+	catch (const std::invalid_argument&) {
+		throw_invalid("unknown format.");
+	}
+
+	// The levels go to the GPU untouched, a level smaller than its extent would be read past.
+	for (uint32_t mip = 0; mip < this->header->mip_count; mip++) {
+		const TextureFileLevel& level = this->header->levels[mip];
+		const uint32_t width = std::max(this->header->width >> mip, 1u);
+		const uint32_t height = std::max(this->header->height >> mip, 1u);
+		if (level.width != width || level.height != height) {
+			throw_invalid("mip " + std::to_string(mip) + " isn't half the size of the one above.");
+		}
+
+		const uint64_t layerSize = get_layer_size(this->header->format, width, height);
+		if (level.size != layerSize * this->header->layer_count) {
+			throw_invalid("mip " + std::to_string(mip) + " doesn't hold every layer.");
+		}
+		if (level.offset % LEVEL_ALIGNMENT != 0 || level.offset > this->data.size() || level.size > this->data.size() - level.offset) {
+			throw_invalid("mip " + std::to_string(mip) + " lies outside the file.");
+		}
+	}
+}
+
+// === Getters ===
+
+TextureFormat TextureFile::get_format() const {
+	return this->header->format;
+}
+
+uint32_t TextureFile::get_width() const {
+	return this->header->width;
+}
+
+uint32_t TextureFile::get_height() const {
+	return this->header->height;
+}
+
+uint32_t TextureFile::get_mip_count() const {
+	return this->header->mip_count;
+}
+
+uint32_t TextureFile::get_layer_count() const {
+	return this->header->layer_count;
+}
+
+const TextureFileLevel& TextureFile::get_level(uint32_t mip) const {
+	return this->header->levels[mip];
+}
+
+std::span<const std::byte> TextureFile::get_level_data(uint32_t mip) const {
+	const TextureFileLevel& level = this->header->levels[mip];
+	return this->data.subspan(level.offset, level.size);
+}
+
+std::span<const std::byte> TextureFile::get_layer_data(uint32_t mip, uint32_t layer) const {
+	const uint64_t layerSize = this->header->levels[mip].size / this->header->layer_count;
+	return this->get_level_data(mip).subspan(layer * layerSize, layerSize);
+}
+
+std::span<const std::byte> TextureFile::get_data() const {
+	return this->data;
+}
+
+size_t TextureFile::size() const {
+	return this->data.size();
+}
@@ -1,9 +1,18 @@
 #include "Engine/thread_pool/thread_pool.h"
+#include <algorithm>
 #include <iostream>
 
 
 namespace ThreadPool {
 
+    namespace {
+        constexpr size_t INJECTION_QUEUE_CAPACITY = 4096;
+
+        // Which pool the current thread works for, if any.
+        thread_local const Pool* currentPool = nullptr;
+        thread_local size_t currentWorkerIndex = 0;
+    }
+
     Worker::Worker(size_t priority_count) {
         deques.reserve(priority_count);
         for (size_t i = 0; i < priority_count; i++) {
@@ -15,6 +24,11 @@ namespace ThreadPool {
         size_t priority_count,
         size_t thread_count
     ) : priority_count(priority_count), thread_count(thread_count) {
+        injection_queues.reserve(priority_count);
+        for (size_t i = 0; i < priority_count; i++) {
+            injection_queues.push_back(std::make_unique<MPMCQueue<Job>>(INJECTION_QUEUE_CAPACITY));
+        }
+
         workers.reserve(thread_count);
 
         for (size_t i = 0; i < thread_count; i++) {
@@ -45,13 +59,96 @@ namespace ThreadPool {
     void Pool::submit(std::function<void()> work, size_t priority) {
         active_jobs.fetch_add(1, std::memory_order_relaxed);
 
-        thread_local static size_t worker_hint =
-            std::hash<std::thread::id>{}(std::this_thread::get_id()) % workers.size();
+        if (this->workers.empty()) {
+            this->run_job(work);
+            return;
+        }
 
         size_t priority_idx = static_cast<size_t>(priority);
-        workers[worker_hint]->deques[priority_idx]->push(Job(work));
+        size_t workerIndex = this->get_current_worker_index();
+
+        if (workerIndex < this->workers.size()) {
+            // Only the owner may push onto a worker's deque.
+            workers[workerIndex]->deques[priority_idx]->push(std::move(work));
+        }
+        else {
+            // Workers take from the injection queue before stealing, so it can only stay full briefly.
+            while (!injection_queues[priority_idx]->try_push(std::move(work))) {
+                std::this_thread::yield();
+            }
+        }
+
+        // Wake a sleeping worker so short jobs don't wait out the idle timeout.
+        shutdown_cv.notify_one();
+    }
+
+    size_t Pool::get_current_worker_index() const {
+        return currentPool == this ? currentWorkerIndex : this->thread_count;
+    }
+
+    void Pool::parallel_for(
+        size_t count,
+        size_t chunk_size,
+        const std::function<void(size_t, size_t)>& work,
+        size_t priority
+    ) {
+        if (count == 0) {
+            return;
+        }
+
+        chunk_size = std::max<size_t>(chunk_size, 1);
+        size_t chunkCount = (count + chunk_size - 1) / chunk_size;
+
+        if (chunkCount == 1 || this->workers.empty()) {
+            work(0, count);
+            return;
+        }
+
+        // Shared with the helper jobs which can outlive this call if a worker
+        // only picks one up after every chunk was already claimed.
+        struct Batch {
+            std::atomic<size_t> next_chunk{ 0 };
+            std::atomic<size_t> finished_chunks{ 0 };
+            std::mutex exception_mutex;
+            std::exception_ptr exception;
+        };
+
+        auto batch = std::make_shared<Batch>();
+
+        // `work` is only touched after claiming a valid chunk, and this function doesn't
+        // return until every claimed chunk has finished, so referencing it is safe.
+        auto runChunks = [batch, &work, count, chunk_size, chunkCount]() {
+            size_t chunk;
+            while ((chunk = batch->next_chunk.fetch_add(1, std::memory_order_relaxed)) < chunkCount) {
+                size_t begin = chunk * chunk_size;
+                size_t end = std::min(begin + chunk_size, count);
+                try {
+                    work(begin, end);
+                }
+                catch (...) {
+                    std::lock_guard<std::mutex> lock(batch->exception_mutex);
+                    if (!batch->exception) {
+                        batch->exception = std::current_exception();
+                    }
+                }
+                batch->finished_chunks.fetch_add(1, std::memory_order_acq_rel);
+            }
+        };
+
+        size_t helperCount = std::min(chunkCount - 1, this->workers.size());
+        for (size_t i = 0; i < helperCount; i++) {
+            this->submit(runChunks, priority);
+        }
+
+        runChunks();
+
+        while (batch->finished_chunks.load(std::memory_order_acquire) < chunkCount) {
+            std::this_thread::yield();
+        }
 
-        worker_hint = (worker_hint + 1) % workers.size();
+        if (batch->exception) {
+            std::rethrow_exception(batch->exception);
+        }
     }
 
     void Pool::wait() {
@@ -62,6 +159,8 @@ namespace ThreadPool {
 
     void Pool::worker_loop(size_t worker_id) {
         Worker& self = *workers[worker_id];
+        currentPool = this;
+        currentWorkerIndex = worker_id;
         std::random_device rd;
         std::mt19937 gen(rd());
 
@@ -74,18 +173,7 @@ namespace ThreadPool {
             std::optional<Job> job = get_job_by_priority(self, worker_id, gen);
 
             if (job.has_value()) {
-                if (job.value()) {
-                    try {
-                        job.value()();
-                        active_jobs.fetch_sub(1, std::memory_order_release);
-                    }
-                    catch (...) {
-                        active_jobs.fetch_sub(1, std::memory_order_release);
-                    }
-                }
-                else {
-                    active_jobs.fetch_sub(1, std::memory_order_release);
-                }
+                this->run_job(job.value());
             }
             else {
                 // Wait on condition variable with timeout
@@ -99,31 +187,35 @@ namespace ThreadPool {
 
         for (size_t p = 0; p < self.deques.size(); p++) {
             std::optional<Job> job = std::nullopt;
-            int jobCount = 0;
             while ((job = self.deques[p]->pop()).has_value()) {
-                jobCount++;
-                if (job.value()) {
-                    try {
-                        job.value()();
-                        active_jobs.fetch_sub(1, std::memory_order_release);
-                    }
-                    catch (...) {
-                        active_jobs.fetch_sub(1, std::memory_order_release);
-                    }
-                }
-                else {
-                    active_jobs.fetch_sub(1, std::memory_order_release);
-                }
+                this->run_job(job.value());
+            }
+            while ((job = injection_queues[p]->try_pop()).has_value()) {
+                this->run_job(job.value());
             }
         }
 
     }
 
+    void Pool::run_job(Job& job) {
+        if (job) {
+            try {
+                job();
+            }
+            catch (...) {
+            }
+        }
+        active_jobs.fetch_sub(1, std::memory_order_release);
+    }
+
     std::optional<Job> Pool::get_job_by_priority(Worker& self, size_t worker_id, std::mt19937& gen) {
-        // First, try own deques from highest to lowest priority
+        // First, try own deques and then the injection queue from highest to lowest priority
         for (size_t p = 0; p < this->priority_count; p++) {
             auto job = self.deques[p]->pop();
             if (job.has_value()) return job;
+
+            job = injection_queues[p]->try_pop();
+            if (job.has_value()) return job;
         }
 
         // If no local work, try to steal from others (priority-aware)
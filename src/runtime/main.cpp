@@ -7,9 +7,20 @@
 
 #include "Engine/constants.h"
 #include "Engine/engine.h"
+#include "Engine/io/virtual_file_system.h"
 #include "Engine/logging/logger.h"
+#include "Engine/scene/scene.h"
+#include "Engine/scene/scene_file.h"
+#include "Engine/spatial/aabb.h"
 #include "Engine/thread_pool/thread_pool.h"
+#include "Engine/render_backends/headless/headless_render_backend.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <memory>
 #include <stdexcept>
+#include <string>
 
 #ifdef RENDER_BACKEND_PROGRESSIVE
 #include "Engine/render_backends/progressive/progressive_render_backend.h"
@@ -21,13 +32,72 @@
 
 using std::cout, std::endl;
 
+static constexpr const char* DEFAULT_SCENE_PATH = "./game_data/main.scene";
+static constexpr const char* DEFAULT_PACK_PATH = "./game_data.pack";
+
+static double get_milliseconds_since(std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void run_scene_load_benchmark(size_t node_count, ThreadPool::Pool* pool) {
+	// A forest of small subtrees with bounds on every node, roughly the shape of a level.
+	using Clock = std::chrono::steady_clock;
+	static constexpr size_t SUBTREE_SIZE = 16;
+
+	cout << "\n - Building a " << node_count << " node scene" << endl;
+
+	Clock::time_point start = Clock::now();
+	Scene sourceScene;
+	{
+		NodeHandle parent;
+		for (size_t i = 0; i < node_count; i++) {
+			NodeHandle node = sourceScene.create_node(i % SUBTREE_SIZE == 0 ? NodeHandle() : parent);
+			sourceScene.set_local_position(node, glm::vec3(static_cast<float>(i % 1000), static_cast<float>(i / 1000 % 1000), static_cast<float>(i % 7)));
+			sourceScene.get_components().add_component<Bounds>(node, Bounds{ Aabb{ glm::vec3(-1.0f), glm::vec3(1.0f) } });
+
+			// Every fourth node gets children, the rest are leaves.
+			if (i % 4 == 0) {
+				parent = node;
+			}
+		}
+		sourceScene.update_world_transforms(pool);
+	}
+	double createMilliseconds = get_milliseconds_since(start);
+
+	const std::string path = (std::filesystem::temp_directory_path() / "scene_load_benchmark.scene").string();
+
+	start = Clock::now();
+	SceneFile::save(sourceScene, path);
+	double saveMilliseconds = get_milliseconds_since(start);
+
+	start = Clock::now();
+	SceneFile file(path);
+	double mapMilliseconds = get_milliseconds_since(start);
+
+	start = Clock::now();
+	Scene loadedScene;
+	loadedScene.instantiate(file);
+	double instantiateMilliseconds = get_milliseconds_since(start);
+
+	start = Clock::now();
+	loadedScene.update_world_transforms(pool);
+	double propagateMilliseconds = get_milliseconds_since(start);
+
+	cout << " - Created node by node in " << createMilliseconds << "ms\n"
+		<< " - Saved " << file.size() / (1024.0 * 1024.0) << "MB in " << saveMilliseconds << "ms\n"
+		<< " - Mapped and validated in " << mapMilliseconds << "ms\n"
+		<< " - Instantiated " << loadedScene.size() << " nodes in " << instantiateMilliseconds << "ms\n"
+		<< " - First world transform update " << propagateMilliseconds << "ms" << endl;
+
+	std::remove(path.c_str());
+}
+
 int main(int argc, char** argv)
 {
 	cout << "Runtime starting...  \n\n" << ENGINE_NAME << " Engine v" << GET_ENGINE_VERSION() << "\n" << endl;
 
-	// TODO: Replace this code once game-data loading logic is available.
-	// For now just create a test window.
-	// Game-data loading logic will choose the render backend and load in the initial scene and node state.
+	// Game data is the initial scene, a binary scene file that is mapped and instantiated as is.
+	// Without one the runtime starts with an empty scene.
 	try {
 
 		// Log pipes must be added to vector this way to avoid copying
@@ -55,29 +125,125 @@ int main(int argc, char** argv)
 		// add 2 to the threadcount for the logger which has its own dedicated thread and the main thread
 		cout << " - Using " << threadPool.thread_count + 2 << " threads" << endl;
 
+		// Command line options for running without a window:
+		//   --headless              run the game loop without a window or GPU
+		//   --frames <count>        stop after this many frames
+		//   --fixed-step <seconds>  simulate this much time every frame instead of real time
+		//   --record <path>         record input and the fixed update schedule to a file
+		//   --replay <path>         play a recording back instead of live input
+		//   --hidden                keep the window hidden
+		//   --scene <path>          the scene to start with, defaults to DEFAULT_SCENE_PATH when it exists
+		//   --benchmark-scene-load <node count>  time saving and loading a scene of that size, then exit
+		//   --pack <path>           mount a pack, can be repeated, defaults to DEFAULT_PACK_PATH when it exists
+		//   --no-loose-files        only read game files from packs
+		bool headless = false;
+		[[maybe_unused]] bool hidden = false;
+		uint64_t maxFrameCount = 0;
+		float fixedFrameDeltaTime = 0.0f;
+		std::string recordPath;
+		std::string replayPath;
+		std::string scenePath;
+		size_t benchmarkNodeCount = 0;
+		vector<std::string> packPaths;
+		bool looseFiles = true;
+
+		for (int i = 1; i < argc; i++) {
+			if (std::strcmp(argv[i], "--headless") == 0) {
+				headless = true;
+			}
+			else if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+				maxFrameCount = std::stoull(argv[++i]);
+			}
+			else if (std::strcmp(argv[i], "--fixed-step") == 0 && i + 1 < argc) {
+				fixedFrameDeltaTime = std::stof(argv[++i]);
+			}
+			else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+				recordPath = argv[++i];
+			}
+			else if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+				replayPath = argv[++i];
+			}
+			else if (std::strcmp(argv[i], "--hidden") == 0) {
+				hidden = true;
+			}
+			else if (std::strcmp(argv[i], "--scene") == 0 && i + 1 < argc) {
+				scenePath = argv[++i];
+			}
+			else if (std::strcmp(argv[i], "--benchmark-scene-load") == 0 && i + 1 < argc) {
+				benchmarkNodeCount = std::stoull(argv[++i]);
+			}
+			else if (std::strcmp(argv[i], "--pack") == 0 && i + 1 < argc) {
+				packPaths.push_back(argv[++i]);
+			}
+			else if (std::strcmp(argv[i], "--no-loose-files") == 0) {
+				looseFiles = false;
+			}
+		}
+
+		if (benchmarkNodeCount > 0) {
+			run_scene_load_benchmark(benchmarkNodeCount, &threadPool);
+			return 0;
+		}
+
+#ifdef RENDER_BACKEND_HEADLESS
+		headless = true;
+#endif // RENDER_BACKEND_HEADLESS
+
 		// Create render backend
+		std::unique_ptr<RenderBackend> renderBackend;
+
+		if (headless) {
+			renderBackend = std::make_unique<HeadlessRenderBackend>(
+				nullptr,
+				fixedFrameDeltaTime,
+				maxFrameCount
+			);
+
+			cout << " - Using Headless Render Backend" << endl;
+		}
+		else {
+#if defined(RENDER_BACKEND_PROGRESSIVE) || defined(RENDER_BACKEND_COMPATIBILITY)
+			Uint32 sdl_windowFlags = SDL_WINDOW_RESIZABLE | (hidden ? SDL_WINDOW_HIDDEN : SDL_WINDOW_SHOWN);
+#endif // RENDER_BACKEND_PROGRESSIVE || RENDER_BACKEND_COMPATIBILITY
+
 #ifdef RENDER_BACKEND_PROGRESSIVE
-		ProgressiveRenderBackend renderBackend = ProgressiveRenderBackend(
-			nullptr
-		);
+			renderBackend = std::make_unique<ProgressiveRenderBackend>(
+				nullptr,
+				sdl_windowFlags
+			);
 
-		cout << " - Using Progressive Render Backend" << endl;
+			cout << " - Using Progressive Render Backend" << endl;
 
 #endif // RENDER_BACKEND_PROGRESSIVE
 
 #ifdef RENDER_BACKEND_COMPATIBILITY
-		CompatibilityRenderBackend renderBackend = CompatibilityRenderBackend(
-			nullptr
-		);
+			renderBackend = std::make_unique<CompatibilityRenderBackend>(
+				nullptr,
+				sdl_windowFlags
+			);
 		
-		cout << " - Using Compatibility Render Backend" << endl;
+			cout << " - Using Compatibility Render Backend" << endl;
 
 #endif // RENDER_BACKEND_COMPATIBILITY
 
+			renderBackend->set_max_frame_count(maxFrameCount);
+			renderBackend->set_fixed_frame_delta_time(fixedFrameDeltaTime);
+		}
+
+		if (!recordPath.empty()) {
+			renderBackend->start_recording(recordPath);
+			cout << " - Recording input to \"" << recordPath << "\"" << endl;
+		}
+
+		if (!replayPath.empty()) {
+			renderBackend->start_replay(replayPath);
+			cout << " - Replaying input from \"" << replayPath << "\"" << endl;
+		}
+
 		// Create an engine instance:
 
 		Tritium::Engine engine = Tritium::Engine(
-			&renderBackend,
+			renderBackend.get(),
 			&logger,
 			&threadPool,
 			"TestApp",
@@ -89,10 +255,49 @@ int main(int argc, char** argv)
 			"dev"
 		);
 
+		// Game files come from the packs first, loose files next to the executable are the
+		// development fallback.
+		VirtualFileSystem fileSystem;
+		if (packPaths.empty() && std::filesystem::exists(DEFAULT_PACK_PATH)) {
+			packPaths.push_back(DEFAULT_PACK_PATH);
+		}
+		for (const std::string& packPath : packPaths) {
+			fileSystem.mount(packPath);
+			cout << " - Mounted \"" << packPath << "\"" << endl;
+		}
+		fileSystem.set_loose_root(looseFiles ? "." : "");
+		engine.file_system = &fileSystem;
+
+		if (scenePath.empty() && fileSystem.exists(DEFAULT_SCENE_PATH)) {
+			scenePath = DEFAULT_SCENE_PATH;
+		}
+
+		Scene scene;
+
+		if (!scenePath.empty()) {
+			std::chrono::steady_clock::time_point loadStart = std::chrono::steady_clock::now();
+
+			// The file only has to live until its arrays are copied into the scene.  Loose files
+			// are mapped, packed ones decompressed.
+			SceneFile sceneFile = fileSystem.is_packed(scenePath) ? SceneFile(fileSystem.read(scenePath, &threadPool)) : SceneFile(scenePath);
+			scene.instantiate(sceneFile);
+
+			cout << " - Loaded " << scene.size() << " nodes from \"" << scenePath << "\" in "
+				<< get_milliseconds_since(loadStart) << "ms" << endl;
+		}
+
+		renderBackend->set_scene(&scene);
+
 		//start the window loop
 
 		engine.start_window(engine.application_name, 600, 600);
 
+		RenderBackend::FrameStatistics frameStatistics = renderBackend->get_frame_statistics();
+		cout << "\n - Ran " << frameStatistics.frame_count << " frames, CPU frame time avg "
+			<< frameStatistics.get_average_frame_seconds() * 1000.0 << "ms min "
+			<< frameStatistics.min_frame_seconds * 1000.0 << "ms max "
+			<< frameStatistics.max_frame_seconds * 1000.0 << "ms" << endl;
+
 		// after close window flush logger
 
 		engine.logger->flush();
@@ -0,0 +1,189 @@
+//*****************************************
+// This is the entry point for the asset cooker, the offline tool that turns source assets
+// into the engine's native formats
+//*****************************************
+
+#include "Engine/mesh/mesh_file.h"
+#include "Tools/mesh/mesh_data.h"
+#include "Tools/mesh/mesh_importer.h"
+#include "Tools/mesh/mesh_optimizer.h"
+#include "Tools/mesh/mesh_simplifier.h"
+#include "Tools/mesh/mesh_writer.h"
+#include "Tools/mesh/meshlet_builder.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+using std::cout, std::cerr, std::endl;
+
+static double get_milliseconds_since(std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void print_usage() {
+	cout << "Usage: asset_cooker [options] <source> <output>\n"
+		<< "  Imports a model with assimp and writes it as a cooked mesh the runtime maps as is.\n\n"
+		<< "Options:\n"
+		<< "  --layout <interleaved|split|separate>  how vertex attributes are split into streams, defaults to interleaved\n"
+		<< "  --quantize                             store 20 byte quantized vertices instead of 48 byte float ones\n"
+		<< "  --no-optimize                          keep the imported triangle and vertex order\n"
+		<< "  --cache-size <vertices>                the post-transform cache size to optimize for, defaults to 16\n"
+		<< "  --lods <count>                         build a chain of up to this many LODs, defaults to 1 (none)\n"
+		<< "  --lod-ratio <ratio>                    the fraction of triangles each LOD keeps, defaults to 0.5\n"
+		<< "  --lod-max-error <fraction>             the largest LOD error relative to the mesh's size, defaults to 0.02\n"
+		<< "  --meshlets                             split submeshes into meshlets of up to 64 vertices and 124 triangles for cluster culling\n"
+		<< endl;
+}
+
+int main(int argc, char** argv)
+{
+	MeshWriter::Layout layout = MeshWriter::Layout::INTERLEAVED;
+	MeshWriter::Encoding encoding = MeshWriter::Encoding::FLOAT;
+	bool optimize = true;
+	uint32_t cacheSize = MeshOptimizer::DEFAULT_CACHE_SIZE;
+	uint32_t lodCount = 1;
+	float lodRatio = MeshSimplifier::DEFAULT_LOD_RATIO;
+	float lodMaxError = MeshSimplifier::DEFAULT_MAX_ERROR;
+	bool buildMeshlets = false;
+	std::string sourcePath;
+	std::string outputPath;
+
+	for (int i = 1; i < argc; i++) {
+		if (std::strcmp(argv[i], "--layout") == 0 && i + 1 < argc) {
+			std::string name = argv[++i];
+			if (name == "interleaved") {
+				layout = MeshWriter::Layout::INTERLEAVED;
+			}
+			else if (name == "split") {
+				layout = MeshWriter::Layout::SPLIT_POSITIONS;
+			}
+			else if (name == "separate") {
+				layout = MeshWriter::Layout::SEPARATE;
+			}
+			else {
+				cerr << "Unknown layout \"" << name << "\"." << endl;
+				return 1;
+			}
+		}
+		else if (std::strcmp(argv[i], "--quantize") == 0) {
+			encoding = MeshWriter::Encoding::QUANTIZED;
+		}
+		else if (std::strcmp(argv[i], "--no-optimize") == 0) {
+			optimize = false;
+		}
+		else if (std::strcmp(argv[i], "--cache-size") == 0 && i + 1 < argc) {
+			cacheSize = static_cast<uint32_t>(std::max(3l, std::strtol(argv[++i], nullptr, 10)));
+		}
+		else if (std::strcmp(argv[i], "--lods") == 0 && i + 1 < argc) {
+			lodCount = static_cast<uint32_t>(std::max(1l, std::strtol(argv[++i], nullptr, 10)));
+		}
+		else if (std::strcmp(argv[i], "--lod-ratio") == 0 && i + 1 < argc) {
+			lodRatio = std::clamp(std::strtof(argv[++i], nullptr), 0.05f, 0.95f);
+		}
+		else if (std::strcmp(argv[i], "--lod-max-error") == 0 && i + 1 < argc) {
+			lodMaxError = std::max(0.0f, std::strtof(argv[++i], nullptr));
+		}
+		else if (std::strcmp(argv[i], "--meshlets") == 0) {
+			buildMeshlets = true;
+		}
+		else if (std::strcmp(argv[i], "--help") == 0) {
+			print_usage();
+			return 0;
+		}
+		else if (sourcePath.empty()) {
+			sourcePath = argv[i];
+		}
+		else if (outputPath.empty()) {
+			outputPath = argv[i];
+		}
+		else {
+			print_usage();
+			return 1;
+		}
+	}
+
+	if (sourcePath.empty() || outputPath.empty()) {
+		print_usage();
+		return 1;
+	}
+
+	try {
+		auto start = std::chrono::steady_clock::now();
+		MeshData mesh = MeshImporter::import(sourcePath);
+		double importMilliseconds = get_milliseconds_since(start);
+
+		cout << " - Imported \"" << sourcePath << "\" in " << importMilliseconds << "ms" << endl;
+
+		if (lodCount > 1) {
+			start = std::chrono::steady_clock::now();
+			uint32_t builtCount = MeshSimplifier::build_lod_chain(mesh, lodCount, lodRatio, lodMaxError);
+			double simplifyMilliseconds = get_milliseconds_since(start);
+
+			cout << " - Built " << builtCount << " LODs in " << simplifyMilliseconds << "ms" << endl;
+			for (const MeshData::Lod& lod : mesh.lods) {
+				uint32_t indexCount = 0;
+				for (uint32_t s = lod.first_submesh; s < lod.first_submesh + lod.submesh_count; s++) {
+					indexCount += mesh.submeshes[s].index_count;
+				}
+				cout << "     " << indexCount / 3 << " triangles, error " << lod.error << endl;
+			}
+		}
+
+		if (optimize) {
+			MeshOptimizer::CacheStatistics before = MeshOptimizer::analyze_vertex_cache(mesh.indices, mesh.get_vertex_count(), cacheSize);
+
+			start = std::chrono::steady_clock::now();
+			MeshOptimizer::optimize(mesh, cacheSize);
+			double optimizeMilliseconds = get_milliseconds_since(start);
+
+			MeshOptimizer::CacheStatistics after = MeshOptimizer::analyze_vertex_cache(mesh.indices, mesh.get_vertex_count(), cacheSize);
+
+			cout << std::fixed << std::setprecision(3)
+				<< " - Optimized in " << optimizeMilliseconds << "ms for a " << cacheSize << " vertex cache\n"
+				<< "     ACMR " << before.acmr << " -> " << after.acmr << "\n"
+				<< "     ATVR " << before.atvr << " -> " << after.atvr << endl;
+		}
+
+		if (buildMeshlets) {
+			// After the optimizer, which reorders triangles and would scatter the meshlets.
+			start = std::chrono::steady_clock::now();
+			MeshletBuilder::build(mesh);
+			if (optimize) {
+				MeshOptimizer::optimize_vertex_fetch(mesh);
+			}
+			double meshletMilliseconds = get_milliseconds_since(start);
+
+			cout << " - Built " << mesh.meshlets.size() << " meshlets in " << meshletMilliseconds << "ms" << endl;
+		}
+
+		start = std::chrono::steady_clock::now();
+		MeshWriter::save(mesh, layout, encoding, outputPath);
+		double writeMilliseconds = get_milliseconds_since(start);
+
+		// Load the result back the way the runtime does, so a broken file never leaves the cooker.
+		start = std::chrono::steady_clock::now();
+		MeshFile cooked(outputPath);
+		double loadMilliseconds = get_milliseconds_since(start);
+
+		uint32_t vertexSize = 0;
+		for (const MeshFile::StreamView& stream : cooked.get_streams()) {
+			vertexSize += stream.stride;
+		}
+
+		cout << " - " << cooked.get_vertex_count() << " vertices of " << vertexSize << " bytes, " << cooked.get_index_count() / 3 << " triangles, "
+			<< cooked.get_lod_submeshes(0).size() << " submeshes, " << cooked.get_lods().size() << " LODs, " << cooked.get_index_size() * 8 << " bit indices\n"
+			<< " - Wrote " << cooked.size() << " bytes to \"" << outputPath << "\" in " << writeMilliseconds << "ms\n"
+			<< " - Mapped and validated in " << loadMilliseconds << "ms" << endl;
+	}
+	catch (const std::exception& exception) {
+		cerr << "Cooking failed: " << exception.what() << endl;
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,214 @@
+//*****************************************
+// This is the entry point for the asset processor, the offline tool that cooks every asset of a
+// project and skips the ones whose cooked result is already in the cache
+//*****************************************
+
+#include "Engine/io/mapped_file.h"
+#include "Engine/thread_pool/thread_pool.h"
+#include "Tools/cache/asset_cache.h"
+#include "Tools/cache/content_hash.h"
+#include "Tools/pipeline/asset_pipeline.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+using std::cout, std::cerr, std::endl;
+using std::vector;
+
+namespace fs = std::filesystem;
+
+namespace {
+
+	struct Asset {
+		std::string source_path;
+		std::string output_path;
+		AssetPipeline::AssetType type;
+		uintmax_t source_size;
+		std::string error;
+		/// Empty unless processing failed.
+	};
+};
+
+static double get_milliseconds_since(std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void print_usage() {
+	cout << "Usage: asset_processor [options] <source directory> <output directory>\n"
+		<< "  Cooks every mesh and texture under the source directory into the output directory, keeping\n"
+		<< "  the tree.  Results are cached by the hash of the source, its settings and the tool version,\n"
+		<< "  so only assets that changed are cooked again.  Per asset settings go in a `<source>.import`\n"
+		<< "  file of `key = value` lines (layout, quantize, optimize, cache_size, lod_count, lod_ratio,\n"
+		<< "  lod_max_error, meshlets, texture_format, linear, mips).\n\n"
+		<< "Options:\n"
+		<< "  --cache <directory>  where cooked results are kept, defaults to .asset_cache\n"
+		<< "  --rebuild            cook everything, refreshing the cache\n"
+		<< "  --threads <count>    worker threads, defaults to the hardware's\n"
+		<< endl;
+}
+
+static ContentKey compute_key(const Asset& asset, const AssetPipeline::Settings& settings, std::atomic<uint64_t>& hashed_bytes) {
+	ContentHasher hasher;
+	hasher.update(static_cast<uint64_t>(AssetPipeline::VERSION));
+	hasher.update(static_cast<uint64_t>(asset.type));
+	hasher.update(static_cast<uint64_t>(AssetPipeline::get_format_version(asset.type)));
+	hasher.update(settings.get_key(asset.type));
+
+	// Mapped rather than read, hashing streams through the pages once.
+	vector<std::string> files = AssetPipeline::get_dependencies(asset.source_path, asset.type);
+	files.insert(files.begin(), asset.source_path);
+	for (size_t i = 0; i < files.size(); i++) {
+		MappedFile file(files[i]);
+		if (i > 0) {
+			hasher.update(fs::path(files[i]).filename().string());
+		}
+		hasher.update(static_cast<uint64_t>(file.size()));
+		hasher.update(file.get_data());
+		hashed_bytes.fetch_add(file.size(), std::memory_order_relaxed);
+	}
+
+	return hasher.finish();
+}
+
+static void write_file(const std::string& path, const vector<std::byte>& bytes) {
+	std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+	stream.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+
+	if (!stream) {
+		throw std::runtime_error("Couldn't write \"" + path + "\".");
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::string cacheDirectory = ".asset_cache";
+	bool rebuild = false;
+	size_t threadCount = std::max(1u, std::thread::hardware_concurrency());
+	std::string sourceDirectory;
+	std::string outputDirectory;
+
+	for (int i = 1; i < argc; i++) {
+		if (std::strcmp(argv[i], "--cache") == 0 && i + 1 < argc) {
+			cacheDirectory = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--rebuild") == 0) {
+			rebuild = true;
+		}
+		else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+			threadCount = static_cast<size_t>(std::max(1l, std::strtol(argv[++i], nullptr, 10)));
+		}
+		else if (std::strcmp(argv[i], "--help") == 0) {
+			print_usage();
+			return 0;
+		}
+		else if (sourceDirectory.empty()) {
+			sourceDirectory = argv[i];
+		}
+		else if (outputDirectory.empty()) {
+			outputDirectory = argv[i];
+		}
+		else {
+			print_usage();
+			return 1;
+		}
+	}
+
+	if (sourceDirectory.empty() || outputDirectory.empty()) {
+		print_usage();
+		return 1;
+	}
+
+	try {
+		auto start = std::chrono::steady_clock::now();
+
+		vector<Asset> assets;
+		std::set<std::string> outputPaths;
+		for (const fs::directory_entry& entry : fs::recursive_directory_iterator(sourceDirectory)) {
+			const AssetPipeline::AssetType type = AssetPipeline::get_asset_type(entry.path().string());
+			if (!entry.is_regular_file() || type == AssetPipeline::AssetType::NONE) {
+				continue;
+			}
+
+			fs::path outputPath = fs::path(outputDirectory) / fs::relative(entry.path(), sourceDirectory);
+			outputPath.replace_extension(AssetPipeline::get_cooked_extension(type));
+
+			Asset asset{ entry.path().string(), outputPath.string(), type, entry.file_size(), "" };
+			if (!outputPaths.insert(asset.output_path).second) {
+				asset.error = "another source cooks to \"" + asset.output_path + "\".";
+			}
+			assets.push_back(std::move(asset));
+		}
+
+		// Biggest first so a large asset found last doesn't run alone at the end.
+		std::sort(assets.begin(), assets.end(), [](const Asset& a, const Asset& b) {
+			return a.source_size > b.source_size;
+		});
+
+		AssetCache cache(cacheDirectory);
+		ThreadPool::Pool pool(1, threadCount);
+		std::atomic<uint64_t> hashedBytes{ 0 };
+		std::atomic<size_t> cookedCount{ 0 };
+		std::atomic<size_t> failedCount{ 0 };
+
+		pool.parallel_for(assets.size(), 1, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++) {
+				Asset& asset = assets[i];
+				try {
+					if (!asset.error.empty()) {
+						throw std::runtime_error(asset.error);
+					}
+
+					const AssetPipeline::Settings settings = AssetPipeline::load_settings(asset.source_path, AssetPipeline::Settings());
+					const ContentKey key = compute_key(asset, settings, hashedBytes);
+
+					fs::create_directories(fs::path(asset.output_path).parent_path());
+					if (!rebuild && cache.fetch(key, asset.output_path)) {
+						continue;
+					}
+
+					// Nested parallel loops (texture encoding) run on this same pool.
+					const vector<std::byte> cooked = AssetPipeline::cook(asset.source_path, asset.type, settings, &pool);
+					cache.store(key, cooked);
+					write_file(asset.output_path, cooked);
+					cookedCount.fetch_add(1, std::memory_order_relaxed);
+				}
+				catch (const std::exception& exception) {
+					asset.error = exception.what();
+					failedCount.fetch_add(1, std::memory_order_relaxed);
+				}
+			}
+		});
+
+		const double totalMilliseconds = get_milliseconds_since(start);
+		const AssetCache::Statistics statistics = cache.get_statistics();
+
+		for (const Asset& asset : assets) {
+			if (!asset.error.empty()) {
+				cerr << " - Failed \"" << asset.source_path << "\": " << asset.error << endl;
+			}
+		}
+
+		cout << std::fixed << std::setprecision(3)
+			<< " - Processed " << assets.size() << " assets on " << pool.thread_count << " threads in " << totalMilliseconds << "ms\n"
+			<< " - " << statistics.hits << " cache hits, " << statistics.misses << " misses, " << cookedCount.load() << " cooked, " << failedCount.load() << " failed\n"
+			<< " - " << statistics.hit_bytes / 1024.0 << "KB copied from the cache, " << statistics.stored_bytes / 1024.0 << "KB stored in it\n"
+			<< " - Hashed " << hashedBytes.load() / 1024.0 << "KB of sources" << endl;
+
+		return failedCount.load() == 0 ? 0 : 1;
+	}
+	catch (const std::exception& exception) {
+		cerr << "Processing failed: " << exception.what() << endl;
+		return 1;
+	}
+}
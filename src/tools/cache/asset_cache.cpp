@@ -0,0 +1,97 @@
+#include "Tools/cache/asset_cache.h"
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <system_error>
+
+// CODE FORMATTING INFORMATION:
+// Simple functions like getters and setters go at the bottom.
+// Organize from most complex at the top to least complex at the bottom.
+
+namespace fs = std::filesystem;
+
+// === Class Functions ===
+
+AssetCache::AssetCache(const std::string& directory)
+	: directory(directory)
+{
+	std::error_code errorCode;
+	fs::create_directories(directory, errorCode);
+	if (errorCode) {
+		throw std::runtime_error("Couldn't create the asset cache \"" + directory + "\": " + errorCode.message());
+	}
+}
+
+// === Entries ===
+
+bool AssetCache::fetch(const ContentKey& key, const std::string& output_path) {
+	const std::string entryPath = this->get_entry_path(key);
+
+	std::error_code errorCode;
+	const uintmax_t size = fs::file_size(entryPath, errorCode);
+	if (errorCode) {
+		this->misses.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	fs::copy_file(entryPath, output_path, fs::copy_options::overwrite_existing, errorCode);
+	if (errorCode) {
+		throw std::runtime_error("Couldn't copy the cached \"" + entryPath + "\" to \"" + output_path + "\": " + errorCode.message());
+	}
+
+	this->hits.fetch_add(1, std::memory_order_relaxed);
+	this->hit_bytes.fetch_add(size, std::memory_order_relaxed);
+	return true;
+}
+
+void AssetCache::store(const ContentKey& key, std::span<const std::byte> bytes) {
+	const std::string entryPath = this->get_entry_path(key);
+
+	std::error_code errorCode;
+	fs::create_directories(fs::path(entryPath).parent_path(), errorCode);
+
+	// Unique per writer, two processes cooking the same asset both write a complete file and the
+	// last rename wins with identical contents.
+	thread_local std::mt19937_64 generator{ std::random_device{}() };
+	const std::string temporaryPath = entryPath + "." + std::to_string(generator()) + ".tmp";
+
+	{
+		std::ofstream stream(temporaryPath, std::ios::binary | std::ios::trunc);
+		stream.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+		if (!stream) {
+			stream.close();
+			fs::remove(temporaryPath, errorCode);
+			throw std::runtime_error("Couldn't write the cache entry \"" + entryPath + "\".");
+		}
+	}
+
+	fs::rename(temporaryPath, entryPath, errorCode);
+	if (errorCode) {
+		fs::remove(temporaryPath, errorCode);
+		throw std::runtime_error("Couldn't write the cache entry \"" + entryPath + "\".");
+	}
+
+	this->stored_bytes.fetch_add(bytes.size(), std::memory_order_relaxed);
+}
+
+// === Getters ===
+
+std::string AssetCache::get_entry_path(const ContentKey& key) const {
+	// Fanned out by the first byte so no directory grows to every entry.
+	const std::string name = key.to_string();
+	return (fs::path(this->directory) / name.substr(0, 2) / name).string();
+}
+
+AssetCache::Statistics AssetCache::get_statistics() const {
+	Statistics statistics;
+	statistics.hits = this->hits.load(std::memory_order_relaxed);
+	statistics.misses = this->misses.load(std::memory_order_relaxed);
+	statistics.hit_bytes = this->hit_bytes.load(std::memory_order_relaxed);
+	statistics.stored_bytes = this->stored_bytes.load(std::memory_order_relaxed);
+	return statistics;
+}
+
+const std::string& AssetCache::get_directory() const {
+	return this->directory;
+}
@@ -0,0 +1,163 @@
+#include "Tools/cache/content_hash.h"
+#include <algorithm>
+#include <cstring>
+
+// CODE FORMATTING INFORMATION:
+// Simple functions like getters and setters go at the bottom.
+// Organize from most complex at the top to least complex at the bottom.
+
+static constexpr uint64_t PRIME_1 = 11400714785074694791ull;
+static constexpr uint64_t PRIME_2 = 14029467366897019727ull;
+static constexpr uint64_t PRIME_3 = 1609587929392839161ull;
+static constexpr uint64_t PRIME_4 = 9650029242287828579ull;
+static constexpr uint64_t PRIME_5 = 2870177450012600261ull;
+
+static constexpr uint64_t SECOND_SEED = 0x9E3779B97F4A7C15ull;
+
+static constexpr size_t STRIPE_SIZE = 32;
+
+static uint64_t rotate_left(uint64_t value, int bits) {
+	return (value << bits) | (value >> (64 - bits));
+}
+
+static uint64_t read_u64(const std::byte* bytes) {
+	// Little endian like every platform the engine ships on, keys only need to agree with
+	// themselves.
+	uint64_t value;
+	std::memcpy(&value, bytes, sizeof(value));
+	return value;
+}
+
+static uint32_t read_u32(const std::byte* bytes) {
+	uint32_t value;
+	std::memcpy(&value, bytes, sizeof(value));
+	return value;
+}
+
+static uint64_t mix_round(uint64_t accumulator, uint64_t input) {
+	accumulator += input * PRIME_2;
+	accumulator = rotate_left(accumulator, 31);
+	return accumulator * PRIME_1;
+}
+
+static uint64_t merge_round(uint64_t hash, uint64_t accumulator) {
+	hash ^= mix_round(0, accumulator);
+	return hash * PRIME_1 + PRIME_4;
+}
+
+// === Hashing ===
+
+ContentHasher::ContentHasher() {
+	for (int l = 0; l < 2; l++) {
+		Lane& lane = this->lanes[l];
+		lane.seed = l == 0 ? 0 : SECOND_SEED;
+		lane.accumulators[0] = lane.seed + PRIME_1 + PRIME_2;
+		lane.accumulators[1] = lane.seed + PRIME_2;
+		lane.accumulators[2] = lane.seed;
+		lane.accumulators[3] = lane.seed - PRIME_1;
+	}
+}
+
+void ContentHasher::update(std::span<const std::byte> bytes) {
+	const std::byte* data = bytes.data();
+	size_t size = bytes.size();
+	this->total_size += size;
+
+	if (this->buffer_size > 0) {
+		const size_t taken = std::min(size, STRIPE_SIZE - this->buffer_size);
+		std::memcpy(this->buffer + this->buffer_size, data, taken);
+		this->buffer_size += taken;
+		data += taken;
+		size -= taken;
+
+		if (this->buffer_size < STRIPE_SIZE) {
+			return;
+		}
+		process_stripe(this->lanes[0], this->buffer);
+		process_stripe(this->lanes[1], this->buffer);
+		this->buffer_size = 0;
+	}
+
+	for (; size >= STRIPE_SIZE; data += STRIPE_SIZE, size -= STRIPE_SIZE) {
+		process_stripe(this->lanes[0], data);
+		process_stripe(this->lanes[1], data);
+	}
+
+	if (size > 0) {
+		std::memcpy(this->buffer, data, size);
+		this->buffer_size = size;
+	}
+}
+
+void ContentHasher::update(const std::string& text) {
+	this->update(static_cast<uint64_t>(text.size()));
+	this->update(std::as_bytes(std::span<const char>(text.data(), text.size())));
+}
+
+void ContentHasher::update(uint64_t value) {
+	std::byte bytes[sizeof(value)];
+	std::memcpy(bytes, &value, sizeof(value));
+	this->update(std::span<const std::byte>(bytes, sizeof(bytes)));
+}
+
+ContentKey ContentHasher::finish() const {
+	return ContentKey{ this->finish_lane(this->lanes[0]), this->finish_lane(this->lanes[1]) };
+}
+
+void ContentHasher::process_stripe(Lane& lane, const std::byte* stripe) {
+	for (int i = 0; i < 4; i++) {
+		lane.accumulators[i] = mix_round(lane.accumulators[i], read_u64(stripe + i * 8));
+	}
+}
+
+uint64_t ContentHasher::finish_lane(const Lane& lane) const {
+	uint64_t hash;
+	if (this->total_size >= STRIPE_SIZE) {
+		const uint64_t* accumulators = lane.accumulators;
+		hash = rotate_left(accumulators[0], 1) + rotate_left(accumulators[1], 7) + rotate_left(accumulators[2], 12) + rotate_left(accumulators[3], 18);
+		for (int i = 0; i < 4; i++) {
+			hash = merge_round(hash, accumulators[i]);
+		}
+	}
+	else {
+		hash = lane.seed + PRIME_5;
+	}
+	hash += this->total_size;
+
+	const std::byte* tail = this->buffer;
+	size_t remaining = this->buffer_size;
+	for (; remaining >= 8; tail += 8, remaining -= 8) {
+		hash ^= mix_round(0, read_u64(tail));
+		hash = rotate_left(hash, 27) * PRIME_1 + PRIME_4;
+	}
+	if (remaining >= 4) {
+		hash ^= static_cast<uint64_t>(read_u32(tail)) * PRIME_1;
+		hash = rotate_left(hash, 23) * PRIME_2 + PRIME_3;
+		tail += 4;
+		remaining -= 4;
+	}
+	for (; remaining > 0; tail++, remaining--) {
+		hash ^= static_cast<uint64_t>(*tail) * PRIME_5;
+		hash = rotate_left(hash, 11) * PRIME_1;
+	}
+
+	hash ^= hash >> 33;
+	hash *= PRIME_2;
+	hash ^= hash >> 29;
+	hash *= PRIME_3;
+	hash ^= hash >> 32;
+	return hash;
+}
+
+// === Keys ===
+
+std::string ContentKey::to_string() const {
+	static constexpr char DIGITS[] = "0123456789abcdef";
+
+	std::string text(32, '0');
+	for (int i = 0; i < 16; i++) {
+		text[15 - i] = DIGITS[(this->high >> (i * 4)) & 0xF];
+		text[31 - i] = DIGITS[(this->low >> (i * 4)) & 0xF];
+	}
+	return text;
+}
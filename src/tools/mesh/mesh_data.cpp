@@ -0,0 +1,62 @@
+#include "Tools/mesh/mesh_data.h"
+#include <stdexcept>
+#include <string>
+
+Aabb MeshData::get_bounds(uint32_t first_index, uint32_t index_count) const {
+	Aabb bounds;
+	for (uint32_t i = first_index; i < first_index + index_count; i++) {
+		bounds.expand(this->positions[this->indices[i]]);
+	}
+	return bounds;
+}
+
+void MeshData::validate() const {
+	const size_t vertexCount = this->positions.size();
+
+	if (vertexCount > UINT32_MAX) {
+		throw std::runtime_error("A mesh can't have more than 2^32 - 1 vertices.");
+	}
+	if ((!this->normals.empty() && this->normals.size() != vertexCount)
+		|| (!this->texcoords.empty() && this->texcoords.size() != vertexCount)
+		|| (!this->colors.empty() && this->colors.size() != vertexCount)) {
+		throw std::runtime_error("A mesh attribute doesn't hold one value per vertex.");
+	}
+
+	if (this->indices.size() % 3 != 0) {
+		throw std::runtime_error("A mesh's indices don't form whole triangles.");
+	}
+	for (uint32_t index : this->indices) {
+		if (index >= vertexCount) {
+			throw std::runtime_error("Mesh index " + std::to_string(index) + " points past the " + std::to_string(vertexCount) + " vertices.");
+		}
+	}
+
+	for (const Submesh& submesh : this->submeshes) {
+		if (submesh.first_index % 3 != 0 || submesh.index_count % 3 != 0 || static_cast<size_t>(submesh.first_index) + submesh.index_count > this->indices.size()) {
+			throw std::runtime_error("A submesh's triangles lie outside the mesh's indices.");
+		}
+		if (submesh.material >= this->material_names.size()) {
+			throw std::runtime_error("A submesh uses a material that doesn't exist.");
+		}
+		if (static_cast<size_t>(submesh.first_meshlet) + submesh.meshlet_count > this->meshlets.size()) {
+			throw std::runtime_error("A submesh's meshlets lie outside the mesh's meshlets.");
+		}
+		for (uint32_t m = submesh.first_meshlet; m < submesh.first_meshlet + submesh.meshlet_count; m++) {
+			const Meshlet& meshlet = this->meshlets[m];
+			if (meshlet.first_index < submesh.first_index || meshlet.first_index + meshlet.index_count > submesh.first_index + submesh.index_count) {
+				throw std::runtime_error("A meshlet's triangles lie outside its submesh.");
+			}
+		}
+	}
+
+	uint32_t nextSubmesh = 0;
+	for (const Lod& lod : this->lods) {
+		if (lod.first_submesh != nextSubmesh) {
+			throw std::runtime_error("A mesh's LODs aren't consecutive runs of its submeshes.");
+		}
+		nextSubmesh += lod.submesh_count;
+	}
+	if (!this->lods.empty() && nextSubmesh != this->submeshes.size()) {
+		throw std::runtime_error("A mesh's LODs don't cover its submeshes.");
+	}
+}
@@ -0,0 +1,97 @@
+#include "Tools/mesh/mesh_importer.h"
+#include <assimp/Importer.hpp>
+#include <assimp/postprocess.h>
+#include <assimp/scene.h>
+#include <stdexcept>
+
+static constexpr unsigned int IMPORT_FLAGS =
+	aiProcess_Triangulate
+	| aiProcess_JoinIdenticalVertices
+	| aiProcess_GenSmoothNormals
+	| aiProcess_PreTransformVertices
+	| aiProcess_SortByPType
+	| aiProcess_RemoveRedundantMaterials
+	| aiProcess_FindInvalidData
+	| aiProcess_ValidateDataStructure;
+
+MeshData MeshImporter::import(const std::string& path) {
+	Assimp::Importer importer;
+
+	// Points and lines are sorted into meshes of their own and skipped below.
+	importer.SetPropertyInteger(AI_CONFIG_PP_SBP_REMOVE, aiPrimitiveType_POINT | aiPrimitiveType_LINE);
+
+	const aiScene* scene = importer.ReadFile(path, IMPORT_FLAGS);
+	if (scene == nullptr || (scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE) != 0) {
+		throw std::runtime_error("Couldn't import \"" + path + "\": " + importer.GetErrorString());
+	}
+
+	MeshData mesh;
+
+	for (unsigned int m = 0; m < scene->mNumMaterials; m++) {
+		mesh.material_names.push_back(scene->mMaterials[m]->GetName().C_Str());
+	}
+	if (mesh.material_names.empty()) {
+		mesh.material_names.push_back("default");
+	}
+
+	// Optional attributes are kept when any source mesh has them, the others are filled with defaults.
+	bool hasTexcoords = false;
+	bool hasColors = false;
+	for (unsigned int m = 0; m < scene->mNumMeshes; m++) {
+		hasTexcoords = hasTexcoords || scene->mMeshes[m]->HasTextureCoords(0);
+		hasColors = hasColors || scene->mMeshes[m]->HasVertexColors(0);
+	}
+
+	for (unsigned int m = 0; m < scene->mNumMeshes; m++) {
+		const aiMesh* source = scene->mMeshes[m];
+		if ((source->mPrimitiveTypes & aiPrimitiveType_TRIANGLE) == 0) {
+			continue;
+		}
+
+		const uint32_t baseVertex = static_cast<uint32_t>(mesh.positions.size());
+
+		for (unsigned int v = 0; v < source->mNumVertices; v++) {
+			const aiVector3D& position = source->mVertices[v];
+			mesh.positions.push_back(glm::vec3(position.x, position.y, position.z));
+
+			const aiVector3D normal = source->HasNormals() ? source->mNormals[v] : aiVector3D(0.0f, 1.0f, 0.0f);
+			mesh.normals.push_back(glm::vec3(normal.x, normal.y, normal.z));
+
+			if (hasTexcoords) {
+				const aiVector3D texcoord = source->HasTextureCoords(0) ? source->mTextureCoords[0][v] : aiVector3D(0.0f);
+				mesh.texcoords.push_back(glm::vec2(texcoord.x, texcoord.y));
+			}
+
+			if (hasColors) {
+				const aiColor4D color = source->HasVertexColors(0) ? source->mColors[0][v] : aiColor4D(1.0f, 1.0f, 1.0f, 1.0f);
+				mesh.colors.push_back(glm::vec4(color.r, color.g, color.b, color.a));
+			}
+		}
+
+		MeshData::Submesh submesh;
+		submesh.first_index = static_cast<uint32_t>(mesh.indices.size());
+		submesh.material = source->mMaterialIndex < mesh.material_names.size() ? source->mMaterialIndex : 0;
+
+		for (unsigned int f = 0; f < source->mNumFaces; f++) {
+			const aiFace& face = source->mFaces[f];
+			if (face.mNumIndices != 3) {
+				continue;
+			}
+			mesh.indices.push_back(baseVertex + face.mIndices[0]);
+			mesh.indices.push_back(baseVertex + face.mIndices[1]);
+			mesh.indices.push_back(baseVertex + face.mIndices[2]);
+		}
+
+		submesh.index_count = static_cast<uint32_t>(mesh.indices.size()) - submesh.first_index;
+		if (submesh.index_count != 0) {
+			mesh.submeshes.push_back(submesh);
+		}
+	}
+
+	if (mesh.indices.empty()) {
+		throw std::runtime_error("\"" + path + "\" doesn't contain any triangles.");
+	}
+
+	mesh.validate();
+	return mesh;
+}
@@ -0,0 +1,360 @@
+#include "Tools/mesh/mesh_optimizer.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <type_traits>
+
+// CODE FORMATTING INFORMATION:
+// Simple functions like getters and setters go at the bottom.
+// Organize from most complex at the top to least complex at the bottom.
+
+static constexpr uint32_t INVALID_VERTEX = std::numeric_limits<uint32_t>::max();
+
+namespace {
+
+	// A FIFO post-transform cache, a vertex is a hit while fewer than `size` misses happened
+	// since it was last loaded.  `reset` makes everything miss without touching the timestamps.
+	struct CacheSimulation {
+		vector<uint32_t> timestamps;
+		uint32_t time;
+		uint32_t size;
+
+		CacheSimulation(size_t vertex_count, uint32_t cache_size)
+			: timestamps(vertex_count, 0),
+			time(cache_size + 1),
+			size(cache_size)
+		{}
+
+		uint32_t add_triangle(const uint32_t* triangle) {
+			uint32_t misses = 0;
+			for (int k = 0; k < 3; k++) {
+				uint32_t& timestamp = this->timestamps[triangle[k]];
+				if (this->time - timestamp > this->size) {
+					timestamp = this->time++;
+					misses++;
+				}
+			}
+			return misses;
+		}
+
+		void reset() {
+			this->time += this->size + 1;
+		}
+	};
+};
+
+static uint32_t compact_vertices(std::span<const uint32_t> indices, vector<uint32_t>& local_indices, vector<uint32_t>& vertices) {
+	// Submeshes use a small part of the mesh's vertices, renumbering them keeps the per vertex
+	// arrays below sized by the submesh.
+	vertices.assign(indices.begin(), indices.end());
+	std::sort(vertices.begin(), vertices.end());
+	vertices.erase(std::unique(vertices.begin(), vertices.end()), vertices.end());
+
+	local_indices.resize(indices.size());
+	for (size_t i = 0; i < indices.size(); i++) {
+		local_indices[i] = static_cast<uint32_t>(std::lower_bound(vertices.begin(), vertices.end(), indices[i]) - vertices.begin());
+	}
+
+	return static_cast<uint32_t>(vertices.size());
+}
+
+// === Analysis ===
+
+MeshOptimizer::CacheStatistics MeshOptimizer::analyze_vertex_cache(std::span<const uint32_t> indices, size_t vertex_count, uint32_t cache_size) {
+	CacheStatistics statistics;
+	if (indices.size() < 3) {
+		return statistics;
+	}
+
+	CacheSimulation cache(vertex_count, cache_size);
+	vector<bool> used(vertex_count, false);
+
+	uint64_t misses = 0;
+	size_t usedCount = 0;
+	for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+		misses += cache.add_triangle(&indices[i]);
+		for (int k = 0; k < 3; k++) {
+			if (!used[indices[i + k]]) {
+				used[indices[i + k]] = true;
+				usedCount++;
+			}
+		}
+	}
+
+	statistics.acmr = static_cast<float>(misses) / static_cast<float>(indices.size() / 3);
+	statistics.atvr = static_cast<float>(misses) / static_cast<float>(usedCount);
+	return statistics;
+}
+
+// === Vertex Cache ===
+
+void MeshOptimizer::optimize_vertex_cache(std::span<uint32_t> indices, uint32_t cache_size) {
+	const size_t triangleCount = indices.size() / 3;
+	if (triangleCount < 2) {
+		return;
+	}
+
+	vector<uint32_t> localIndices;
+	vector<uint32_t> vertices;
+	const uint32_t vertexCount = compact_vertices(indices, localIndices, vertices);
+
+	// Vertex to triangle adjacency, and how many triangles of each vertex are left to emit.
+	vector<uint32_t> liveCounts(vertexCount, 0);
+	for (uint32_t index : localIndices) {
+		liveCounts[index]++;
+	}
+
+	vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+	std::partial_sum(liveCounts.begin(), liveCounts.end(), adjacencyOffsets.begin() + 1);
+
+	vector<uint32_t> adjacency(localIndices.size());
+	{
+		vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+		for (size_t i = 0; i < localIndices.size(); i++) {
+			adjacency[fill[localIndices[i]]++] = static_cast<uint32_t>(i / 3);
+		}
+	}
+
+	vector<uint32_t> cacheTimes(vertexCount, 0);
+	vector<bool> emitted(triangleCount, false);
+	vector<uint32_t> deadEnds;
+	vector<uint32_t> candidates;
+
+	vector<uint32_t> output;
+	output.reserve(localIndices.size());
+
+	uint32_t time = cache_size + 1;
+	uint32_t cursor = 0;
+
+	// Falls back to the most recently used vertex with triangles left, then to the next one in
+	// input order.
+	auto skipDeadEnd = [&]() {
+		while (!deadEnds.empty()) {
+			uint32_t vertex = deadEnds.back();
+			deadEnds.pop_back();
+			if (liveCounts[vertex] > 0) {
+				return vertex;
+			}
+		}
+		while (cursor < vertexCount) {
+			if (liveCounts[cursor] > 0) {
+				return cursor;
+			}
+			cursor++;
+		}
+		return INVALID_VERTEX;
+	};
+
+	uint32_t fanning = skipDeadEnd();
+
+	while (fanning != INVALID_VERTEX) {
+		// Emit every triangle left around the fanning vertex.
+		candidates.clear();
+		for (uint32_t a = adjacencyOffsets[fanning]; a < adjacencyOffsets[fanning + 1]; a++) {
+			const uint32_t triangle = adjacency[a];
+			if (emitted[triangle]) {
+				continue;
+			}
+
+			for (int k = 0; k < 3; k++) {
+				const uint32_t vertex = localIndices[triangle * 3 + k];
+				output.push_back(vertex);
+				deadEnds.push_back(vertex);
+				candidates.push_back(vertex);
+				liveCounts[vertex]--;
+
+				if (time - cacheTimes[vertex] > cache_size) {
+					cacheTimes[vertex] = time++;
+				}
+			}
+			emitted[triangle] = true;
+		}
+
+		// Fan next around the oldest candidate that will still be cached after its triangles are
+		// emitted, vertices that would drop out score 0.
+		uint32_t best = INVALID_VERTEX;
+		int64_t bestPriority = -1;
+		for (uint32_t vertex : candidates) {
+			if (liveCounts[vertex] == 0) {
+				continue;
+			}
+
+			int64_t priority = 0;
+			const int64_t age = static_cast<int64_t>(time) - cacheTimes[vertex];
+			if (age + 2 * static_cast<int64_t>(liveCounts[vertex]) <= cache_size) {
+				priority = age;
+			}
+			if (priority > bestPriority) {
+				bestPriority = priority;
+				best = vertex;
+			}
+		}
+
+		fanning = best != INVALID_VERTEX ? best : skipDeadEnd();
+	}
+
+	for (size_t i = 0; i < output.size(); i++) {
+		indices[i] = vertices[output[i]];
+	}
+}
+
+// === Overdraw ===
+
+void MeshOptimizer::optimize_overdraw(std::span<uint32_t> indices, std::span<const glm::vec3> positions, float threshold, uint32_t cache_size) {
+	const size_t triangleCount = indices.size() / 3;
+	if (triangleCount < 2) {
+		return;
+	}
+
+	vector<uint32_t> localIndices;
+	vector<uint32_t> vertices;
+	const uint32_t vertexCount = compact_vertices(indices, localIndices, vertices);
+
+	// Hard boundaries are where all three vertices miss, the cache order jumped elsewhere.
+	vector<uint32_t> hardBoundaries;
+	uint64_t totalMisses = 0;
+	{
+		CacheSimulation cache(vertexCount, cache_size);
+		for (size_t t = 0; t < triangleCount; t++) {
+			uint32_t misses = cache.add_triangle(&localIndices[t * 3]);
+			totalMisses += misses;
+			if (t == 0 || misses == 3) {
+				hardBoundaries.push_back(static_cast<uint32_t>(t));
+			}
+		}
+		hardBoundaries.push_back(static_cast<uint32_t>(triangleCount));
+	}
+
+	// Soft boundaries split a hard cluster as soon as the part so far is as cache efficient as
+	// the whole order, starting each part with a cold cache since it may be drawn anywhere.
+	const float acmrLimit = threshold * static_cast<float>(totalMisses) / static_cast<float>(triangleCount);
+
+	vector<uint32_t> clusterStarts;
+	{
+		CacheSimulation cache(vertexCount, cache_size);
+		for (size_t h = 0; h + 1 < hardBoundaries.size(); h++) {
+			const uint32_t end = hardBoundaries[h + 1];
+
+			uint32_t clusterStart = hardBoundaries[h];
+			uint32_t clusterMisses = 0;
+			clusterStarts.push_back(clusterStart);
+			cache.reset();
+
+			for (uint32_t t = clusterStart; t < end; t++) {
+				clusterMisses += cache.add_triangle(&localIndices[t * 3]);
+
+				if (t + 1 < end && static_cast<float>(clusterMisses) <= acmrLimit * static_cast<float>(t - clusterStart + 1)) {
+					clusterStart = t + 1;
+					clusterMisses = 0;
+					clusterStarts.push_back(clusterStart);
+					cache.reset();
+				}
+			}
+		}
+		clusterStarts.push_back(static_cast<uint32_t>(triangleCount));
+	}
+
+	// Sort the clusters facing out from the mesh's centre first, they are the likeliest to
+	// occlude the others from any view.
+	const size_t clusterCount = clusterStarts.size() - 1;
+	vector<glm::vec3> clusterCentroids(clusterCount, glm::vec3(0.0f));
+	vector<glm::vec3> clusterNormals(clusterCount, glm::vec3(0.0f));
+	glm::vec3 meshCentroid(0.0f);
+	float meshArea = 0.0f;
+
+	for (size_t c = 0; c < clusterCount; c++) {
+		float clusterArea = 0.0f;
+		for (uint32_t t = clusterStarts[c]; t < clusterStarts[c + 1]; t++) {
+			const glm::vec3& p0 = positions[indices[t * 3 + 0]];
+			const glm::vec3& p1 = positions[indices[t * 3 + 1]];
+			const glm::vec3& p2 = positions[indices[t * 3 + 2]];
+
+			const glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+			const float area = glm::length(normal);
+
+			clusterCentroids[c] += (p0 + p1 + p2) * (area / 3.0f);
+			clusterNormals[c] += normal;
+			clusterArea += area;
+		}
+
+		meshCentroid += clusterCentroids[c];
+		meshArea += clusterArea;
+
+		clusterCentroids[c] = clusterArea > 0.0f ? clusterCentroids[c] / clusterArea : glm::vec3(0.0f);
+		const float normalLength = glm::length(clusterNormals[c]);
+		clusterNormals[c] = normalLength > 0.0f ? clusterNormals[c] / normalLength : glm::vec3(0.0f);
+	}
+
+	if (meshArea > 0.0f) {
+		meshCentroid /= meshArea;
+	}
+
+	vector<float> sortKeys(clusterCount);
+	for (size_t c = 0; c < clusterCount; c++) {
+		sortKeys[c] = glm::dot(clusterCentroids[c] - meshCentroid, clusterNormals[c]);
+	}
+
+	vector<uint32_t> order(clusterCount);
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&sortKeys](uint32_t a, uint32_t b) {
+		return sortKeys[a] > sortKeys[b];
+	});
+
+	vector<uint32_t> sorted;
+	sorted.reserve(triangleCount * 3);
+	for (uint32_t c : order) {
+		sorted.insert(sorted.end(), indices.begin() + clusterStarts[c] * 3, indices.begin() + clusterStarts[c + 1] * 3);
+	}
+	std::copy(sorted.begin(), sorted.end(), indices.begin());
+}
+
+// === Vertex Fetch ===
+
+void MeshOptimizer::optimize_vertex_fetch(MeshData& mesh) {
+	vector<uint32_t> remap(mesh.get_vertex_count(), INVALID_VERTEX);
+	uint32_t nextVertex = 0;
+
+	for (uint32_t& index : mesh.indices) {
+		if (remap[index] == INVALID_VERTEX) {
+			remap[index] = nextVertex++;
+		}
+		index = remap[index];
+	}
+
+	auto reorder = [&remap, nextVertex](auto& values) {
+		if (values.empty()) {
+			return;
+		}
+
+		std::remove_reference_t<decltype(values)> reordered(nextVertex);
+		for (size_t v = 0; v < values.size(); v++) {
+			if (remap[v] != INVALID_VERTEX) {
+				reordered[remap[v]] = values[v];
+			}
+		}
+		values = std::move(reordered);
+	};
+
+	reorder(mesh.positions);
+	reorder(mesh.normals);
+	reorder(mesh.texcoords);
+	reorder(mesh.colors);
+}
+
+void MeshOptimizer::optimize(MeshData& mesh, uint32_t cache_size, float overdraw_threshold) {
+	mesh.validate();
+
+	vector<MeshData::Submesh> submeshes = mesh.submeshes;
+	if (submeshes.empty()) {
+		submeshes.push_back(MeshData::Submesh{ 0, static_cast<uint32_t>(mesh.indices.size()), 0 });
+	}
+
+	for (const MeshData::Submesh& submesh : submeshes) {
+		std::span<uint32_t> indices(mesh.indices.data() + submesh.first_index, submesh.index_count);
+		optimize_vertex_cache(indices, cache_size);
+		optimize_overdraw(indices, mesh.positions, overdraw_threshold, cache_size);
+	}
+
+	optimize_vertex_fetch(mesh);
+}
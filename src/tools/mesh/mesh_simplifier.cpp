@@ -0,0 +1,351 @@
+#include "Tools/mesh/mesh_simplifier.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+
+// CODE FORMATTING INFORMATION:
+// Simple functions like getters and setters go at the bottom.
+// Organize from most complex at the top to least complex at the bottom.
+
+static constexpr uint32_t INVALID_VERTEX = std::numeric_limits<uint32_t>::max();
+
+static constexpr float MIN_SIMPLIFICATION = 0.9f;
+/// A LOD must drop at least a tenth of the previous one's indices to be worth its memory.
+
+namespace {
+
+	// The sum of squared distances to a set of planes, weighted by the triangles' areas, as the
+	// symmetric matrix A, vector b and constant c of `p^T A p + 2 b.p + c`.  Doubles, because the
+	// terms of nearly flat neighbourhoods cancel.
+	struct Quadric {
+		double a00 = 0.0, a01 = 0.0, a02 = 0.0, a11 = 0.0, a12 = 0.0, a22 = 0.0;
+		double b0 = 0.0, b1 = 0.0, b2 = 0.0;
+		double c = 0.0;
+		double weight = 0.0;
+
+		void add_plane(const glm::dvec3& normal, double distance, double area) {
+			this->a00 += area * normal.x * normal.x;
+			this->a01 += area * normal.x * normal.y;
+			this->a02 += area * normal.x * normal.z;
+			this->a11 += area * normal.y * normal.y;
+			this->a12 += area * normal.y * normal.z;
+			this->a22 += area * normal.z * normal.z;
+			this->b0 += area * normal.x * distance;
+			this->b1 += area * normal.y * distance;
+			this->b2 += area * normal.z * distance;
+			this->c += area * distance * distance;
+			this->weight += area;
+		}
+
+		void add(const Quadric& other) {
+			this->a00 += other.a00;
+			this->a01 += other.a01;
+			this->a02 += other.a02;
+			this->a11 += other.a11;
+			this->a12 += other.a12;
+			this->a22 += other.a22;
+			this->b0 += other.b0;
+			this->b1 += other.b1;
+			this->b2 += other.b2;
+			this->c += other.c;
+			this->weight += other.weight;
+		}
+
+		double evaluate(const glm::vec3& point) const {
+			// Divided by the total area, the mean squared distance to the planes.
+			const double x = point.x, y = point.y, z = point.z;
+			const double error = this->a00 * x * x + this->a11 * y * y + this->a22 * z * z
+				+ 2.0 * (this->a01 * x * y + this->a02 * x * z + this->a12 * y * z)
+				+ 2.0 * (this->b0 * x + this->b1 * y + this->b2 * z)
+				+ this->c;
+			return this->weight > 0.0 ? std::max(error, 0.0) / this->weight : 0.0;
+		}
+	};
+
+	struct Collapse {
+		double cost;
+		uint32_t from;
+		uint32_t to;
+		/// The vertex `from` is replaced by, in the collapsed edge's triangle.
+	};
+
+	struct PositionHash {
+		size_t operator()(const glm::vec3& position) const {
+			const uint64_t x = std::bit_cast<uint32_t>(position.x);
+			const uint64_t y = std::bit_cast<uint32_t>(position.y);
+			const uint64_t z = std::bit_cast<uint32_t>(position.z);
+			return static_cast<size_t>((x * 73856093u) ^ (y * 19349663u) ^ (z * 83492791u));
+		}
+	};
+};
+
+static uint64_t get_edge_key(uint32_t a, uint32_t b) {
+	return a < b ? (static_cast<uint64_t>(a) << 32) | b : (static_cast<uint64_t>(b) << 32) | a;
+}
+
+// === Simplification ===
+
+float MeshSimplifier::simplify(std::span<const glm::vec3> positions, std::span<const uint32_t> indices, size_t target_index_count, float max_error, vector<uint32_t>& result) {
+	// Work on the vertices the triangles use, renumbered from zero, so simplifying a submesh
+	// doesn't cost in proportion to the whole mesh.
+	vector<uint32_t> vertices(indices.begin(), indices.end());
+	std::sort(vertices.begin(), vertices.end());
+	vertices.erase(std::unique(vertices.begin(), vertices.end()), vertices.end());
+	const uint32_t vertexCount = static_cast<uint32_t>(vertices.size());
+
+	vector<uint32_t> triangles(indices.size());
+	for (size_t i = 0; i < indices.size(); i++) {
+		triangles[i] = static_cast<uint32_t>(std::lower_bound(vertices.begin(), vertices.end(), indices[i]) - vertices.begin());
+	}
+
+	// Vertices at the same position are the same point of the surface, the first one stands
+	// for the rest.  A point with several vertices lies on an attribute seam.
+	vector<uint32_t> canonical(vertexCount);
+	vector<bool> locked(vertexCount, false);
+	std::unordered_map<glm::vec3, uint32_t, PositionHash> positionVertices;
+	positionVertices.reserve(vertexCount);
+	for (uint32_t v = 0; v < vertexCount; v++) {
+		auto [it, inserted] = positionVertices.emplace(positions[vertices[v]], v);
+		canonical[v] = it->second;
+		if (!inserted) {
+			locked[it->second] = true;
+		}
+	}
+
+	// Edges that don't have exactly two triangles are on a border or non manifold, moving their
+	// vertices would open holes.
+	std::unordered_map<uint64_t, uint32_t> edgeTriangles;
+	edgeTriangles.reserve(triangles.size());
+	for (size_t i = 0; i < triangles.size(); i += 3) {
+		for (int k = 0; k < 3; k++) {
+			const uint32_t a = canonical[triangles[i + k]];
+			const uint32_t b = canonical[triangles[i + (k + 1) % 3]];
+			if (a != b) {
+				edgeTriangles[get_edge_key(a, b)]++;
+			}
+		}
+	}
+	for (const auto& [key, count] : edgeTriangles) {
+		if (count != 2) {
+			locked[static_cast<uint32_t>(key >> 32)] = true;
+			locked[static_cast<uint32_t>(key)] = true;
+		}
+	}
+
+	vector<Quadric> quadrics(vertexCount);
+	for (size_t i = 0; i < triangles.size(); i += 3) {
+		const glm::dvec3 p0 = positions[vertices[triangles[i]]];
+		const glm::dvec3 p1 = positions[vertices[triangles[i + 1]]];
+		const glm::dvec3 p2 = positions[vertices[triangles[i + 2]]];
+		const glm::dvec3 normal = glm::cross(p1 - p0, p2 - p0);
+		const double length = glm::length(normal);
+		if (length <= 0.0) {
+			continue;
+		}
+
+		const glm::dvec3 unitNormal = normal / length;
+		const double distance = -glm::dot(unitNormal, p0);
+		for (int k = 0; k < 3; k++) {
+			quadrics[canonical[triangles[i + k]]].add_plane(unitNormal, distance, length * 0.5);
+		}
+	}
+
+	const double maxCost = static_cast<double>(max_error) * max_error;
+	double largestCost = 0.0;
+
+	vector<uint32_t> adjacencyOffsets(vertexCount + 1);
+	vector<uint32_t> adjacency;
+	vector<Collapse> collapses;
+	vector<uint32_t> remap(vertexCount, INVALID_VERTEX);
+	vector<bool> touched(vertexCount);
+
+	// Passes of independent collapses: a vertex takes part in at most one per pass, so the
+	// adjacency and positions every check reads stay those of the pass's start.
+	while (triangles.size() > target_index_count) {
+		const auto position = [&](uint32_t v) -> const glm::vec3& { return positions[vertices[v]]; };
+
+		std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+		for (uint32_t index : triangles) {
+			adjacencyOffsets[canonical[index] + 1]++;
+		}
+		for (uint32_t v = 0; v < vertexCount; v++) {
+			adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+		}
+		adjacency.resize(triangles.size());
+		{
+			vector<uint32_t> cursors(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+			for (size_t i = 0; i < triangles.size(); i++) {
+				adjacency[cursors[canonical[triangles[i]]]++] = static_cast<uint32_t>(i / 3);
+			}
+		}
+
+		collapses.clear();
+		for (size_t i = 0; i < triangles.size(); i += 3) {
+			for (int k = 0; k < 3; k++) {
+				const uint32_t a = triangles[i + k];
+				const uint32_t b = triangles[i + (k + 1) % 3];
+				const uint32_t ca = canonical[a];
+				const uint32_t cb = canonical[b];
+				if (ca == cb || (locked[ca] && locked[cb])) {
+					continue;
+				}
+
+				Quadric quadric = quadrics[ca];
+				quadric.add(quadrics[cb]);
+				// Unlocked vertices are alone at their position, so `a` and `b` are the canonical
+				// vertices whenever they are the ones moving.
+				if (!locked[ca]) {
+					collapses.push_back({ quadric.evaluate(position(cb)), ca, b });
+				}
+				if (!locked[cb]) {
+					collapses.push_back({ quadric.evaluate(position(ca)), cb, a });
+				}
+			}
+		}
+		std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) {
+			return a.cost < b.cost;
+		});
+
+		std::fill(touched.begin(), touched.end(), false);
+		size_t remainingIndices = triangles.size();
+		size_t collapseCount = 0;
+		for (const Collapse& collapse : collapses) {
+			if (collapse.cost > maxCost || remainingIndices <= target_index_count) {
+				break;
+			}
+
+			const uint32_t to = canonical[collapse.to];
+			if (touched[collapse.from] || touched[to]) {
+				continue;
+			}
+
+			bool valid = true;
+			size_t removedIndices = 0;
+			for (uint32_t a = adjacencyOffsets[collapse.from]; a < adjacencyOffsets[collapse.from + 1] && valid; a++) {
+				const uint32_t* triangle = &triangles[adjacency[a] * 3];
+				glm::vec3 corners[3];
+				glm::vec3 moved[3];
+				bool collapsesAway = false;
+				for (int k = 0; k < 3; k++) {
+					const uint32_t corner = canonical[triangle[k]];
+					valid = valid && !touched[corner];
+					collapsesAway = collapsesAway || corner == to;
+					corners[k] = position(corner);
+					moved[k] = corner == collapse.from ? position(to) : corners[k];
+				}
+				if (collapsesAway) {
+					removedIndices += 3;
+					continue;
+				}
+
+				const glm::vec3 before = glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+				const glm::vec3 after = glm::cross(moved[1] - moved[0], moved[2] - moved[0]);
+				valid = valid && glm::dot(before, after) > 0.0f;
+			}
+			if (!valid) {
+				continue;
+			}
+
+			touched[collapse.from] = true;
+			touched[to] = true;
+			for (uint32_t a = adjacencyOffsets[collapse.from]; a < adjacencyOffsets[collapse.from + 1]; a++) {
+				for (int k = 0; k < 3; k++) {
+					touched[canonical[triangles[adjacency[a] * 3 + k]]] = true;
+				}
+			}
+
+			remap[collapse.from] = collapse.to;
+			quadrics[to].add(quadrics[collapse.from]);
+			largestCost = std::max(largestCost, collapse.cost);
+			remainingIndices -= std::min(removedIndices, remainingIndices);
+			collapseCount++;
+		}
+
+		if (collapseCount == 0) {
+			break;
+		}
+
+		size_t kept = 0;
+		for (size_t i = 0; i < triangles.size(); i += 3) {
+			uint32_t triangle[3];
+			for (int k = 0; k < 3; k++) {
+				const uint32_t index = triangles[i + k];
+				triangle[k] = remap[index] != INVALID_VERTEX ? remap[index] : index;
+			}
+			const uint32_t c0 = canonical[triangle[0]];
+			const uint32_t c1 = canonical[triangle[1]];
+			const uint32_t c2 = canonical[triangle[2]];
+			if (c0 == c1 || c1 == c2 || c0 == c2) {
+				continue;
+			}
+			std::copy(triangle, triangle + 3, triangles.begin() + kept);
+			kept += 3;
+		}
+		triangles.resize(kept);
+		std::fill(remap.begin(), remap.end(), INVALID_VERTEX);
+	}
+
+	result.resize(triangles.size());
+	for (size_t i = 0; i < triangles.size(); i++) {
+		result[i] = vertices[triangles[i]];
+	}
+	return static_cast<float>(std::sqrt(largestCost));
+}
+
+// === LOD Chains ===
+
+uint32_t MeshSimplifier::build_lod_chain(MeshData& mesh, uint32_t max_lod_count, float ratio, float max_error) {
+	if (mesh.lods.size() > 1) {
+		throw std::runtime_error("A mesh's LOD chain can only be built once.");
+	}
+	if (mesh.lods.empty()) {
+		mesh.lods.push_back({ 0, static_cast<uint32_t>(mesh.submeshes.size()), 0.0f });
+	}
+
+	const vector<MeshData::Submesh> baseSubmeshes = mesh.submeshes;
+	const Aabb bounds = mesh.get_bounds(0, static_cast<uint32_t>(mesh.indices.size()));
+	const float maxDistance = max_error * glm::length(bounds.max - bounds.min);
+
+	size_t previousIndexCount = 0;
+	for (const MeshData::Submesh& submesh : baseSubmeshes) {
+		previousIndexCount += submesh.index_count;
+	}
+
+	vector<uint32_t> simplified;
+	for (uint32_t lod = 1; lod < max_lod_count; lod++) {
+		const float targetRatio = std::pow(ratio, static_cast<float>(lod));
+
+		MeshData::Lod lodRange;
+		lodRange.first_submesh = static_cast<uint32_t>(mesh.submeshes.size());
+		lodRange.error = mesh.lods.back().error;
+
+		const size_t firstIndex = mesh.indices.size();
+		vector<MeshData::Submesh> lodSubmeshes;
+		for (const MeshData::Submesh& submesh : baseSubmeshes) {
+			const std::span<const uint32_t> indices(mesh.indices.data() + submesh.first_index, submesh.index_count);
+			const size_t targetIndexCount = static_cast<size_t>(submesh.index_count * targetRatio) / 3 * 3;
+			const float error = simplify(mesh.positions, indices, targetIndexCount, maxDistance, simplified);
+
+			lodSubmeshes.push_back({ static_cast<uint32_t>(mesh.indices.size()), static_cast<uint32_t>(simplified.size()), submesh.material });
+			mesh.indices.insert(mesh.indices.end(), simplified.begin(), simplified.end());
+			// Kept monotonic, so the runtime can walk the chain until the error is too large.
+			lodRange.error = std::max(lodRange.error, error);
+		}
+
+		const size_t indexCount = mesh.indices.size() - firstIndex;
+		if (indexCount > previousIndexCount * MIN_SIMPLIFICATION) {
+			mesh.indices.resize(firstIndex);
+			break;
+		}
+
+		mesh.submeshes.insert(mesh.submeshes.end(), lodSubmeshes.begin(), lodSubmeshes.end());
+		lodRange.submesh_count = static_cast<uint32_t>(lodSubmeshes.size());
+		mesh.lods.push_back(lodRange);
+		previousIndexCount = indexCount;
+	}
+
+	return static_cast<uint32_t>(mesh.lods.size());
+}
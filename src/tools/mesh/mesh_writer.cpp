@@ -0,0 +1,321 @@
+#include "Tools/mesh/mesh_writer.h"
+#include "Engine/mesh/mesh_file.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+static constexpr size_t ARRAY_ALIGNMENT = 16;
+
+namespace {
+
+	struct SourceAttribute {
+		VertexSemantic semantic;
+		VertexFormat format;
+		const std::byte* values;
+		uint32_t size;
+	};
+};
+
+static uint16_t float_to_half(float value) {
+	uint32_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+
+	const uint32_t sign = (bits >> 16) & 0x8000;
+	const uint32_t exponent = (bits >> 23) & 0xFF;
+	uint32_t mantissa = bits & 0x7FFFFF;
+
+	if (exponent == 0xFF) {
+		return static_cast<uint16_t>(sign | 0x7C00 | (mantissa != 0 ? 0x200 : 0));
+	}
+
+	const int32_t halfExponent = static_cast<int32_t>(exponent) - 127 + 15;
+	if (halfExponent >= 31) {
+		// Clamp to the largest half instead of infinity.
+		return static_cast<uint16_t>(sign | 0x7BFF);
+	}
+	if (halfExponent <= 0) {
+		if (halfExponent < -10) {
+			return static_cast<uint16_t>(sign);
+		}
+		mantissa |= 0x800000;
+		const uint32_t shift = static_cast<uint32_t>(14 - halfExponent);
+		uint32_t half = mantissa >> shift;
+		if ((mantissa >> (shift - 1)) & 1) {
+			half++;
+		}
+		return static_cast<uint16_t>(sign | half);
+	}
+
+	// Rounding may carry into the exponent, which is still the correctly rounded value.
+	uint32_t half = sign | (static_cast<uint32_t>(halfExponent) << 10) | (mantissa >> 13);
+	if (mantissa & 0x1000) {
+		half++;
+	}
+	return static_cast<uint16_t>(half);
+}
+
+template<typename T>
+static T quantize_normalized(float value) {
+	// Rounds to the nearest step of an unsigned or signed normalized integer.
+	constexpr float MAX = static_cast<float>(std::numeric_limits<T>::max());
+	const float low = std::is_signed_v<T> ? -1.0f : 0.0f;
+	return static_cast<T>(std::lround(std::clamp(value, low, 1.0f) * MAX));
+}
+
+static glm::vec2 encode_octahedral(const glm::vec3& normal) {
+	// Projects onto the octahedron |x| + |y| + |z| = 1 and folds the lower half over the upper one.
+	const float length = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+	if (length == 0.0f) {
+		return glm::vec2(0.0f, 0.0f);
+	}
+
+	glm::vec2 encoded(normal.x / length, normal.y / length);
+	if (normal.z < 0.0f) {
+		encoded = glm::vec2(
+			(1.0f - std::abs(encoded.y)) * (encoded.x >= 0.0f ? 1.0f : -1.0f),
+			(1.0f - std::abs(encoded.x)) * (encoded.y >= 0.0f ? 1.0f : -1.0f)
+		);
+	}
+	return encoded;
+}
+
+template<typename T, size_t N, typename Encode>
+static vector<std::byte> encode_attribute(size_t vertex_count, Encode encode) {
+	vector<std::byte> encoded(vertex_count * N * sizeof(T));
+	std::array<T, N> vertex;
+	for (size_t v = 0; v < vertex_count; v++) {
+		encode(v, vertex);
+		std::memcpy(encoded.data() + v * sizeof(vertex), vertex.data(), sizeof(vertex));
+	}
+	return encoded;
+}
+
+vector<std::byte> MeshWriter::serialize(const MeshData& mesh, Layout layout, Encoding encoding) {
+	mesh.validate();
+
+	const uint32_t vertexCount = static_cast<uint32_t>(mesh.get_vertex_count());
+	const uint32_t indexCount = static_cast<uint32_t>(mesh.indices.size());
+
+	vector<std::byte> file(sizeof(MeshFileHeader));
+
+	auto append = [&file](const void* values, size_t count, size_t element_size, size_t alignment) {
+		size_t offset = (file.size() + alignment - 1) / alignment * alignment;
+		file.resize(offset + count * element_size);
+		// Null reserves zeroed space that is filled in place.
+		if (values != nullptr && count != 0) {
+			std::memcpy(file.data() + offset, values, count * element_size);
+		}
+		return MeshFileRange{ offset, count };
+	};
+
+	auto appendArray = [&append](const auto& values) {
+		using T = std::remove_cvref_t<decltype(values[0])>;
+		return append(values.data(), values.size(), sizeof(T), std::max(ARRAY_ALIGNMENT, alignof(T)));
+	};
+
+	MeshFileHeader header;
+	header.vertex_count = vertexCount;
+	header.index_count = indexCount;
+
+	// === Vertices ===
+
+	vector<SourceAttribute> sources;
+	vector<vector<std::byte>> encodedAttributes;
+
+	auto addFloat = [&sources](VertexSemantic semantic, VertexFormat format, const auto& values) {
+		sources.push_back({ semantic, format, reinterpret_cast<const std::byte*>(values.data()), static_cast<uint32_t>(sizeof(values[0])) });
+	};
+
+	auto addEncoded = [&sources, &encodedAttributes](VertexSemantic semantic, VertexFormat format, vector<std::byte> values) {
+		encodedAttributes.push_back(std::move(values));
+		sources.push_back({ semantic, format, encodedAttributes.back().data(), MeshFile::get_format_size(format) });
+	};
+
+	if (encoding == Encoding::FLOAT) {
+		addFloat(VertexSemantic::POSITION, VertexFormat::FLOAT3, mesh.positions);
+		if (!mesh.normals.empty()) {
+			addFloat(VertexSemantic::NORMAL, VertexFormat::FLOAT3, mesh.normals);
+		}
+		if (!mesh.texcoords.empty()) {
+			addFloat(VertexSemantic::TEXCOORD, VertexFormat::FLOAT2, mesh.texcoords);
+		}
+		if (!mesh.colors.empty()) {
+			addFloat(VertexSemantic::COLOR, VertexFormat::FLOAT4, mesh.colors);
+		}
+	}
+	else {
+		encodedAttributes.reserve(4);
+
+		// Positions are normalized over every vertex's bounds, not just the ones triangles use.
+		Aabb positionBounds;
+		for (const glm::vec3& position : mesh.positions) {
+			positionBounds.expand(position);
+		}
+		if (!positionBounds.is_empty()) {
+			header.position_offset = positionBounds.min;
+			header.position_scale = positionBounds.max - positionBounds.min;
+		}
+
+		const glm::vec3 offset = header.position_offset;
+		const glm::vec3 scale = header.position_scale;
+		addEncoded(VertexSemantic::POSITION, VertexFormat::UNORM16x4, encode_attribute<uint16_t, 4>(vertexCount, [&](size_t v, std::array<uint16_t, 4>& out) {
+			const glm::vec3 relative = mesh.positions[v] - offset;
+			out[0] = quantize_normalized<uint16_t>(scale.x > 0.0f ? relative.x / scale.x : 0.0f);
+			out[1] = quantize_normalized<uint16_t>(scale.y > 0.0f ? relative.y / scale.y : 0.0f);
+			out[2] = quantize_normalized<uint16_t>(scale.z > 0.0f ? relative.z / scale.z : 0.0f);
+			out[3] = 0;
+		}));
+
+		if (!mesh.normals.empty()) {
+			addEncoded(VertexSemantic::NORMAL, VertexFormat::SNORM16x2, encode_attribute<int16_t, 2>(vertexCount, [&](size_t v, std::array<int16_t, 2>& out) {
+				const glm::vec2 octahedral = encode_octahedral(mesh.normals[v]);
+				out[0] = quantize_normalized<int16_t>(octahedral.x);
+				out[1] = quantize_normalized<int16_t>(octahedral.y);
+			}));
+		}
+		if (!mesh.texcoords.empty()) {
+			addEncoded(VertexSemantic::TEXCOORD, VertexFormat::HALF2, encode_attribute<uint16_t, 2>(vertexCount, [&](size_t v, std::array<uint16_t, 2>& out) {
+				out[0] = float_to_half(mesh.texcoords[v].x);
+				out[1] = float_to_half(mesh.texcoords[v].y);
+			}));
+		}
+		if (!mesh.colors.empty()) {
+			addEncoded(VertexSemantic::COLOR, VertexFormat::UNORM8x4, encode_attribute<uint8_t, 4>(vertexCount, [&](size_t v, std::array<uint8_t, 4>& out) {
+				for (int c = 0; c < 4; c++) {
+					out[c] = quantize_normalized<uint8_t>(mesh.colors[v][c]);
+				}
+			}));
+		}
+	}
+
+	vector<MeshFileVertexAttribute> attributes;
+	vector<uint32_t> strides;
+
+	for (size_t a = 0; a < sources.size(); a++) {
+		uint32_t stream = 0;
+		if (layout == Layout::SEPARATE) {
+			stream = static_cast<uint32_t>(a);
+		}
+		else if (layout == Layout::SPLIT_POSITIONS) {
+			stream = sources[a].semantic == VertexSemantic::POSITION ? 0 : 1;
+		}
+
+		if (stream >= strides.size()) {
+			strides.resize(stream + 1, 0);
+		}
+
+		MeshFileVertexAttribute attribute;
+		attribute.semantic = sources[a].semantic;
+		attribute.format = sources[a].format;
+		attribute.stream = stream;
+		attribute.offset = strides[stream];
+		attributes.push_back(attribute);
+
+		strides[stream] += sources[a].size;
+	}
+
+	vector<MeshFileVertexStream> streams(strides.size());
+	for (size_t s = 0; s < streams.size(); s++) {
+		streams[s].stride = strides[s];
+		streams[s].data = append(nullptr, static_cast<size_t>(vertexCount) * strides[s], 1, ARRAY_ALIGNMENT);
+	}
+
+	// Scatter every attribute into its stream's vertices.
+	for (size_t a = 0; a < sources.size(); a++) {
+		const MeshFileVertexStream& stream = streams[attributes[a].stream];
+		std::byte* destination = file.data() + stream.data.offset + attributes[a].offset;
+		for (uint32_t v = 0; v < vertexCount; v++) {
+			std::memcpy(destination + static_cast<size_t>(v) * stream.stride, sources[a].values + static_cast<size_t>(v) * sources[a].size, sources[a].size);
+		}
+	}
+
+	header.attributes = appendArray(attributes);
+	header.streams = appendArray(streams);
+
+	// === Indices ===
+
+	// Half the index bandwidth whenever the vertices allow it.
+	if (vertexCount <= std::numeric_limits<uint16_t>::max()) {
+		vector<uint16_t> shortIndices(mesh.indices.begin(), mesh.indices.end());
+		header.index_size = sizeof(uint16_t);
+		header.indices = append(shortIndices.data(), shortIndices.size() * sizeof(uint16_t), 1, ARRAY_ALIGNMENT);
+	}
+	else {
+		header.index_size = sizeof(uint32_t);
+		header.indices = append(mesh.indices.data(), mesh.indices.size() * sizeof(uint32_t), 1, ARRAY_ALIGNMENT);
+	}
+
+	// === Submeshes ===
+
+	header.bounds = mesh.get_bounds(0, indexCount);
+
+	vector<MeshFileSubmesh> submeshes;
+	for (const MeshData::Submesh& source : mesh.submeshes) {
+		MeshFileSubmesh submesh;
+		submesh.first_index = source.first_index;
+		submesh.index_count = source.index_count;
+		submesh.material = source.material;
+		submesh.bounds = mesh.get_bounds(source.first_index, source.index_count);
+		submesh.first_meshlet = source.first_meshlet;
+		submesh.meshlet_count = source.meshlet_count;
+		submeshes.push_back(submesh);
+	}
+
+	vector<MeshFileMeshlet> meshlets;
+	for (const MeshData::Meshlet& source : mesh.meshlets) {
+		MeshFileMeshlet meshlet;
+		meshlet.center = source.center;
+		meshlet.radius = source.radius;
+		meshlet.cone_axis = source.cone_axis;
+		meshlet.cone_cutoff = source.cone_cutoff;
+		meshlet.first_index = source.first_index;
+		meshlet.index_count = source.index_count;
+		meshlets.push_back(meshlet);
+	}
+
+	vector<MeshFileRange> materialNames;
+	for (const std::string& name : mesh.material_names) {
+		materialNames.push_back(append(name.data(), name.size(), 1, 1));
+	}
+
+	// A mesh without a LOD chain is a single LOD of every submesh.
+	vector<MeshFileLod> lods;
+	for (const MeshData::Lod& source : mesh.lods) {
+		MeshFileLod lod;
+		lod.first_submesh = source.first_submesh;
+		lod.submesh_count = source.submesh_count;
+		lod.error = source.error;
+		lods.push_back(lod);
+	}
+	if (lods.empty()) {
+		MeshFileLod lod;
+		lod.submesh_count = static_cast<uint32_t>(mesh.submeshes.size());
+		lods.push_back(lod);
+	}
+
+	header.submeshes = appendArray(submeshes);
+	header.material_names = appendArray(materialNames);
+	header.lods = appendArray(lods);
+	header.meshlets = appendArray(meshlets);
+
+	header.file_size = file.size();
+	std::memcpy(file.data(), &header, sizeof(header));
+
+	return file;
+}
+
+void MeshWriter::save(const MeshData& mesh, Layout layout, Encoding encoding, const std::string& path) {
+	vector<std::byte> file = serialize(mesh, layout, encoding);
+
+	std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+	stream.write(reinterpret_cast<const char*>(file.data()), static_cast<std::streamsize>(file.size()));
+
+	if (!stream) {
+		throw std::runtime_error("Couldn't write the mesh file \"" + path + "\".");
+	}
+}
@@ -0,0 +1,191 @@
+#include "Tools/mesh/meshlet_builder.h"
+#include <algorithm>
+#include <cmath>
+#include <span>
+#include <stdexcept>
+
+// CODE FORMATTING INFORMATION:
+// Simple functions like getters and setters go at the bottom.
+// Organize from most complex at the top to least complex at the bottom.
+
+static void compute_meshlet_bounds(const MeshData& mesh, std::span<const uint32_t> indices, MeshData::Meshlet& meshlet) {
+	Aabb box;
+	for (uint32_t index : indices) {
+		box.expand(mesh.positions[index]);
+	}
+
+	meshlet.center = box.get_center();
+	meshlet.radius = 0.0f;
+	for (uint32_t index : indices) {
+		meshlet.radius = std::max(meshlet.radius, glm::length(mesh.positions[index] - meshlet.center));
+	}
+
+	// The cone around the face normals (not the vertex normals, those don't decide the facing).
+	glm::vec3 normalSum(0.0f);
+	for (size_t i = 0; i < indices.size(); i += 3) {
+		const glm::vec3& p0 = mesh.positions[indices[i]];
+		const glm::vec3 normal = glm::cross(mesh.positions[indices[i + 1]] - p0, mesh.positions[indices[i + 2]] - p0);
+		const float length = glm::length(normal);
+		if (length > 0.0f) {
+			normalSum += normal / length;
+		}
+	}
+
+	meshlet.cone_axis = glm::vec3(0.0f);
+	meshlet.cone_cutoff = 1.0f;
+
+	const float sumLength = glm::length(normalSum);
+	if (sumLength <= 0.0f) {
+		return;
+	}
+
+	const glm::vec3 axis = normalSum / sumLength;
+	float minDot = 1.0f;
+	for (size_t i = 0; i < indices.size(); i += 3) {
+		const glm::vec3& p0 = mesh.positions[indices[i]];
+		const glm::vec3 normal = glm::cross(mesh.positions[indices[i + 1]] - p0, mesh.positions[indices[i + 2]] - p0);
+		const float length = glm::length(normal);
+		if (length > 0.0f) {
+			minDot = std::min(minDot, glm::dot(normal / length, axis));
+		}
+	}
+
+	if (minDot > MeshletBuilder::MIN_CONE_SPREAD) {
+		meshlet.cone_axis = axis;
+		meshlet.cone_cutoff = std::sqrt(1.0f - minDot * minDot);
+	}
+}
+
+static void build_submesh_meshlets(MeshData& mesh, MeshData::Submesh& submesh, uint32_t max_vertices, uint32_t max_triangles) {
+	std::span<uint32_t> indices(mesh.indices.data() + submesh.first_index, submesh.index_count);
+	const uint32_t triangleCount = submesh.index_count / 3;
+
+	// Renumber the submesh's vertices from zero so the per vertex arrays are sized by it.
+	vector<uint32_t> vertices(indices.begin(), indices.end());
+	std::sort(vertices.begin(), vertices.end());
+	vertices.erase(std::unique(vertices.begin(), vertices.end()), vertices.end());
+	const uint32_t vertexCount = static_cast<uint32_t>(vertices.size());
+
+	vector<uint32_t> localIndices(indices.size());
+	for (size_t i = 0; i < indices.size(); i++) {
+		localIndices[i] = static_cast<uint32_t>(std::lower_bound(vertices.begin(), vertices.end(), indices[i]) - vertices.begin());
+	}
+
+	vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+	for (uint32_t index : localIndices) {
+		adjacencyOffsets[index + 1]++;
+	}
+	for (uint32_t v = 0; v < vertexCount; v++) {
+		adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+	}
+	vector<uint32_t> adjacency(localIndices.size());
+	{
+		vector<uint32_t> cursors(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+		for (size_t i = 0; i < localIndices.size(); i++) {
+			adjacency[cursors[localIndices[i]]++] = static_cast<uint32_t>(i / 3);
+		}
+	}
+
+	vector<bool> emitted(triangleCount, false);
+	// The stamp of the last meshlet each vertex was added to, stamps start at 1.
+	vector<uint32_t> vertexMeshlet(vertexCount, 0);
+	vector<uint32_t> candidates;
+	vector<uint32_t> meshletTriangles;
+	vector<uint32_t> reordered;
+	reordered.reserve(indices.size());
+
+	uint32_t meshletStamp = 0;
+	uint32_t meshletVertexCount = 0;
+
+	auto count_new_vertices = [&](uint32_t triangle) {
+		uint32_t count = 0;
+		for (int k = 0; k < 3; k++) {
+			count += vertexMeshlet[localIndices[triangle * 3 + k]] != meshletStamp;
+		}
+		return count;
+	};
+
+	auto add_triangle = [&](uint32_t triangle) {
+		for (int k = 0; k < 3; k++) {
+			const uint32_t vertex = localIndices[triangle * 3 + k];
+			if (vertexMeshlet[vertex] != meshletStamp) {
+				vertexMeshlet[vertex] = meshletStamp;
+				meshletVertexCount++;
+				candidates.insert(candidates.end(), adjacency.begin() + adjacencyOffsets[vertex], adjacency.begin() + adjacencyOffsets[vertex + 1]);
+			}
+		}
+		emitted[triangle] = true;
+		meshletTriangles.push_back(triangle);
+	};
+
+	uint32_t seed = 0;
+	while (true) {
+		while (seed < triangleCount && emitted[seed]) {
+			seed++;
+		}
+		if (seed == triangleCount) {
+			break;
+		}
+
+		meshletStamp++;
+		meshletVertexCount = 0;
+		meshletTriangles.clear();
+		candidates.clear();
+		add_triangle(seed);
+
+		while (meshletTriangles.size() < max_triangles) {
+			uint32_t best = triangleCount;
+			uint32_t bestNewVertices = 4;
+
+			// Drop the triangles already taken while looking, the list only grows otherwise.
+			size_t kept = 0;
+			for (size_t c = 0; c < candidates.size(); c++) {
+				const uint32_t candidate = candidates[c];
+				if (emitted[candidate]) {
+					continue;
+				}
+				candidates[kept++] = candidate;
+
+				const uint32_t newVertices = count_new_vertices(candidate);
+				if (newVertices < bestNewVertices && meshletVertexCount + newVertices <= max_vertices) {
+					best = candidate;
+					bestNewVertices = newVertices;
+				}
+			}
+			candidates.resize(kept);
+
+			if (best == triangleCount) {
+				break;
+			}
+			add_triangle(best);
+		}
+
+		MeshData::Meshlet meshlet;
+		meshlet.first_index = submesh.first_index + static_cast<uint32_t>(reordered.size());
+		meshlet.index_count = static_cast<uint32_t>(meshletTriangles.size() * 3);
+		for (uint32_t triangle : meshletTriangles) {
+			for (int k = 0; k < 3; k++) {
+				reordered.push_back(vertices[localIndices[triangle * 3 + k]]);
+			}
+		}
+		compute_meshlet_bounds(mesh, std::span<const uint32_t>(reordered.end() - meshlet.index_count, reordered.end()), meshlet);
+		mesh.meshlets.push_back(meshlet);
+	}
+
+	std::copy(reordered.begin(), reordered.end(), indices.begin());
+}
+
+// === Building ===
+
+void MeshletBuilder::build(MeshData& mesh, uint32_t max_vertices, uint32_t max_triangles) {
+	if (max_vertices < 3 || max_triangles < 1) {
+		throw std::invalid_argument("A meshlet must fit at least one triangle.");
+	}
+
+	mesh.meshlets.clear();
+	for (MeshData::Submesh& submesh : mesh.submeshes) {
+		submesh.first_meshlet = static_cast<uint32_t>(mesh.meshlets.size());
+		build_submesh_meshlets(mesh, submesh, max_vertices, max_triangles);
+		submesh.meshlet_count = static_cast<uint32_t>(mesh.meshlets.size()) - submesh.first_meshlet;
+	}
+}
@@ -0,0 +1,181 @@
+#include "Tools/pack/pack_writer.h"
+#include "Engine/io/block_compression.h"
+#include "Engine/io/mapped_file.h"
+#include "Engine/io/pack_file.h"
+#include "Engine/thread_pool/thread_pool.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string_view>
+
+// CODE FORMATTING INFORMATION:
+// Simple functions like getters and setters go at the bottom.
+// Organize from most complex at the top to least complex at the bottom.
+
+static constexpr size_t BATCH_BLOCK_COUNT = 256;
+/// 16 MB of input per batch.
+
+namespace {
+
+	struct PendingBlock {
+		const std::byte* data;
+		size_t size;
+		vector<std::byte> compressed;
+		/// Empty when the block is stored as is.
+	};
+};
+
+static void write_padding(std::ofstream& stream, uint64_t& position, size_t alignment) {
+	static constexpr char ZEROS[16] = {};
+	const size_t padding = static_cast<size_t>((alignment - position % alignment) % alignment);
+	stream.write(ZEROS, static_cast<std::streamsize>(padding));
+	position += padding;
+}
+
+// === Packing ===
+
+vector<PackWriter::Source> PackWriter::collect(const std::string& directory) {
+	vector<Source> sources;
+	for (const std::filesystem::directory_entry& entry : std::filesystem::recursive_directory_iterator(directory)) {
+		if (entry.is_regular_file()) {
+			sources.push_back(Source{ std::filesystem::relative(entry.path(), directory).generic_string(), entry.path().string() });
+		}
+	}
+
+	// Packs built from the same files come out byte for byte the same.
+	std::sort(sources.begin(), sources.end(), [](const Source& a, const Source& b) {
+		return a.name < b.name;
+	});
+	return sources;
+}
+
+PackWriter::Statistics PackWriter::save(const vector<Source>& sources, const std::string& path, bool compress, ThreadPool::Pool* pool) {
+	vector<PackFileEntry> entries;
+	vector<PackFileBlock> blocks;
+	std::string names;
+	Statistics statistics;
+
+	for (const Source& source : sources) {
+		const std::string name = PackFile::normalize_path(source.name);
+		PackFileEntry entry;
+		entry.path_hash = PackFile::hash_path(name);
+		entry.name_offset = static_cast<uint32_t>(names.size());
+		entry.name_size = static_cast<uint32_t>(name.size());
+		names += name;
+		entries.push_back(entry);
+	}
+
+	{
+		vector<std::string_view> sortedNames;
+		for (const PackFileEntry& entry : entries) {
+			sortedNames.push_back(std::string_view(names).substr(entry.name_offset, entry.name_size));
+		}
+		std::sort(sortedNames.begin(), sortedNames.end());
+		auto duplicate = std::adjacent_find(sortedNames.begin(), sortedNames.end());
+		if (duplicate != sortedNames.end()) {
+			throw std::invalid_argument("Two files are packed as \"" + std::string(*duplicate) + "\".");
+		}
+	}
+
+	std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+	PackFileHeader header;
+	stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	uint64_t position = sizeof(header);
+
+	vector<MappedFile> batchFiles;
+	vector<PendingBlock> batch;
+
+	auto flushBatch = [&]() {
+		auto compressBlocks = [&batch, compress](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++) {
+				PendingBlock& block = batch[i];
+				block.compressed.clear();
+				if (!compress) {
+					continue;
+				}
+
+				block.compressed.resize(BlockCompression::get_max_compressed_size(block.size));
+				const size_t compressedSize = BlockCompression::compress(std::span<const std::byte>(block.data, block.size), block.compressed);
+				block.compressed.resize(compressedSize < block.size ? compressedSize : 0);
+			}
+		};
+
+		if (pool != nullptr) {
+			pool->parallel_for(batch.size(), 1, compressBlocks);
+		}
+		else {
+			compressBlocks(0, batch.size());
+		}
+
+		for (const PendingBlock& pending : batch) {
+			const bool stored = pending.compressed.empty();
+			PackFileBlock block;
+			block.offset = position;
+			block.size = static_cast<uint32_t>(pending.size);
+			block.compressed_size = stored ? block.size : static_cast<uint32_t>(pending.compressed.size());
+			stream.write(reinterpret_cast<const char*>(stored ? pending.data : pending.compressed.data()), block.compressed_size);
+			position += block.compressed_size;
+			statistics.packed_size += block.compressed_size;
+			blocks.push_back(block);
+		}
+
+		batch.clear();
+		batchFiles.clear();
+	};
+
+	for (size_t s = 0; s < sources.size(); s++) {
+		MappedFile& file = batchFiles.emplace_back(sources[s].path);
+		std::span<const std::byte> bytes = file.get_data();
+
+		PackFileEntry& entry = entries[s];
+		entry.size = bytes.size();
+		entry.first_block = blocks.size() + batch.size();
+		entry.block_count = static_cast<uint32_t>((bytes.size() + PackFileHeader::BLOCK_SIZE - 1) / PackFileHeader::BLOCK_SIZE);
+
+		for (size_t offset = 0; offset < bytes.size(); offset += PackFileHeader::BLOCK_SIZE) {
+			batch.push_back(PendingBlock{ bytes.data() + offset, std::min<size_t>(PackFileHeader::BLOCK_SIZE, bytes.size() - offset), {} });
+		}
+		statistics.size += bytes.size();
+
+		if (batch.size() >= BATCH_BLOCK_COUNT) {
+			flushBatch();
+		}
+	}
+	flushBatch();
+	statistics.file_count = entries.size();
+
+	// Sorted by hash for the binary search, names break (very unlikely) ties.
+	std::sort(entries.begin(), entries.end(), [&names](const PackFileEntry& a, const PackFileEntry& b) {
+		if (a.path_hash != b.path_hash) {
+			return a.path_hash < b.path_hash;
+		}
+		return names.compare(a.name_offset, a.name_size, names, b.name_offset, b.name_size) < 0;
+	});
+
+	write_padding(stream, position, alignof(PackFileEntry));
+	header.entries_offset = position;
+	header.entry_count = static_cast<uint32_t>(entries.size());
+	stream.write(reinterpret_cast<const char*>(entries.data()), static_cast<std::streamsize>(entries.size() * sizeof(PackFileEntry)));
+	position += entries.size() * sizeof(PackFileEntry);
+
+	header.blocks_offset = position;
+	header.block_count = blocks.size();
+	stream.write(reinterpret_cast<const char*>(blocks.data()), static_cast<std::streamsize>(blocks.size() * sizeof(PackFileBlock)));
+	position += blocks.size() * sizeof(PackFileBlock);
+
+	header.names_offset = position;
+	header.names_size = names.size();
+	stream.write(names.data(), static_cast<std::streamsize>(names.size()));
+	position += names.size();
+
+	header.file_size = position;
+	stream.seekp(0);
+	stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+	if (!stream) {
+		throw std::runtime_error("Couldn't write the pack \"" + path + "\".");
+	}
+
+	return statistics;
+}
@@ -0,0 +1,97 @@
+//*****************************************
+// This is the entry point for the pack builder, the offline tool that bundles a directory of
+// game files into one compressed pack the runtime mounts
+//*****************************************
+
+#include "Engine/io/pack_file.h"
+#include "Engine/thread_pool/thread_pool.h"
+#include "Tools/pack/pack_writer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using std::cout, std::cerr, std::endl;
+using std::vector;
+
+static double get_milliseconds_since(std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void print_usage() {
+	cout << "Usage: pack_builder [options] <directory> <output>\n"
+		<< "  Packs every file under the directory, named by its path relative to it, into one archive\n"
+		<< "  of 64 KB compressed blocks.\n\n"
+		<< "Options:\n"
+		<< "  --store            don't compress, for data that is already compressed\n"
+		<< "  --threads <count>  worker threads, defaults to the hardware's\n"
+		<< endl;
+}
+
+int main(int argc, char** argv)
+{
+	bool compress = true;
+	size_t threadCount = std::max(1u, std::thread::hardware_concurrency());
+	std::string directory;
+	std::string outputPath;
+
+	for (int i = 1; i < argc; i++) {
+		if (std::strcmp(argv[i], "--store") == 0) {
+			compress = false;
+		}
+		else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+			threadCount = static_cast<size_t>(std::max(1l, std::strtol(argv[++i], nullptr, 10)));
+		}
+		else if (std::strcmp(argv[i], "--help") == 0) {
+			print_usage();
+			return 0;
+		}
+		else if (directory.empty()) {
+			directory = argv[i];
+		}
+		else if (outputPath.empty()) {
+			outputPath = argv[i];
+		}
+		else {
+			print_usage();
+			return 1;
+		}
+	}
+
+	if (directory.empty() || outputPath.empty()) {
+		print_usage();
+		return 1;
+	}
+
+	try {
+		ThreadPool::Pool pool(1, threadCount);
+
+		auto start = std::chrono::steady_clock::now();
+		vector<PackWriter::Source> sources = PackWriter::collect(directory);
+		PackWriter::Statistics statistics = PackWriter::save(sources, outputPath, compress, &pool);
+		double packMilliseconds = get_milliseconds_since(start);
+
+		// Open the result the way the runtime does, so a broken pack never leaves the builder.
+		start = std::chrono::steady_clock::now();
+		PackFile pack(outputPath);
+		double openMilliseconds = get_milliseconds_since(start);
+
+		cout << std::fixed << std::setprecision(3)
+			<< " - Packed " << statistics.file_count << " files, " << statistics.size << " bytes into " << statistics.packed_size << " ("
+			<< (statistics.size > 0 ? static_cast<double>(statistics.packed_size) / statistics.size : 1.0) << " of the size) on " << pool.thread_count << " threads in " << packMilliseconds << "ms\n"
+			<< " - Wrote " << pack.size() << " bytes to \"" << outputPath << "\"\n"
+			<< " - Mapped and validated in " << openMilliseconds << "ms" << endl;
+	}
+	catch (const std::exception& exception) {
+		cerr << "Packing failed: " << exception.what() << endl;
+		return 1;
+	}
+
+	return 0;
+}
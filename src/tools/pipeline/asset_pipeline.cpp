@@ -0,0 +1,300 @@
+#include "Tools/pipeline/asset_pipeline.h"
+#include "Engine/mesh/mesh_file.h"
+#include "Tools/mesh/mesh_importer.h"
+#include "Tools/mesh/meshlet_builder.h"
+#include "Tools/texture/mip_generator.h"
+#include "Tools/texture/texture_importer.h"
+#include "Tools/texture/texture_writer.h"
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+// CODE FORMATTING INFORMATION:
+// Simple functions like getters and setters go at the bottom.
+// Organize from most complex at the top to least complex at the bottom.
+
+namespace fs = std::filesystem;
+
+static const char* const MESH_EXTENSIONS[] = { ".obj", ".fbx", ".gltf", ".glb", ".dae", ".3ds", ".blend", ".ply", ".stl" };
+static const char* const TEXTURE_EXTENSIONS[] = { ".png", ".jpg", ".jpeg", ".tga", ".bmp", ".psd", ".gif" };
+
+static std::string to_lower(std::string text) {
+	std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+	return text;
+}
+
+static std::string trim(const std::string& text) {
+	const size_t first = text.find_first_not_of(" \t\r");
+	if (first == std::string::npos) {
+		return "";
+	}
+	return text.substr(first, text.find_last_not_of(" \t\r") - first + 1);
+}
+
+static bool parse_bool(const std::string& key, const std::string& value) {
+	if (value == "true" || value == "1") {
+		return true;
+	}
+	if (value == "false" || value == "0") {
+		return false;
+	}
+	throw std::invalid_argument("\"" + key + "\" must be true or false, not \"" + value + "\".");
+}
+
+static uint32_t parse_uint(const std::string& key, const std::string& value, uint32_t min) {
+	try {
+		size_t end;
+		const unsigned long parsed = std::stoul(value, &end);
+		if (end == value.size() && parsed >= min) {
+			return static_cast<uint32_t>(parsed);
+		}
+	}
+	catch (const std::exception&) {
+	}
+	throw std::invalid_argument("\"" + key + "\" must be a whole number of at least " + std::to_string(min) + ", not \"" + value + "\".");
+}
+
+static float parse_float(const std::string& key, const std::string& value, float min, float max) {
+	try {
+		size_t end;
+		const float parsed = std::stof(value, &end);
+		if (end == value.size() && parsed >= min && parsed <= max) {
+			return parsed;
+		}
+	}
+	catch (const std::exception&) {
+	}
+	throw std::invalid_argument("\"" + key + "\" must be between " + std::to_string(min) + " and " + std::to_string(max) + ", not \"" + value + "\".");
+}
+
+static vector<std::byte> cook_mesh(const std::string& source_path, const AssetPipeline::Settings& settings) {
+	// The same steps in the same order as the asset cooker.
+	MeshData mesh = MeshImporter::import(source_path);
+
+	if (settings.lod_count > 1) {
+		MeshSimplifier::build_lod_chain(mesh, settings.lod_count, settings.lod_ratio, settings.lod_max_error);
+	}
+	if (settings.optimize) {
+		MeshOptimizer::optimize(mesh, settings.cache_size);
+	}
+	if (settings.meshlets) {
+		MeshletBuilder::build(mesh);
+		if (settings.optimize) {
+			MeshOptimizer::optimize_vertex_fetch(mesh);
+		}
+	}
+
+	return MeshWriter::serialize(mesh, settings.layout, settings.encoding);
+}
+
+static vector<std::byte> cook_texture(const std::string& source_path, const AssetPipeline::Settings& settings, ThreadPool::Pool* pool) {
+	const TextureFormat format = settings.get_texture_format();
+	const bool linear = settings.linear || format == TextureFormat::BC5_UNORM;
+
+	vector<vector<ImageData>> layers;
+	layers.push_back(MipGenerator::build_mip_chain(TextureImporter::import(source_path, !linear), settings.mips ? MipGenerator::ALL_MIPS : 1, pool));
+	return TextureWriter::serialize(layers, format, pool);
+}
+
+// === Cooking ===
+
+vector<std::byte> AssetPipeline::cook(const std::string& source_path, AssetType type, const Settings& settings, ThreadPool::Pool* pool) {
+	switch (type) {
+	case AssetType::MESH:
+		return cook_mesh(source_path, settings);
+	case AssetType::TEXTURE:
+		return cook_texture(source_path, settings, pool);
+	default:
+		throw std::invalid_argument("\"" + source_path + "\" isn't an asset.");
+	}
+}
+
+AssetPipeline::Settings AssetPipeline::load_settings(const std::string& source_path, const Settings& defaults) {
+	Settings settings = defaults;
+
+	const std::string importPath = source_path + ".import";
+	std::ifstream stream(importPath);
+	if (!stream) {
+		return settings;
+	}
+
+	std::string line;
+	for (uint32_t lineNumber = 1; std::getline(stream, line); lineNumber++) {
+		line = trim(line.substr(0, line.find('#')));
+		if (line.empty()) {
+			continue;
+		}
+
+		const size_t equals = line.find('=');
+		if (equals == std::string::npos) {
+			throw std::invalid_argument("\"" + importPath + "\" line " + std::to_string(lineNumber) + ": expected key = value.");
+		}
+
+		try {
+			settings.set(trim(line.substr(0, equals)), trim(line.substr(equals + 1)));
+		}
+		catch (const std::invalid_argument& exception) {
+			throw std::invalid_argument("\"" + importPath + "\" line " + std::to_string(lineNumber) + ": " + exception.what());
+		}
+	}
+
+	return settings;
+}
+
+vector<std::string> AssetPipeline::get_dependencies(const std::string& source_path, AssetType type) {
+	vector<std::string> dependencies;
+	if (type != AssetType::MESH) {
+		return dependencies;
+	}
+
+	const fs::path source(source_path);
+	std::error_code errorCode;
+	for (const fs::directory_entry& entry : fs::directory_iterator(source.parent_path().empty() ? fs::path(".") : source.parent_path(), errorCode)) {
+		if (entry.is_regular_file() && entry.path().stem() == source.stem() && entry.path().filename() != source.filename()) {
+			dependencies.push_back(entry.path().string());
+		}
+	}
+
+	// Directory order isn't stable, the key must be.
+	std::sort(dependencies.begin(), dependencies.end());
+	return dependencies;
+}
+
+void AssetPipeline::Settings::set(const std::string& key, const std::string& value) {
+	if (key == "layout") {
+		if (value == "interleaved") {
+			this->layout = MeshWriter::Layout::INTERLEAVED;
+		}
+		else if (value == "split") {
+			this->layout = MeshWriter::Layout::SPLIT_POSITIONS;
+		}
+		else if (value == "separate") {
+			this->layout = MeshWriter::Layout::SEPARATE;
+		}
+		else {
+			throw std::invalid_argument("unknown layout \"" + value + "\".");
+		}
+	}
+	else if (key == "quantize") {
+		this->encoding = parse_bool(key, value) ? MeshWriter::Encoding::QUANTIZED : MeshWriter::Encoding::FLOAT;
+	}
+	else if (key == "optimize") {
+		this->optimize = parse_bool(key, value);
+	}
+	else if (key == "cache_size") {
+		this->cache_size = parse_uint(key, value, 3);
+	}
+	else if (key == "lod_count") {
+		this->lod_count = parse_uint(key, value, 1);
+	}
+	else if (key == "lod_ratio") {
+		this->lod_ratio = parse_float(key, value, 0.05f, 0.95f);
+	}
+	else if (key == "lod_max_error") {
+		this->lod_max_error = parse_float(key, value, 0.0f, 1.0f);
+	}
+	else if (key == "meshlets") {
+		this->meshlets = parse_bool(key, value);
+	}
+	else if (key == "texture_format") {
+		const std::string previous = this->texture_format;
+		this->texture_format = value;
+		try {
+			this->get_texture_format();
+		}
+		catch (const std::invalid_argument&) {
+			this->texture_format = previous;
+			throw;
+		}
+	}
+	else if (key == "linear") {
+		this->linear = parse_bool(key, value);
+	}
+	else if (key == "mips") {
+		this->mips = parse_bool(key, value);
+	}
+	else {
+		throw std::invalid_argument("unknown setting \"" + key + "\".");
+	}
+}
+
+std::string AssetPipeline::Settings::get_key(AssetType type) const {
+	std::ostringstream key;
+	// Floats as hex so equal settings always print the same.
+	key << std::hexfloat;
+
+	if (type == AssetType::MESH) {
+		key << "layout=" << static_cast<int>(this->layout)
+			<< ";encoding=" << static_cast<int>(this->encoding)
+			<< ";optimize=" << this->optimize
+			<< ";cache_size=" << this->cache_size
+			<< ";lod_count=" << this->lod_count
+			<< ";lod_ratio=" << this->lod_ratio
+			<< ";lod_max_error=" << this->lod_max_error
+			<< ";meshlets=" << this->meshlets;
+	}
+	else if (type == AssetType::TEXTURE) {
+		key << "texture_format=" << static_cast<uint32_t>(this->get_texture_format())
+			<< ";linear=" << this->linear
+			<< ";mips=" << this->mips;
+	}
+
+	return key.str();
+}
+
+TextureFormat AssetPipeline::Settings::get_texture_format() const {
+	if (this->texture_format == "bc1") {
+		return this->linear ? TextureFormat::BC1_UNORM : TextureFormat::BC1_SRGB;
+	}
+	if (this->texture_format == "bc3") {
+		return this->linear ? TextureFormat::BC3_UNORM : TextureFormat::BC3_SRGB;
+	}
+	if (this->texture_format == "bc5") {
+		return TextureFormat::BC5_UNORM;
+	}
+	if (this->texture_format == "bc7") {
+		return this->linear ? TextureFormat::BC7_UNORM : TextureFormat::BC7_SRGB;
+	}
+	if (this->texture_format == "rgba8") {
+		return this->linear ? TextureFormat::RGBA8_UNORM : TextureFormat::RGBA8_SRGB;
+	}
+	throw std::invalid_argument("unknown texture format \"" + this->texture_format + "\".");
+}
+
+// === Asset Types ===
+
+AssetPipeline::AssetType AssetPipeline::get_asset_type(const std::string& path) {
+	const std::string extension = to_lower(fs::path(path).extension().string());
+	if (std::find(std::begin(MESH_EXTENSIONS), std::end(MESH_EXTENSIONS), extension) != std::end(MESH_EXTENSIONS)) {
+		return AssetType::MESH;
+	}
+	if (std::find(std::begin(TEXTURE_EXTENSIONS), std::end(TEXTURE_EXTENSIONS), extension) != std::end(TEXTURE_EXTENSIONS)) {
+		return AssetType::TEXTURE;
+	}
+	return AssetType::NONE;
+}
+
+const char* AssetPipeline::get_cooked_extension(AssetType type) {
+	switch (type) {
+	case AssetType::MESH:
+		return ".mesh";
+	case AssetType::TEXTURE:
+		return ".texture";
+	default:
+		return "";
+	}
+}
+
+uint32_t AssetPipeline::get_format_version(AssetType type) {
+	switch (type) {
+	case AssetType::MESH:
+		return MeshFileHeader::VERSION;
+	case AssetType::TEXTURE:
+		return TextureFileHeader::VERSION;
+	default:
+		return 0;
+	}
+}
@@ -0,0 +1,422 @@
+#include "Tools/texture/bc_encoder.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// CODE FORMATTING INFORMATION:
+// Simple functions like getters and setters go at the bottom.
+// Organize from most complex at the top to least complex at the bottom.
+
+static constexpr int BLOCK_TEXELS = 16;
+
+static constexpr int REFINE_ITERATIONS = 2;
+/// Least squares fits after the principal axis endpoints, the best of all tries is kept.
+
+static constexpr int POWER_ITERATIONS = 8;
+
+static constexpr int BC7_WEIGHTS[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+/// Mode 6's interpolation weights out of 64.
+
+namespace {
+
+	// Writes a block's fields least significant bit first, the order every BCn format uses.
+	struct BitWriter {
+		uint8_t* bytes;
+		uint32_t position = 0;
+
+		void write(uint32_t value, uint32_t bit_count) {
+			for (uint32_t bit = 0; bit < bit_count; bit++, this->position++) {
+				if ((value >> bit) & 1u) {
+					this->bytes[this->position / 8] |= static_cast<uint8_t>(1u << (this->position % 8));
+				}
+			}
+		}
+	};
+};
+
+static float get_distance_squared(const float* a, const float* b, int channels) {
+	float distance = 0.0f;
+	for (int c = 0; c < channels; c++) {
+		distance += (a[c] - b[c]) * (a[c] - b[c]);
+	}
+	return distance;
+}
+
+static void find_principal_endpoints(const float (*points)[4], int count, int channels, float* start, float* end) {
+	float mean[4] = {};
+	for (int i = 0; i < count; i++) {
+		for (int c = 0; c < channels; c++) {
+			mean[c] += points[i][c];
+		}
+	}
+	for (int c = 0; c < channels; c++) {
+		mean[c] /= static_cast<float>(count);
+	}
+
+	float covariance[4][4] = {};
+	for (int i = 0; i < count; i++) {
+		for (int a = 0; a < channels; a++) {
+			for (int b = 0; b < channels; b++) {
+				covariance[a][b] += (points[i][a] - mean[a]) * (points[i][b] - mean[b]);
+			}
+		}
+	}
+
+	// Power iteration for the direction of largest variance.
+	float axis[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+	for (int iteration = 0; iteration < POWER_ITERATIONS; iteration++) {
+		float next[4] = {};
+		float largest = 0.0f;
+		for (int a = 0; a < channels; a++) {
+			for (int b = 0; b < channels; b++) {
+				next[a] += covariance[a][b] * axis[b];
+			}
+			largest = std::max(largest, std::abs(next[a]));
+		}
+		if (largest <= 0.0f) {
+			break;
+		}
+		for (int c = 0; c < channels; c++) {
+			axis[c] = next[c] / largest;
+		}
+	}
+
+	float length = 0.0f;
+	for (int c = 0; c < channels; c++) {
+		length += axis[c] * axis[c];
+	}
+	length = length > 0.0f ? std::sqrt(length) : 1.0f;
+
+	float minProjection = std::numeric_limits<float>::max();
+	float maxProjection = std::numeric_limits<float>::lowest();
+	for (int i = 0; i < count; i++) {
+		float projection = 0.0f;
+		for (int c = 0; c < channels; c++) {
+			projection += (points[i][c] - mean[c]) * axis[c] / length;
+		}
+		minProjection = std::min(minProjection, projection);
+		maxProjection = std::max(maxProjection, projection);
+	}
+
+	for (int c = 0; c < channels; c++) {
+		start[c] = std::clamp(mean[c] + axis[c] / length * minProjection, 0.0f, 255.0f);
+		end[c] = std::clamp(mean[c] + axis[c] / length * maxProjection, 0.0f, 255.0f);
+	}
+}
+
+static bool fit_endpoints(const float (*points)[4], const float* weights, int count, int channels, float* start, float* end) {
+	// Least squares for the endpoints given each point's interpolation weight towards `end`.
+	double aa = 0.0, ab = 0.0, bb = 0.0;
+	double ax[4] = {};
+	double bx[4] = {};
+	for (int i = 0; i < count; i++) {
+		const double a = 1.0 - weights[i];
+		const double b = weights[i];
+		aa += a * a;
+		ab += a * b;
+		bb += b * b;
+		for (int c = 0; c < channels; c++) {
+			ax[c] += a * points[i][c];
+			bx[c] += b * points[i][c];
+		}
+	}
+
+	const double determinant = aa * bb - ab * ab;
+	if (std::abs(determinant) < 1e-6) {
+		return false;
+	}
+
+	for (int c = 0; c < channels; c++) {
+		start[c] = std::clamp(static_cast<float>((ax[c] * bb - bx[c] * ab) / determinant), 0.0f, 255.0f);
+		end[c] = std::clamp(static_cast<float>((bx[c] * aa - ax[c] * ab) / determinant), 0.0f, 255.0f);
+	}
+	return true;
+}
+
+static uint16_t pack_565(const float* color) {
+	const uint32_t r = static_cast<uint32_t>(std::clamp(std::round(color[0] * 31.0f / 255.0f), 0.0f, 31.0f));
+	const uint32_t g = static_cast<uint32_t>(std::clamp(std::round(color[1] * 63.0f / 255.0f), 0.0f, 63.0f));
+	const uint32_t b = static_cast<uint32_t>(std::clamp(std::round(color[2] * 31.0f / 255.0f), 0.0f, 31.0f));
+	return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+}
+
+static void unpack_565(uint16_t packed, float* color) {
+	const uint32_t r = packed >> 11;
+	const uint32_t g = (packed >> 5) & 63u;
+	const uint32_t b = packed & 31u;
+	color[0] = static_cast<float>((r << 3) | (r >> 2));
+	color[1] = static_cast<float>((g << 2) | (g >> 4));
+	color[2] = static_cast<float>((b << 3) | (b >> 2));
+	color[3] = 255.0f;
+}
+
+static void write_color_block(uint16_t color0, uint16_t color1, const int* selection, uint8_t* block) {
+	uint32_t indices = 0;
+	for (int i = 0; i < BLOCK_TEXELS; i++) {
+		indices |= static_cast<uint32_t>(selection[i]) << (i * 2);
+	}
+	block[0] = static_cast<uint8_t>(color0);
+	block[1] = static_cast<uint8_t>(color0 >> 8);
+	block[2] = static_cast<uint8_t>(color1);
+	block[3] = static_cast<uint8_t>(color1 >> 8);
+	for (int i = 0; i < 4; i++) {
+		block[4 + i] = static_cast<uint8_t>(indices >> (i * 8));
+	}
+}
+
+static void encode_color_block(const uint8_t* texels, bool punch_through, uint8_t* block) {
+	// BC1 decides the mode from the endpoint order: color0 > color1 interpolates four colors,
+	// otherwise three and index 3 is transparent black.
+	float points[BLOCK_TEXELS][4];
+	bool transparent[BLOCK_TEXELS];
+	int count = 0;
+	for (int i = 0; i < BLOCK_TEXELS; i++) {
+		transparent[i] = punch_through && texels[i * 4 + 3] < 128;
+		if (!transparent[i]) {
+			for (int c = 0; c < 4; c++) {
+				points[count][c] = texels[i * 4 + c];
+			}
+			count++;
+		}
+	}
+
+	int selection[BLOCK_TEXELS];
+	if (count == 0) {
+		std::fill(selection, selection + BLOCK_TEXELS, 3);
+		write_color_block(0, 0, selection, block);
+		return;
+	}
+
+	const bool threeColors = count < BLOCK_TEXELS;
+	const int paletteSize = threeColors ? 3 : 4;
+	const float paletteWeights[4] = { 0.0f, 1.0f, threeColors ? 0.5f : 1.0f / 3.0f, 2.0f / 3.0f };
+
+	float start[4];
+	float end[4];
+	find_principal_endpoints(points, count, 3, start, end);
+
+	float bestError = std::numeric_limits<float>::max();
+	uint16_t bestColor0 = 0;
+	uint16_t bestColor1 = 0;
+	int bestSelection[BLOCK_TEXELS] = {};
+
+	for (int iteration = 0; iteration <= REFINE_ITERATIONS; iteration++) {
+		const uint16_t color0 = pack_565(start);
+		const uint16_t color1 = pack_565(end);
+
+		float palette[4][4];
+		unpack_565(color0, palette[0]);
+		unpack_565(color1, palette[1]);
+		for (int p = 2; p < paletteSize; p++) {
+			for (int c = 0; c < 3; c++) {
+				palette[p][c] = palette[0][c] + (palette[1][c] - palette[0][c]) * paletteWeights[p];
+			}
+		}
+
+		float error = 0.0f;
+		float weights[BLOCK_TEXELS];
+		int point = 0;
+		for (int i = 0; i < BLOCK_TEXELS; i++) {
+			if (transparent[i]) {
+				selection[i] = 3;
+				continue;
+			}
+
+			float nearest = std::numeric_limits<float>::max();
+			for (int p = 0; p < paletteSize; p++) {
+				const float distance = get_distance_squared(points[point], palette[p], 3);
+				if (distance < nearest) {
+					nearest = distance;
+					selection[i] = p;
+				}
+			}
+			error += nearest;
+			weights[point++] = paletteWeights[selection[i]];
+		}
+
+		if (error < bestError) {
+			bestError = error;
+			bestColor0 = color0;
+			bestColor1 = color1;
+			std::copy(selection, selection + BLOCK_TEXELS, bestSelection);
+		}
+		if (error == 0.0f || !fit_endpoints(points, weights, count, 3, start, end)) {
+			break;
+		}
+	}
+
+	// Put the endpoints in the order that selects the mode, the palette is the same reversed.
+	const bool swap = threeColors ? bestColor0 > bestColor1 : bestColor0 < bestColor1;
+	if (swap) {
+		std::swap(bestColor0, bestColor1);
+		for (int& index : bestSelection) {
+			static constexpr int SWAPPED[4] = { 1, 0, 3, 2 };
+			index = threeColors ? (index < 2 ? 1 - index : index) : SWAPPED[index];
+		}
+	}
+	if (!threeColors && bestColor0 == bestColor1) {
+		// Equal endpoints decode as three colors, where index 3 would be black.
+		std::fill(bestSelection, bestSelection + BLOCK_TEXELS, 0);
+	}
+
+	write_color_block(bestColor0, bestColor1, bestSelection, block);
+}
+
+// === Encoding ===
+
+void BcEncoder::encode_bc1(const uint8_t* texels, uint8_t* block) {
+	encode_color_block(texels, true, block);
+}
+
+void BcEncoder::encode_bc3(const uint8_t* texels, uint8_t* block) {
+	encode_bc4(texels, 3, block);
+	// BC3's color block always interpolates four colors, whatever the endpoint order.
+	encode_color_block(texels, false, block + 8);
+}
+
+void BcEncoder::encode_bc4(const uint8_t* texels, uint32_t channel, uint8_t* block) {
+	uint8_t minValue = 255;
+	uint8_t maxValue = 0;
+	for (int i = 0; i < BLOCK_TEXELS; i++) {
+		minValue = std::min(minValue, texels[i * 4 + channel]);
+		maxValue = std::max(maxValue, texels[i * 4 + channel]);
+	}
+
+	// With the larger endpoint first there are six interpolated values between the two.
+	float palette[8];
+	palette[0] = maxValue;
+	palette[1] = minValue;
+	for (int p = 2; p < 8; p++) {
+		palette[p] = ((8 - p) * static_cast<float>(maxValue) + (p - 1) * static_cast<float>(minValue)) / 7.0f;
+	}
+
+	uint64_t indices = 0;
+	if (maxValue != minValue) {
+		for (int i = 0; i < BLOCK_TEXELS; i++) {
+			const float value = texels[i * 4 + channel];
+			uint64_t nearest = 0;
+			for (int p = 1; p < 8; p++) {
+				if (std::abs(value - palette[p]) < std::abs(value - palette[nearest])) {
+					nearest = static_cast<uint64_t>(p);
+				}
+			}
+			indices |= nearest << (i * 3);
+		}
+	}
+
+	block[0] = maxValue;
+	block[1] = minValue;
+	for (int i = 0; i < 6; i++) {
+		block[2 + i] = static_cast<uint8_t>(indices >> (i * 8));
+	}
+}
+
+void BcEncoder::encode_bc5(const uint8_t* texels, uint8_t* block) {
+	encode_bc4(texels, 0, block);
+	encode_bc4(texels, 1, block + 8);
+}
+
+void BcEncoder::encode_bc7(const uint8_t* texels, uint8_t* block) {
+	float points[BLOCK_TEXELS][4];
+	for (int i = 0; i < BLOCK_TEXELS; i++) {
+		for (int c = 0; c < 4; c++) {
+			points[i][c] = texels[i * 4 + c];
+		}
+	}
+
+	float endpoints[2][4];
+	find_principal_endpoints(points, BLOCK_TEXELS, 4, endpoints[0], endpoints[1]);
+
+	float bestError = std::numeric_limits<float>::max();
+	uint32_t bestQuantized[2][4] = {};
+	uint32_t bestPBits[2] = {};
+	int bestSelection[BLOCK_TEXELS] = {};
+
+	for (int iteration = 0; iteration <= REFINE_ITERATIONS; iteration++) {
+		// Endpoints are 7 bits per channel plus a p-bit shared by the endpoint's four channels,
+		// pick the p-bit that lands closer.
+		uint32_t quantized[2][4];
+		uint32_t pBits[2];
+		float palette[16][4];
+		float decoded[2][4];
+		for (int e = 0; e < 2; e++) {
+			float bestEndpointError = std::numeric_limits<float>::max();
+			for (uint32_t p = 0; p < 2; p++) {
+				uint32_t candidate[4];
+				float endpointError = 0.0f;
+				for (int c = 0; c < 4; c++) {
+					candidate[c] = static_cast<uint32_t>(std::clamp(std::round((endpoints[e][c] - p) / 2.0f), 0.0f, 127.0f));
+					const float value = static_cast<float>((candidate[c] << 1) | p);
+					endpointError += (value - endpoints[e][c]) * (value - endpoints[e][c]);
+				}
+				if (endpointError < bestEndpointError) {
+					bestEndpointError = endpointError;
+					pBits[e] = p;
+					std::copy(candidate, candidate + 4, quantized[e]);
+				}
+			}
+			for (int c = 0; c < 4; c++) {
+				decoded[e][c] = static_cast<float>((quantized[e][c] << 1) | pBits[e]);
+			}
+		}
+
+		for (int p = 0; p < 16; p++) {
+			for (int c = 0; c < 4; c++) {
+				const uint32_t start = static_cast<uint32_t>(decoded[0][c]);
+				const uint32_t end = static_cast<uint32_t>(decoded[1][c]);
+				palette[p][c] = static_cast<float>(((64 - BC7_WEIGHTS[p]) * start + BC7_WEIGHTS[p] * end + 32) >> 6);
+			}
+		}
+
+		int selection[BLOCK_TEXELS];
+		float weights[BLOCK_TEXELS];
+		float error = 0.0f;
+		for (int i = 0; i < BLOCK_TEXELS; i++) {
+			float nearest = std::numeric_limits<float>::max();
+			for (int p = 0; p < 16; p++) {
+				const float distance = get_distance_squared(points[i], palette[p], 4);
+				if (distance < nearest) {
+					nearest = distance;
+					selection[i] = p;
+				}
+			}
+			error += nearest;
+			weights[i] = BC7_WEIGHTS[selection[i]] / 64.0f;
+		}
+
+		if (error < bestError) {
+			bestError = error;
+			std::copy(&quantized[0][0], &quantized[0][0] + 8, &bestQuantized[0][0]);
+			std::copy(pBits, pBits + 2, bestPBits);
+			std::copy(selection, selection + BLOCK_TEXELS, bestSelection);
+		}
+		if (error == 0.0f || !fit_endpoints(points, weights, BLOCK_TEXELS, 4, endpoints[0], endpoints[1])) {
+			break;
+		}
+	}
+
+	// The first texel's index drops its top bit, so it must be in the first half of the palette.
+	if (bestSelection[0] >= 8) {
+		for (int c = 0; c < 4; c++) {
+			std::swap(bestQuantized[0][c], bestQuantized[1][c]);
+		}
+		std::swap(bestPBits[0], bestPBits[1]);
+		for (int& index : bestSelection) {
+			index = 15 - index;
+		}
+	}
+
+	std::fill(block, block + 16, static_cast<uint8_t>(0));
+	BitWriter writer{ block };
+	writer.write(1u << 6, 7);
+	for (int c = 0; c < 4; c++) {
+		writer.write(bestQuantized[0][c], 7);
+		writer.write(bestQuantized[1][c], 7);
+	}
+	writer.write(bestPBits[0], 1);
+	writer.write(bestPBits[1], 1);
+	writer.write(static_cast<uint32_t>(bestSelection[0]), 3);
+	for (int i = 1; i < BLOCK_TEXELS; i++) {
+		writer.write(static_cast<uint32_t>(bestSelection[i]), 4);
+	}
+}
@@ -0,0 +1,94 @@
+#include "Tools/texture/mip_generator.h"
+#include "Engine/thread_pool/thread_pool.h"
+#include <algorithm>
+
+#if defined(__AVX__)
+	#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define MIP_GENERATOR_SSE
+#endif
+
+// CODE FORMATTING INFORMATION:
+// Simple functions like getters and setters go at the bottom.
+// Organize from most complex at the top to least complex at the bottom.
+
+static constexpr size_t ROW_CHUNK_SIZE = 16;
+/// Destination rows one thread pool job filters.
+
+static void downsample_rows(const ImageData& source, ImageData& destination, size_t begin, size_t end) {
+	const uint32_t lastX = source.width - 1;
+	const uint32_t lastY = source.height - 1;
+	const float* sourcePixels = &source.pixels[0].x;
+	float* destinationPixels = &destination.pixels[0].x;
+
+	for (size_t y = begin; y < end; y++) {
+		const size_t row0 = static_cast<size_t>(std::min(static_cast<uint32_t>(y * 2), lastY)) * source.width;
+		const size_t row1 = static_cast<size_t>(std::min(static_cast<uint32_t>(y * 2 + 1), lastY)) * source.width;
+		float* output = destinationPixels + y * destination.width * 4;
+
+		for (uint32_t x = 0; x < destination.width; x++) {
+			const uint32_t x0 = std::min(x * 2, lastX);
+			const uint32_t x1 = std::min(x * 2 + 1, lastX);
+			const float* a = sourcePixels + (row0 + x0) * 4;
+			const float* b = sourcePixels + (row0 + x1) * 4;
+			const float* c = sourcePixels + (row1 + x0) * 4;
+			const float* d = sourcePixels + (row1 + x1) * 4;
+
+#if defined(__AVX__)
+			if (x1 == x0 + 1) {
+				// Both source pixels of a row are next to each other, one load each.
+				const __m256 sum = _mm256_add_ps(_mm256_loadu_ps(a), _mm256_loadu_ps(c));
+				const __m128 pixel = _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+				_mm_storeu_ps(output + x * 4, _mm_mul_ps(pixel, _mm_set1_ps(0.25f)));
+				continue;
+			}
+			const __m128 sum = _mm_add_ps(_mm_add_ps(_mm_loadu_ps(a), _mm_loadu_ps(b)), _mm_add_ps(_mm_loadu_ps(c), _mm_loadu_ps(d)));
+			_mm_storeu_ps(output + x * 4, _mm_mul_ps(sum, _mm_set1_ps(0.25f)));
+#elif defined(MIP_GENERATOR_SSE)
+			const __m128 sum = _mm_add_ps(_mm_add_ps(_mm_loadu_ps(a), _mm_loadu_ps(b)), _mm_add_ps(_mm_loadu_ps(c), _mm_loadu_ps(d)));
+			_mm_storeu_ps(output + x * 4, _mm_mul_ps(sum, _mm_set1_ps(0.25f)));
+#else
+			for (int k = 0; k < 4; k++) {
+				output[x * 4 + k] = (a[k] + b[k] + c[k] + d[k]) * 0.25f;
+			}
+#endif
+		}
+	}
+}
+
+// === Mip Chains ===
+
+vector<ImageData> MipGenerator::build_mip_chain(ImageData base, uint32_t max_mip_count, ThreadPool::Pool* pool) {
+	vector<ImageData> mips;
+	mips.push_back(std::move(base));
+
+	while ((mips.back().width > 1 || mips.back().height > 1) && (max_mip_count == ALL_MIPS || mips.size() < max_mip_count)) {
+		// Each level is filtered from the one above, never from the base, so the cost stays a
+		// third of the base's.
+		ImageData next = downsample(mips.back(), pool);
+		mips.push_back(std::move(next));
+	}
+
+	return mips;
+}
+
+ImageData MipGenerator::downsample(const ImageData& image, ThreadPool::Pool* pool) {
+	ImageData result;
+	result.width = std::max(image.width / 2, 1u);
+	result.height = std::max(image.height / 2, 1u);
+	result.pixels.resize(static_cast<size_t>(result.width) * result.height);
+
+	auto filter_rows = [&image, &result](size_t begin, size_t end) {
+		downsample_rows(image, result, begin, end);
+	};
+
+	if (pool != nullptr && result.height > ROW_CHUNK_SIZE) {
+		pool->parallel_for(result.height, ROW_CHUNK_SIZE, filter_rows);
+	}
+	else {
+		filter_rows(0, result.height);
+	}
+
+	return result;
+}
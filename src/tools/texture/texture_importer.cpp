@@ -0,0 +1,33 @@
+#include "Tools/texture/texture_importer.h"
+#include <stdexcept>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+ImageData TextureImporter::import(const std::string& path, bool srgb) {
+	int width;
+	int height;
+	int channels;
+	stbi_uc* texels = stbi_load(path.c_str(), &width, &height, &channels, 4);
+	if (texels == nullptr) {
+		throw std::runtime_error("Failed to decode \"" + path + "\": " + stbi_failure_reason());
+	}
+
+	// Every 8 bit value is converted the same way, a table saves the pow per texel.
+	float colorTable[256];
+	for (int i = 0; i < 256; i++) {
+		colorTable[i] = srgb ? ImageData::decode_srgb(i / 255.0f) : i / 255.0f;
+	}
+
+	ImageData image;
+	image.width = static_cast<uint32_t>(width);
+	image.height = static_cast<uint32_t>(height);
+	image.pixels.resize(static_cast<size_t>(width) * height);
+	for (size_t i = 0; i < image.pixels.size(); i++) {
+		const stbi_uc* texel = texels + i * 4;
+		image.pixels[i] = glm::vec4(colorTable[texel[0]], colorTable[texel[1]], colorTable[texel[2]], texel[3] / 255.0f);
+	}
+
+	stbi_image_free(texels);
+	return image;
+}
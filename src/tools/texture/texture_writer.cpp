@@ -0,0 +1,159 @@
+#include "Tools/texture/texture_writer.h"
+#include "Engine/thread_pool/thread_pool.h"
+#include "Tools/texture/bc_encoder.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+// CODE FORMATTING INFORMATION:
+// Simple functions like getters and setters go at the bottom.
+// Organize from most complex at the top to least complex at the bottom.
+
+static constexpr size_t LEVEL_ALIGNMENT = 16;
+
+static constexpr size_t BLOCK_ROW_CHUNK_SIZE = 4;
+/// Rows of 4x4 blocks one thread pool job encodes.
+
+static bool is_srgb(TextureFormat format) {
+	return format == TextureFormat::RGBA8_SRGB || format == TextureFormat::BC1_SRGB
+		|| format == TextureFormat::BC3_SRGB || format == TextureFormat::BC7_SRGB;
+}
+
+static void to_texel(const glm::vec4& pixel, bool srgb, uint8_t* texel) {
+	// Alpha is never gamma encoded.
+	for (int c = 0; c < 4; c++) {
+		float value = std::clamp(pixel[c], 0.0f, 1.0f);
+		if (srgb && c < 3) {
+			value = ImageData::encode_srgb(value);
+		}
+		texel[c] = static_cast<uint8_t>(std::lround(value * 255.0f));
+	}
+}
+
+static void encode_rows(const ImageData& image, TextureFormat format, std::byte* destination, size_t begin, size_t end) {
+	const bool srgb = is_srgb(format);
+
+	if (!TextureFile::is_block_compressed(format)) {
+		for (size_t y = begin; y < end; y++) {
+			for (uint32_t x = 0; x < image.width; x++) {
+				to_texel(image.get_pixel(x, static_cast<uint32_t>(y)), srgb, reinterpret_cast<uint8_t*>(destination) + (y * image.width + x) * 4);
+			}
+		}
+		return;
+	}
+
+	const uint32_t blockColumns = (image.width + 3) / 4;
+	const size_t blockSize = TextureFile::get_layer_size(format, 4, 4);
+	uint8_t texels[16 * 4];
+
+	for (size_t blockRow = begin; blockRow < end; blockRow++) {
+		for (uint32_t blockColumn = 0; blockColumn < blockColumns; blockColumn++) {
+			// Blocks past the edge repeat the last row and column, which keeps the endpoints
+			// fitted to texels that are actually sampled.
+			for (uint32_t t = 0; t < 16; t++) {
+				const uint32_t x = std::min(blockColumn * 4 + t % 4, image.width - 1);
+				const uint32_t y = std::min(static_cast<uint32_t>(blockRow) * 4 + t / 4, image.height - 1);
+				to_texel(image.get_pixel(x, y), srgb, texels + t * 4);
+			}
+
+			uint8_t* block = reinterpret_cast<uint8_t*>(destination) + (blockRow * blockColumns + blockColumn) * blockSize;
+			switch (format) {
+			case TextureFormat::BC1_UNORM:
+			case TextureFormat::BC1_SRGB:
+				BcEncoder::encode_bc1(texels, block);
+				break;
+			case TextureFormat::BC3_UNORM:
+			case TextureFormat::BC3_SRGB:
+				BcEncoder::encode_bc3(texels, block);
+				break;
+			case TextureFormat::BC5_UNORM:
+				BcEncoder::encode_bc5(texels, block);
+				break;
+			default:
+				BcEncoder::encode_bc7(texels, block);
+				break;
+			}
+		}
+	}
+}
+
+static void encode_level(const ImageData& image, TextureFormat format, std::byte* destination, ThreadPool::Pool* pool) {
+	const size_t rowCount = TextureFile::is_block_compressed(format) ? (image.height + 3) / 4 : image.height;
+	const size_t chunkSize = TextureFile::is_block_compressed(format) ? BLOCK_ROW_CHUNK_SIZE : BLOCK_ROW_CHUNK_SIZE * 4;
+
+	auto encode = [&image, format, destination](size_t begin, size_t end) {
+		encode_rows(image, format, destination, begin, end);
+	};
+
+	if (pool != nullptr && rowCount > chunkSize) {
+		pool->parallel_for(rowCount, chunkSize, encode);
+	}
+	else {
+		encode(0, rowCount);
+	}
+}
+
+// === Writing ===
+
+vector<std::byte> TextureWriter::serialize(const vector<vector<ImageData>>& layers, TextureFormat format, ThreadPool::Pool* pool) {
+	if (layers.empty() || layers[0].empty()) {
+		throw std::invalid_argument("A texture needs at least one layer and one mip.");
+	}
+
+	const uint32_t mipCount = static_cast<uint32_t>(layers[0].size());
+	if (mipCount > TextureFileHeader::MAX_MIP_COUNT) {
+		throw std::invalid_argument("A texture has at most " + std::to_string(TextureFileHeader::MAX_MIP_COUNT) + " mips.");
+	}
+
+	TextureFileHeader header;
+	header.format = format;
+	header.width = layers[0][0].width;
+	header.height = layers[0][0].height;
+	header.mip_count = mipCount;
+	header.layer_count = static_cast<uint32_t>(layers.size());
+
+	size_t fileSize = sizeof(TextureFileHeader);
+	for (uint32_t mip = 0; mip < mipCount; mip++) {
+		TextureFileLevel& level = header.levels[mip];
+		level.width = std::max(header.width >> mip, 1u);
+		level.height = std::max(header.height >> mip, 1u);
+
+		for (const vector<ImageData>& layer : layers) {
+			if (layer.size() != mipCount || layer[mip].width != level.width || layer[mip].height != level.height
+				|| layer[mip].pixels.size() != static_cast<size_t>(level.width) * level.height) {
+				throw std::invalid_argument("Every layer of a texture needs the same size and mip chain.");
+			}
+		}
+
+		level.offset = (fileSize + LEVEL_ALIGNMENT - 1) / LEVEL_ALIGNMENT * LEVEL_ALIGNMENT;
+		level.size = TextureFile::get_layer_size(format, level.width, level.height) * header.layer_count;
+		fileSize = level.offset + level.size;
+	}
+	header.file_size = fileSize;
+
+	vector<std::byte> file(fileSize);
+	std::memcpy(file.data(), &header, sizeof(header));
+
+	for (uint32_t mip = 0; mip < mipCount; mip++) {
+		const TextureFileLevel& level = header.levels[mip];
+		const uint64_t layerSize = level.size / header.layer_count;
+		for (uint32_t layer = 0; layer < header.layer_count; layer++) {
+			encode_level(layers[layer][mip], format, file.data() + level.offset + layer * layerSize, pool);
+		}
+	}
+
+	return file;
+}
+
+void TextureWriter::save(const vector<vector<ImageData>>& layers, TextureFormat format, ThreadPool::Pool* pool, const std::string& path) {
+	vector<std::byte> file = serialize(layers, format, pool);
+
+	std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+	stream.write(reinterpret_cast<const char*>(file.data()), static_cast<std::streamsize>(file.size()));
+
+	if (!stream) {
+		throw std::runtime_error("Couldn't write the texture file \"" + path + "\".");
+	}
+}
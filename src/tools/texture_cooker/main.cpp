@@ -0,0 +1,153 @@
+//*****************************************
+// This is the entry point for the texture cooker, the offline tool that turns source images
+// into block compressed textures with their mips
+//*****************************************
+
+#include "Engine/texture/texture_file.h"
+#include "Engine/thread_pool/thread_pool.h"
+#include "Tools/texture/image_data.h"
+#include "Tools/texture/mip_generator.h"
+#include "Tools/texture/texture_importer.h"
+#include "Tools/texture/texture_writer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using std::cout, std::cerr, std::endl;
+using std::vector;
+
+static double get_milliseconds_since(std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void print_usage() {
+	cout << "Usage: texture_cooker [options] <source> [<source>...] <output>\n"
+		<< "  Decodes images, builds their mips and block compresses them into a cooked texture the runtime\n"
+		<< "  copies to the GPU as is.  Several sources make an array texture, one layer each.\n\n"
+		<< "Options:\n"
+		<< "  --format <bc1|bc3|bc5|bc7|rgba8>  the GPU format, defaults to bc7\n"
+		<< "  --linear                          the sources are data (masks, roughness...), not sRGB colors; always the case for bc5\n"
+		<< "  --no-mips                         only store the full size image\n"
+		<< "  --threads <count>                 worker threads, defaults to the hardware's\n"
+		<< endl;
+}
+
+int main(int argc, char** argv)
+{
+	std::string formatName = "bc7";
+	bool linear = false;
+	bool buildMips = true;
+	size_t threadCount = std::max(1u, std::thread::hardware_concurrency());
+	vector<std::string> paths;
+
+	for (int i = 1; i < argc; i++) {
+		if (std::strcmp(argv[i], "--format") == 0 && i + 1 < argc) {
+			formatName = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--linear") == 0) {
+			linear = true;
+		}
+		else if (std::strcmp(argv[i], "--no-mips") == 0) {
+			buildMips = false;
+		}
+		else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+			threadCount = static_cast<size_t>(std::max(1l, std::strtol(argv[++i], nullptr, 10)));
+		}
+		else if (std::strcmp(argv[i], "--help") == 0) {
+			print_usage();
+			return 0;
+		}
+		else {
+			paths.push_back(argv[i]);
+		}
+	}
+
+	if (paths.size() < 2) {
+		print_usage();
+		return 1;
+	}
+
+	const std::string outputPath = paths.back();
+	paths.pop_back();
+
+	TextureFormat format;
+	if (formatName == "bc1") {
+		format = linear ? TextureFormat::BC1_UNORM : TextureFormat::BC1_SRGB;
+	}
+	else if (formatName == "bc3") {
+		format = linear ? TextureFormat::BC3_UNORM : TextureFormat::BC3_SRGB;
+	}
+	else if (formatName == "bc5") {
+		linear = true;
+		format = TextureFormat::BC5_UNORM;
+	}
+	else if (formatName == "bc7") {
+		format = linear ? TextureFormat::BC7_UNORM : TextureFormat::BC7_SRGB;
+	}
+	else if (formatName == "rgba8") {
+		format = linear ? TextureFormat::RGBA8_UNORM : TextureFormat::RGBA8_SRGB;
+	}
+	else {
+		cerr << "Unknown format \"" << formatName << "\"." << endl;
+		return 1;
+	}
+
+	try {
+		ThreadPool::Pool pool(1, threadCount);
+
+		// One job per source, decoding is single threaded inside stb_image.
+		auto start = std::chrono::steady_clock::now();
+		vector<ImageData> images(paths.size());
+		pool.parallel_for(paths.size(), 1, [&images, &paths, linear](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++) {
+				images[i] = TextureImporter::import(paths[i], !linear);
+			}
+		});
+		double importMilliseconds = get_milliseconds_since(start);
+
+		cout << " - Imported " << paths.size() << " images of " << images[0].width << "x" << images[0].height << " in " << importMilliseconds << "ms" << endl;
+
+		start = std::chrono::steady_clock::now();
+		vector<vector<ImageData>> layers;
+		layers.reserve(images.size());
+		for (ImageData& image : images) {
+			layers.push_back(MipGenerator::build_mip_chain(std::move(image), buildMips ? MipGenerator::ALL_MIPS : 1, &pool));
+		}
+		double mipMilliseconds = get_milliseconds_since(start);
+
+		cout << " - Built " << layers[0].size() << " mips in " << mipMilliseconds << "ms" << endl;
+
+		start = std::chrono::steady_clock::now();
+		TextureWriter::save(layers, format, &pool, outputPath);
+		double encodeMilliseconds = get_milliseconds_since(start);
+
+		// Load the result back the way the runtime does, so a broken file never leaves the cooker.
+		start = std::chrono::steady_clock::now();
+		TextureFile cooked(outputPath);
+		double loadMilliseconds = get_milliseconds_since(start);
+
+		uint64_t uncompressedSize = 0;
+		for (uint32_t mip = 0; mip < cooked.get_mip_count(); mip++) {
+			const TextureFileLevel& level = cooked.get_level(mip);
+			uncompressedSize += TextureFile::get_layer_size(TextureFormat::RGBA8_UNORM, level.width, level.height) * cooked.get_layer_count();
+		}
+
+		cout << std::fixed << std::setprecision(3)
+			<< " - Encoded " << formatName << (linear ? "" : " sRGB") << " on " << pool.thread_count << " threads in " << encodeMilliseconds << "ms\n"
+			<< " - Wrote " << cooked.size() << " bytes to \"" << outputPath << "\", " << static_cast<double>(uncompressedSize) / cooked.size() << "x smaller than RGBA8\n"
+			<< " - Mapped and validated in " << loadMilliseconds << "ms" << endl;
+	}
+	catch (const std::exception& exception) {
+		cerr << "Cooking failed: " << exception.what() << endl;
+		return 1;
+	}
+
+	return 0;
+}